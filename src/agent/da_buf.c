@@ -24,6 +24,7 @@
 #include "da_string.h"
 
 static size_t mbuf_offset; /* mbuf offset in chunk (const) */
+static size_t mbuf_reserve; /* headroom of new mbuf (const) */
 struct pool_head *pool2_buf = NULL;
 
 int mbuf_init(struct instance *ins) {
@@ -33,6 +34,7 @@ int mbuf_init(struct instance *ins) {
 		return -1;
 	}
 	mbuf_offset = ins->mbuf_chunk_size - sizeof(struct mbuf);
+	mbuf_reserve = mbuf_offset >= 4 * MBUF_HEADROOM ? MBUF_HEADROOM : 0;
 	log_debug("mbuf hsize %lu chunk size %zu offset %zu length %zu",
 			sizeof(struct mbuf), ins->mbuf_chunk_size, mbuf_offset,
 			mbuf_offset);
@@ -79,8 +81,8 @@ struct mbuf *mbuf_get() {
 
 	ASSERT(mbuf->end - mbuf->start == (int )mbuf_offset);ASSERT(mbuf->start < mbuf->end);
 
-	mbuf->pos = mbuf->start;
-	mbuf->last = mbuf->start;
+	mbuf->pos = mbuf->start + mbuf_reserve;
+	mbuf->last = mbuf->pos;
 
 	log_debug("get mbuf %p", mbuf);
 	return mbuf;
@@ -102,8 +104,8 @@ void mbuf_put(struct mbuf *mbuf) {
  * 重置mbuf
  */
 void mbuf_rewind(struct mbuf *mbuf) {
-	mbuf->pos = mbuf->start;
-	mbuf->last = mbuf->start;
+	mbuf->pos = mbuf->start + mbuf_reserve;
+	mbuf->last = mbuf->pos;
 }
 
 /*
@@ -119,6 +121,14 @@ uint32_t mbuf_size(struct mbuf *mbuf) {
 	return (uint32_t) (mbuf->end - mbuf->last);
 }
 
+/*
+ * 返回pos前可以写入的空间
+ */
+uint32_t mbuf_headroom(struct mbuf *mbuf) {
+	ASSERT(mbuf->pos >= mbuf->start);
+	return (uint32_t) (mbuf->pos - mbuf->start);
+}
+
 size_t mbuf_data_size(void) {
 	return mbuf_offset;
 }
@@ -150,6 +160,20 @@ void mbuf_copy(struct mbuf *mbuf, uint8_t *pos, size_t n) {
 	mbuf->last += n;
 }
 
+/*
+ * copy data before pos,n must not exceed headroom
+ */
+void mbuf_prepend(struct mbuf *mbuf, uint8_t *pos, size_t n) {
+	if (n == 0) {
+		return;
+	}
+	ASSERT(n <= mbuf_headroom(mbuf));
+	/* no overlapping copy */
+	ASSERT(pos < mbuf->start || pos >= mbuf->end);
+	mbuf->pos -= n;
+	da_memcpy(mbuf->pos, pos, n);
+}
+
 struct mbuf* mbuf_split(struct mbuf *mbuf, uint8_t *pos, mbuf_copy_t cb,
 		void *cbarg) {
 	struct mbuf *nbuf;
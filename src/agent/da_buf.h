@@ -43,6 +43,10 @@ STAILQ_HEAD(buf_stqh, mbuf);
 #define MBUF_MIN_SIZE 256
 #define MBUF_MAX_SIZE 16777216
 #define DEF_MBUF_SIZE 16384
+/*
+ * mbuf数据区前预留的空间，转发时在原地写入DTC头，chunk太小时不预留
+ */
+#define MBUF_HEADROOM 64
 
 static inline bool mbuf_empty(struct mbuf *mbuf) {
   return mbuf->pos == mbuf->last ? true : false;
@@ -59,10 +63,12 @@ void mbuf_put(struct mbuf *mbuf);
 void mbuf_rewind(struct mbuf *mbuf);
 uint32_t mbuf_length(struct mbuf *mbuf);
 uint32_t mbuf_size(struct mbuf *mbuf);
+uint32_t mbuf_headroom(struct mbuf *mbuf);
 size_t mbuf_data_size(void);
 void mbuf_insert(struct buf_stqh *mhdr, struct mbuf *mbuf);
 void mbuf_remove(struct buf_stqh *mhdr, struct mbuf *mbuf);
 void mbuf_copy(struct mbuf *mbuf, uint8_t *pos, size_t n);
+void mbuf_prepend(struct mbuf *mbuf, uint8_t *pos, size_t n);
 struct mbuf *mbuf_split(struct mbuf *mbuf, uint8_t *pos, mbuf_copy_t cb,
                         void *cbarg);
 struct mbuf *_mbuf_split(struct mbuf *mbuf, uint8_t *pos, mbuf_copy_t cb,
@@ -24,7 +24,9 @@
 #include "da_log.h"
 #include "da_conf.h"
 #include "da_util.h"
+#include "da_time.h"
 #include "da_top_percentile.h"
+#include "da_hotkey.h"
 
 #define DEFINE_ACTION(_hash, _name) string(#_name),
 static struct string hash_strings[] = {
@@ -55,6 +57,10 @@ static struct command conf_commands[] = {
 		{ string("TopPercentileEnable"), conf_set_bool, offsetof(struct conf_pool, top_percentile_enable) },
 		{ string("TopPercentileDomain"), conf_set_string, offsetof(struct conf_pool, top_percentile_domain) },
 		{ string("TopPercentilePort"), conf_set_num, offsetof(struct conf_pool, top_percentile_port) },
+		{ string("TopPercentileInterval"), conf_set_num, offsetof(struct conf_pool, top_percentile_interval) },
+		{ string("HotKeyThreshold"), conf_set_num, offsetof(struct conf_pool, hotkey_threshold) },
+		{ string("HotKeyInterval"), conf_set_num, offsetof(struct conf_pool, hotkey_interval) },
+		{ string("HotKeyFanout"), conf_set_bool, offsetof(struct conf_pool, hotkey_fanout) },
 		//For Sharding 
 		{ string("ShardingReplicaEnable"), conf_set_bool, offsetof(struct conf_server, replica_enable) },
 		{ string("ShardingName"), conf_set_string, offsetof(struct conf_server, name) },
@@ -91,6 +97,14 @@ static char *svrpool_elem[] = {
 		"TopPercentilePort",
 		};
 
+//可缺省的pool属性，未配置时取默认值
+static char *svrpool_opt_elem[] = {
+		"TopPercentileInterval",
+		"HotKeyThreshold",
+		"HotKeyInterval",
+		"HotKeyFanout",
+		};
+
 static char *server_elem[] = {
 		"ShardingReplicaEnable",
 		"ShardingName",             //Server name
@@ -299,6 +313,10 @@ static int conf_pool_init(struct conf_pool *cp, struct string *name) {
 	cp->auto_remove_replica = CONF_UNSET_NUM;
 	cp->top_percentile_enable = CONF_UNSET_NUM;
 	cp->top_percentile_port = CONF_UNSET_NUM;
+	cp->top_percentile_interval = CONF_UNSET_NUM;
+	cp->hotkey_threshold = CONF_UNSET_NUM;
+	cp->hotkey_interval = CONF_UNSET_NUM;
+	cp->hotkey_fanout = CONF_UNSET_NUM;
 
 	string_init(&cp->idc);
 	cp->valid = 0;
@@ -371,6 +389,8 @@ int conf_pool_each_transform(void *elem, void *data) {
 	sp->ncontinuum = 0;
 	sp->nserver_continuum = 0;
 	sp->continuum = NULL;
+	sp->hotkey = NULL;
+	sp->hotkey_fanout = 0;
 
 	string_copy(&sp->name, cp->name.data, cp->name.len);
 	string_copy(&sp->accesskey, cp->accesskey.data, cp->accesskey.len);
@@ -415,6 +435,19 @@ int conf_pool_each_transform(void *elem, void *data) {
 		set_remote_param((uBid << 32) | uIP, (uConstValue << 32) | sp->port, RT_SHARDING, sp->top_percentile_param);
 		set_remote_param(uBid, 1, RT_ALL, sp->top_percentile_param);
 	}
+	sp->top_percentile_interval = cp->top_percentile_interval;
+	sp->top_percentile_last = now_ms;
+	sp->top_percentile_stat = calloc((int8_t)RT_MAX - 1, sizeof(struct top_percentile_stat));
+	if (sp->top_percentile_stat == NULL) {
+		log_error("transform to pool '%.*s' error : can not calloc mem for top percentile stat",
+				cp->name.len, cp->name.data);
+		return -1;
+	}
+
+	if (cp->hotkey_threshold > 0) {
+		sp->hotkey = hotkey_create((uint32_t)cp->hotkey_threshold, cp->hotkey_interval);
+		sp->hotkey_fanout = (sp->hotkey != NULL && cp->hotkey_fanout) ? 1 : 0;
+	}
 
 	status = server_init(&sp->server, &cp->server, sp);
 	if (status != 0) {
@@ -556,6 +589,25 @@ static int conf_parse_core(struct conf *cf) {
 			string_deinit(&cf->arg);
 		}
 
+		sz = sizeof(svrpool_opt_elem) / sizeof(svrpool_opt_elem[0]);
+		for (i = 0; i < sz; i++) {
+			char *argment = (char *) mxmlElementGetAttr(poolnode,
+					svrpool_opt_elem[i]);
+			if (argment == NULL) {
+				continue;
+			}
+			status = string_copy(&cf->arg, (uint8_t *) argment,
+					da_strlen(argment));
+			if (status < 0) {
+				return status;
+			}
+			status = conf_handler(svrpool_opt_elem[i], cf, void_cp);
+			if (status < 0) {
+				return status;
+			}
+			string_deinit(&cf->arg);
+		}
+
 		for (servernode = mxmlFindElement(poolnode, poolnode, "CACHESHARDING",
 		NULL, NULL, MXML_DESCEND); servernode != NULL; servernode =
 				mxmlFindElement(servernode, poolnode, "CACHESHARDING",
@@ -809,6 +861,22 @@ static int conf_validate_pool(struct conf *cf, struct conf_pool *cp) {
 		cp->top_percentile_port = CONF_DEFAULT_TOP_PERCENTILE_PORT;
 	}
 
+	if (cp->top_percentile_interval == CONF_UNSET_NUM || cp->top_percentile_interval <= 0){
+		cp->top_percentile_interval = CONF_DEFAULT_TOP_PERCENTILE_INTERVAL;
+	}
+
+	if (cp->hotkey_threshold == CONF_UNSET_NUM || cp->hotkey_threshold < 0){
+		cp->hotkey_threshold = CONF_DEFAULT_HOTKEY_THRESHOLD;
+	}
+
+	if (cp->hotkey_interval == CONF_UNSET_NUM || cp->hotkey_interval <= 0){
+		cp->hotkey_interval = CONF_DEFAULT_HOTKEY_INTERVAL;
+	}
+
+	if (cp->hotkey_fanout == CONF_UNSET_NUM){
+		cp->hotkey_fanout = CONF_DEFAULT_HOTKEY_FANOUT;
+	}
+
 	if (cp->server_connections == CONF_UNSET_NUM) {
 		cp->server_connections = CONF_DEFAULT_SERVER_CONNECTIONS;
 	} else if (cp->server_connections == 0) {
@@ -958,6 +1026,8 @@ static void conf_dump(struct conf *cf) {
 		log_debug("server_connections: %d", cp->server_connections);
 		log_debug("idc : %.*s", cp->idc.len , cp->idc.data);
 		log_debug("ReplicaEnable : %d", cp->replica_enable);
+		log_debug("HotKeyThreshold : %d", cp->hotkey_threshold);
+		log_debug("HotKeyFanout : %d", cp->hotkey_fanout);
 
 
 		nserver = array_n(&cp->server);
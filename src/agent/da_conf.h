@@ -44,6 +44,10 @@
 #define CONF_DEFAULT_TOP_PERCENTILE_ENABLE 1
 #define CONF_DEFAULT_TOP_PERCENTILE_DOMAIN "127.0.0.1"
 #define CONF_DEFAULT_TOP_PERCENTILE_PORT 20020
+#define CONF_DEFAULT_TOP_PERCENTILE_INTERVAL 1000
+#define CONF_DEFAULT_HOTKEY_THRESHOLD 0
+#define CONF_DEFAULT_HOTKEY_INTERVAL 1000
+#define CONF_DEFAULT_HOTKEY_FANOUT false
 #define CONF_DEFAULT_LOG_SWITCH 0 /*1:on, 0:off*/
 #define CONF_DEFAULT_REMOTE_LOG_SWITCH 1 /*1:on, 0:off*/
 #define CONF_DEFAULT_REMOTE_LOG_IP "127.0.0.1"
@@ -97,6 +101,11 @@ struct conf_pool {
 	int top_percentile_enable; /*tp99 性能指标开启状态*/
 	struct string top_percentile_domain; /*tp99 性能指标上报服务器地址*/
 	int top_percentile_port; /*tp99 性能指标上报服务器端口*/
+	int top_percentile_interval; /*tp99 性能指标汇总上报周期(ms)*/
+
+	int hotkey_threshold; /*周期内访问次数达到该值的key视为热点，0关闭探测*/
+	int hotkey_interval; /*热点key统计周期(ms)*/
+	int hotkey_fanout; /*热点key的读请求分散到副本*/
 
 	char localip[16]; /*本地IP，放在此位置*/
 	unsigned valid : 1; /* valid? */
@@ -27,6 +27,8 @@
 #include "da_time.h"
 #include "da_signal.h"
 #include "da_stats.h"
+#include "da_top_percentile.h"
+#include "da_hotkey.h"
 
 static enum core_status inst_status = NORMAL;
 static uint32_t ctx_id; /* context generation */
@@ -439,6 +441,8 @@ int core_loop(struct context *ctx) {
 	}
 	process_cached_write_event(ctx);
 	core_timeout(ctx);
+	top_percentile_flush(ctx);
+	hotkey_flush(ctx);
 	stats_swap(ctx->stats);
 	return 0;
 }
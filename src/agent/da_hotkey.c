@@ -0,0 +1,266 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "da_hotkey.h"
+#include "da_hashkit.h"
+#include "da_core.h"
+#include "da_server.h"
+#include "da_msg.h"
+#include "da_stats.h"
+#include "da_time.h"
+#include "da_log.h"
+
+#define HOTKEY_FILE "da.hotkey"
+
+struct hotkey_sketch *hotkey_create(uint32_t threshold, int interval)
+{
+	struct hotkey_sketch *hk;
+
+	hk = calloc(1, sizeof(*hk));
+	if (hk == NULL) {
+		log_error("hotkey sketch alloc failed");
+		return NULL;
+	}
+	hk->threshold = threshold;
+	hk->interval = interval;
+	hk->last_flush = now_ms;
+	return hk;
+}
+
+static void hotkey_file_name(struct server_pool *pool, char *path, int len)
+{
+	snprintf(path, len, "%s%s_%.*s_%d", STATS_DIR, HOTKEY_FILE,
+			pool->name.len, pool->name.data, (int)getpid());
+}
+
+void hotkey_destroy(struct hotkey_sketch *hk, struct server_pool *pool)
+{
+	char path[256];
+
+	if (hk == NULL)
+		return;
+	hotkey_file_name(pool, path, sizeof(path));
+	unlink(path);
+	free(hk);
+}
+
+/*
+ * conservative update：只增加等于最小值的计数器，返回增加后的估计值。
+ * 各行的下标由同一个hash派生(h1 + i * h2)。
+ */
+static uint32_t hotkey_sketch_add(struct hotkey_sketch *hk, uint32_t hash)
+{
+	uint32_t h2 = ((hash >> 16) | (hash << 16)) * 0x9e3779b1U | 1;
+	uint32_t *cell[HOTKEY_SKETCH_DEPTH];
+	uint32_t min = UINT32_MAX;
+	int i;
+
+	for (i = 0; i < HOTKEY_SKETCH_DEPTH; i++) {
+		cell[i] = &hk->counter[i][(hash + i * h2) & (HOTKEY_SKETCH_WIDTH - 1)];
+		if (*cell[i] < min)
+			min = *cell[i];
+	}
+	for (i = 0; i < HOTKEY_SKETCH_DEPTH; i++) {
+		if (*cell[i] == min)
+			(*cell[i])++;
+	}
+	return min + 1;
+}
+
+/* 候选key的淘汰依据，刚进入新周期的热点key还保有上个周期的计数 */
+static inline uint32_t hotkey_weight(struct hotkey_item *it)
+{
+	return it->count > it->last ? it->count : it->last;
+}
+
+static struct hotkey_item *hotkey_find(struct hotkey_sketch *hk, uint32_t hash,
+		uint8_t *key, uint32_t keylen)
+{
+	int i;
+	uint32_t cmplen = keylen < HOTKEY_KEY_LEN ? keylen : HOTKEY_KEY_LEN;
+
+	for (i = 0; i < hk->nitem; i++) {
+		struct hotkey_item *it = &hk->item[i];
+		if (it->hash == hash && it->keylen == keylen
+				&& memcmp(it->key, key, cmplen) == 0)
+			return it;
+	}
+	return NULL;
+}
+
+int hotkey_touch(struct hotkey_sketch *hk, uint8_t *key, uint32_t keylen)
+{
+	struct hotkey_item *it, *min;
+	uint32_t hash, est;
+	int i;
+
+	hash = hash_murmur((const char *)key, keylen);
+	est = hotkey_sketch_add(hk, hash);
+
+	it = hotkey_find(hk, hash, key, keylen);
+	if (it == NULL) {
+		//候选列表已满时，只有估计值超过列表中最小的才替换进来
+		if (hk->nitem < HOTKEY_TOPK) {
+			it = &hk->item[hk->nitem++];
+		} else {
+			min = &hk->item[0];
+			for (i = 1; i < HOTKEY_TOPK; i++) {
+				if (hotkey_weight(&hk->item[i]) < hotkey_weight(min))
+					min = &hk->item[i];
+			}
+			if (est <= hotkey_weight(min))
+				return 0;
+			it = min;
+		}
+		it->hash = hash;
+		it->last = 0;
+		it->keylen = keylen;
+		memcpy(it->key, key, keylen < HOTKEY_KEY_LEN ? keylen : HOTKEY_KEY_LEN);
+	}
+	it->count = est;
+
+	//上个周期的热点在新周期刚开始计数时仍视为热点
+	return it->count >= hk->threshold || it->last >= hk->threshold;
+}
+
+int hotkey_check(struct context *ctx, struct server_pool *pool,
+		struct msg *msg)
+{
+	struct keypos *kpos;
+
+	//多key请求已按server拆分，只统计单key请求
+	if (pool->hotkey == NULL || msg->keyCount != 1)
+		return 0;
+
+	kpos = &msg->keys[0];
+	if (kpos->start == NULL || kpos->end <= kpos->start)
+		return 0;
+
+	if (!hotkey_touch(pool->hotkey, kpos->start, kpos->end - kpos->start))
+		return 0;
+
+	stats_pool_incr(ctx, pool, pool_hotkey_requests);
+	if (msg->cmd != MSG_REQ_GET || pool->hotkey_fanout == 0)
+		return 0;
+
+	stats_pool_incr(ctx, pool, pool_hotkey_fanout);
+	return 1;
+}
+
+static int hotkey_item_cmp(const void *a, const void *b)
+{
+	const struct hotkey_item *x = a, *y = b;
+
+	if (x->count != y->count)
+		return x->count < y->count ? 1 : -1;
+	return 0;
+}
+
+/* 可打印的key原样输出，否则输出十六进制 */
+static void hotkey_dump_key(FILE *fp, struct hotkey_item *it)
+{
+	uint32_t i, len = it->keylen < HOTKEY_KEY_LEN ? it->keylen : HOTKEY_KEY_LEN;
+
+	for (i = 0; i < len; i++) {
+		if (!isgraph(it->key[i]))
+			break;
+	}
+	if (i == len) {
+		fprintf(fp, "%.*s", (int)len, it->key);
+	} else {
+		fprintf(fp, "0x");
+		for (i = 0; i < len; i++)
+			fprintf(fp, "%02x", it->key[i]);
+	}
+	if (len < it->keylen)
+		fprintf(fp, "...");
+}
+
+/* 先写临时文件再rename，读取方不会看到写了一半的列表 */
+static void hotkey_publish(struct server_pool *pool, struct hotkey_sketch *hk)
+{
+	char path[256], tmp[264];
+	FILE *fp;
+	int i;
+
+	hotkey_file_name(pool, path, sizeof(path));
+	snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+	fp = fopen(tmp, "w");
+	if (fp == NULL) {
+		log_error("open hotkey file %s failed: %m", tmp);
+		return;
+	}
+	fprintf(fp, "# time %"PRIu64" interval %d threshold %u\n", now_ms,
+			hk->interval, hk->threshold);
+	for (i = 0; i < hk->nitem; i++) {
+		struct hotkey_item *it = &hk->item[i];
+		if (it->count == 0)
+			break;
+		fprintf(fp, "%u %s ", it->count,
+				it->count >= hk->threshold ? "hot" : "-");
+		hotkey_dump_key(fp, it);
+		fprintf(fp, "\n");
+
+		if (it->count >= hk->threshold && it->last < hk->threshold) {
+			log_info("pool %.*s hot key found, count %u, keylen %u",
+					pool->name.len, pool->name.data, it->count, it->keylen);
+		}
+	}
+	fclose(fp);
+
+	if (rename(tmp, path) < 0)
+		log_error("rename hotkey file %s failed: %m", path);
+}
+
+void hotkey_flush(struct context *ctx)
+{
+	uint32_t i;
+	int j, n;
+
+	for (i = 0; i < array_n(&ctx->pool); i++) {
+		struct server_pool *pool = array_get(&ctx->pool, i);
+		struct hotkey_sketch *hk = pool->hotkey;
+
+		if (hk == NULL || now_ms - hk->last_flush < (uint64_t)hk->interval)
+			continue;
+		hk->last_flush = now_ms;
+
+		qsort(hk->item, hk->nitem, sizeof(hk->item[0]), hotkey_item_cmp);
+		hotkey_publish(pool, hk);
+
+		//新周期重新计数，本周期没有访问的候选key被淘汰
+		memset(hk->counter, 0, sizeof(hk->counter));
+		for (j = 0, n = 0; j < hk->nitem; j++) {
+			struct hotkey_item *it = &hk->item[j];
+			if (it->count == 0)
+				continue;
+			it->last = it->count;
+			it->count = 0;
+			if (n != j)
+				hk->item[n] = *it;
+			n++;
+		}
+		hk->nitem = n;
+	}
+}
@@ -0,0 +1,62 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#ifndef DA_HOTKEY_H_
+#define DA_HOTKEY_H_
+
+#include <stdint.h>
+
+struct context;
+struct server_pool;
+struct msg;
+
+/*
+ * 每个pool一个热点key探测器：count-min sketch估计每个key在当前周期内的
+ * 访问次数，另外保留估计值最大的HOTKEY_TOPK个候选key。
+ * 每个周期结束时把候选列表输出到stats目录，sketch清零重新计数。
+ */
+#define HOTKEY_SKETCH_DEPTH 4
+#define HOTKEY_SKETCH_WIDTH 4096 /* 必须是2的幂 */
+#define HOTKEY_TOPK 16
+#define HOTKEY_KEY_LEN 64 /* 只保存key的前64字节用于比较和输出 */
+
+struct hotkey_item {
+  uint32_t hash;
+  uint32_t count; /* 本周期的估计访问次数 */
+  uint32_t last;  /* 上个周期的估计访问次数 */
+  uint32_t keylen;
+  uint8_t key[HOTKEY_KEY_LEN];
+};
+
+struct hotkey_sketch {
+  uint32_t threshold; /* 周期内访问次数达到该值即为热点 */
+  int interval;       /* 周期(ms) */
+  uint64_t last_flush;
+  int nitem;
+  struct hotkey_item item[HOTKEY_TOPK];
+  uint32_t counter[HOTKEY_SKETCH_DEPTH][HOTKEY_SKETCH_WIDTH];
+};
+
+struct hotkey_sketch *hotkey_create(uint32_t threshold, int interval);
+void hotkey_destroy(struct hotkey_sketch *hk, struct server_pool *pool);
+/* 记录一次访问，返回1表示该key当前是热点 */
+int hotkey_touch(struct hotkey_sketch *hk, uint8_t *key, uint32_t keylen);
+/* 统计请求中的key，请求含热点key且pool开启了热点读扩散时返回1 */
+int hotkey_check(struct context *ctx, struct server_pool *pool,
+                 struct msg *msg);
+/* 在事件循环中调用，到达周期的pool输出热点列表并重新计数 */
+void hotkey_flush(struct context *ctx);
+
+#endif
@@ -322,14 +322,16 @@ static void req_make_loopback(struct context *ctx, struct conn *conn,
 int dtc_header_add(struct msg *msg, enum enum_agent_admin admin, char* dbname)
 {
 	struct DTC_HEADER_V2 dtc_header = { 0 };
+	struct mbuf *mbuf, *hbuf;
+	uint32_t plen = 0, hlen;
 
-	struct mbuf *mbuf = STAILQ_LAST(&msg->buf_q, mbuf, next);
+	mbuf = STAILQ_FIRST(&msg->buf_q);
 	if (!mbuf)
 		return -1;
 
-	struct mbuf *new_buf = mbuf_get();
-	if (new_buf == NULL)
-		return -2;
+	STAILQ_FOREACH(hbuf, &msg->buf_q, next) {
+		plen += mbuf_length(hbuf);
+	}
 
 	dtc_header.version = DA_PROTOCOL_VERSION;
 	dtc_header.admin = admin;
@@ -341,21 +343,35 @@ int dtc_header_add(struct msg *msg, enum enum_agent_admin admin, char* dbname)
 	dtc_header.id = msg->id;
 
 	dtc_header.dbname_len = dbname ? strlen(dbname) : 0;
-	dtc_header.packet_len = mbuf_length(mbuf) + sizeof(dtc_header) + dtc_header.dbname_len;
+	hlen = sizeof(dtc_header) + dtc_header.dbname_len;
+	dtc_header.packet_len = plen + hlen;
 	dtc_header.layer = msg->layer;
 
-	mbuf_copy(new_buf, &dtc_header, sizeof(dtc_header));
-	if(dbname)
-		mbuf_copy(new_buf, dbname, dtc_header.dbname_len);
-	mbuf_copy(new_buf, mbuf->start, mbuf_length(mbuf));
-
-	mbuf_remove(&msg->buf_q, mbuf);
-	mbuf_put(mbuf);
-	mbuf_insert(&msg->buf_q, new_buf);
+	/*
+	 * 头部写到首个mbuf预留的空间里，空间不够时在前面挂一个只有头部的mbuf，
+	 * 数据本身不拷贝，发送时由msg_send_chain按iovec一起发出
+	 */
+	if (mbuf_headroom(mbuf) >= hlen) {
+		if (dbname)
+			mbuf_prepend(mbuf, (uint8_t *)dbname, dtc_header.dbname_len);
+		mbuf_prepend(mbuf, (uint8_t *)&dtc_header, sizeof(dtc_header));
+	} else {
+		hbuf = mbuf_get();
+		if (hbuf == NULL)
+			return -2;
+		if (hlen > mbuf_size(hbuf)) {
+			mbuf_put(hbuf);
+			return -3;
+		}
+		mbuf_copy(hbuf, (uint8_t *)&dtc_header, sizeof(dtc_header));
+		if (dbname)
+			mbuf_copy(hbuf, (uint8_t *)dbname, dtc_header.dbname_len);
+		STAILQ_INSERT_HEAD(&msg->buf_q, hbuf, next);
+	}
 
-	msg->mlen = mbuf_length(new_buf);
-	log_debug("msg->mlen:%d sizeof(dtc_header):%d mbuf_length(mbuf):%d",
-		  msg->mlen, sizeof(dtc_header), mbuf_length(mbuf));
+	msg->mlen = dtc_header.packet_len;
+	log_debug("msg->mlen:%d sizeof(dtc_header):%d payload:%d",
+		  msg->mlen, sizeof(dtc_header), plen);
 
 	return 0;
 }
@@ -140,22 +140,33 @@ static void rsp_recv_done_stats(struct context *ctx, struct cache_instance *ci,
 
 int dtc_header_remove(struct msg* msg)
 {
-	struct mbuf* mbuf = STAILQ_LAST(&msg->buf_q, mbuf, next);
-	if(!mbuf)
+	struct mbuf *mbuf, *nbuf;
+	uint32_t n = sizeof(struct DTC_HEADER_V2);
+	uint32_t len;
+
+	if(STAILQ_EMPTY(&msg->buf_q) || msg->mlen < n)
 		return -1;
 
-	struct mbuf* new_buf = mbuf_get();
-	if(new_buf == NULL)
+	/* 只移动pos跳过头部，跨mbuf时释放已经读完的mbuf */
+	for(mbuf = STAILQ_FIRST(&msg->buf_q); mbuf != NULL && n > 0; mbuf = nbuf)
+	{
+		nbuf = STAILQ_NEXT(mbuf, next);
+		len = mbuf_length(mbuf);
+		if(len > n)
+		{
+			mbuf->pos += n;
+			n = 0;
+			break;
+		}
+		n -= len;
+		mbuf_remove(&msg->buf_q, mbuf);
+		mbuf_put(mbuf);
+	}
+	if(n > 0)
 		return -2;
 
-	mbuf_copy(new_buf, mbuf->start + sizeof(struct DTC_HEADER_V2), mbuf_length(mbuf) - sizeof(struct DTC_HEADER_V2));
-
-	mbuf_remove(&msg->buf_q, mbuf);
-	mbuf_put(mbuf);
-	mbuf_insert(&msg->buf_q, new_buf);
-
-	msg->mlen = mbuf_length(new_buf);
-	log_debug("msg->mlen:%d mbuf_length(mbuf):%d", msg->mlen, mbuf_length(mbuf));
+	msg->mlen -= sizeof(struct DTC_HEADER_V2);
+	log_debug("msg->mlen:%d", msg->mlen);
 
 	return 0;
 }
@@ -170,11 +181,11 @@ int key_define_handle(struct msg* msg)
 	if(!mbuf)
 		return -1;
 
-	buf_len = mbuf->last - mbuf->start;
+	buf_len = mbuf->last - mbuf->pos;
 	if(buf_len < sizeof(struct DTC_HEADER_V2))
 		return -3;
 
-	uint8_t* pos = mbuf->start + sizeof(struct DTC_HEADER_V2);
+	uint8_t* pos = mbuf->pos + sizeof(struct DTC_HEADER_V2);
 	uint8_t type = *pos;
 	uint8_t key_len;
 	int i = 0;
@@ -25,6 +25,7 @@
 #include "da_conf.h"
 #include "da_stats.h"
 #include "da_time.h"
+#include "da_hotkey.h"
 
 static int keep_alive = 1;   // 开启keepalive属性. 缺省值: 0(关闭)  
 static int keep_idle = 5;   // 如果在60秒内没有任何数据交互,则进行探测. 缺省值:7200(s)  
@@ -420,6 +421,7 @@ struct conn *server_pool_conn(struct context *ctx, struct server_pool *pool,
 	struct server *server;
 	struct conn *conn = NULL;
 	struct cache_instance *ci;
+	int hot;
 
 	/* from a given {key, keylen} pick a server from pool */
 	server = server_pool_server(pool, msg);
@@ -427,11 +429,12 @@ struct conn *server_pool_conn(struct context *ctx, struct server_pool *pool,
 		return NULL;
 	}
 
-	
+	//热点key的读请求即使没有开启副本读也分散到该分片的所有实例
+	hot = hotkey_check(ctx, pool, msg);
 
 	// if write cmd always send to master or replica is disable in sys 
 	// always forward to master instance
-	if (msg->cmd != MSG_REQ_GET || pool->replica_enable == 0)
+	if (msg->cmd != MSG_REQ_GET || (pool->replica_enable == 0 && hot == 0))
 	{
 		conn = instance_conn(server->master);
 		if (conn == NULL) {
@@ -875,7 +878,7 @@ static int server_pool_each_calc_connections(void *elem, void *data) {
 	ninstance = 0;
 	for (i = 0; i < array_n(&sp->server); i++){
 		server = array_get(&sp->server, i);
-		if (sp->replica_enable) {
+		if (sp->replica_enable || sp->hotkey_fanout) {
 			ninstance += array_n(&server->high_ptry_ins);
 			ninstance += array_n(&server->low_prty_ins);
 		}
@@ -1002,6 +1005,9 @@ void server_pool_deinit(struct array *server_pool) {
 
 		if(sp->top_percentile_param)
 			free(sp->top_percentile_param);
+		if(sp->top_percentile_stat)
+			free(sp->top_percentile_stat);
+		hotkey_destroy(sp->hotkey, sp);
 
 		log_debug("deinit pool %"PRIu32" '%.*s'", sp->idx, sp->name.len,
 				sp->name.data);
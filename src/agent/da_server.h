@@ -23,6 +23,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+struct hotkey_sketch;
+
 typedef uint32_t (*hash_t)(const char *, size_t);
 #define ERROR_UPPER_LIMIT 1
 #define FAIL_TIME_LIMIT 6
@@ -102,6 +104,12 @@ struct server_pool {
   struct sockaddr_in top_percentile_addr;
   int top_percentile_addr_len;
   struct remote_param *top_percentile_param;
+  int top_percentile_interval;                  /* 汇总上报周期(ms) */
+  uint64_t top_percentile_last;                 /* 上次上报时间(ms) */
+  struct top_percentile_stat *top_percentile_stat; /* 每种上报类型的耗时分布 */
+
+  struct hotkey_sketch *hotkey; /* 热点key探测，未开启时为NULL */
+  int hotkey_fanout;            /* 热点key的读请求分散到副本 */
 };
 
 uint32_t server_pool_idx(struct server_pool *pool, uint8_t *key,
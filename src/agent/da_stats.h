@@ -57,7 +57,10 @@ typedef void (*event_stats_cb_t)(void *, int);
   ACTION(pool_logic_hit, STATS_COUNTER, "# pool logic hit times")              \
   ACTION(pool_elaspe_time, STATS_COUNTER, "# pool elapse time(us)")            \
   ACTION(pool_package_split, STATS_COUNTER, "# pool package split times")      \
-  ACTION(pool_request_get_keys, STATS_COUNTER, "# pool get request key count")
+  ACTION(pool_request_get_keys, STATS_COUNTER, "# pool get request key count") \
+  ACTION(pool_hotkey_requests, STATS_COUNTER, "# pool requests on hot keys")   \
+  ACTION(pool_hotkey_fanout, STATS_COUNTER,                                    \
+         "# pool hot key reads spread to replicas")
 
 #define STATS_SERVER_CODEC(ACTION)                                             \
   /* server behavior */                                                        \
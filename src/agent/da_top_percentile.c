@@ -20,6 +20,7 @@
 #include "da_top_percentile.h"
 #include "da_core.h"
 #include "da_server.h"
+#include "da_time.h"
 
 
 #define ADDR_LEN 16
@@ -107,48 +108,145 @@ int set_remote_fd()
 	return fd;
 }
 
-void top_percentile_report(struct context *ctx, struct server_pool *pool, int64_t elaspe, int32_t status, enum E_REPORT_TYPE type)
+static inline int tp_bucket_index(uint64_t elaspe)
+{
+	int msb;
+
+	if(elaspe < TP_SUB_BUCKETS)
+		return (int)elaspe;
+	if(elaspe > UINT32_MAX)
+		return TP_BUCKETS - 1;
+
+	msb = 63 - __builtin_clzll(elaspe);
+	return ((msb - TP_SUB_BITS + 1) << TP_SUB_BITS) +
+		(int)((elaspe >> (msb - TP_SUB_BITS)) & (TP_SUB_BUCKETS - 1));
+}
+
+//返回桶的上界
+static uint64_t tp_bucket_value(int idx)
 {
-	if(NULL == ctx || NULL == pool)
+	int shift;
+
+	if(idx < TP_SUB_BUCKETS)
+		return idx;
+
+	shift = (idx >> TP_SUB_BITS) - 1;
+	return (((uint64_t)(TP_SUB_BUCKETS + (idx & (TP_SUB_BUCKETS - 1))) + 1) << shift) - 1;
+}
+
+static uint64_t tp_percentile(const struct top_percentile_hist *hist, uint32_t permille)
+{
+	uint64_t target = ((uint64_t)hist->count * permille + 999) / 1000;
+	uint64_t sum = 0;
+	int i;
+
+	if(target == 0)
+		target = 1;
+	for(i = 0; i < TP_BUCKETS; i++)
 	{
-		log_debug("ctx or pool is null!");
-		return;
+		sum += hist->buckets[i];
+		if(sum >= target)
+		{
+			uint64_t v = tp_bucket_value(i);
+			return v < hist->max ? v : hist->max;
+		}
 	}
-	
-	if((int8_t)type <= (int8_t)RT_MIN || (int8_t)type >= (int8_t)RT_MAX)
+	return hist->max;
+}
+
+static struct top_percentile_hist *tp_find_slot(struct top_percentile_stat *stat, int32_t status)
+{
+	struct top_percentile_hist *hist;
+	int i;
+
+	for(i = 0; i < stat->nslot; i++)
 	{
-		log_debug("the type <= RT_MIN or the type >= RT_MAX");
-		return;
+		if(stat->slot[i].status == status)
+			return &stat->slot[i];
 	}
 
-	if(0 == pool->top_percentile_enable)
+	if(stat->nslot < TP_STATUS_SLOTS)
 	{
-		log_debug("the top_percentile_enable is 0");
-		return;
+		hist = &stat->slot[stat->nslot++];
+		hist->status = status;
+		return hist;
 	}
 
-	if(pool->top_percentile_fd < 0)
-	{
-		log_debug("the top_percentile_fd < 0");
+	hist = &stat->slot[TP_STATUS_SLOTS - 1];
+	hist->status = TP_STATUS_OTHER;
+	return hist;
+}
+
+void top_percentile_report(struct context *ctx, struct server_pool *pool, int64_t elaspe, int32_t status, enum E_REPORT_TYPE type)
+{
+	struct top_percentile_hist *hist;
+
+	if(NULL == pool || 0 == pool->top_percentile_enable || NULL == pool->top_percentile_stat)
 		return;
-	}
+	if((int8_t)type <= (int8_t)RT_MIN || (int8_t)type >= (int8_t)RT_MAX)
+		return;
+	if(elaspe < 0)
+		elaspe = 0;
+
+	hist = tp_find_slot(&pool->top_percentile_stat[(int8_t)type - 1], status);
+	hist->buckets[tp_bucket_index((uint64_t)elaspe)]++;
+	hist->count++;
+	if((uint64_t)elaspe > hist->max)
+		hist->max = elaspe;
+}
 
-	if(0 == pool->top_percentile_addr_len)
+static void tp_send_summary(struct server_pool *pool, enum E_REPORT_TYPE type, uint64_t interval)
+{
+	struct top_percentile_stat *stat = &pool->top_percentile_stat[(int8_t)type - 1];
+	struct remote_param *param = &pool->top_percentile_param[(int8_t)type - 1];
+	char szMsg[MSG_SIZE];
+	int i, off;
+
+	for(i = 0; i < stat->nslot; i++)
 	{
-		log_debug("the top_percentile_addr_len is 0");
-		return;
+		struct top_percentile_hist *hist = &stat->slot[i];
+		if(0 == hist->count)
+			continue;
+
+		off = snprintf(szMsg, sizeof(szMsg), "{\"app_id\":%"PRIu64",\"interface_id\":%"PRIu64",\"status\":%d,\"interval\":%"PRIu64",\"count\":%u,\"p50\":%"PRIu64",\"p90\":%"PRIu64",\"p99\":%"PRIu64",\"p999\":%"PRIu64",\"max\":%"PRIu64"}",
+				param->app_id, param->interface_id, hist->status, interval, hist->count,
+				tp_percentile(hist, 500), tp_percentile(hist, 900),
+				tp_percentile(hist, 990), tp_percentile(hist, 999), hist->max);
+		sendto(pool->top_percentile_fd, szMsg, off, 0, (const struct sockaddr *)&(pool->top_percentile_addr), pool->top_percentile_addr_len);
+		log_debug("send msg is : [%s]", szMsg);
 	}
 
-	if(NULL == pool->top_percentile_param)
-	{
-		log_debug("the top_percentile_param is null");
+	memset(stat, 0, sizeof(*stat));
+}
+
+void top_percentile_flush(struct context *ctx)
+{
+	uint32_t i;
+	int8_t type;
+
+	if(NULL == ctx)
 		return;
-	}
-	
-	char szMsg[MSG_SIZE];
-	memset(szMsg, 0, MSG_SIZE);
-	int off = snprintf(szMsg, sizeof(szMsg), "{\"app_id\":%"PRIu64",\"interface_id\":%"PRIu64",\"call_time\":%"PRIu64",\"status\":%d}", pool->top_percentile_param[(int8_t)type - 1].app_id, pool->top_percentile_param[(int8_t)type - 1].interface_id, elaspe, status);
-	sendto(pool->top_percentile_fd, szMsg, off, 0, (const struct sockaddr *)&(pool->top_percentile_addr), pool->top_percentile_addr_len);
 
-	log_debug("send msg is : [%s]", szMsg);
+	for(i = 0; i < array_n(&ctx->pool); i++)
+	{
+		struct server_pool *pool = array_get(&ctx->pool, i);
+		uint64_t interval = now_ms - pool->top_percentile_last;
+
+		if(interval < (uint64_t)pool->top_percentile_interval)
+			continue;
+		pool->top_percentile_last = now_ms;
+
+		if(0 == pool->top_percentile_enable || NULL == pool->top_percentile_stat)
+			continue;
+
+		if(pool->top_percentile_fd < 0 || 0 == pool->top_percentile_addr_len || NULL == pool->top_percentile_param)
+		{
+			//没有可用的上报通道，丢弃本周期的数据
+			memset(pool->top_percentile_stat, 0, sizeof(struct top_percentile_stat) * ((int8_t)RT_MAX - 1));
+			continue;
+		}
+
+		for(type = (int8_t)RT_MIN + 1; type < (int8_t)RT_MAX; type++)
+			tp_send_summary(pool, (enum E_REPORT_TYPE)type, interval);
+	}
 }
@@ -28,14 +28,40 @@ struct remote_param {
   uint64_t interface_id;
 };
 
+/*
+ * 耗时分布(us)：按2的幂分段，每段再线性分8个子桶，相对误差不超过12.5%，
+ * 超过2^32us的耗时计入最后一个桶。
+ */
+#define TP_SUB_BITS 3
+#define TP_SUB_BUCKETS (1 << TP_SUB_BITS)
+#define TP_BUCKETS ((32 - TP_SUB_BITS + 1) * TP_SUB_BUCKETS)
+/* 每种上报类型最多区分的status个数，超出的合并到最后一个槽位 */
+#define TP_STATUS_SLOTS 8
+#define TP_STATUS_OTHER INT32_MIN
+
+struct top_percentile_hist {
+  int32_t status;
+  uint32_t count;
+  uint64_t max;
+  uint32_t buckets[TP_BUCKETS];
+};
+
+struct top_percentile_stat {
+  int nslot;
+  struct top_percentile_hist slot[TP_STATUS_SLOTS];
+};
+
 int8_t get_host_name_info(const char *addr, char *result);
 int8_t set_remote_config(const char *addr, uint16_t port,
                          struct sockaddr_in *remote_addr);
 int8_t set_remote_param(uint64_t app_id, uint64_t interface_id,
                         enum E_REPORT_TYPE type, struct remote_param *pParam);
 int set_remote_fd();
+/* 只在内存中累加耗时分布，由top_percentile_flush按周期汇总上报 */
 void top_percentile_report(struct context *ctx, struct server_pool *pool,
                            int64_t elaspe, int32_t status,
                            enum E_REPORT_TYPE type);
+/* 在事件循环中调用，到达上报周期的pool发送count/p50/p90/p99/p999 */
+void top_percentile_flush(struct context *ctx);
 
 #endif
@@ -18,7 +18,6 @@
 
 using namespace std;
 
-typedef CThreadingWaitQueue<CTaskRequest*> TransThreadQueue;
 
 class TableInfo{
 public:
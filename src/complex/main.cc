@@ -144,10 +144,11 @@ void register_signal()
 int start_db_thread_group(DBHost* dbconfig, std::string level)
 {
 	const int thread_num  = g_config.GetIntValue("TransThreadNum", 10);
+	const int queue_depth = g_config.GetIntValue("TransQueueDepth", 32);
 	CTransactionGroup* group = NULL;
-	log4cplus_debug("transaction thread count:%d, level:%s", thread_num, level.c_str());
+	log4cplus_debug("transaction thread count:%d, queue depth:%d, level:%s", thread_num, queue_depth, level.c_str());
 
-	group = new CTransactionGroup(thread_num);
+	group = new CTransactionGroup(thread_num, queue_depth);
 	if(group->Initialize(dbconfig))
 	{
 		log4cplus_error("init thread group failed");
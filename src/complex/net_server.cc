@@ -50,11 +50,13 @@ void CNetServerProcess::TaskNotify(CTaskRequest * cur)
 		sprintf(err, "layer level error:%d.", level);
 		request->setResult(err);
 		request->ReplyNotify();
+		return;
 	}
 	
+	// 所有worker的队列都已满，直接拒绝，客户端稍后重试
 	if(group->Push(request) != 0)
 	{
-		request->setResult("transaction insert queue failed.");
+		request->setResult("server busy: transaction queue full.");
 		request->ReplyNotify();
 	}
 	
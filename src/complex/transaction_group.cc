@@ -1,8 +1,14 @@
+#include <errno.h>
+#include <sys/time.h>
 #include "transaction_group.h"
+#include "timestamp.h"
 
-CTransactionGroup::CTransactionGroup(int thread_num): m_thread_num(thread_num), m_thread_index(0)
+CTransactionGroup::CTransactionGroup(int thread_num, int queue_depth):
+	m_thread_num(thread_num), m_thread_index(0), m_queue_depth(queue_depth),
+	m_trans_queue(NULL), m_trans_thread(NULL), m_pending(0), m_rejected(0)
 {
-
+	pthread_mutex_init(&m_idle_lock, NULL);
+	pthread_cond_init(&m_idle_cond, NULL);
 }
 
 int CTransactionGroup::Initialize(DBHost* dbconfig)
@@ -10,16 +16,16 @@ int CTransactionGroup::Initialize(DBHost* dbconfig)
 	if(!dbconfig ||!dbconfig->Host)
 		return -1;
 
-	m_trans_queue = new TransThreadQueue*[m_thread_num];
+	m_trans_queue = new CTransWorkQueue*[m_thread_num];
 	m_trans_thread = new CTransactionThread*[m_thread_num];
 
 	for(int i = 0; i < m_thread_num; i++)
 	{
 		char thread_name[256] = {0};
-		m_trans_queue[i] = new TransThreadQueue;
+		m_trans_queue[i] = new CTransWorkQueue(m_queue_depth);
 		
 		snprintf(thread_name, sizeof(thread_name), "%s:%d@%d", dbconfig->Host, dbconfig->Port, i);
-		m_trans_thread[i] = new CTransactionThread(thread_name, m_trans_queue[i], i, dbconfig);
+		m_trans_thread[i] = new CTransactionThread(thread_name, this, i, dbconfig);
 		m_trans_thread[i]->InitializeThread();
 	}
 
@@ -34,20 +40,65 @@ void CTransactionGroup::RunningThread()
 
 int CTransactionGroup::Push(CTaskRequest* task)
 {
-	int count = 0;
-	while(count < m_thread_num)
+	TransWorkItem item;
+	item.task = task;
+	item.enqueue_time = GET_TIMESTAMP();
+
+	// 轮询选择起始队列，满了就放到下一个，空闲的worker会来偷取
+	for(int count = 0; count < m_thread_num; count++)
 	{
 		m_thread_index = (m_thread_index + 1) % m_thread_num;
-		if(m_trans_queue[m_thread_index]->Count() == 0)
+		if(m_trans_queue[m_thread_index]->Push(item) == 0)
 		{
-			m_trans_queue[m_thread_index]->Push(task);
+			__sync_fetch_and_add(&m_pending, 1);
+			pthread_mutex_lock(&m_idle_lock);
+			pthread_cond_signal(&m_idle_cond);
+			pthread_mutex_unlock(&m_idle_lock);
 			return 0;
 		}
-		else
+	}
+
+	__sync_fetch_and_add(&m_rejected, 1);
+	return -1;
+}
+
+bool CTransactionGroup::Pop(int thread_id, TransWorkItem& item, int timeout_ms)
+{
+	for(int round = 0; round < 2; round++)
+	{
+		if(m_trans_queue[thread_id]->Pop(item))
 		{
-			count++;
+			__sync_fetch_and_sub(&m_pending, 1);
+			return true;
 		}
+
+		for(int i = 1; i < m_thread_num; i++)
+		{
+			if(m_trans_queue[(thread_id + i) % m_thread_num]->Steal(item))
+			{
+				__sync_fetch_and_sub(&m_pending, 1);
+				return true;
+			}
+		}
+
+		if(round > 0)
+			break;
+
+		struct timeval now;
+		struct timespec deadline;
+		gettimeofday(&now, NULL);
+		int64_t nsec = (now.tv_usec + (int64_t)timeout_ms * 1000) * 1000;
+		deadline.tv_sec = now.tv_sec + nsec / 1000000000;
+		deadline.tv_nsec = nsec % 1000000000;
+
+		pthread_mutex_lock(&m_idle_lock);
+		while(m_pending == 0)
+		{
+			if(pthread_cond_timedwait(&m_idle_cond, &m_idle_lock, &deadline) == ETIMEDOUT)
+				break;
+		}
+		pthread_mutex_unlock(&m_idle_lock);
 	}
 
-	return -1;
-}
\ No newline at end of file
+	return false;
+}
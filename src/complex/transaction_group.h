@@ -2,6 +2,7 @@
 #define _TRANS_GROUP_H_
 
 #include "transaction_thread.h"
+#include "transaction_queue.h"
 #include "poll_thread_group.h"
 
 class CTransactionGroup
@@ -9,16 +10,27 @@ class CTransactionGroup
 private:
 	int m_thread_num;
 	int m_thread_index;
-	TransThreadQueue** m_trans_queue;
+	int m_queue_depth;
+	CTransWorkQueue** m_trans_queue;
 	CTransactionThread** m_trans_thread;
 
+	// 所有队列都为空时worker在此等待
+	pthread_mutex_t m_idle_lock;
+	pthread_cond_t m_idle_cond;
+	volatile int m_pending;
+	volatile uint64_t m_rejected;
+
 public:
-	CTransactionGroup(int thread_num);
+	CTransactionGroup(int thread_num, int queue_depth);
 	~CTransactionGroup() {}
 
 	int Initialize(DBHost* dbconfig);
 	void RunningThread();
+	// 所有worker的队列都满时返回-1，调用者需要向客户端返回繁忙
 	int Push(CTaskRequest* task);
+	// 先取自己的队列，再从其它worker队尾偷取，都为空时最多等待timeout_ms
+	bool Pop(int thread_id, TransWorkItem& item, int timeout_ms);
+	uint64_t Rejected() const { return m_rejected; }
 };
 
 
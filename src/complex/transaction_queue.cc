@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <string.h>
+#include "transaction_queue.h"
+
+CTransWorkQueue::CTransWorkQueue(int depth): m_depth(depth)
+{
+	pthread_mutex_init(&m_lock, NULL);
+}
+
+CTransWorkQueue::~CTransWorkQueue()
+{
+	pthread_mutex_destroy(&m_lock);
+}
+
+int CTransWorkQueue::Push(const TransWorkItem& item)
+{
+	int ret = -1;
+
+	pthread_mutex_lock(&m_lock);
+	if((int)m_queue.size() < m_depth)
+	{
+		m_queue.push_back(item);
+		ret = 0;
+	}
+	pthread_mutex_unlock(&m_lock);
+	return ret;
+}
+
+bool CTransWorkQueue::Pop(TransWorkItem& item)
+{
+	bool ret = false;
+
+	pthread_mutex_lock(&m_lock);
+	if(!m_queue.empty())
+	{
+		item = m_queue.front();
+		m_queue.pop_front();
+		ret = true;
+	}
+	pthread_mutex_unlock(&m_lock);
+	return ret;
+}
+
+bool CTransWorkQueue::Steal(TransWorkItem& item)
+{
+	bool ret = false;
+
+	pthread_mutex_lock(&m_lock);
+	if(!m_queue.empty())
+	{
+		item = m_queue.back();
+		m_queue.pop_back();
+		ret = true;
+	}
+	pthread_mutex_unlock(&m_lock);
+	return ret;
+}
+
+int CTransWorkQueue::Count()
+{
+	int count;
+
+	pthread_mutex_lock(&m_lock);
+	count = m_queue.size();
+	pthread_mutex_unlock(&m_lock);
+	return count;
+}
+
+void CTransLatencyHist::Reset()
+{
+	memset(m_buckets, 0, sizeof(m_buckets));
+	m_count = 0;
+	m_total = 0;
+	m_max = 0;
+}
+
+void CTransLatencyHist::Add(int64_t us)
+{
+	if(us < 0)
+		us = 0;
+
+	int i = 0;
+	while(i < BUCKETS - 1 && (us >> i) > 0)
+		i++;
+
+	m_buckets[i]++;
+	m_count++;
+	m_total += us;
+	if((uint64_t)us > m_max)
+		m_max = us;
+}
+
+// 返回所在桶的上界
+uint64_t CTransLatencyHist::Percentile(double p) const
+{
+	uint64_t target = (uint64_t)(m_count * p);
+	uint64_t sum = 0;
+
+	for(int i = 0; i < BUCKETS; i++)
+	{
+		sum += m_buckets[i];
+		if(sum > target)
+			return i == 0 ? 0 : (1ULL << i) - 1;
+	}
+	return m_max;
+}
+
+std::string CTransLatencyHist::Dump() const
+{
+	char buf[256];
+
+	snprintf(buf, sizeof(buf), "n=%llu avg=%lluus max=%lluus p50<=%lluus p99<=%lluus",
+		(unsigned long long)m_count,
+		(unsigned long long)(m_count ? m_total / m_count : 0),
+		(unsigned long long)m_max,
+		(unsigned long long)Percentile(0.50),
+		(unsigned long long)Percentile(0.99));
+	return buf;
+}
@@ -0,0 +1,61 @@
+#ifndef _TRANS_QUEUE_H_
+#define _TRANS_QUEUE_H_
+
+#include <pthread.h>
+#include <stdint.h>
+#include <deque>
+#include <string>
+
+class CTaskRequest;
+
+struct TransWorkItem
+{
+	CTaskRequest* task;
+	int64_t enqueue_time; // us
+};
+
+// 单个worker的有界队列，本worker从队头取，空闲worker从队尾偷
+class CTransWorkQueue
+{
+private:
+	pthread_mutex_t m_lock;
+	std::deque<TransWorkItem> m_queue;
+	int m_depth;
+
+public:
+	CTransWorkQueue(int depth);
+	~CTransWorkQueue();
+
+	// 队列满返回-1
+	int Push(const TransWorkItem& item);
+	bool Pop(TransWorkItem& item);
+	bool Steal(TransWorkItem& item);
+	int Count();
+};
+
+// 以2的幂划分的耗时分布(us)，只在所属worker线程中更新
+class CTransLatencyHist
+{
+public:
+	enum { BUCKETS = 24 };
+
+private:
+	uint64_t m_buckets[BUCKETS];
+	uint64_t m_count;
+	uint64_t m_total;
+	uint64_t m_max;
+
+public:
+	CTransLatencyHist() { Reset(); }
+
+	void Reset();
+	void Add(int64_t us);
+	uint64_t Count() const { return m_count; }
+	// 输出 "n=.. avg=.. max=.. p50=.. p99=.."
+	std::string Dump() const;
+
+private:
+	uint64_t Percentile(double p) const;
+};
+
+#endif
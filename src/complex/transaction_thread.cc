@@ -1,15 +1,19 @@
 #include "transaction_thread.h"
 #include "transaction_task.h"
+#include "transaction_group.h"
 #include "net_server.h"
+#include "timestamp.h"
 
 extern CNetServerProcess *netserverProcess;
 
 #define MIN(x,y) ((x)<=(y)?(x):(y))
+#define LATENCY_REPORT_INTERVAL (60 * TIMESTAMP_PRECISION)
 
-CTransactionThread::CTransactionThread(const char *name, TransThreadQueue* trans_queue, int thread_id, DBHost* dbconfig): 
+CTransactionThread::CTransactionThread(const char *name, CTransactionGroup* group, int thread_id, DBHost* dbconfig): 
 	CThread(name, CThread::ThreadTypeAsync), 
 	m_thread_id(thread_id),
-	m_trans_queue(trans_queue)
+	m_group(group),
+	m_report_time(GET_TIMESTAMP())
 {
 	init_mysql_connection(dbconfig);
 }
@@ -18,18 +22,39 @@ CTransactionThread::~CTransactionThread()
 {
 }
 
+void CTransactionThread::ReportLatency(int64_t now)
+{
+	if(now - m_report_time < (int64_t)LATENCY_REPORT_INTERVAL)
+		return;
+
+	if(m_service_hist.Count() > 0)
+	{
+		log4cplus_info("transaction thread %d queue wait: %s", m_thread_id, m_wait_hist.Dump().c_str());
+		log4cplus_info("transaction thread %d service: %s, rejected: %llu", m_thread_id,
+			m_service_hist.Dump().c_str(), (unsigned long long)m_group->Rejected());
+	}
+	m_wait_hist.Reset();
+	m_service_hist.Reset();
+	m_report_time = now;
+}
+
 void* CTransactionThread::Process(void)
 {
+	TransWorkItem item;
+
 	while(Stopping() == false)
 	{
-		log4cplus_debug("transaction thread process.");
-		CTaskRequest* request = m_trans_queue->Pop();
-		if(request == NULL)
+		if(!m_group->Pop(m_thread_id, item, 100))
 		{
-			log4cplus_error("transaction pop task error.");
+			ReportLatency(GET_TIMESTAMP());
 			continue;
 		}
 
+		log4cplus_debug("transaction thread process.");
+		CTaskRequest* request = item.task;
+		int64_t start = GET_TIMESTAMP();
+		m_wait_hist.Add(start - item.enqueue_time);
+
 		TransactionTask* task = new TransactionTask(&m_db_conn);	
 		if (task == NULL) {
 			log4cplus_error("no new memory for task");
@@ -44,6 +69,10 @@ void* CTransactionThread::Process(void)
 		if (task != NULL) {
 			delete task;
 		}
+
+		int64_t now = GET_TIMESTAMP();
+		m_service_hist.Add(now - start);
+		ReportLatency(now);
 	}
 	return 0;
 }
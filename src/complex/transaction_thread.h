@@ -6,16 +6,26 @@
 #include "task_request.h"
 #include "global.h"
 #include "cm_conn.h"
+#include "transaction_queue.h"
+
+class CTransactionGroup;
 
 class CTransactionThread : public CThread
 {
 private:
 	int m_thread_id;
-	TransThreadQueue* m_trans_queue;
+	CTransactionGroup* m_group;
 	MysqlConn m_db_conn;
 
+	// 排队耗时与执行耗时分布，定期输出到日志
+	CTransLatencyHist m_wait_hist;
+	CTransLatencyHist m_service_hist;
+	int64_t m_report_time;
+
+	void ReportLatency(int64_t now);
+
 public:
-	CTransactionThread(const char *name, TransThreadQueue* trans_queue, int thread_id, DBHost* dbconfig);
+	CTransactionThread(const char *name, CTransactionGroup* group, int thread_id, DBHost* dbconfig);
 	virtual ~CTransactionThread();
 
 	int init_mysql_connection(DBHost* dbconfig);
@@ -19,6 +19,9 @@
 #include "ca_quick_find.h"
 #include "app_shm_manager.h"
 
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
 typedef struct handle_ptr {
 	uint64_t version;
 	IP_NODE *master_app_set;
@@ -26,6 +29,23 @@ typedef struct handle_ptr {
 	FORWARD_ITEM *forward_ptr;
 } HANDLE_PTR;
 
+#define ROUTE_SET_NUM 2
+#define ROUTE_MAX_RETRY 64
+
+//常驻映射，每个线程一份，lookup_ip_route不再attach/detach
+typedef struct route_cache {
+	FORWARD_ITEM *forward_ptr;
+	size_t forward_size;
+	IP_NODE *app_set[ROUTE_SET_NUM];
+	size_t app_set_size[ROUTE_SET_NUM];
+	int app_set_shm_id[ROUTE_SET_NUM];
+	uint64_t time_stamp;
+} ROUTE_CACHE;
+
+static __thread ROUTE_CACHE route_cache;
+static const uint32_t route_set_key[ROUTE_SET_NUM] = { MASTER_SHM_KEY,
+							SLAVE_SHM_KEY };
+
 int print_forward(FORWARD_ITEM *header_ptr)
 {
 	if (!header_ptr)
@@ -230,3 +250,142 @@ int free_ip_route(IP_ROUTE *ip_route)
 	}
 	return 0;
 }
+
+static void detach_route_set(ROUTE_CACHE *cache, int idx)
+{
+	if (cache->app_set[idx]) {
+		detach_shm(cache->app_set[idx]);
+		cache->app_set[idx] = NULL;
+	}
+	cache->app_set_size[idx] = 0;
+	cache->app_set_shm_id[idx] = -1;
+}
+
+//版本变化时检查app set共享内存是否被重建，重建了才重新attach
+static int refresh_route_set(ROUTE_CACHE *cache, uint64_t time_stamp)
+{
+	int idx = 0;
+	for (; idx < ROUTE_SET_NUM; ++idx) {
+		if (cache->app_set[idx] &&
+		    shmget(route_set_key[idx], 0, 0) ==
+			    cache->app_set_shm_id[idx])
+			continue;
+
+		detach_route_set(cache, idx);
+		cache->app_set[idx] = (IP_NODE *)attach_exist_shm(
+			route_set_key[idx], &cache->app_set_shm_id[idx],
+			&cache->app_set_size[idx]);
+		if (!cache->app_set[idx])
+			return -GET_SHM_ERR;
+	}
+	cache->time_stamp = time_stamp;
+	return 0;
+}
+
+static int load_route_cache(ROUTE_CACHE *cache)
+{
+	if (cache->forward_ptr)
+		return 0;
+
+	int shm_id = 0;
+	memset(cache, 0, sizeof(ROUTE_CACHE));
+	cache->app_set_shm_id[0] = cache->app_set_shm_id[1] = -1;
+	cache->forward_ptr = (FORWARD_ITEM *)attach_exist_shm(
+		FORWARD_SHM_KEY, &shm_id, &cache->forward_size);
+	if (!cache->forward_ptr)
+		return -GET_SHM_ERR;
+	if (cache->forward_size < sizeof(FORWARD_ITEM) * ROUTE_SET_NUM) {
+		release_ip_route_cache();
+		return -GET_SHM_ERR;
+	}
+
+	int ret = refresh_route_set(cache, cache->forward_ptr->time_stamp);
+	if (ret < 0)
+		release_ip_route_cache();
+	return ret;
+}
+
+int lookup_ip_route(int bid, IP_ROUTE_VIEW *view)
+{
+	if (bid < 0 || view == NULL)
+		return -PARAM_ERR;
+
+	ROUTE_CACHE *cache = &route_cache;
+	int ret = load_route_cache(cache);
+	if (ret < 0)
+		return ret;
+
+	volatile FORWARD_ITEM *master_forward = cache->forward_ptr;
+	int retry = 0;
+	for (; retry < ROUTE_MAX_RETRY; ++retry) {
+		int lock = master_forward->lock;
+		uint64_t time_stamp = master_forward->time_stamp;
+		__sync_synchronize();
+
+		if (time_stamp != cache->time_stamp) {
+			ret = refresh_route_set(cache, time_stamp);
+			if (ret < 0)
+				return ret;
+		}
+
+		//lock为0时读master，否则读slave，与get_ip_route一致
+		int idx = lock ? 1 : 0;
+		const FORWARD_ITEM *forward = cache->forward_ptr + idx;
+		int bid_size = forward->bid_size;
+		if (bid_size > DEFAULT_BID_NUM)
+			bid_size = DEFAULT_BID_NUM;
+		int pos = lower_bound_header(forward->headers, bid_size, bid);
+		int offset = pos < 0 ? 0 : forward->headers[pos].offset;
+		int size = pos < 0 ? 0 : forward->headers[pos].size;
+
+		__sync_synchronize();
+		if (master_forward->lock != lock ||
+		    master_forward->time_stamp != time_stamp)
+			continue;
+
+		if (pos < 0)
+			return -NOT_FIND_BID;
+		if (offset < 0 ||
+		    (size_t)offset + (size_t)(size > 0 ? size : 0) >
+			    cache->app_set_size[idx] / sizeof(IP_NODE))
+			return -OFFSET_ERR;
+		if (size <= 0)
+			return -IP_NUM_ERR;
+
+		view->ip_num = size;
+		view->ip_list = cache->app_set[idx] + offset;
+		view->lock = lock;
+		view->time_stamp = time_stamp;
+		return 0;
+	}
+
+	return -ROUTE_CHANGED;
+}
+
+int check_ip_route_view(const IP_ROUTE_VIEW *view)
+{
+	if (view == NULL || route_cache.forward_ptr == NULL)
+		return -PARAM_ERR;
+
+	volatile FORWARD_ITEM *master_forward = route_cache.forward_ptr;
+	__sync_synchronize();
+	if (master_forward->lock != view->lock ||
+	    master_forward->time_stamp != view->time_stamp)
+		return -ROUTE_CHANGED;
+	return 0;
+}
+
+int release_ip_route_cache(void)
+{
+	ROUTE_CACHE *cache = &route_cache;
+	int idx = 0;
+	for (; idx < ROUTE_SET_NUM; ++idx)
+		detach_route_set(cache, idx);
+	if (cache->forward_ptr) {
+		detach_shm(cache->forward_ptr);
+		cache->forward_ptr = NULL;
+	}
+	cache->forward_size = 0;
+	cache->time_stamp = 0;
+	return 0;
+}
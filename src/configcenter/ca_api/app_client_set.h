@@ -38,6 +38,17 @@ typedef struct ip_route {
 	IP_NODE *ip_list;
 } IP_ROUTE;
 
+/*
+ * 只读路由视图，ip_list直接指向共享内存，不需要释放。
+ * 使用完后调用check_ip_route_view，返回非0说明期间路由被更新，需要重新查询。
+ */
+typedef struct ip_route_view {
+	int ip_num;
+	const IP_NODE *ip_list;
+	int lock;
+	uint64_t time_stamp;
+} IP_ROUTE_VIEW;
+
 int get_version(uint64_t *version);
 
 int dump_ca_shm();
@@ -46,4 +57,15 @@ int get_ip_route(int bid, IP_ROUTE *ip_route);
 
 int free_ip_route(IP_ROUTE *ip_route);
 
+/*
+ * 常驻映射的路由查询：每个线程第一次查询时attach共享内存，之后不再attach/detach。
+ * 以forward头中的lock和time_stamp作为版本号(seqlock)：读之前和读之后版本一致
+ * 才认为结果有效，否则重试，读者不会阻塞写者，也不会读到写了一半的数据。
+ */
+int lookup_ip_route(int bid, IP_ROUTE_VIEW *view);
+
+int check_ip_route_view(const IP_ROUTE_VIEW *view);
+
+int release_ip_route_cache(void);
+
 #endif
@@ -62,6 +62,33 @@ char *get_shm(uint32_t key, uint32_t len, int flag, int *shm_id, bool create,
 	return (char *)(shm_ptr);
 }
 
+char *attach_exist_shm(uint32_t key, int *shm_id, size_t *size)
+{
+	if (!shm_id || !size)
+		return NULL;
+
+	(*shm_id) = shmget(key, 0, 0);
+	if ((*shm_id) < 0)
+		return NULL;
+
+	struct shmid_ds ds;
+	if (shmctl((*shm_id), IPC_STAT, &ds) < 0) {
+		printf("shmctl failed, ShmId:%d, errno:%d, strerror:%s\n",
+		       *shm_id, errno, strerror(errno));
+		return NULL;
+	}
+
+	void *shm_ptr = shmat((*shm_id), NULL, SHM_RDONLY);
+	if (shm_ptr == (void *)-1) {
+		printf("shmat failed, ShmId:%d, errno:%d, strerror:%s\n",
+		       *shm_id, errno, strerror(errno));
+		return NULL;
+	}
+
+	*size = ds.shm_segsz;
+	return (char *)(shm_ptr);
+}
+
 int detach_shm(void *shmaddr)
 {
 	if (!shmaddr) {
@@ -26,6 +26,9 @@
 
 char* get_shm(uint32_t key, uint32_t len, int flag, int *shm_id, bool create, int *exist);
 
+//attach已存在的共享内存，不限定大小，size返回段的实际大小
+char* attach_exist_shm(uint32_t key, int *shm_id, size_t *size);
+
 int detach_shm(void* shmaddr);
 
 #endif
@@ -15,12 +15,71 @@
 * 
 */
 #include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
 #include "app_client_set.h"
 
+#define DEFAULT_BENCH_COUNT 100000
+
+static double elapse_sec(const struct timeval *begin)
+{
+	struct timeval end;
+	gettimeofday(&end, NULL);
+	return (end.tv_sec - begin->tv_sec) +
+	       (end.tv_usec - begin->tv_usec) / 1000000.0;
+}
+
+//对比get_ip_route和lookup_ip_route每秒的查询次数
+static int bench_ip_route(int bid, int count)
+{
+	struct timeval begin;
+	IP_ROUTE route;
+	IP_ROUTE_VIEW view;
+	int i = 0;
+	int ret = 0;
+
+	gettimeofday(&begin, NULL);
+	for (i = 0; i < count; ++i) {
+		ret = get_ip_route(bid, &route);
+		if (ret < 0) {
+			printf("get ip route error %d\n", ret);
+			return -1;
+		}
+		free_ip_route(&route);
+	}
+	double old_sec = elapse_sec(&begin);
+
+	gettimeofday(&begin, NULL);
+	for (i = 0; i < count; ++i) {
+		ret = lookup_ip_route(bid, &view);
+		if (ret < 0) {
+			printf("lookup ip route error %d\n", ret);
+			return -1;
+		}
+	}
+	double new_sec = elapse_sec(&begin);
+	release_ip_route_cache();
+
+	printf("bid=[%d] count=[%d] ip_num=[%d]\n", bid, count, view.ip_num);
+	printf("get_ip_route:    %.3fs %.0f lookups/s\n", old_sec,
+	       old_sec > 0 ? count / old_sec : 0);
+	printf("lookup_ip_route: %.3fs %.0f lookups/s\n", new_sec,
+	       new_sec > 0 ? count / new_sec : 0);
+	return 0;
+}
+
 int main(int argc, char **argv)
 {
 	if (argc < 2) {
 		dump_ca_shm();
+	} else if (strcmp(argv[1], "-b") == 0) {
+		if (argc < 3) {
+			printf("usage: %s -b bid [count]\n", argv[0]);
+			return -1;
+		}
+		int count = argc > 3 ? atoi(argv[3]) : DEFAULT_BENCH_COUNT;
+		return bench_ip_route(atoi(argv[2]),
+				      count > 0 ? count : DEFAULT_BENCH_COUNT);
 	} else {
 		int bid = atoi(argv[1]);
 		uint64_t version = 0;
@@ -47,6 +47,25 @@ int binary_search_header(NODE_HEADER *headers_ptr, const int low,
 	}
 }
 
+int lower_bound_header(const NODE_HEADER *headers_ptr, const int size,
+		       const int key)
+{
+	int low = 0;
+	int high = size;
+
+	while (low < high) {
+		int mid_index = low + (high - low) / 2;
+		if (headers_ptr[mid_index].bid < key)
+			low = mid_index + 1;
+		else
+			high = mid_index;
+	}
+
+	if (low < size && headers_ptr[low].bid == key)
+		return low;
+	return -1;
+}
+
 int binary_search_node(IP_NODE *app_set_ptr, const int low, const int high,
 		       const int key)
 {
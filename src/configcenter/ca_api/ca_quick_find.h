@@ -23,6 +23,10 @@
 int binary_search_header(NODE_HEADER *headers_ptr, const int low,
 			 const int high, const int key);
 
+//非递归版本，在[0, size)中查找第一个等于key的位置，找不到返回-1
+int lower_bound_header(const NODE_HEADER *headers_ptr, const int size,
+		       const int key);
+
 int binary_search_node(IP_NODE *app_set_ptr, const int low, const int high,
 		       const int key);
 
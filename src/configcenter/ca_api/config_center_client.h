@@ -38,6 +38,7 @@ enum { BEGIN = 10000,
        OFFSET_ERR,
        IP_NUM_ERR,
        PARAM_ERR,
+       ROUTE_CHANGED,
 
        END,
 };
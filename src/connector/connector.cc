@@ -314,6 +314,9 @@ int main(int argc, char **argv)
 		show_usage();
 		return -1;
 	}
+	// 只有helper接受DTC合并flush行的Replace，DTC不接受客户端带DTCResultSet的Replace
+	DtcJob::accept_batch_replace = true;
+
 	int usematch = g_dtc_config->get_int_val("cache",
 						 "UseMatchedAsAffectedRows", 1);
 
@@ -44,6 +44,7 @@ CDBConn::CDBConn()
     db_err = 0;
     memset(&DBConfig, 0, sizeof(DBConfig));
     use_matched = 0;
+    conn_seq = 0;
 
     if (mysql_init(&Mysql) == NULL) {
         db_err = mysql_errno(&Mysql);
@@ -62,6 +63,8 @@ CDBConn::CDBConn(const DBHost *Host)
     Connected = 0;
     need_free = 0;
     db_err = 0;
+    use_matched = 0;
+    conn_seq = 0;
     memset(achErr, 0, sizeof(achErr));
     memset(&DBConfig, 0, sizeof(DBConfig));
     STRCPY(DBConfig.Host, Host->Host);
@@ -172,6 +175,7 @@ int CDBConn::Connect(const char *DBName)
         }
 
         Connected = 1;
+        conn_seq++;
     }
 
     if (DBName != NULL && DBName[0] != '\0') {
@@ -371,6 +375,91 @@ int CDBConn::free_result()
     return (0);
 }
 
+/* 连接错误时关闭连接，下次使用时重连 */
+#define STMT_ERROR(Stmt, What)                                                 \
+    do {                                                                   \
+        db_err = mysql_stmt_errno(Stmt);                               \
+        snprintf(achErr, sizeof(achErr) - 1, What " error: %s",       \
+             mysql_stmt_error(Stmt));                                  \
+        if (db_err == CR_SERVER_GONE_ERROR || db_err == CR_SERVER_LOST) \
+            Close();                                               \
+    } while (0)
+
+MYSQL_STMT *CDBConn::stmt_prepare(const char *SQL, unsigned long Len)
+{
+    if (Open() != 0)
+        return NULL;
+
+    MYSQL_STMT *Stmt = mysql_stmt_init(&Mysql);
+    if (Stmt == NULL) {
+        db_err = mysql_errno(&Mysql);
+        snprintf(achErr, sizeof(achErr) - 1,
+             "mysql stmt init error: %s", mysql_error(&Mysql));
+        return NULL;
+    }
+
+    if (mysql_stmt_prepare(Stmt, SQL, Len) != 0) {
+        STMT_ERROR(Stmt, "mysql stmt prepare");
+        mysql_stmt_close(Stmt);
+        return NULL;
+    }
+
+    // store_result时计算每列的最大长度，用于分配结果buffer
+    my_bool UpdateMaxLength = 1;
+    mysql_stmt_attr_set(Stmt, STMT_ATTR_UPDATE_MAX_LENGTH,
+                &UpdateMaxLength);
+
+    return Stmt;
+}
+
+int CDBConn::stmt_execute(MYSQL_STMT *Stmt, MYSQL_BIND *Params)
+{
+    if (Params != NULL && mysql_stmt_bind_param(Stmt, Params) != 0) {
+        STMT_ERROR(Stmt, "mysql stmt bind param");
+        return (-1);
+    }
+
+    if (mysql_stmt_execute(Stmt) != 0) {
+        STMT_ERROR(Stmt, "mysql stmt execute");
+        return (-1);
+    }
+
+    return (0);
+}
+
+int CDBConn::stmt_store_result(MYSQL_STMT *Stmt)
+{
+    if (mysql_stmt_store_result(Stmt) != 0) {
+        STMT_ERROR(Stmt, "mysql stmt store result");
+        return (-1);
+    }
+
+    res_num = mysql_stmt_num_rows(Stmt);
+    return (0);
+}
+
+int CDBConn::stmt_fetch(MYSQL_STMT *Stmt)
+{
+    int Ret = mysql_stmt_fetch(Stmt);
+    if (Ret == 1) {
+        STMT_ERROR(Stmt, "mysql stmt fetch");
+        return (-1);
+    }
+    if (Ret == MYSQL_DATA_TRUNCATED) {
+        db_err = CR_UNKNOWN_ERROR;
+        snprintf(achErr, sizeof(achErr) - 1,
+             "mysql stmt fetch error: data truncated");
+        return (-1);
+    }
+
+    return Ret;
+}
+
+void CDBConn::stmt_close(MYSQL_STMT *Stmt)
+{
+    mysql_stmt_close(Stmt);
+}
+
 uint32_t CDBConn::escape_string(char To[], const char *From)
 {
     return mysql_real_escape_string(&Mysql, To, From, strlen(From));
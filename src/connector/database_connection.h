@@ -44,6 +44,8 @@ class CDBConn {
 	char achErr[400];
 	int db_err;
 	int use_matched;
+	// 每次建立连接递增，连接断开后prepared statement失效
+	unsigned int conn_seq;
 
     public:
 	MYSQL_RES *Res;
@@ -92,6 +94,16 @@ class CDBConn {
 		return mysql_fetch_lengths(Res);
 	}
 
+	unsigned int connect_seq(void) const
+	{
+		return conn_seq;
+	}
+	MYSQL_STMT *stmt_prepare(const char *SQL, unsigned long Len);
+	int stmt_execute(MYSQL_STMT *Stmt, MYSQL_BIND *Params);
+	int stmt_store_result(MYSQL_STMT *Stmt);
+	int stmt_fetch(MYSQL_STMT *Stmt);
+	void stmt_close(MYSQL_STMT *Stmt);
+
 	~CDBConn();
 };
 
@@ -40,7 +40,8 @@
 
 #define MIN(x, y) ((x) <= (y) ? (x) : (y))
 
-ConnectorProcess::ConnectorProcess() : _lengths(0)
+ConnectorProcess::ConnectorProcess()
+    : _lengths(0), stmt_use_tick(0), stmt_conn_seq(0)
 {
     error_no = 0;
 
@@ -882,6 +883,9 @@ int ConnectorProcess::process_select(DtcJob *Task)
     init_table_name(Task->request_key(), table_def->field_type(0));
     log4cplus_info("line:%d" ,__LINE__);
 
+    if (dbConfig->stmtCacheSize > 0)
+        return process_select_stmt(Task);
+
     if (haslimit)
         sql_append_const("SELECT SQL_CALC_FOUND_ROWS ");
     else
@@ -1014,36 +1018,413 @@ int ConnectorProcess::process_select(DtcJob *Task)
     db_conn.free_result();
 
     //bug fixed确认客户端带Limit限制
-    if (haslimit) { // 获取总行数
-        init_sql_buffer();
-        sql_append_const("SELECT FOUND_ROWS() ");
+    if (haslimit) // 获取总行数
+        return fetch_found_rows(Task, nRows);
 
-        log4cplus_debug("db: %s, sql: %s", DBName, sql.c_str());
+    return (0);
+}
 
-        Ret = db_conn.do_query(DBName, sql.c_str());
-        log4cplus_debug("SELECT %d %d", Ret, db_conn.get_raw_err_no());
-        if (Ret != 0) {
-            Task->set_error_dup(db_conn.get_err_no(), __FUNCTION__,
-                        db_conn.get_err_msg());
-            log4cplus_warning(
-                "db query error: %s, pid: %d, group-id: %d",
-                db_conn.get_err_msg(), getpid(), self_group_id);
-            return (-4);
+int ConnectorProcess::fetch_found_rows(DtcJob *Task, int nRows)
+{
+    int Ret;
+
+    init_sql_buffer();
+    sql_append_const("SELECT FOUND_ROWS() ");
+
+    log4cplus_debug("db: %s, sql: %s", DBName, sql.c_str());
+
+    Ret = db_conn.do_query(DBName, sql.c_str());
+    log4cplus_debug("SELECT %d %d", Ret, db_conn.get_raw_err_no());
+    if (Ret != 0) {
+        Task->set_error_dup(db_conn.get_err_no(), __FUNCTION__,
+                    db_conn.get_err_msg());
+        log4cplus_warning("db query error: %s, pid: %d, group-id: %d",
+                  db_conn.get_err_msg(), getpid(), self_group_id);
+        return (-4);
+    }
+
+    Ret = db_conn.use_result();
+    if (Ret != 0) {
+        Task->set_error_dup(db_conn.get_err_no(), __FUNCTION__,
+                    db_conn.get_err_msg());
+        log4cplus_warning("db user result error: %s",
+                  db_conn.get_err_msg());
+        return (-5);
+    }
+
+    Ret = db_conn.fetch_row();
+
+    if (Ret != 0) {
+        db_conn.free_result();
+        Task->set_error_dup(db_conn.get_err_no(), __FUNCTION__,
+                    db_conn.get_err_msg());
+        log4cplus_warning("db fetch row error: %s",
+                  db_conn.get_err_msg());
+        return (-6);
+    }
+
+    unsigned long totalRows = strtoul(db_conn.Row[0], NULL, 0);
+    if (totalRows == 0) {
+        if (nRows != 0)
+            totalRows = Task->requestInfo.limit_start() + nRows;
+        else
+            totalRows = 0;
+    }
+
+    Ret = Task->set_total_rows(totalRows, 1);
+
+    log4cplus_debug("db: total-rows: %lu, ret: %d", totalRows, Ret);
+
+    db_conn.free_result();
+
+    return (0);
+}
+
+void ConnectorProcess::stmt_cache_clear(void)
+{
+    std::map<std::string, StmtCacheEntry>::iterator it;
+    for (it = stmt_cache.begin(); it != stmt_cache.end(); ++it)
+        db_conn.stmt_close(it->second.stmt);
+    stmt_cache.clear();
+}
+
+/* 以当前sql(参数为占位符)作为key，查找或者prepare语句 */
+MYSQL_STMT *ConnectorProcess::stmt_lookup(void)
+{
+    // 重新连接后，之前prepare的语句全部失效
+    if (db_conn.Open() != 0)
+        return NULL;
+    if (stmt_conn_seq != db_conn.connect_seq()) {
+        stmt_cache_clear();
+        stmt_conn_seq = db_conn.connect_seq();
+    }
+
+    std::string key(sql.c_str(), sql.size());
+    std::map<std::string, StmtCacheEntry>::iterator it =
+        stmt_cache.find(key);
+    if (it != stmt_cache.end()) {
+        it->second.last_use = ++stmt_use_tick;
+        return it->second.stmt;
+    }
+
+    MYSQL_STMT *stmt = db_conn.stmt_prepare(sql.c_str(), sql.size());
+    if (stmt == NULL)
+        return NULL;
+
+    // sql带分库分表名，分表多时满是常态，只淘汰最久未用的一条
+    if ((int)stmt_cache.size() >= dbConfig->stmtCacheSize) {
+        std::map<std::string, StmtCacheEntry>::iterator victim =
+            stmt_cache.begin();
+        for (it = stmt_cache.begin(); it != stmt_cache.end(); ++it)
+            if (it->second.last_use < victim->second.last_use)
+                victim = it;
+        db_conn.stmt_close(victim->second.stmt);
+        stmt_cache.erase(victim);
+    }
+    StmtCacheEntry &entry = stmt_cache[key];
+    entry.stmt = stmt;
+    entry.last_use = ++stmt_use_tick;
+    return stmt;
+}
+
+void ConnectorProcess::stmt_drop(MYSQL_STMT *stmt)
+{
+    std::map<std::string, StmtCacheEntry>::iterator it;
+    for (it = stmt_cache.begin(); it != stmt_cache.end(); ++it) {
+        if (it->second.stmt == stmt) {
+            stmt_cache.erase(it);
+            break;
         }
+    }
+    db_conn.stmt_close(stmt);
+}
 
-        Ret = db_conn.use_result();
-        if (Ret != 0) {
-            Task->set_error_dup(db_conn.get_err_no(), __FUNCTION__,
-                        db_conn.get_err_msg());
-            log4cplus_warning("db user result error: %s",
-                      db_conn.get_err_msg());
-            return (-5);
+void ConnectorProcess::stmt_bind_value(MYSQL_BIND *bind, const DTCValue *value,
+                       int field_type)
+{
+    memset(bind, 0, sizeof(MYSQL_BIND));
+    if (value == NULL) {
+        bind->buffer_type = MYSQL_TYPE_NULL;
+        return;
+    }
+
+    switch (field_type) {
+    case DField::Signed:
+        bind->buffer_type = MYSQL_TYPE_LONGLONG;
+        bind->buffer = (void *)&value->s64;
+        break;
+
+    case DField::Unsigned:
+        bind->buffer_type = MYSQL_TYPE_LONGLONG;
+        bind->buffer = (void *)&value->u64;
+        bind->is_unsigned = 1;
+        break;
+
+    case DField::Float:
+        bind->buffer_type = MYSQL_TYPE_DOUBLE;
+        bind->buffer = (void *)&value->flt;
+        break;
+
+    case DField::String:
+    case DField::Binary:
+        bind->buffer_type = field_type == DField::String ?
+                        MYSQL_TYPE_STRING :
+                        MYSQL_TYPE_BLOB;
+        bind->buffer = value->str.ptr;
+        bind->buffer_length = value->str.len;
+        break;
+
+    default:
+        bind->buffer_type = MYSQL_TYPE_NULL;
+        error_no = -1;
+        log4cplus_error("unknown field type: %d", field_type);
+    }
+}
+
+/* 按结果列的最大长度分配buffer，并绑定到stmt */
+int ConnectorProcess::stmt_bind_result(MYSQL_STMT *stmt, int count_only)
+{
+    MYSQL_RES *meta = mysql_stmt_result_metadata(stmt);
+    if (meta == NULL) {
+        log4cplus_error("stmt result metadata error: %s",
+                mysql_stmt_error(stmt));
+        return (-1);
+    }
+
+    int ncol = mysql_num_fields(meta);
+    if (ncol != (count_only ? 1 : table_def->num_fields() + 1)) {
+        log4cplus_error("stmt result field count mismatch: %d", ncol);
+        mysql_free_result(meta);
+        return (-1);
+    }
+
+    stmt_results.resize(ncol);
+    stmt_nulls.resize(ncol);
+    stmt_lengths.resize(ncol);
+    memset(&stmt_results[0], 0, sizeof(MYSQL_BIND) * ncol);
+
+    // 先计算每列的buffer大小，按8字节对齐
+    MYSQL_FIELD *fields = mysql_fetch_fields(meta);
+    unsigned long size = 0;
+    for (int i = 0; i < ncol; i++) {
+        MYSQL_BIND *bind = &stmt_results[i];
+        int type = count_only ? DField::Unsigned :
+                    table_def->field_type(i);
+
+        bind->is_null = &stmt_nulls[i];
+        bind->length = &stmt_lengths[i];
+        switch (type) {
+        case DField::Signed:
+        case DField::Unsigned:
+            bind->buffer_type = MYSQL_TYPE_LONGLONG;
+            bind->is_unsigned = type == DField::Unsigned;
+            bind->buffer_length = sizeof(uint64_t);
+            break;
+        case DField::Float:
+            bind->buffer_type = MYSQL_TYPE_DOUBLE;
+            bind->buffer_length = sizeof(double);
+            break;
+        default:
+            bind->buffer_type = type == DField::String ?
+                            MYSQL_TYPE_STRING :
+                            MYSQL_TYPE_BLOB;
+            bind->buffer_length = (fields[i].max_length + 8) & ~7UL;
+            break;
         }
+        size += bind->buffer_length;
+    }
+    mysql_free_result(meta);
 
-        Ret = db_conn.fetch_row();
+    stmt_buf.clear();
+    if (stmt_buf.expand(size) < 0) {
+        log4cplus_error("realloc (size: %lu) error: %m", size);
+        return (-1);
+    }
+
+    char *p = stmt_buf.c_str();
+    for (int i = 0; i < ncol; i++) {
+        stmt_results[i].buffer = p;
+        p += stmt_results[i].buffer_length;
+    }
+
+    if (mysql_stmt_bind_result(stmt, &stmt_results[0]) != 0) {
+        log4cplus_error("stmt bind result error: %s",
+                mysql_stmt_error(stmt));
+        return (-1);
+    }
+    return (0);
+}
+
+int ConnectorProcess::stmt_save_row(RowValue *Row, DtcJob *Task)
+{
+    for (int i = 1; i <= table_def->num_fields(); i++) {
+        MYSQL_BIND *bind = &stmt_results[i];
+        DTCValue &Value = (*Row)[i];
+
+        if (stmt_nulls[i]) {
+            set_default_value(table_def->field_type(i), Value);
+            continue;
+        }
+
+        switch (table_def->field_type(i)) {
+        case DField::Signed:
+            Value.s64 = *(int64_t *)bind->buffer;
+            break;
+        case DField::Unsigned:
+            Value.u64 = *(uint64_t *)bind->buffer;
+            break;
+        case DField::Float:
+            Value.flt = *(double *)bind->buffer;
+            break;
+        case DField::String:
+        case DField::Binary:
+            Value.str.len = stmt_lengths[i];
+            Value.str.ptr = (char *)bind->buffer;
+            break;
+        default:
+            log4cplus_error("field[%d] type[%d] invalid.", i,
+                    table_def->field_type(i));
+            break;
+        }
+    }
+
+    Task->update_key(Row);
+    if (Task->append_row(Row) < 0)
+        return (-3);
+
+    return (0);
+}
+
+/*
+ * SELECT走prepared statement：同一个(字段集合, 条件形状)的语句每个连接只
+ * prepare一次，参数以二进制方式绑定，结果也以二进制返回，省去双方的
+ * sql解析和数值的字符串转换。
+ */
+int ConnectorProcess::process_select_stmt(DtcJob *Task)
+{
+    int Ret, i;
+    RowValue *Row = NULL;
+    int nRows;
+    int haslimit =
+        !Task->count_only() && (Task->requestInfo.limit_start() ||
+                    Task->requestInfo.limit_count());
+    const DTCFieldValue *Condition = Task->request_condition();
+    int nCond = Condition ? Condition->num_fields() : 0;
 
+    if (haslimit)
+        sql_append_const("SELECT SQL_CALC_FOUND_ROWS ");
+    else
+        sql_append_const("SELECT ");
+    select_field_concate(Task->request_fields()); // 总是SELECT所有字段
+    sql_append_const(" FROM ");
+    // 语句跨库复用，表名需要带上库名
+    sql_append_string(&left_quote, 1);
+    sql_append_string(DBName);
+    sql_append_string(&right_quote, 1);
+    sql_append_const(".");
+    sql_append_table();
+
+    sql_append_const(" WHERE ");
+    sql_append_field(0);
+    sql_append_const("=?");
+
+    for (i = 0; i < nCond; i++) {
+        if (table_def->is_volatile(i)) {
+            Task->set_error(-EC_BAD_COMMAND, __FUNCTION__,
+                    "Volatile condition not allowed");
+            return (-7);
+        }
+        sql_append_const(" AND ");
+        sql_append_field(Condition->field_id(i));
+        sql_append_comparator(Condition->field_operation(i));
+        sql_append_const("?");
+    }
+
+    if (dbConfig->ordSql) {
+        sql_append_const(" ");
+        sql_append_string(dbConfig->ordSql);
+    }
+
+    uint64_t limit[2] = { Task->requestInfo.limit_start(),
+                  Task->requestInfo.limit_count() };
+    if (limit[1] > 0)
+        sql_append_const(" LIMIT ?, ?");
+
+    if (error_no != 0) {
+        Task->set_error(-EC_ERROR_BASE, __FUNCTION__, "printf error");
+        log4cplus_error("error occur: %d", error_no);
+        return (-1);
+    }
+
+    // 绑定参数：key、条件、limit
+    stmt_params.resize(1 + nCond + 2);
+    stmt_bind_value(&stmt_params[0], Task->request_key(),
+            table_def->field_type(0));
+    for (i = 0; i < nCond; i++)
+        stmt_bind_value(&stmt_params[1 + i], Condition->field_value(i),
+                Condition->field_type(i));
+    if (limit[1] > 0) {
+        for (i = 0; i < 2; i++) {
+            MYSQL_BIND *bind = &stmt_params[1 + nCond + i];
+            memset(bind, 0, sizeof(MYSQL_BIND));
+            bind->buffer_type = MYSQL_TYPE_LONGLONG;
+            bind->buffer = &limit[i];
+            bind->is_unsigned = 1;
+        }
+    }
+
+    Ret = Task->prepare_result_no_limit();
+    if (Ret != 0) {
+        Task->set_error(-EC_ERROR_BASE, __FUNCTION__,
+                "task prepare-result error");
+        log4cplus_error("task prepare-result error: %d, %m", Ret);
+        return (-2);
+    }
+
+    log4cplus_debug("db: %s, stmt: %s", DBName, sql.c_str());
+
+    MYSQL_STMT *stmt = stmt_lookup();
+    if (stmt == NULL) {
+        Task->set_error_dup(db_conn.get_err_no(), __FUNCTION__,
+                    db_conn.get_err_msg());
+        log4cplus_warning("db prepare error: %s, pid: %d, group-id: %d",
+                  db_conn.get_err_msg(), getpid(), self_group_id);
+        return (-4);
+    }
+
+    if (db_conn.stmt_execute(stmt, &stmt_params[0]) != 0 ||
+        db_conn.stmt_store_result(stmt) != 0) {
+        Task->set_error_dup(db_conn.get_err_no(), __FUNCTION__,
+                    db_conn.get_err_msg());
+        log4cplus_warning("db execute error: %s, pid: %d, group-id: %d",
+                  db_conn.get_err_msg(), getpid(), self_group_id);
+        stmt_drop(stmt);
+        return (-4);
+    }
+
+    if (stmt_bind_result(stmt, Task->count_only()) != 0) {
+        mysql_stmt_free_result(stmt);
+        Task->set_error(-EC_ERROR_BASE, __FUNCTION__,
+                "stmt bind result error");
+        return (-5);
+    }
+
+    if (!Task->count_only()) {
+        Row = new RowValue(table_def);
+        if (Row == NULL) {
+            mysql_stmt_free_result(stmt);
+            Task->set_error(-ENOMEM, __FUNCTION__, "new row error");
+            log4cplus_error("%s new RowValue error: %m", "");
+            return (-3);
+        }
+    }
+
+    nRows = db_conn.res_num;
+    for (i = 0; i < nRows; i++) {
+        Ret = db_conn.stmt_fetch(stmt);
         if (Ret != 0) {
-            db_conn.free_result();
+            delete Row;
+            mysql_stmt_free_result(stmt);
             Task->set_error_dup(db_conn.get_err_no(), __FUNCTION__,
                         db_conn.get_err_msg());
             log4cplus_warning("db fetch row error: %s",
@@ -1051,21 +1432,28 @@ int ConnectorProcess::process_select(DtcJob *Task)
             return (-6);
         }
 
-        unsigned long totalRows = strtoul(db_conn.Row[0], NULL, 0);
-        if (totalRows == 0) {
-            if (nRows != 0)
-                totalRows =
-                    Task->requestInfo.limit_start() + nRows;
-            else
-                totalRows = 0;
+        if (Task->count_only()) {
+            nRows = *(uint64_t *)stmt_results[0].buffer;
+            Task->set_total_rows(nRows);
+            break;
+        } else if ((Ret = stmt_save_row(Row, Task)) != 0) {
+            delete Row;
+            mysql_stmt_free_result(stmt);
+            Task->set_error(-EC_ERROR_BASE, __FUNCTION__,
+                    "task append row error");
+            log4cplus_error("task append row error: %d", Ret);
+            return (-7);
         }
+    }
 
-        Ret = Task->set_total_rows(totalRows, 1);
+    log4cplus_debug("pid: %d, group-id: %d, result: %d row, db: %s, stmt: %s",
+            getpid(), self_group_id, nRows, DBName, sql.c_str());
 
-        log4cplus_debug("db: total-rows: %lu, ret: %d", totalRows, Ret);
+    delete Row;
+    mysql_stmt_free_result(stmt);
 
-        db_conn.free_result();
-    }
+    if (haslimit)
+        return fetch_found_rows(Task, nRows);
 
     return (0);
 }
@@ -1384,6 +1772,10 @@ int ConnectorProcess::process_replace(DtcJob *Task)
 {
     int Ret;
 
+    /* DTC合并的flush行放在DTCResultSet中 */
+    if (Task->result != NULL && Task->result->total_rows() > 0)
+        return process_batch_replace(Task);
+
     set_title("REPLACE...");
     init_sql_buffer();
     init_table_name(Task->request_key(), table_def->field_type(0));
@@ -1435,8 +1827,132 @@ int ConnectorProcess::process_replace(DtcJob *Task)
     return 0;
 }
 
+int ConnectorProcess::batch_replace_query(DtcJob *Task, const char *db,
+                        unsigned int seq, int64_t &affected)
+{
+    if (error_no != 0) { // 主要检查PrintfAppend是否发生过错误
+        Task->set_error(-EC_ERROR_BASE, __FUNCTION__, "printf error");
+        log4cplus_error("error occur: %d", error_no);
+        db_conn.roll_back();
+        return (-1);
+    }
+
+    log4cplus_debug("db: %s, sql: %s", db, sql.c_str());
+
+    int Ret = db_conn.do_query(db, sql.c_str());
+    if (Ret != 0) {
+        Task->set_error_dup(db_conn.get_err_no(), __FUNCTION__,
+                    db_conn.get_err_msg());
+        log4cplus_warning("db query error: %s", db_conn.get_err_msg());
+        return (-1);
+    }
+    /* 中途重连说明事务已经丢失，之后的语句是自动提交的 */
+    if (db_conn.connect_seq() != seq) {
+        Task->set_error(-EC_ERROR_BASE, __FUNCTION__,
+                "connection reset during batch");
+        log4cplus_warning("connection reset during batch replace");
+        return (-1);
+    }
+
+    affected += db_conn.affected_rows();
+    return 0;
+}
+
+/*
+ * 多行Replace：同一张表的连续行拼成一条REPLACE ... VALUES (...),(...)，
+ * 整批在一个事务中提交。REPLACE整行覆盖，失败后DTC重新flush是幂等的。
+ */
+int ConnectorProcess::process_batch_replace(DtcJob *Task)
+{
+    ResultSet *rs = Task->result;
+    const RowValue *row;
+    char batch_db[sizeof(DBName)] = "";
+    char batch_table[sizeof(table_name)] = "";
+    int nrows = 0;
+    int64_t affected = 0;
+
+    set_title("BATCH REPLACE...");
+
+    if (db_conn.begin_work() != 0) {
+        Task->set_error_dup(db_conn.get_err_no(), __FUNCTION__,
+                    db_conn.get_err_msg());
+        log4cplus_warning("begin batch error: %s", db_conn.get_err_msg());
+        return (-1);
+    }
+    unsigned int seq = db_conn.connect_seq();
+
+    init_sql_buffer();
+    rs->rewind();
+    while ((row = rs->fetch_row()) != NULL) {
+        init_table_name(row->field_value(0), table_def->field_type(0));
+
+        /* 分库分表时换表就先执行前面的语句 */
+        if (nrows > 0 && (strcmp(DBName, batch_db) != 0 ||
+                  strcmp(table_name, batch_table) != 0)) {
+            if (batch_replace_query(Task, batch_db, seq, affected) != 0)
+                return (-1);
+            init_sql_buffer();
+            nrows = 0;
+        }
+
+        if (nrows == 0) {
+            strcpy(batch_db, DBName);
+            strcpy(batch_table, table_name);
+            sql_append_const("REPLACE INTO ");
+            sql_append_table();
+            sql_append_const(" (");
+            sql_append_field(0);
+            for (int i = 1; i <= table_def->num_fields(); i++) {
+                if (table_def->is_volatile(i))
+                    continue;
+                sql_append_const(",");
+                sql_append_field(i);
+            }
+            sql_append_const(") VALUES (");
+        } else {
+            sql_append_const(",(");
+        }
+
+        format_sql_value(row->field_value(0), table_def->field_type(0));
+        for (int i = 1; i <= table_def->num_fields(); i++) {
+            if (table_def->is_volatile(i))
+                continue;
+            sql_append_const(",");
+            format_sql_value(row->field_value(i),
+                     table_def->field_type(i));
+        }
+        sql_append_const(")");
+        nrows++;
+    }
+
+    if (rs->error_num() != 0) {
+        Task->set_error(rs->error_num(), __FUNCTION__,
+                "decode batch rows error");
+        log4cplus_error("decode batch rows error: %d", rs->error_num());
+        db_conn.roll_back();
+        return (-1);
+    }
+
+    if (nrows > 0 && batch_replace_query(Task, batch_db, seq, affected) != 0)
+        return (-1);
+
+    if (db_conn.do_commit() != 0) {
+        Task->set_error_dup(db_conn.get_err_no(), __FUNCTION__,
+                    db_conn.get_err_msg());
+        log4cplus_warning("commit batch error: %s", db_conn.get_err_msg());
+        return (-1);
+    }
+
+    Task->resultInfo.set_affected_rows(affected);
+    log4cplus_debug("batch replace %d rows successful",
+            rs->total_rows());
+
+    return 0;
+}
+
 ConnectorProcess::~ConnectorProcess()
 {
+    stmt_cache_clear();
 }
 
 void ConnectorProcess::init_title(int group, int role)
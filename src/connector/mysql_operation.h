@@ -21,6 +21,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <string>
+#include <map>
+#include <vector>
 // local include files
 #include "database_connection.h"
 // common include files
@@ -51,6 +53,19 @@ class ConnectorProcess {
 	DBHost db_host_conf;
 
 	unsigned long *_lengths;
+	/* prepared statement cache，key为带占位符的sql，满时淘汰最久未用的 */
+	struct StmtCacheEntry {
+		MYSQL_STMT *stmt;
+		uint64_t last_use;
+	};
+	std::map<std::string, StmtCacheEntry> stmt_cache;
+	uint64_t stmt_use_tick;
+	unsigned int stmt_conn_seq;
+	std::vector<MYSQL_BIND> stmt_params;
+	std::vector<MYSQL_BIND> stmt_results;
+	std::vector<my_bool> stmt_nulls;
+	std::vector<unsigned long> stmt_lengths;
+	class buffer stmt_buf;
 	time_t last_access;
 	int ping_timeout;
 	unsigned int proc_timeout;
@@ -82,8 +97,18 @@ class ConnectorProcess {
 	int default_value_concate(const DTCFieldValue *UpdateInfo);
 	int save_row(RowValue *Row, DtcJob *Task);
 
+	void stmt_cache_clear(void);
+	MYSQL_STMT *stmt_lookup(void);
+	void stmt_drop(MYSQL_STMT *stmt);
+	void stmt_bind_value(MYSQL_BIND *bind, const DTCValue *value,
+			     int field_type);
+	int stmt_bind_result(MYSQL_STMT *stmt, int count_only);
+	int stmt_save_row(RowValue *Row, DtcJob *Task);
+	int fetch_found_rows(DtcJob *Task, int nRows);
+
 	
 	int process_select(DtcJob *Task);
+	int process_select_stmt(DtcJob *Task);
 	int process_insert(DtcJob *Task);
 	int process_insert_rb(DtcJob *Task);
 	int process_update(DtcJob *Task);
@@ -91,6 +116,9 @@ class ConnectorProcess {
 	int process_delete(DtcJob *Task);
 	int process_delete_rb(DtcJob *Task);
 	int process_replace(DtcJob *Task);
+	int process_batch_replace(DtcJob *Task);
+	int batch_replace_query(DtcJob *Task, const char *db,
+				unsigned int seq, int64_t &affected);
  	int process_reload_config(DtcJob *Task);
 public:
 	ConnectorProcess();
@@ -121,6 +149,24 @@ public:
 	}
 
 	int process_statement_query(const DTCValue* key, std::string& s_sql);
+	/* 批量执行process_statement_query时使用的事务，
+	 * 出错时连接会被关闭，调用者通过connect_seq判断事务是否还有效 */
+	int begin_batch(void)
+	{
+		return db_conn.begin_work();
+	}
+	int commit_batch(void)
+	{
+		return db_conn.do_commit();
+	}
+	int rollback_batch(void)
+	{
+		return db_conn.roll_back();
+	}
+	unsigned int connect_seq(void) const
+	{
+		return db_conn.connect_seq();
+	}
 	~ConnectorProcess();
 };
 
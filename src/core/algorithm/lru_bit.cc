@@ -23,6 +23,9 @@
 #include "node_index.h"
 #include "log/log.h"
 #include "table/table_def_manager.h"
+#include "config/config.h"
+
+extern DTCConfig *g_dtc_config;
 
 LruBitObj::LruBitObj(LruBitUnit *t)
 	: _max_lru_bit(0), _scan_lru_bit(0), _scan_idx_off(0), _lru_writer(0),
@@ -141,9 +144,6 @@ int LruBitObj::Scan(void)
 		}
 
 		if (found > 0) {
-			//批量写入lru变更
-			_lru_writer->Commit();
-
 			//idx清零1byete， blk清零64bytes
 			total_1_bits -= p->clear(_scan_idx_off);
 		}
@@ -153,10 +153,15 @@ int LruBitObj::Scan(void)
 		found_id += found;
 		// 如果超过此水位，终止扫描, 等待下一次被调度
 		if (found_id >= _scan_stop_until) {
+			//本次扫描的lru变更合并成一条日志写入
+			_lru_writer->Commit();
 			return 0;
 		}
 	}
 
+	if (found_id > 0)
+		_lru_writer->Commit();
+
 	//调整为下一个lru_bit(4k)
 	_scan_idx_off = 0;
 	_scan_lru_bit += 1;
@@ -218,13 +223,19 @@ int LruBitUnit::Unset(unsigned int v)
 	return _is_start ? _lru_bit_obj->SetNodeID(v, 0) : 0;
 }
 
-LruWriter::LruWriter(BinlogWriter *w) : _log_writer(w), _raw_data(0)
+LruWriter::LruWriter(BinlogWriter *w)
+	: _log_writer(w), _raw_data(0), _batch(0)
 {
+	lru_sync_keys = g_stat_mgr.get_stat_int_counter(HBP_LRU_SYNC_KEYS);
+	lru_sync_bytes = g_stat_mgr.get_stat_int_counter(HBP_LRU_SYNC_BYTES);
+	lru_sync_row_bytes =
+		g_stat_mgr.get_stat_int_counter(HBP_LRU_SYNC_ROW_BYTES);
 }
 
 LruWriter::~LruWriter()
 {
 	DELETE(_raw_data);
+	DELETE(_batch);
 }
 
 int LruWriter::do_init()
@@ -241,6 +252,16 @@ int LruWriter::do_init()
 			    (const char *)&type, 0, -1, -1, 0))
 		return -1;
 
+	/* 合并格式需要备机支持AdjustLRUBatch，默认仍然一个key一行 */
+	if (g_dtc_config->get_int_val("cache", "LruSyncBatch", 0) > 0) {
+		NEW(LruSyncBatch(TableDefinitionManager::instance()
+					 ->get_cur_table_def()
+					 ->key_format()),
+		    _batch);
+		if (!_batch)
+			return -1;
+	}
+
 	return 0;
 }
 
@@ -253,17 +274,28 @@ int LruWriter::Write(unsigned int v)
 		return 0;
 
 	DataChunk *p = M_POINTER(DataChunk, node.vd_handle());
+
+	//self table-definition encode packed key
+	DTCValue key = TableDefinitionManager::instance()
+			       ->get_cur_table_def()
+			       ->packed_key(p->key());
+
+	/* 一个key一行: flag + flag字段 + key/value的长度 + key */
+	lru_sync_row_bytes += sizeof(unsigned char) + sizeof(int32_t) +
+			      2 * sizeof(int) + key.bin.len;
+
+	if (_batch) {
+		_batch->add_key(key.bin.ptr);
+		return 0;
+	}
+
 	RowValue r(
 		TableDefinitionManager::instance()->get_hot_backup_table_def());
-
 	r[0].u64 = DTCHotBackup::SYNC_LRU;
 	r[1].u64 = DTCHotBackup::NON_VALUE;
-
-	//self table-definition encode packed key
-	r[2] = TableDefinitionManager::instance()
-		       ->get_cur_table_def()
-		       ->packed_key(p->key());
+	r[2] = key;
 	r[3].Set(0);
+	lru_sync_keys++;
 
 	return _raw_data->insert_row(r, false, false);
 }
@@ -272,8 +304,28 @@ int LruWriter::Commit(void)
 {
 	log4cplus_debug("lru write commit");
 
+	if (_batch) {
+		if (_batch->Count() == 0)
+			return 0;
+
+		lru_sync_keys += _batch->Encode(_batch_buf);
+		_batch->Reset();
+
+		RowValue r(TableDefinitionManager::instance()
+				   ->get_hot_backup_table_def());
+		r[0].u64 = DTCHotBackup::SYNC_LRU;
+		r[1].u64 = DTCHotBackup::NON_VALUE | DTCHotBackup::KEY_BATCH;
+		r[2].Set(0);
+		r[3].Set(_batch_buf.data(), _batch_buf.size());
+		if (_raw_data->insert_row(r, false, false) != 0)
+			return -1;
+	} else if (_raw_data->total_rows() == 0) {
+		return 0;
+	}
+
 	_log_writer->insert_header(BINLOG_LRU, 0, 1);
 	_log_writer->append_body(_raw_data->get_addr(), _raw_data->data_size());
+	lru_sync_bytes += _raw_data->data_size();
 
 	log4cplus_debug("body: len=%d, content:%x", _raw_data->data_size(),
 			*(char *)_raw_data->get_addr());
@@ -26,6 +26,7 @@
 #include "raw_data.h"
 #include "data_chunk.h"
 #include "table/hotbackup_table_def.h"
+#include "table/lru_sync_batch.h"
 #include "sys_malloc.h"
 
 #define IDX_SIZE (4 << 10) //4K
@@ -136,6 +137,13 @@ class LruWriter {
     private:
 	BinlogWriter *_log_writer;
 	RawData *_raw_data;
+	/* LruSyncBatch开启时一次扫描的key合并成一行，减少热备日志量 */
+	LruSyncBatch *_batch;
+	std::string _batch_buf;
+
+	StatCounter lru_sync_keys;
+	StatCounter lru_sync_bytes;
+	StatCounter lru_sync_row_bytes;
 };
 
 class LruBitUnit;
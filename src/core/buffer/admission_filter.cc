@@ -0,0 +1,107 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "admission_filter.h"
+#include "algorithm/new_hash.h"
+#include "log/log.h"
+
+AdmissionFilter::AdmissionFilter()
+	: table_(NULL), mask_(0), additions_(0), sample_size_(0), key_size_(0)
+{
+}
+
+AdmissionFilter::~AdmissionFilter()
+{
+	free(table_);
+}
+
+int AdmissionFilter::init(unsigned width, int key_size)
+{
+	unsigned w = 1024;
+
+	while (w < width && w < (1U << 28))
+		w <<= 1;
+
+	table_ = (uint8_t *)calloc(AF_DEPTH, w);
+	if (table_ == NULL) {
+		log4cplus_error("alloc admission filter %u x %u failed: %m",
+				AF_DEPTH, w);
+		return -1;
+	}
+	mask_ = w - 1;
+	additions_ = 0;
+	sample_size_ = w * AF_SAMPLE_FACTOR;
+	key_size_ = key_size;
+	return 0;
+}
+
+uint32_t AdmissionFilter::key_hash(const char *key) const
+{
+	//变长key的第一个字节是长度
+	int size = key_size_ > 0 ? key_size_ : *(const unsigned char *)key++;
+
+	return new_hash(key, size);
+}
+
+void AdmissionFilter::touch(const char *key)
+{
+	uint32_t h = key_hash(key);
+	uint32_t h2 = ((h >> 16) | (h << 16)) * 0x9e3779b1U | 1;
+	uint8_t *cell[AF_DEPTH];
+	uint8_t min = AF_MAX_COUNT;
+
+	//conservative update: 只增加等于最小值的计数器
+	for (int i = 0; i < AF_DEPTH; i++) {
+		cell[i] = table_ + i * (mask_ + 1) + ((h + i * h2) & mask_);
+		if (*cell[i] < min)
+			min = *cell[i];
+	}
+	if (min < AF_MAX_COUNT) {
+		for (int i = 0; i < AF_DEPTH; i++) {
+			if (*cell[i] == min)
+				++*cell[i];
+		}
+	}
+
+	if (++additions_ >= sample_size_)
+		halve();
+}
+
+unsigned AdmissionFilter::estimate(const char *key) const
+{
+	uint32_t h = key_hash(key);
+	uint32_t h2 = ((h >> 16) | (h << 16)) * 0x9e3779b1U | 1;
+	uint8_t min = AF_MAX_COUNT;
+
+	for (int i = 0; i < AF_DEPTH; i++) {
+		uint8_t c = table_[i * (mask_ + 1) + ((h + i * h2) & mask_)];
+		if (c < min)
+			min = c;
+	}
+	return min;
+}
+
+void AdmissionFilter::halve(void)
+{
+	uint64_t *p = (uint64_t *)table_;
+	size_t n = (size_t)AF_DEPTH * (mask_ + 1) / sizeof(uint64_t);
+
+	for (size_t i = 0; i < n; i++)
+		p[i] = (p[i] >> 1) & 0x7f7f7f7f7f7f7f7fULL;
+	additions_ /= 2;
+}
@@ -0,0 +1,63 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef __DTC_ADMISSION_FILTER_H__
+#define __DTC_ADMISSION_FILTER_H__
+
+#include <stdint.h>
+
+#define AF_DEPTH 4 /* count-min的行数 */
+#define AF_MAX_COUNT 15 /* 计数器上限 */
+#define AF_SAMPLE_FACTOR 10 /* 累计访问达到宽度的倍数时计数减半 */
+
+/*
+ * TinyLFU准入过滤，放在进程内存中，重启后重新统计。
+ * 用count-min sketch记录key的访问频率，累计访问次数达到
+ * AF_SAMPLE_FACTOR倍宽度时所有计数减半，使旧的热度逐渐衰减。
+ * 缺失回填需要淘汰节点时，新key的频率高于被淘汰的key才进入cache。
+ */
+class AdmissionFilter {
+    public:
+	AdmissionFilter();
+	~AdmissionFilter();
+
+	/* width向上取整到2的幂，建议与cache的节点数相当；key_size为0表示变长key */
+	int init(unsigned width, int key_size);
+	/* key为packed key，与BufferPond中的格式相同 */
+	void touch(const char *key);
+	unsigned estimate(const char *key) const;
+	bool admit(const char *candidate, const char *victim) const
+	{
+		return estimate(candidate) > estimate(victim);
+	}
+
+	unsigned width(void) const
+	{
+		return mask_ + 1;
+	}
+
+    private:
+	uint32_t key_hash(const char *key) const;
+	void halve(void);
+
+	uint8_t *table_;
+	uint32_t mask_;
+	uint32_t additions_;
+	uint32_t sample_size_;
+	int key_size_;
+};
+
+#endif
@@ -17,9 +17,11 @@
 #include "buffer_flush.h"
 #include "buffer_process_ask_chain.h"
 #include "global.h"
+#include "algorithm/timestamp.h"
 
 DTCFlushRequest::DTCFlushRequest(BufferProcessAskChain *o, const char *key)
-	: owner(o), numReq(0), badReq(0), wait(NULL)
+	: owner(o), numReq(0), badReq(0), wait(NULL),
+	  startTime(GET_TIMESTAMP())
 {
 }
 
@@ -78,6 +80,8 @@ int DTCFlushRequest::flush_row(const RowValue &row)
 
 void DTCFlushRequest::complete_row(DTCJobOperation *req, int index)
 {
+	if (req->result_code() < 0)
+		badReq++;
 	delete req;
 	numReq--;
 	if (numReq == 0) {
@@ -31,6 +31,7 @@ class DTCFlushRequest {
 	int numReq;
 	int badReq;
 	DTCJobOperation *wait;
+	int64_t startTime; /* us */
 
     public:
 	friend class BufferProcessAskChain;
@@ -25,6 +25,7 @@
 #include "buffer_pond.h"
 #include "data_chunk.h"
 #include "empty_filter.h"
+#include "empty_key_filter.h"
 #include "task/task_request.h"
 #include "dtc_global.h"
 #include "algorithm/relative_hour_calculator.h"
@@ -54,6 +55,10 @@ BufferPond::BufferPond(PurgeNodeProcessor *pn) : _purge_processor(pn)
 	first_marker_time = last_marker_time = 0;
 	empty_limit = 0;
 	_disable_try_purge = 0;
+	_admission_filter = NULL;
+	_admission_key = NULL;
+	_admission_result = 0;
+	_purge_look_ahead = 0;
 	survival_hour = g_stat_mgr.get_sample(DATA_SURVIVAL_HOUR_STAT);
 }
 
@@ -225,6 +230,10 @@ TRY_CACHE_INIT_AGAIN:
 	stat_purge_for_create_update_count =
 		g_stat_mgr.get_sample(PURGE_CREATE_UPDATE_STAT);
 	stat_try_purge_nodes = g_stat_mgr.get_stat_int_counter(TRY_PURGE_NODES);
+	stat_purge_nodes_per_alloc = g_stat_mgr.get_sample(PURGE_NODES_PER_ALLOC);
+	stat_purge_look_ahead_picks =
+		g_stat_mgr.get_stat_int_counter(PURGE_LOOK_AHEAD_PICKS);
+	stat_compress_saved = g_stat_mgr.get_stat_int_counter(DTC_COMPRESS_SAVED);
 	stat_last_purge_node_mod_time =
 		g_stat_mgr.get_stat_int_counter(LAST_PURGE_NODE_MOD_TIME);
 	stat_data_exist_time = g_stat_mgr.get_stat_int_counter(DATA_EXIST_TIME);
@@ -366,7 +375,8 @@ TRY_CACHE_INIT_AGAIN:
 	stat_cache_key = _cache_info.ipc_mem_key;
 	stat_cache_version = _cache_info.version;
 	stat_update_mode = _cache_info.sync_update;
-	stat_empty_filter = _cache_info.empty_filter;
+	stat_empty_filter = _cache_info.empty_filter ||
+			    _cache_info.empty_key_filter_size;
 	/*set minchunksize*/
 	PtMalloc::instance()->set_min_chunk_size(DTCGlobal::min_chunk_size_);
 
@@ -490,6 +500,31 @@ int BufferPond::dtc_mem_init(APP_STORAGE_T *storage)
 		}
 	}
 
+	/* Empty-Key Filter, 整型key优先使用Empty-Node Filter */
+	if (!_cache_info.empty_filter && _cache_info.empty_key_filter_size) {
+		EmptyKeyFilter *p = EmptyKeyFilter::instance();
+		if (!p) {
+			snprintf(_err_msg, sizeof(_err_msg),
+				 "start Empty-Key Filter failed, no memory");
+			return -1;
+		}
+		if (p->do_init(_cache_info.empty_key_filter_size,
+			       _cache_info.empty_key_filter_fp_rate,
+			       _cache_info.key_size)) {
+			snprintf(_err_msg, sizeof(_err_msg),
+				 "start Empty-Key Filter failed, %s",
+				 p->error());
+			return -1;
+		}
+
+		if (_feature->add_feature(EMPTY_KEY_FILTER, p->get_handle())) {
+			snprintf(_err_msg, sizeof(_err_msg),
+				 "add empty-key-filter feature failed, %s",
+				 _feature->error());
+			return -1;
+		}
+	}
+
 	// column expand
 	_col_expand = DTCColExpand::instance();
 	if (!_col_expand || _col_expand->initialization()) {
@@ -1084,6 +1119,17 @@ int BufferPond::try_purge_size(size_t size, Node reserve,
 
 	unsigned real_try_purge_count = 0;
 
+	/*
+	 * 从clean lru队尾找合并后足够大的节点。开启look-ahead时，找到第一个
+	 * 之后再比较最多_purge_look_ahead个节点，按GreedyDual-Size的思路
+	 * 选(深度+1)/合并大小最小的：越旧、释放的连续空间越大越先淘汰。
+	 */
+	Node victim;
+	DataChunk *victim_chunk = NULL;
+	unsigned victim_iter = 0;
+	unsigned first_iter = 0;
+	double victim_cost = 0;
+
 	/* clean lru header */
 	Node clean_header = clean_lru_head();
 
@@ -1093,6 +1139,9 @@ int BufferPond::try_purge_size(size_t size, Node reserve,
 	     iter < max_purge_count && !(!pos) && pos != clean_header; ++iter) {
 		Node purge_node = pos;
 
+		if (victim_chunk != NULL && iter - first_iter > _purge_look_ahead)
+			break;
+
 		if (get_total_used_node() < 10)
 			break;
 
@@ -1129,23 +1178,57 @@ int BufferPond::try_purge_size(size_t size, Node reserve,
 				data_chunk->node_size());
 
 		if (combine_size >= size) {
-			/* stat total rows */
-			inc_total_row(0LL - node_rows_count(purge_node));
-			purge_node_with_alert(purge_node);
-			_need_purge_node_count = iter;
-			log4cplus_debug(
-				"try purge size for create or update: %d",
-				iter + 1);
-			stat_purge_for_create_update_count.push(iter + 1);
-			++stat_try_purge_nodes;
-			return 0;
+			double cost = (double)(iter + 1) / combine_size;
+			if (victim_chunk == NULL) {
+				first_iter = iter;
+			} else if (cost >= victim_cost) {
+				continue;
+			}
+			victim = purge_node;
+			victim_chunk = data_chunk;
+			victim_iter = iter;
+			victim_cost = cost;
+			continue;
 		}
 
-		++real_try_purge_count;
+		if (victim_chunk == NULL)
+			++real_try_purge_count;
 	}
 
-	_need_purge_node_count = real_try_purge_count;
-	return -1;
+	if (victim_chunk == NULL) {
+		/* 没有足够大的节点，和first-fit一样延迟淘汰扫描过的整段队尾 */
+		_need_purge_node_count = real_try_purge_count;
+		stat_purge_nodes_per_alloc.push(_need_purge_node_count);
+		return -1;
+	}
+
+	/* 新key不比被淘汰的key更热，放弃本次回填，也不安排延迟淘汰 */
+	if (_admission_key != NULL) {
+		if (!_admission_filter->admit(_admission_key,
+					      victim_chunk->key())) {
+			_admission_result = -1;
+			return -1;
+		}
+		_admission_result = 1;
+	}
+
+	if (victim_iter != first_iter)
+		++stat_purge_look_ahead_picks;
+	/*
+	 * 和first-fit一样延迟淘汰第一个足够大的节点之前的节点，
+	 * look-ahead只决定立即淘汰哪一个
+	 */
+	_need_purge_node_count = first_iter;
+
+	/* stat total rows */
+	inc_total_row(0LL - node_rows_count(victim));
+	purge_node_with_alert(victim);
+	log4cplus_debug("try purge size for create or update: %d",
+			victim_iter + 1);
+	stat_purge_for_create_update_count.push(victim_iter + 1);
+	stat_purge_nodes_per_alloc.push(_need_purge_node_count + 1);
+	++stat_try_purge_nodes;
+	return 0;
 }
 
 int BufferPond::purge_node(const char *key, Node purge_node)
@@ -1194,6 +1277,8 @@ int BufferPond::purge_node_and_data(Node node)
 			       *(unsigned char *)(data_chunk->key()) + 1);
 
 		/* destroy data-chunk */
+		stat_compress_saved -=
+			data_chunk->compressed_saved_size(_cache_info.key_size);
 		data_chunk->destory(PtMalloc::instance());
 
 		return purge_node(key, node);
@@ -1204,6 +1289,11 @@ int BufferPond::purge_node_and_data(Node node)
 
 uint32_t BufferPond::get_cmodtime(Node *node)
 {
+	/* 压缩过的冷节点不解压，直接取压缩时记下的最大lastcmod */
+	DataChunk *chunk = M_POINTER(DataChunk, node->vd_handle());
+	if (chunk->is_compressed())
+		return chunk->compressed_lastcmod(_cache_info.key_size);
+
 	// how init
 	RawData *_raw_data = new RawData(PtMalloc::instance(), 1);
 	uint32_t lastcmod = 0;
@@ -1281,6 +1371,8 @@ int BufferPond::purge_node_and_data(const char *key, Node node)
 			node.node_id(), dwCreatetime, dwPurgeHour);
 		survival_hour.push((dwPurgeHour - dwCreatetime));
 		/* destroy data-chunk */
+		stat_compress_saved -=
+			data_chunk->compressed_saved_size(_cache_info.key_size);
 		data_chunk->destory(PtMalloc::instance());
 	}
 
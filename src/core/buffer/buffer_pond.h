@@ -35,6 +35,7 @@
 #include "timer/timer_list.h"
 #include "misc/purge_processor.h"
 #include "data/data_chunk.h"
+#include "admission_filter.h"
 
 DTC_BEGIN_NAMESPACE
 
@@ -63,6 +64,10 @@ typedef struct _BlockProperties {
 	unsigned char auto_delete_dirty_shm : 1;
 	// 是否需要强制使用table.conf更新共享内存中的配置
 	unsigned char force_update_table_conf : 1;
+	// 空key过滤器占用的内存，0表示不启用
+	uint64_t empty_key_filter_size;
+	// 空key过滤器期望的误判率
+	double empty_key_filter_fp_rate;
 
 	inline void init(int key_format, unsigned long cache_size,
 			 unsigned int create_version)
@@ -106,6 +111,14 @@ class BufferPond : private TimerObject {
 	int _disable_try_purge;
 	//如果自动淘汰的数据最后更新时间比当前时间减DataExpireAlertTime小则报警
 	int date_expire_alert_time;
+	//缺失回填的准入判断，未开启时为NULL
+	AdmissionFilter *_admission_filter;
+	//正在回填的新key，非NULL时淘汰前先做准入判断
+	const char *_admission_key;
+	//本次回填的准入结果：0未比较，1准入，-1拒绝
+	int _admission_result;
+	//try_purge_size找到第一个足够大的节点后继续比较的节点数，0为直接淘汰第一个
+	unsigned _purge_look_ahead;
 
     protected:
 	//统计
@@ -120,12 +133,16 @@ class BufferPond : private TimerObject {
 	StatCounter stat_dirty_age;
 	StatSample stat_try_purge_count;
 	StatCounter stat_try_purge_nodes;
+	StatCounter stat_compress_saved;
 	//最后被淘汰的节点的lastcmod的最大值(如果多行)
 	StatCounter stat_last_purge_node_mod_time;
 	//当前时间减去statLastPurgeNodeModTime
 	StatCounter stat_data_exist_time;
 	StatSample survival_hour;
 	StatSample stat_purge_for_create_update_count;
+	//每次try_purge_size立即淘汰和延迟淘汰的节点数
+	StatSample stat_purge_nodes_per_alloc;
+	StatCounter stat_purge_look_ahead_picks;
 
     private:
 	int app_storage_open();
@@ -246,6 +263,25 @@ class BufferPond : private TimerObject {
 	{
 		date_expire_alert_time = time < 0 ? 0 : time;
 	};
+	void set_admission_filter(AdmissionFilter *filter)
+	{
+		_admission_filter = filter;
+	}
+	/* 在admission_begin/admission_end之间，try_purge_size只在key比被淘汰的节点更热时才淘汰 */
+	void admission_begin(const char *key)
+	{
+		_admission_key = _admission_filter ? key : NULL;
+		_admission_result = 0;
+	}
+	int admission_end(void)
+	{
+		_admission_key = NULL;
+		return _admission_result;
+	}
+	void set_purge_look_ahead(unsigned count)
+	{
+		_purge_look_ahead = count;
+	}
 
 	//淘汰固定个节点
 	void delay_purge_notify(const unsigned count = 50);
@@ -329,6 +365,7 @@ class BufferPond : private TimerObject {
 	friend class BufferProcessAskChain;
 	friend class RawDataProcess;
 	friend class TreeDataProcess;
+	friend class ColdNodeCompressor;
 };
 
 DTC_END_NAMESPACE
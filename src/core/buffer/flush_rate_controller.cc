@@ -0,0 +1,90 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "flush_rate_controller.h"
+#include "log/log.h"
+
+FlushRateController::FlushRateController()
+	: max_budget_(1), queue_limit_(FRC_DEFAULT_QUEUE_LIMIT), budget_(1),
+	  baseline_(0), window_usec_(0), window_count_(0), window_errors_(0),
+	  last_latency_(0), last_errors_(0)
+{
+}
+
+void FlushRateController::set_limit(int max_budget, int queue_limit)
+{
+	if (max_budget < 1)
+		max_budget = 1;
+	if (queue_limit < 1)
+		queue_limit = FRC_DEFAULT_QUEUE_LIMIT;
+
+	max_budget_ = max_budget;
+	queue_limit_ = queue_limit;
+	/* 从最大并发开始，与不做控制时的行为一致 */
+	budget_ = max_budget;
+}
+
+void FlushRateController::complete(uint64_t usec, int errors)
+{
+	window_usec_ += usec;
+	window_count_++;
+	window_errors_ += errors;
+}
+
+int FlushRateController::adjust(int queue, int inflight)
+{
+	uint64_t avg = window_count_ ? window_usec_ / window_count_ : 0;
+
+	int congested = 0;
+	if (window_errors_ > 0)
+		congested = 1;
+	else if (queue > queue_limit_)
+		congested = 2;
+	else if (baseline_ && avg > FRC_MIN_LATENCY &&
+		 avg > baseline_ * FRC_LATENCY_FACTOR)
+		congested = 3;
+
+	if (congested) {
+		budget_ /= 2;
+		if (budget_ < 1)
+			budget_ = 1;
+		log4cplus_info(
+			"flush congested[%d]: errors %d queue %d latency %lu/%lu, budget %d",
+			congested, window_errors_, queue, (unsigned long)avg,
+			(unsigned long)baseline_, (int)budget_);
+	} else if (window_count_ + inflight >= (int)budget_) {
+		/* 预算被用满才增加，避免空闲时预算虚高 */
+		budget_ += 1;
+		if (budget_ > max_budget_)
+			budget_ = max_budget_;
+	}
+
+	/* 基线取观察到的最小时延，并缓慢上浮以适应DB负载变化 */
+	if (avg > 0) {
+		if (baseline_ == 0 || avg < baseline_)
+			baseline_ = avg;
+		else
+			baseline_ += (avg - baseline_) / 64;
+	}
+
+	last_latency_ = avg;
+	last_errors_ = window_errors_;
+	window_usec_ = 0;
+	window_count_ = 0;
+	window_errors_ = 0;
+
+	return (int)budget_;
+}
@@ -0,0 +1,70 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef __DTC_FLUSH_RATE_CONTROLLER_H__
+#define __DTC_FLUSH_RATE_CONTROLLER_H__
+
+#include <stdint.h>
+
+#define FRC_DEFAULT_QUEUE_LIMIT 8 /* 提交队列积压阈值 */
+#define FRC_LATENCY_FACTOR 4 /* 时延超过基线的倍数视为拥塞 */
+#define FRC_MIN_LATENCY 5000 /* us，低于该时延不判定拥塞 */
+
+/*
+ * 回写模式的flush并发预算，按周期(flush timer)做AIMD调整：
+ * 周期内有flush失败、提交队列积压或者时延明显高于基线时预算减半，
+ * 否则预算被用满时加一。
+ */
+class FlushRateController {
+    public:
+	FlushRateController();
+
+	void set_limit(int max_budget, int queue_limit);
+	/* 一个DTCFlushRequest完成，usec为从发出到全部行应答的耗时 */
+	void complete(uint64_t usec, int errors);
+	/* 每个周期调用一次，返回新的预算 */
+	int adjust(int queue, int inflight);
+
+	int budget(void) const
+	{
+		return (int)budget_;
+	}
+	uint64_t last_latency(void) const
+	{
+		return last_latency_;
+	}
+	int last_errors(void) const
+	{
+		return last_errors_;
+	}
+
+    private:
+	int max_budget_;
+	int queue_limit_;
+	double budget_;
+	uint64_t baseline_;
+
+	/* 当前周期 */
+	uint64_t window_usec_;
+	int window_count_;
+	int window_errors_;
+
+	/* 上一周期，用于统计 */
+	uint64_t last_latency_;
+	int last_errors_;
+};
+
+#endif
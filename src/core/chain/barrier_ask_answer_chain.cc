@@ -21,13 +21,16 @@
 #include <poll/poller_base.h>
 
 #include "log/log.h"
+#include "task/task_pkey.h"
+#include "table/table_def.h"
 
 //-------------------------------------------------------------------------
 BarrierAskAnswerChain::BarrierAskAnswerChain(PollerBase *o, int max,
 					     int maxkeycount,
 					     E_BARRIER_UNIT_PLACE place)
 	: JobAskInterface<DTCJobOperation>(o), count(0), max_barrier(max),
-	  max_key_count_(maxkeycount), main_chain(o)
+	  max_key_count_(maxkeycount), collapse_read_(place == IN_FRONT),
+	  main_chain(o)
 {
 	free_list.InitList();
 	for (int i = 0; i < BARRIER_HASH_MAX; i++)
@@ -38,11 +41,14 @@ BarrierAskAnswerChain::BarrierAskAnswerChain(PollerBase *o, int max,
 			DTC_FRONT_BARRIER_COUNT);
 		stat_barrier_max_task = g_stat_mgr.get_stat_int_counter(
 			DTC_FRONT_BARRIER_MAX_TASK);
+		stat_barrier_collapsed = g_stat_mgr.get_stat_int_counter(
+			DTC_FRONT_BARRIER_COLLAPSED);
 	} else if (IN_BACK == place) {
 		stat_barrier_count =
 			g_stat_mgr.get_stat_int_counter(DTC_BACK_BARRIER_COUNT);
 		stat_barrier_max_task = g_stat_mgr.get_stat_int_counter(
 			DTC_BACK_BARRIER_MAX_TASK);
+		/* 只有前端barrier合并读请求，后端不注册合并计数 */
 	} else {
 		log4cplus_error("bad place value %d", place);
 	}
@@ -96,6 +102,63 @@ void BarrierAskAnswerChain::attach_free_barrier(BarrierQueue *barrier)
 	//Stat.set_barrier_count (count);
 }
 
+bool BarrierAskAnswerChain::collapsible(DTCJobOperation *job)
+{
+	return collapse_read_ && job->request_code() == DRequest::Get &&
+	       !job->flag_no_cache() && !job->flag_pass_thru() &&
+	       job->packed_key() != NULL;
+}
+
+bool BarrierAskAnswerChain::match_collapse(BarrierQueue *barrier,
+					   DTCJobOperation *job)
+{
+	if (!collapsible(job))
+		return false;
+
+	int size = TaskPackedKey::packed_key_size(
+		job->packed_key(), job->table_definition()->key_format());
+	return barrier->match_collapse_key(job->packed_key(), size);
+}
+
+/*
+ * 队头的读请求已经把数据填充到cache，紧随其后的同key读请求会直接命中，
+ * 不需要逐个排队，一次性全部下发。合并执行的请求只有读，相互之间
+ * 不影响一致性；排在后面的写请求等它们全部返回后再执行。
+ */
+void BarrierAskAnswerChain::collapse_reads(BarrierQueue *barrier,
+					   DTCJobOperation *head)
+{
+	if (head->result_code() < 0 || !collapsible(head))
+		return;
+
+	int size = TaskPackedKey::packed_key_size(
+		head->packed_key(), head->table_definition()->key_format());
+	if (barrier->set_collapse_key(head->packed_key(), size) != 0)
+		return;
+
+	DTCJobOperation *next;
+	while ((next = barrier->Front()) != NULL &&
+	       match_collapse(barrier, next)) {
+		barrier->Pop();
+		barrier->collapsed_++;
+		stat_barrier_collapsed++;
+		queue_request(next);
+	}
+}
+
+void BarrierAskAnswerChain::release_barrier(BarrierQueue *barrier)
+{
+	if (barrier->collapsed_ > 0)
+		return;
+
+	DTCJobOperation *next = barrier->Front();
+	if (next == NULL) {
+		attach_free_barrier(barrier);
+	} else {
+		queue_request(next);
+	}
+}
+
 void BarrierAskAnswerChain::job_ask_procedure(DTCJobOperation *job_operation)
 {
 	log4cplus_debug("enter job_ask_procedure");
@@ -115,7 +178,13 @@ void BarrierAskAnswerChain::job_ask_procedure(DTCJobOperation *job_operation)
 	BarrierQueue *barrier = get_barrier(key);
 
 	if (barrier) {
-		if (barrier->Count() < max_key_count_) {
+		if (barrier->collapsed_ > 0 && barrier->queue_empty() &&
+		    match_collapse(barrier, job_operation)) {
+			// 同key的读请求正在合并执行，直接加入
+			barrier->collapsed_++;
+			stat_barrier_collapsed++;
+			chain_request(job_operation);
+		} else if (barrier->Count() < max_key_count_) {
 			barrier->Push(job_operation);
 			if (barrier->Count() >
 			    stat_barrier_max_task) //max key number
@@ -172,12 +241,12 @@ void BarrierAskAnswerChain::job_answer_procedure(DTCJobOperation *job_operation)
 		if (barrier->Count() == stat_barrier_max_task) //max key number
 			stat_barrier_max_task--;
 		barrier->Pop();
-		DTCJobOperation *next = barrier->Front();
-		if (next == NULL) {
-			attach_free_barrier(barrier);
-		} else {
-			queue_request(next);
-		}
+		collapse_reads(barrier, job_operation);
+		release_barrier(barrier);
+	} else if (barrier->collapsed_ > 0) {
+		// 合并执行的读请求返回
+		barrier->collapsed_--;
+		release_barrier(barrier);
 	} else {
 		log4cplus_error("return job not barrier header, key=%lu", key);
 	}
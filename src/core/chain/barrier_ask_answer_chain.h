@@ -88,15 +88,23 @@ class BarrierAskAnswerChain : public JobAskInterface<DTCJobOperation>,
 	{
 		return key % BARRIER_HASH_MAX;
 	}
+	/* 可以合并执行的读请求 */
+	bool collapsible(DTCJobOperation *job);
+	bool match_collapse(BarrierQueue *barrier, DTCJobOperation *job);
+	void collapse_reads(BarrierQueue *barrier, DTCJobOperation *head);
+	void release_barrier(BarrierQueue *barrier);
 
     private:
 	int max_key_count_;
+	// 队头读请求完成后，合并执行紧随其后的同key读请求
+	bool collapse_read_;
 
 	ChainJoint<DTCJobOperation> main_chain;
 
 	//stat
 	StatCounter stat_barrier_count;
 	StatCounter stat_barrier_max_task;
+	StatCounter stat_barrier_collapsed;
 };
 
 #endif
@@ -24,10 +24,13 @@
 #include "packet/packet.h"
 #include "log/log.h"
 #include "buffer_process_ask_chain.h"
+#include "table/lru_sync_batch.h"
 #include "buffer_flush.h"
 #include "mysql_error.h"
 #include "sys_malloc.h"
 #include "data_chunk.h"
+#include "data_connector_ask_chain.h"
+#include "algorithm/timestamp.h"
 #include "raw_data_process.h"
 #include "key/key_route_ask_chain.h"
 #include "buffer_remoteLog.h"
@@ -54,8 +57,7 @@ inline int BufferProcessAskChain::transaction_find_node(DTCJobOperation &job)
 	log4cplus_debug("transaction_find_node entry.");
 	// alreay cleared/zero-ed
 	key = job.packed_key();
-	if (empty_node_filter_ != NULL &&
-	    empty_node_filter_->ISSET(job.int_key())) {
+	if (empty_filter_isset(job)) {
 		//Cache.cache_purge(key);
 		cache_transaction_node = Node();
 		return node_status = DTC_CODE_NODE_EMPTY;
@@ -101,6 +103,44 @@ inline int BufferProcessAskChain::transaction_find_node(DTCJobOperation &job)
 	return node_status = DTC_CODE_NODE_HIT;
 }
 
+inline int BufferProcessAskChain::empty_filter_isset(DTCJobOperation &job)
+{
+	int ret = 0;
+	if (empty_node_filter_ != NULL)
+		ret = empty_node_filter_->ISSET(job.int_key());
+	else if (empty_key_filter_ != NULL)
+		ret = empty_key_filter_->ISSET(job.packed_key());
+	if (ret)
+		stat_empty_filter_hits_++;
+	return ret;
+}
+
+inline int BufferProcessAskChain::empty_filter_set(DTCJobOperation &job)
+{
+	int ret = 0;
+	if (empty_node_filter_ != NULL) {
+		empty_node_filter_->SET(job.int_key());
+	} else if (empty_key_filter_ != NULL) {
+		ret = empty_key_filter_->SET(job.packed_key());
+		if (ret != 0) {
+			log4cplus_debug("%s", empty_key_filter_->error());
+			stat_empty_filter_full_++;
+		}
+		stat_empty_filter_keys_ = empty_key_filter_->key_count();
+	}
+	return ret;
+}
+
+inline void BufferProcessAskChain::empty_filter_clr(DTCJobOperation &job)
+{
+	if (empty_node_filter_ != NULL) {
+		empty_node_filter_->CLR(job.int_key());
+	} else if (empty_key_filter_ != NULL) {
+		empty_key_filter_->CLR(job.packed_key());
+		stat_empty_filter_keys_ = empty_key_filter_->key_count();
+	}
+}
+
 inline void BufferProcessAskChain::transaction_update_lru(bool async, int level)
 {
 	if (!key_dirty) {
@@ -286,14 +326,16 @@ BufferProcessAskChain::BufferProcessAskChain(PollerBase *p,
 	  flush_reply_(this), flush_timer_(NULL),
 	  current_pend_flush_request_(0), pend_flush_request_(0),
 	  max_flush_request_(1), marker_interval_(300), min_dirty_time_(3600),
-	  max_dirty_time_(43200),
+	  max_dirty_time_(43200), adaptive_flush_(0),
+	  flush_queue_source_(NULL),
 
-	  empty_node_filter_(NULL),
+	  empty_node_filter_(NULL), empty_key_filter_(NULL),
 	  // Hot Backup
 	  log_hotbackup_key_switch_(false), hotbackup_lru_feature_(NULL),
 	  // Hot Backup
 	  // BlackList
-	  black_list_(0), blacklist_timer_(0)
+	  black_list_(0), blacklist_timer_(0), cold_compress_(NULL),
+	  admission_filter_(NULL)
 
 // BlackList
 {
@@ -324,22 +366,61 @@ BufferProcessAskChain::BufferProcessAskChain(PollerBase *p,
 		g_stat_mgr.get_stat_int_counter(DTC_OLDEST_DIRTY_TIME);
 	stat_asyncflush_count_ =
 		g_stat_mgr.get_stat_int_counter(DTC_ASYNC_FLUSH_COUNT);
+	stat_flush_budget_ = g_stat_mgr.get_stat_int_counter(DTC_FLUSH_BUDGET);
+	stat_flush_queue_ = g_stat_mgr.get_stat_int_counter(DTC_FLUSH_QUEUE);
+	stat_flush_latency_ =
+		g_stat_mgr.get_stat_int_counter(DTC_FLUSH_LATENCY);
+	stat_flush_errors_ = g_stat_mgr.get_stat_int_counter(DTC_FLUSH_ERRORS);
 
 	stat_expire_count_ =
 		g_stat_mgr.get_stat_int_counter(DTC_KEY_EXPIRE_USER_COUNT);
 	stat_buffer_process_expire_count_ =
 		g_stat_mgr.get_stat_int_counter(CACHE_EXPIRE_REQ);
 
+	stat_empty_filter_hits_ =
+		g_stat_mgr.get_stat_int_counter(DTC_EMPTY_FILTER_HITS);
+	stat_empty_filter_keys_ =
+		g_stat_mgr.get_stat_int_counter(DTC_EMPTY_FILTER_KEYS);
+	stat_empty_filter_full_ =
+		g_stat_mgr.get_stat_int_counter(DTC_EMPTY_FILTER_FULL);
+
+	stat_admission_admitted_ =
+		g_stat_mgr.get_stat_int_counter(DTC_ADMISSION_ADMITTED);
+	stat_admission_rejected_ =
+		g_stat_mgr.get_stat_int_counter(DTC_ADMISSION_REJECTED);
+
 	max_expire_count_ =
 		g_dtc_config->get_int_val("cache", "max_expire_count_", 100);
 	max_expire_time_ = g_dtc_config->get_int_val(
 		"cache", "max_expire_time_", 3600 * 24 * 30);
+
+	cold_compress_enable_ =
+		g_dtc_config->get_int_val("cache", "ColdCompressEnable", 0);
+	cold_compress_ratio_ =
+		g_dtc_config->get_int_val("cache", "ColdCompressRatio", 50);
+	cold_compress_scan_nodes_ =
+		g_dtc_config->get_int_val("cache", "ColdCompressScanNodes", 1000);
+	cold_compress_min_saved_ =
+		g_dtc_config->get_int_val("cache", "ColdCompressMinSaved", 64);
+	cold_compress_level_ =
+		g_dtc_config->get_int_val("cache", "ColdCompressLevel", 1);
+
+	admission_filter_width_ =
+		g_dtc_config->get_int_val("cache", "AdmissionFilterWidth", 0);
+	purge_look_ahead_ =
+		g_dtc_config->get_int_val("cache", "PurgeLookAhead", 0);
 }
 
 BufferProcessAskChain::~BufferProcessAskChain()
 {
 	if (empty_node_filter_ != NULL)
 		delete empty_node_filter_;
+	if (empty_key_filter_ != NULL)
+		delete empty_key_filter_;
+	if (cold_compress_ != NULL)
+		delete cold_compress_;
+	if (admission_filter_ != NULL)
+		delete admission_filter_;
 }
 
 int BufferProcessAskChain::set_insert_order(int o)
@@ -425,6 +506,12 @@ int BufferProcessAskChain::open_init_buffer(int key_name,
 		enable_auto_clean_dirty_buffer ? 1 : 0;
 	cache_info_.force_update_table_conf =
 		g_dtc_config->get_int_val("cache", "ForceUpdateTableConf", 0);
+	cache_info_.empty_key_filter_size = g_dtc_config->get_size_val(
+		"cache", "EmptyKeyFilterSize", 0, 'M');
+	const char *fp_rate =
+		g_dtc_config->get_str_val("cache", "EmptyKeyFilterFPRate");
+	cache_info_.empty_key_filter_fp_rate =
+		fp_rate ? strtod(fp_rate, NULL) : DF_EKF_FP_RATE;
 
 	log4cplus_debug(
 		"cache_info: \n\tshmkey[%d] \n\tshmsize[" UINT64FMT
@@ -498,6 +585,25 @@ int BufferProcessAskChain::open_init_buffer(int key_name,
 			return -1;
 		}
 	}
+	pstFeature = cache_.query_feature_by_id(EMPTY_KEY_FILTER);
+	if (pstFeature != NULL && empty_node_filter_ == NULL) {
+		NEW(EmptyKeyFilter, empty_key_filter_);
+		if (empty_key_filter_ == NULL) {
+			log4cplus_error("new %s error: %m", "EmptyKeyFilter");
+			return -1;
+		}
+		if (empty_key_filter_->do_attach(pstFeature->fi_handle) != 0) {
+			log4cplus_error("EmptyKeyFilter attach error: %s",
+					empty_key_filter_->error());
+			return -1;
+		}
+		stat_empty_filter_keys_ = empty_key_filter_->key_count();
+		log4cplus_info("Empty-Key Filter enabled, capacity %llu keys",
+			       (unsigned long long)empty_key_filter_->capacity());
+	} else if (cache_info_.empty_key_filter_size > 0) {
+		log4cplus_warning("Empty-Key Filter not found in shm, "
+				  "recreate shm to enable it");
+	}
 	MallocBase *pstMalloc = PtMalloc::instance();
 	UpdateMode stUpdateMod = { async_server_, update_mode_, insert_mode_,
 				   insert_order_ };
@@ -581,6 +687,46 @@ int BufferProcessAskChain::open_init_buffer(int key_name,
 			return -1;
 		}
 	}
+	// 冷节点压缩，只支持平板数据
+	if (cold_compress_enable_) {
+		if (table_define_infomation_->index_fields() > 0) {
+			log4cplus_warning(
+				"tree index table do not support cold compress");
+		} else {
+			RawDataProcess *pstRaw = (RawDataProcess *)data_process_;
+			pstRaw->set_compress_level(cold_compress_level_);
+			NEW(ColdNodeCompressor(
+				    owner->get_timer_list_by_m_seconds(
+					    1000 /* 1s */),
+				    &cache_, pstRaw, cold_compress_ratio_,
+				    cold_compress_scan_nodes_,
+				    cold_compress_min_saved_),
+			    cold_compress_);
+			if (cold_compress_ == NULL) {
+				log4cplus_error("init cold node compress failed");
+				return -1;
+			}
+			cold_compress_->start_cold_compress_task();
+		}
+	}
+	// 缺失回填的TinyLFU准入，无DB模式没有回填
+	if (admission_filter_width_ > 0 && full_mode_ == false) {
+		NEW(AdmissionFilter, admission_filter_);
+		if (admission_filter_ == NULL ||
+		    admission_filter_->init(admission_filter_width_,
+					    cache_info_.key_size) != 0) {
+			log4cplus_error("init admission filter failed");
+			return -1;
+		}
+		cache_.set_admission_filter(admission_filter_);
+		log4cplus_info("admission filter enabled, width %u",
+			       admission_filter_->width());
+	}
+	if (purge_look_ahead_ > 0) {
+		cache_.set_purge_look_ahead(purge_look_ahead_);
+		log4cplus_info("purge look-ahead enabled, window %d",
+			       purge_look_ahead_);
+	}
 	// Empty Node list
 	if (full_mode_ == true) {
 		// nodb Mode has not empty nodes,
@@ -637,8 +783,7 @@ BufferResult BufferProcessAskChain::insert_default_row(DTCJobOperation &job)
 				      "alloc cache node error");
 			return DTC_CODE_BUFFER_ERROR;
 		}
-		if (empty_node_filter_)
-			empty_node_filter_->CLR(job.int_key());
+		empty_filter_clr(job);
 	} else {
 		uint32_t uiTotalRows =
 			((DataChunk *)(PtMalloc::instance()->handle_to_ptr(
@@ -693,6 +838,8 @@ BufferResult BufferProcessAskChain::buffer_get_data(DTCJobOperation &job)
 
 	log4cplus_debug("buffer_get_data start ");
 	transaction_find_node(job);
+	if (admission_filter_ != NULL)
+		admission_filter_->touch(key);
 	switch (node_status) {
 	case DTC_CODE_NODE_NOTFOUND:
 		if (full_mode_ == false) {
@@ -759,6 +906,8 @@ BufferResult BufferProcessAskChain::buffer_batch_get_data(DTCJobOperation &job)
 		++stat_get_count_;
 		job.set_result_hit_flag(HIT_INIT);
 		transaction_find_node(job);
+		if (admission_filter_ != NULL)
+			admission_filter_->touch(key);
 		switch (node_status) {
 		case DTC_CODE_NODE_EMPTY:
 			++stat_get_hits_;
@@ -823,6 +972,18 @@ BufferResult BufferProcessAskChain::buffer_get_rb(DTCJobOperation &job)
 	return DTC_CODE_BUFFER_SUCCESS;
 }
 
+inline void BufferProcessAskChain::admission_finish(DTCJobOperation &job)
+{
+	int ret = cache_.admission_end();
+	if (ret > 0) {
+		++stat_admission_admitted_;
+	} else if (ret < 0) {
+		++stat_admission_rejected_;
+		// 不是因为数据太大而放弃，不能加入黑名单
+		job.pop_black_list_size();
+	}
+}
+
 // helper执行GET回来后，更新内存数据
 BufferResult BufferProcessAskChain::buffer_replace_result(DTCJobOperation &job)
 {
@@ -834,24 +995,33 @@ BufferResult BufferProcessAskChain::buffer_replace_result(DTCJobOperation &job)
 	// 数据库回来的记录如果是0行则
 	// 1. 设置bits
 	// 2. 直接构造0行的result响应包
-	if (empty_node_filter_ != NULL) {
+	if (empty_node_filter_ != NULL || empty_key_filter_ != NULL) {
 		if ((job.result == NULL || job.result->total_rows() == 0)) {
 			log4cplus_debug("SET Empty-Node[%u]", job.int_key());
-			empty_node_filter_->SET(job.int_key());
-			cache_.cache_purge(key);
-			return DTC_CODE_BUFFER_SUCCESS;
+			if (empty_filter_set(job) == 0) {
+				cache_.cache_purge(key);
+				return DTC_CODE_BUFFER_SUCCESS;
+			}
+			// 过滤器已满，按没有过滤器时的方式缓存空节点
 		} else {
-			empty_node_filter_->CLR(job.int_key());
+			empty_filter_clr(job);
 		}
 	}
-	if (!cache_transaction_node) {
-		if (insert_empty_node() == false)
+	// 新key需要淘汰其他节点时先做准入判断，被拒绝则只返回结果不进cache
+	bool admitting = !cache_transaction_node;
+	if (admitting) {
+		cache_.admission_begin(key);
+		if (insert_empty_node() == false) {
+			admission_finish(job);
 			return DTC_CODE_BUFFER_SUCCESS;
+		}
 	} else {
 		oldRows = cache_.node_rows_count(cache_transaction_node);
 	}
 	unsigned int uiNodeID = cache_transaction_node.node_id();
 	iRet = data_process_->do_replace_all(job, &cache_transaction_node);
+	if (admitting)
+		admission_finish(job);
 	if (iRet != 0 || cache_transaction_node.vd_handle() == INVALID_HANDLE) {
 		if (dtc_mode_ == DTC_MODE_CACHE_ONLY) {
 			// UNREACHABLE
@@ -1088,7 +1258,7 @@ BufferResult BufferProcessAskChain::buffer_purge_data(DTCJobOperation &job)
 	transaction_find_node(job);
 	switch (node_status) {
 	case DTC_CODE_NODE_EMPTY:
-		empty_node_filter_->CLR(job.int_key());
+		empty_filter_clr(job);
 		return DTC_CODE_BUFFER_SUCCESS;
 
 	case DTC_CODE_NODE_NOTFOUND:
@@ -1271,8 +1441,7 @@ BufferResult BufferProcessAskChain::buffer_insert_row(DTCJobOperation &job,
 			cache_.purge_node_and_data(key, cache_transaction_node);
 			return DTC_CODE_BUFFER_ERROR;
 		}
-		if (empty_node_filter_)
-			empty_node_filter_->CLR(job.int_key());
+		empty_filter_clr(job);
 	}
 	int oldRows = cache_.node_rows_count(cache_transaction_node);
 	iRet = data_process_->do_append(job, &cache_transaction_node, log_rows,
@@ -1348,8 +1517,7 @@ BufferResult BufferProcessAskChain::buffer_delete_rows(DTCJobOperation &job)
 				data_process_->get_increase_dirty_row_count());
 		}
 		cache_.purge_node_and_data(key, cache_transaction_node);
-		if (empty_node_filter_)
-			empty_node_filter_->SET(job.int_key());
+		empty_filter_set(job);
 		// Hot Backup
 		Node stEmpytNode;
 		if (write_hotbackup_log(job, stEmpytNode,
@@ -2514,6 +2682,13 @@ void BufferProcessAskChain::set_flush_parameter(int intvl, int mreq,
 	}
 }
 
+void BufferProcessAskChain::set_flush_rate_control(int enable, int queue_limit)
+{
+	adaptive_flush_ = enable;
+	flush_rate_.set_limit(max_flush_request_, queue_limit);
+	stat_flush_budget_ = flush_rate_.budget();
+}
+
 int BufferProcessAskChain::commit_flush_request(DTCFlushRequest *req,
 						DTCJobOperation *callbackTask)
 {
@@ -2530,6 +2705,8 @@ int BufferProcessAskChain::commit_flush_request(DTCFlushRequest *req,
 
 void BufferProcessAskChain::complete_flush_request(DTCFlushRequest *req)
 {
+	flush_rate_.complete(GET_TIMESTAMP() - req->startTime, req->badReq);
+	stat_flush_errors_ += req->badReq;
 	delete req;
 	current_pend_flush_request_--;
 	stat_currentFlush_request_ = current_pend_flush_request_;
@@ -2593,7 +2770,8 @@ int BufferProcessAskChain::oldest_dirty_node_alarm()
 	}
 }
 
-/*flush speed(nFlushReq) only depend on oldest dirty node existing time*/
+/*flush speed(nFlushReq) depend on oldest dirty node existing time,
+ *and limited by flush budget from DB feedback if adaptive flush enabled*/
 void BufferProcessAskChain::calculate_flush_speed(int is_flush_timer)
 {
 	delete_tail_time_markers();
@@ -2623,8 +2801,13 @@ void BufferProcessAskChain::calculate_flush_speed(int is_flush_timer)
 				"oldest dirty node exist time > max dirty time");
 		}
 	} else if (v >= min_dirty_time_) {
-		m = 1 + (v - min_dirty_time_) * (max_flush_request_ - 1) /
-				(max_dirty_time_ - min_dirty_time_);
+		/* 受DB反馈控制时直接用预算，DB空闲时尽快回写 */
+		if (adaptive_flush_)
+			m = max_flush_request_;
+		else
+			m = 1 + (v - min_dirty_time_) *
+					(max_flush_request_ - 1) /
+					(max_dirty_time_ - min_dirty_time_);
 		if (m > pend_flush_request_)
 			pend_flush_request_ = m;
 	} else {
@@ -2635,6 +2818,21 @@ __stat:
 	if (pend_flush_request_ > max_flush_request_)
 		pend_flush_request_ = max_flush_request_;
 
+	if (adaptive_flush_) {
+		/* 每个flush timer周期调整一次预算 */
+		if (is_flush_timer) {
+			int queue = flush_queue_source_ ?
+					    flush_queue_source_->commit_queue_count() :
+					    0;
+			flush_rate_.adjust(queue, current_pend_flush_request_);
+			stat_flush_queue_ = queue;
+			stat_flush_latency_ = flush_rate_.last_latency();
+			stat_flush_budget_ = flush_rate_.budget();
+		}
+		if (pend_flush_request_ > flush_rate_.budget())
+			pend_flush_request_ = flush_rate_.budget();
+	}
+
 	stat_maxflush_request_ = pend_flush_request_;
 	stat_oldestdirty_time_ = v;
 }
@@ -2783,6 +2981,9 @@ BufferResult BufferProcessAskChain::buffer_process_admin(DTCJobOperation &Job)
 	case DRequest::SystemCommand::AdjustLRU:
 		return buffer_adjust_lru(Job);
 
+	case DRequest::SystemCommand::AdjustLRUBatch:
+		return buffer_adjust_lru_batch(Job);
+
 	case DRequest::SystemCommand::VerifyHBT:
 		return buffer_verify_hbt(Job);
 
@@ -3369,8 +3570,12 @@ BufferProcessAskChain::buffer_replace_raw_data(DTCJobOperation &Job)
 	log4cplus_debug("value[len: %d]", stRow[3].bin.len);
 
 	//调整备机的空节点过滤
-	if (stRow[1].u64 & DTCHotBackup::EMPTY_NODE && empty_node_filter_) {
-		empty_node_filter_->SET(*(unsigned int *)(key->bin.ptr));
+	if (stRow[1].u64 & DTCHotBackup::EMPTY_NODE) {
+		if (empty_node_filter_)
+			empty_node_filter_->SET(
+				*(unsigned int *)(key->bin.ptr));
+		else if (empty_key_filter_)
+			empty_key_filter_->SET(key->bin.ptr);
 	}
 
 	//key在master不存在, 或者是空节点，purge cache.
@@ -3522,6 +3727,53 @@ BufferResult BufferProcessAskChain::buffer_adjust_lru(DTCJobOperation &Job)
 	return DTC_CODE_BUFFER_SUCCESS;
 }
 
+/*
+ * 每个条件值是主机一次扫描合并的LruSyncBatch，批量调整LRU，
+ * 不存在的key跳过，不像单key的AdjustLRU那样整个请求失败
+ */
+BufferResult
+BufferProcessAskChain::buffer_adjust_lru_batch(DTCJobOperation &Job)
+{
+	const DTCFieldValue *condition = Job.request_condition();
+	const DTCValue *batch;
+	LruSyncBatchReader reader;
+	const char *packed_key;
+	int ret, count;
+
+	log4cplus_debug("buffer_adjust_lru_batch start ");
+
+	for (int i = 0; condition != NULL && i < condition->num_fields();
+	     i++) {
+		batch = condition->field_value(i);
+		if (reader.Attach(batch->bin.ptr, batch->bin.len,
+				  table_define_infomation_->key_format()) < 0) {
+			Job.set_error(-EC_BAD_RAW_DATA, CACHE_SVC,
+				      "bad lru sync batch");
+			return DTC_CODE_BUFFER_ERROR;
+		}
+
+		count = 0;
+		while ((ret = reader.Next(packed_key)) > 0) {
+			Node stNode =
+				cache_.cache_find_auto_chose_hash(packed_key);
+			if (!stNode)
+				continue;
+			cache_.remove_from_lru(stNode);
+			cache_.insert_to_clean_lru(stNode);
+			count++;
+		}
+		if (ret < 0) {
+			Job.set_error(-EC_BAD_RAW_DATA, CACHE_SVC,
+				      "bad lru sync batch");
+			return DTC_CODE_BUFFER_ERROR;
+		}
+		log4cplus_debug("adjust lru batch, keys %d, relinked %d",
+				reader.Count(), count);
+	}
+
+	return DTC_CODE_BUFFER_SUCCESS;
+}
+
 BufferResult BufferProcessAskChain::buffer_verify_hbt(DTCJobOperation &Job)
 {
 	log4cplus_debug("buffer_verify_hbt start ");
@@ -3663,21 +3915,25 @@ BufferProcessAskChain::buffer_nodehandlechange(DTCJobOperation &Job)
 		return DTC_CODE_BUFFER_ERROR;
 	}
 
-	node_raw_data.do_attach(node_handle,
-				table_define_infomation_->key_fields() - 1,
-				table_define_infomation_->key_format());
+	/* 压缩过的冷节点按原样搬迁，不需要解压 */
+	if (M_POINTER(DataChunk, node_handle)->is_compressed()) {
+		buff_len = M_POINTER(DataChunk, node_handle)->node_size();
+	} else {
+		node_raw_data.do_attach(
+			node_handle, table_define_infomation_->key_fields() - 1,
+			table_define_infomation_->key_format());
+		buff_len = node_raw_data.data_size();
+	}
 
-	if ((private_buff = (char *)MALLOC(node_raw_data.data_size())) ==
-	    NULL) {
+	if ((private_buff = (char *)MALLOC(buff_len)) == NULL) {
 		log4cplus_error("no mem");
 		Job.set_error(-ENOMEM, CACHE_SVC, "malloc error");
 		return DTC_CODE_BUFFER_ERROR;
 	}
 
-	memcpy(private_buff, node_raw_data.get_addr(),
-	       node_raw_data.data_size());
-	buff_len = node_raw_data.data_size();
-	if (node_raw_data.destory()) {
+	memcpy(private_buff, PtMalloc::instance()->handle_to_ptr(node_handle),
+	       buff_len);
+	if (PtMalloc::instance()->Free(node_handle)) {
 		log4cplus_error("node raw data detroy error");
 		Job.set_error(-ENOMEM, CACHE_SVC, "free error");
 		FREE_IF(private_buff);
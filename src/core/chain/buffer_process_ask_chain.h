@@ -35,6 +35,7 @@
 #include "stat_dtc.h"
 #include "data_process.h"
 #include "empty_filter.h"
+#include "empty_key_filter.h"
 #include "namespace.h"
 #include "task_pendlist.h"
 #include "data_chunk.h"
@@ -43,12 +44,15 @@
 #include "hb_feature.h"
 #include "blacklist/blacklist_unit.h"
 #include "expire_time.h"
+#include "cold_node_compressor.h"
 #include "buffer_process_answer_chain.h"
+#include "flush_rate_controller.h"
 
 DTC_BEGIN_NAMESPACE
 
 class DTCFlushRequest;
 class BufferProcessAskChain;
+class DataConnectorAskChain;
 class DTCTableDefinition;
 class TaskPendingList;
 enum BufferResult {
@@ -186,6 +190,18 @@ class BufferProcessAskChain : public JobAskInterface<DTCJobOperation>,
 	int max_expire_count_;
 	int max_expire_time_;
 
+	// cold node compress
+	int cold_compress_enable_;
+	int cold_compress_ratio_;
+	int cold_compress_scan_nodes_;
+	int cold_compress_min_saved_;
+	int cold_compress_level_;
+
+	// TinyLFU admission, 0 = disabled
+	int admission_filter_width_;
+	// size-aware victim look-ahead in try_purge_size, 0 = first fit
+	int purge_look_ahead_;
+
     protected:
 	// stat subsystem
 	StatCounter stat_get_count_;
@@ -208,10 +224,21 @@ class BufferProcessAskChain : public JobAskInterface<DTCJobOperation>,
 	StatCounter stat_currentFlush_request_;
 	StatCounter stat_oldestdirty_time_;
 	StatCounter stat_asyncflush_count_;
+	StatCounter stat_flush_budget_;
+	StatCounter stat_flush_queue_;
+	StatCounter stat_flush_latency_;
+	StatCounter stat_flush_errors_;
 
 	StatCounter stat_expire_count_;
 	StatCounter stat_buffer_process_expire_count_;
 
+	StatCounter stat_empty_filter_hits_;
+	StatCounter stat_empty_filter_keys_;
+	StatCounter stat_empty_filter_full_;
+
+	StatCounter stat_admission_admitted_;
+	StatCounter stat_admission_rejected_;
+
     protected:
 	// async flush members
 	FlushReplyNotify flush_reply_;
@@ -225,10 +252,16 @@ class BufferProcessAskChain : public JobAskInterface<DTCJobOperation>,
 	volatile unsigned short marker_interval_;
 	volatile int min_dirty_time_;
 	volatile int max_dirty_time_;
+	// flush budget from DB feedback
+	int adaptive_flush_;
+	FlushRateController flush_rate_;
+	DataConnectorAskChain *flush_queue_source_;
 	// async log writer
 	int async_log_;
 	// empty node filter.
 	EmptyNodeFilter *empty_node_filter_;
+	// empty key filter, for any key type.
+	EmptyKeyFilter *empty_key_filter_;
 	// Hot Backup
 	// record update key.
 	bool log_hotbackup_key_switch_;
@@ -240,6 +273,8 @@ class BufferProcessAskChain : public JobAskInterface<DTCJobOperation>,
 	// BlackList
 	ExpireTime *key_expire;
 	TimerList *key_expire_timer_;
+	ColdNodeCompressor *cold_compress_;
+	AdmissionFilter *admission_filter_;
 	HotBackReplay hotback_reply_;
 
     private:
@@ -252,6 +287,7 @@ class BufferProcessAskChain : public JobAskInterface<DTCJobOperation>,
 	BufferResult buffer_replace_result(DTCJobOperation &job);
 	// GET response, DB --> client
 	BufferResult buffer_get_rb(DTCJobOperation &job);
+	void admission_finish(DTCJobOperation &job);
 
 	// implementation some admin/purge/flush function
 	BufferResult buffer_process_admin(DTCJobOperation &job);
@@ -307,6 +343,7 @@ class BufferProcessAskChain : public JobAskInterface<DTCJobOperation>,
 	BufferResult buffer_get_raw_data(DTCJobOperation &job);
 	BufferResult buffer_replace_raw_data(DTCJobOperation &job);
 	BufferResult buffer_adjust_lru(DTCJobOperation &job);
+	BufferResult buffer_adjust_lru_batch(DTCJobOperation &job);
 	BufferResult buffer_verify_hbt(DTCJobOperation &job);
 	BufferResult buffer_get_hbt(DTCJobOperation &job);
 
@@ -483,6 +520,12 @@ class BufferProcessAskChain : public JobAskInterface<DTCJobOperation>,
 
 	// flush api
 	void set_flush_parameter(int, int, int, int);
+	/* 按DB的反馈(队列、时延、错误)调整flush并发，需在set_flush_parameter之后调用 */
+	void set_flush_rate_control(int enable, int queue_limit);
+	void set_flush_queue_source(DataConnectorAskChain *src)
+	{
+		flush_queue_source_ = src;
+	}
 	void set_drop_count(int); // to be remove
 	int commit_flush_request(DTCFlushRequest *, DTCJobOperation *);
 	void complete_flush_request(DTCFlushRequest *);
@@ -511,6 +554,10 @@ class BufferProcessAskChain : public JobAskInterface<DTCJobOperation>,
 	}
 	void transaction_end(void);
 	inline int transaction_find_node(DTCJobOperation &job);
+	// empty node/key filter
+	inline int empty_filter_isset(DTCJobOperation &job);
+	inline int empty_filter_set(DTCJobOperation &job);
+	inline void empty_filter_clr(DTCJobOperation &job);
 	inline void transaction_update_lru(bool async, int type);
 	void dispatch_hot_back_task(DTCJobOperation *job)
 	{
@@ -26,6 +26,37 @@ class DataChunk {
 	unsigned char data_type_; // 数据chunk的类型
 
     public:
+	/* 去掉table index(0x80)及压缩(0x40)标记后判断是否平板数据 */
+	bool is_raw() const
+	{
+		return (data_type_ & TREE_DATA_TYPE_MASK) == DATA_TYPE_RAW;
+	}
+
+	/* 平板数据的行数据是否已被压缩 */
+	bool is_compressed() const
+	{
+		return is_raw() && (data_type_ & RAW_COMPRESSED_FLAG);
+	}
+
+	/* 压缩节点相比解压后节省的字节数 */
+	unsigned int compressed_saved_size(int iKeySize)
+	{
+		if (!is_compressed())
+			return 0;
+		uint32_t plain_size =
+			*(uint32_t *)((char *)this + data_size(iKeySize));
+		return plain_size - node_size();
+	}
+
+	/* 压缩节点里所有行的最大lastcmod，压缩时记录 */
+	uint32_t compressed_lastcmod(int iKeySize)
+	{
+		if (!is_compressed())
+			return 0;
+		return *(uint32_t *)((char *)this + data_size(iKeySize) +
+				     sizeof(uint32_t));
+	}
+
 	/*************************************************
 	  Description:	计算基本结构大小
 	  Input:		
@@ -34,7 +65,7 @@ class DataChunk {
 	*************************************************/
 	ALLOC_SIZE_T base_size()
 	{
-		if (data_type_ == DATA_TYPE_RAW)
+		if (is_raw())
 			return (sizeof(RawFormat));
 		else
 			return (sizeof(RootData));
@@ -61,10 +92,11 @@ class DataChunk {
 	*************************************************/
 	const char *key() const
 	{
-		if ((data_type_ & 0x7f) == DATA_TYPE_RAW) {
+		if (is_raw()) {
 			RawFormat *pstRaw = (RawFormat *)this;
 			return pstRaw->p_key_;
-		} else if ((data_type_ & 0x7f) == DATA_TYPE_TREE_ROOT) {
+		} else if ((data_type_ & TREE_DATA_TYPE_MASK) ==
+			   DATA_TYPE_TREE_ROOT) {
 			RootData *pstRoot = (RootData *)this;
 			return pstRoot->p_key_;
 		}
@@ -79,10 +111,11 @@ class DataChunk {
 	*************************************************/
 	char *key()
 	{
-		if ((data_type_ & 0x7f) == DATA_TYPE_RAW) {
+		if (is_raw()) {
 			RawFormat *pstRaw = (RawFormat *)this;
 			return pstRaw->p_key_;
-		} else if ((data_type_ & 0x7f) == DATA_TYPE_TREE_ROOT) {
+		} else if ((data_type_ & TREE_DATA_TYPE_MASK) ==
+			   DATA_TYPE_TREE_ROOT) {
 			RootData *pstRoot = (RootData *)this;
 			return pstRoot->p_key_;
 		}
@@ -99,7 +132,7 @@ class DataChunk {
 #define SET_KEY_FUNC(type, key)                                                \
 	void set_key(type key)                                                 \
 	{                                                                      \
-		if (data_type_ == DATA_TYPE_RAW) {                             \
+		if (is_raw()) {                                                \
 			RawFormat *pstRaw = (RawFormat *)this;                 \
 			*(type *)(void *)pstRaw->p_key_ = key;                 \
 		} else {                                                       \
@@ -122,7 +155,7 @@ class DataChunk {
 	*************************************************/
 	void set_key(const char *pchKey, int iLen)
 	{
-		if (data_type_ == DATA_TYPE_RAW) {
+		if (is_raw()) {
 			RawFormat *pstRaw = (RawFormat *)this;
 			*(unsigned char *)pstRaw->p_key_ = iLen;
 			memcpy(pstRaw->p_key_ + 1, pchKey, iLen);
@@ -141,7 +174,7 @@ class DataChunk {
 	*************************************************/
 	void set_key(const char *pchKey)
 	{
-		if (data_type_ == DATA_TYPE_RAW) {
+		if (is_raw()) {
 			RawFormat *pstRaw = (RawFormat *)this;
 			memcpy(pstRaw->p_key_, pchKey,
 			       *(unsigned char *)pchKey);
@@ -160,7 +193,7 @@ class DataChunk {
 	*************************************************/
 	int str_key_size()
 	{
-		if (data_type_ == DATA_TYPE_RAW) {
+		if (is_raw()) {
 			RawFormat *pstRaw = (RawFormat *)this;
 			return *(unsigned char *)pstRaw->p_key_;
 		} else {
@@ -182,7 +215,7 @@ class DataChunk {
 
 	unsigned int head_size()
 	{
-		if (data_type_ == DATA_TYPE_RAW)
+		if (is_raw())
 			return sizeof(RawFormat);
 		else
 			return sizeof(RootData);
@@ -202,7 +235,7 @@ class DataChunk {
 
 	unsigned int node_size()
 	{
-		if (data_type_ == DATA_TYPE_RAW) {
+		if (is_raw()) {
 			RawFormat *pstRaw = (RawFormat *)this;
 			return pstRaw->data_size_;
 		} else {
@@ -212,7 +245,7 @@ class DataChunk {
 
 	unsigned int create_time()
 	{
-		if (data_type_ == DATA_TYPE_RAW) {
+		if (is_raw()) {
 			RawFormat *pstRaw = (RawFormat *)this;
 			return pstRaw->create_time_;
 		} else {
@@ -221,7 +254,7 @@ class DataChunk {
 	}
 	unsigned last_access_time()
 	{
-		if (data_type_ == DATA_TYPE_RAW) {
+		if (is_raw()) {
 			RawFormat *pstRaw = (RawFormat *)this;
 			return pstRaw->latest_request_time_;
 		} else {
@@ -230,7 +263,7 @@ class DataChunk {
 	}
 	unsigned int last_update_time()
 	{
-		if (data_type_ == DATA_TYPE_RAW) {
+		if (is_raw()) {
 			RawFormat *pstRaw = (RawFormat *)this;
 			return pstRaw->latest_update_time_;
 		} else {
@@ -240,7 +273,7 @@ class DataChunk {
 
 	uint32_t total_rows()
 	{
-		if (data_type_ == DATA_TYPE_RAW) {
+		if (is_raw()) {
 			RawFormat *pstRaw = (RawFormat *)this;
 			return pstRaw->row_count_;
 		} else {
@@ -258,9 +291,10 @@ class DataChunk {
 	int destory(MallocBase *pstMalloc)
 	{
 		MEM_HANDLE_T hHandle = pstMalloc->ptr_to_handle(this);
-		if (data_type_ == DATA_TYPE_RAW) {
+		if (is_raw()) {
 			return pstMalloc->Free(hHandle);
-		} else if (data_type_ == DATA_TYPE_TREE_ROOT) {
+		} else if ((data_type_ & TREE_DATA_TYPE_MASK) ==
+			   DATA_TYPE_TREE_ROOT) {
 			TreeData stTree(pstMalloc);
 			int iRet = stTree.do_attach(hHandle);
 			if (iRet != 0) {
@@ -276,9 +310,10 @@ class DataChunk {
 	{
 		MEM_HANDLE_T hHandle = pstMalloc->ptr_to_handle(this);
 
-		if (data_type_ == DATA_TYPE_RAW) {
+		if (is_raw()) {
 			return pstMalloc->ask_for_destroy_size(hHandle);
-		} else if (data_type_ == DATA_TYPE_TREE_ROOT) {
+		} else if ((data_type_ & TREE_DATA_TYPE_MASK) ==
+			   DATA_TYPE_TREE_ROOT) {
 			TreeData stTree(pstMalloc);
 			if (stTree.do_attach(hHandle))
 				return 0;
@@ -264,6 +264,8 @@ static int single_thread_mode_initiazation()
 				->register_next_chain(
 					g_black_hole_ask_instance);
 		} else if (g_datasource_mode == DTC_MODE_DATABASE_ADDITION) {
+			g_buffer_process_ask_instance->set_flush_queue_source(
+				g_data_connector_ask_instance);
 			if (g_buffer_process_ask_instance->update_mode() ||
 			    g_buffer_process_ask_instance->is_mem_dirty()) {
 				g_connector_barrier_instance =
@@ -422,6 +424,8 @@ static int multiple_thread_mode_initiazation()
 				->register_next_chain(
 					g_black_hole_ask_instance);
 		} else if (g_datasource_mode == DTC_MODE_DATABASE_ADDITION) {
+			g_buffer_process_ask_instance->set_flush_queue_source(
+				g_data_connector_ask_instance);
 			if (g_buffer_process_ask_instance->update_mode() ||
 			    g_buffer_process_ask_instance->is_mem_dirty()) {
 				g_connector_barrier_instance =
@@ -31,6 +31,7 @@ enum feature_id {
 	EMPTY_FILTER,
 	HOT_BACKUP,
 	COL_EXPAND,
+	EMPTY_KEY_FILTER,
 };
 typedef enum feature_id FEATURE_ID_T;
 
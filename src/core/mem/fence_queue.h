@@ -17,6 +17,8 @@
 #ifndef __BARRIER_QUEUE_H__
 #define __BARRIER_QUEUE_H__
 
+#include <stdlib.h>
+#include <string.h>
 #include <list/list.h>
 #include <queue/lqueue.h>
 
@@ -30,10 +32,15 @@ class BarrierQueue : public ListObject<BarrierQueue>,
 	friend class BarrierAskAnswerChain;
 
 	inline BarrierQueue(LinkQueue<DTCJobOperation *>::allocator *a = NULL)
-		: LinkQueue<DTCJobOperation *>(a), key_(0)
+		: LinkQueue<DTCJobOperation *>(a), key_(0), collapsed_(0),
+		  collapse_key_(NULL), collapse_key_size_(0),
+		  collapse_key_cap_(0)
 	{
 	}
-	inline ~BarrierQueue(){};
+	inline ~BarrierQueue()
+	{
+		free(collapse_key_);
+	}
 
 	inline unsigned long key() const
 	{
@@ -44,8 +51,36 @@ class BarrierQueue : public ListObject<BarrierQueue>,
 		key_ = k;
 	}
 
+	/* 合并执行中的读请求个数 */
+	inline int collapsed() const
+	{
+		return collapsed_;
+	}
+	inline int set_collapse_key(const char *k, int size)
+	{
+		if (size > collapse_key_cap_) {
+			char *p = (char *)realloc(collapse_key_, size);
+			if (p == NULL)
+				return -1;
+			collapse_key_ = p;
+			collapse_key_cap_ = size;
+		}
+		memcpy(collapse_key_, k, size);
+		collapse_key_size_ = size;
+		return 0;
+	}
+	inline bool match_collapse_key(const char *k, int size) const
+	{
+		return size == collapse_key_size_ &&
+		       memcmp(collapse_key_, k, size) == 0;
+	}
+
     private:
 	unsigned long key_;
+	int collapsed_;
+	char *collapse_key_;
+	int collapse_key_size_;
+	int collapse_key_cap_;
 };
 
 #endif
@@ -302,6 +302,11 @@ int init_buffer_process_ask_chain_thread()
 						  3600),
 			g_dtc_config->get_int_val("cache", "MaxDirtyTime",
 						  43200));
+		g_buffer_process_ask_instance->set_flush_rate_control(
+			g_dtc_config->get_int_val("cache", "AdaptiveFlushSpeed",
+						  0),
+			g_dtc_config->get_int_val("cache", "FlushQueueLimit",
+						  FRC_DEFAULT_QUEUE_LIMIT));
 
 		g_buffer_process_ask_instance->set_drop_count(
 			g_dtc_config->get_int_val("cache", "MaxDropCount",
@@ -543,6 +548,11 @@ int init_buffer_process_ask_chain(PollerBase *thread)
 						  3600),
 			g_dtc_config->get_int_val("cache", "MaxDirtyTime",
 						  43200));
+		g_buffer_process_ask_instance->set_flush_rate_control(
+			g_dtc_config->get_int_val("cache", "AdaptiveFlushSpeed",
+						  0),
+			g_dtc_config->get_int_val("cache", "FlushQueueLimit",
+						  FRC_DEFAULT_QUEUE_LIMIT));
 
 		g_buffer_process_ask_instance->set_drop_count(
 			g_dtc_config->get_int_val("cache", "MaxDropCount",
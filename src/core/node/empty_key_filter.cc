@@ -0,0 +1,296 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "pt_malloc.h"
+#include "empty_key_filter.h"
+
+/* FNV-1a + murmur3 fmix64，key较短时也能得到分布均匀的64位hash */
+static inline uint64_t ekf_hash(const char *key, uint32_t len)
+{
+	uint64_t h = 0xcbf29ce484222325ULL;
+	for (uint32_t i = 0; i < len; i++) {
+		h ^= (unsigned char)key[i];
+		h *= 0x100000001b3ULL;
+	}
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
+EmptyKeyFilter::EmptyKeyFilter() : _ekf(0), _table(0)
+{
+	memset(errmsg_, 0x0, sizeof(errmsg_));
+}
+
+EmptyKeyFilter::~EmptyKeyFilter()
+{
+}
+
+int EmptyKeyFilter::fingerprint_bits(double fpRate)
+{
+	if (fpRate <= 0 || fpRate >= 1)
+		fpRate = DF_EKF_FP_RATE;
+
+	/* 每个key查找两个桶，误判率约为 2 * EKF_BUCKET_SLOTS / 2^bits */
+	double bits = ceil(log2(2.0 * EKF_BUCKET_SLOTS / fpRate));
+	if (bits <= 8)
+		return 8;
+	if (bits <= 16)
+		return 16;
+	return 32;
+}
+
+void EmptyKeyFilter::hash_key(const char *key, uint32_t &index, uint32_t &fp)
+{
+	//变长key的前一个字节编码的是key的长度
+	uint32_t size = _ekf->ekf_fixedsize ? _ekf->ekf_fixedsize :
+					      *(unsigned char *)key + 1;
+	uint64_t h = ekf_hash(key, size);
+
+	index = (uint32_t)h & (_ekf->ekf_buckets - 1);
+	fp = (uint32_t)(h >> 32);
+	if (_ekf->ekf_fp_bits < 32)
+		fp &= (1U << _ekf->ekf_fp_bits) - 1;
+	/* 0 表示空槽 */
+	if (fp == 0)
+		fp = 1;
+}
+
+uint32_t EmptyKeyFilter::get_slot(uint32_t index, int slot)
+{
+	/* 桶个数可达2^31，偏移用64位计算 */
+	uint64_t off = (uint64_t)index * EKF_BUCKET_SLOTS + slot;
+
+	switch (_ekf->ekf_fp_bits) {
+	case 8:
+		return ((uint8_t *)_table)[off];
+	case 16:
+		return ((uint16_t *)_table)[off];
+	default:
+		return ((uint32_t *)_table)[off];
+	}
+}
+
+void EmptyKeyFilter::set_slot(uint32_t index, int slot, uint32_t fp)
+{
+	uint64_t off = (uint64_t)index * EKF_BUCKET_SLOTS + slot;
+
+	switch (_ekf->ekf_fp_bits) {
+	case 8:
+		((uint8_t *)_table)[off] = fp;
+		break;
+	case 16:
+		((uint16_t *)_table)[off] = fp;
+		break;
+	default:
+		((uint32_t *)_table)[off] = fp;
+		break;
+	}
+}
+
+bool EmptyKeyFilter::bucket_contain(uint32_t index, uint32_t fp)
+{
+	for (int i = 0; i < EKF_BUCKET_SLOTS; i++)
+		if (get_slot(index, i) == fp)
+			return true;
+	return false;
+}
+
+bool EmptyKeyFilter::bucket_insert(uint32_t index, uint32_t fp)
+{
+	for (int i = 0; i < EKF_BUCKET_SLOTS; i++) {
+		if (get_slot(index, i) == 0) {
+			set_slot(index, i, fp);
+			_ekf->ekf_count++;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool EmptyKeyFilter::bucket_delete(uint32_t index, uint32_t fp)
+{
+	for (int i = 0; i < EKF_BUCKET_SLOTS; i++) {
+		if (get_slot(index, i) == fp) {
+			set_slot(index, i, 0);
+			_ekf->ekf_count--;
+			return true;
+		}
+	}
+	return false;
+}
+
+int EmptyKeyFilter::do_insert(uint32_t index, uint32_t fp)
+{
+	if (bucket_insert(index, fp))
+		return 0;
+
+	index = alt_index(index, fp);
+	if (bucket_insert(index, fp))
+		return 0;
+
+	/* 两个桶都满了，随机踢出一个指纹到它的另一个桶 */
+	for (int n = 0; n < EKF_MAX_KICKS; n++) {
+		int slot = random() % EKF_BUCKET_SLOTS;
+		uint32_t old = get_slot(index, slot);
+		set_slot(index, slot, fp);
+		fp = old;
+
+		index = alt_index(index, fp);
+		if (bucket_insert(index, fp))
+			return 0;
+	}
+
+	/* 最后一个被踢出的指纹暂存在victim中，保证不丢失已有的key */
+	_ekf->ekf_has_victim = 1;
+	_ekf->ekf_victim_fp = fp;
+	_ekf->ekf_victim_index = index;
+	return 0;
+}
+
+int EmptyKeyFilter::ISSET(const char *key)
+{
+	uint32_t index, fp;
+	hash_key(key, index, fp);
+
+	if (bucket_contain(index, fp) ||
+	    bucket_contain(alt_index(index, fp), fp))
+		return 1;
+
+	if (_ekf->ekf_has_victim && _ekf->ekf_victim_fp == fp &&
+	    (_ekf->ekf_victim_index == index ||
+	     _ekf->ekf_victim_index == alt_index(index, fp)))
+		return 1;
+
+	return 0;
+}
+
+int EmptyKeyFilter::SET(const char *key)
+{
+	if (ISSET(key))
+		return 0;
+
+	uint32_t index, fp;
+	hash_key(key, index, fp);
+	if (bucket_insert(index, fp) ||
+	    bucket_insert(alt_index(index, fp), fp))
+		return 0;
+
+	/* victim被占用说明过滤器已满，不再踢出 */
+	if (_ekf->ekf_has_victim) {
+		snprintf(errmsg_, sizeof(errmsg_),
+			 "Empty-Key Filter full, %u keys", key_count());
+		return -1;
+	}
+
+	return do_insert(index, fp);
+}
+
+void EmptyKeyFilter::CLR(const char *key)
+{
+	uint32_t index, fp;
+	hash_key(key, index, fp);
+	uint32_t index2 = alt_index(index, fp);
+
+	if (bucket_delete(index, fp) || bucket_delete(index2, fp)) {
+		/* 腾出了空位，尝试把victim放回表中 */
+		if (_ekf->ekf_has_victim) {
+			_ekf->ekf_has_victim = 0;
+			do_insert(_ekf->ekf_victim_index,
+				  _ekf->ekf_victim_fp);
+		}
+		return;
+	}
+
+	if (_ekf->ekf_has_victim && _ekf->ekf_victim_fp == fp &&
+	    (_ekf->ekf_victim_index == index ||
+	     _ekf->ekf_victim_index == index2))
+		_ekf->ekf_has_victim = 0;
+}
+
+int EmptyKeyFilter::do_init(uint64_t size, double fpRate, uint32_t fixedsize)
+{
+	int bits = fingerprint_bits(fpRate);
+	uint64_t bucket_size = EKF_BUCKET_SLOTS * bits / 8;
+
+	/* 桶个数取不超过内存预算的最大2的幂 */
+	uint64_t buckets = 1;
+	while (buckets * 2 * bucket_size <= size && buckets < (1ULL << 31))
+		buckets *= 2;
+	if (buckets * bucket_size > size) {
+		snprintf(errmsg_, sizeof(errmsg_),
+			 "Empty-Key Filter size %lu too small",
+			 (unsigned long)size);
+		return -1;
+	}
+
+	MEM_HANDLE_T v = M_CALLOC(sizeof(EKF_T));
+	if (INVALID_HANDLE == v) {
+		snprintf(errmsg_, sizeof(errmsg_),
+			 "calloc %u bytes mem failed, %s",
+			 (unsigned)sizeof(EKF_T), M_ERROR());
+		return -1;
+	}
+
+	MEM_HANDLE_T t = M_CALLOC(buckets * bucket_size);
+	if (INVALID_HANDLE == t) {
+		snprintf(errmsg_, sizeof(errmsg_),
+			 "calloc %lu bytes mem failed, %s",
+			 (unsigned long)(buckets * bucket_size), M_ERROR());
+		M_FREE(v);
+		return -1;
+	}
+
+	_ekf = M_POINTER(EKF_T, v);
+	_ekf->ekf_buckets = buckets;
+	_ekf->ekf_count = 0;
+	_ekf->ekf_fixedsize = fixedsize;
+	_ekf->ekf_fp_bits = bits;
+	_ekf->ekf_has_victim = 0;
+	_ekf->ekf_table = t;
+	_table = M_POINTER(char, t);
+
+	return 0;
+}
+
+int EmptyKeyFilter::do_attach(MEM_HANDLE_T v)
+{
+	if (INVALID_HANDLE == v) {
+		snprintf(errmsg_, sizeof(errmsg_),
+			 "attach Empty-Key Filter failed, memory handle = 0");
+		return -1;
+	}
+
+	_ekf = M_POINTER(EKF_T, v);
+	_table = M_POINTER(char, _ekf->ekf_table);
+	return 0;
+}
+
+int EmptyKeyFilter::do_detach(void)
+{
+	_ekf = 0;
+	_table = 0;
+	errmsg_[0] = 0;
+
+	return 0;
+}
@@ -0,0 +1,118 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef __DTC_EMPTY_KEY_FILTER_H
+#define __DTC_EMPTY_KEY_FILTER_H
+
+#include "namespace.h"
+#include "algorithm/singleton.h"
+#include "global.h"
+
+DTC_BEGIN_NAMESPACE
+
+#define DF_EKF_FP_RATE 0.000001 /* 默认误判率 */
+#define EKF_BUCKET_SLOTS 4 /* 每个桶的指纹个数 */
+#define EKF_MAX_KICKS 500 /* 插入时最多踢出次数 */
+
+/*
+ * 空key过滤器(cuckoo filter)，按packed key的hash保存指纹，
+ * 适用于任意类型的key，支持删除。
+ * 误判(指纹冲突)会把存在的key当成空key，因此误判率需要配置得足够小；
+ * 漏判只会导致请求穿透到数据源，没有正确性问题。
+ */
+struct _empty_key_filter {
+	uint32_t ekf_buckets; // 桶个数，2的幂
+	uint32_t ekf_count; // 当前保存的指纹个数
+	uint16_t ekf_fixedsize; // key大小：变长key时为0
+	uint8_t ekf_fp_bits; // 指纹位数：8/16/32
+	uint8_t ekf_has_victim; // 踢出失败时暂存的指纹
+	uint32_t ekf_victim_fp;
+	uint32_t ekf_victim_index;
+	MEM_HANDLE_T ekf_table; // 指纹表
+};
+typedef struct _empty_key_filter EKF_T;
+
+class EmptyKeyFilter {
+    public:
+	/* 成功返回0，过滤器已满返回-1 */
+	int SET(const char *key);
+	void CLR(const char *key);
+	int ISSET(const char *key);
+
+    public:
+	/*
+	 * size:	指纹表占用的内存(byte)
+	 * fpRate:	期望的误判率，决定指纹位数
+	 * fixedsize:	key大小，变长key为0
+	 */
+	int do_init(uint64_t size, double fpRate, uint32_t fixedsize);
+	int do_attach(MEM_HANDLE_T);
+	int do_detach(void);
+
+	/* 根据误判率计算指纹位数 */
+	static int fingerprint_bits(double fpRate);
+
+    public:
+	EmptyKeyFilter();
+	~EmptyKeyFilter();
+	static EmptyKeyFilter *instance()
+	{
+		return Singleton<EmptyKeyFilter>::instance();
+	}
+	static void destory()
+	{
+		Singleton<EmptyKeyFilter>::destory();
+	}
+	const char *error() const
+	{
+		return errmsg_;
+	}
+	const MEM_HANDLE_T get_handle() const
+	{
+		return M_HANDLE(_ekf);
+	}
+	uint32_t key_count() const
+	{
+		return _ekf->ekf_count + _ekf->ekf_has_victim;
+	}
+	uint64_t capacity() const
+	{
+		return (uint64_t)_ekf->ekf_buckets * EKF_BUCKET_SLOTS;
+	}
+
+    private:
+	void hash_key(const char *key, uint32_t &index, uint32_t &fp);
+	uint32_t alt_index(uint32_t index, uint32_t fp)
+	{
+		/* murmur2常量，保证两个候选桶可以互相推出 */
+		return (index ^ (fp * 0x5bd1e995)) & (_ekf->ekf_buckets - 1);
+	}
+	uint32_t get_slot(uint32_t index, int slot);
+	void set_slot(uint32_t index, int slot, uint32_t fp);
+	bool bucket_contain(uint32_t index, uint32_t fp);
+	bool bucket_insert(uint32_t index, uint32_t fp);
+	bool bucket_delete(uint32_t index, uint32_t fp);
+	int do_insert(uint32_t index, uint32_t fp);
+
+    private:
+	EKF_T *_ekf;
+	char *_table;
+	char errmsg_[256];
+};
+
+DTC_END_NAMESPACE
+
+#endif
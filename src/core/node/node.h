@@ -188,6 +188,15 @@ class Node {
 	friend struct node_set;
 };
 
+inline Node NodeIndex::do_search(NODE_ID_T id)
+{
+	uint32_t ng = NG_OFFSET(id);
+	if (likely(ng < _flatSize && _flat[ng] != NULL))
+		return Node(_flat[ng], OFFSET3(id));
+
+	return search_index(id);
+}
+
 DTC_END_NAMESPACE
 
 #endif
\ No newline at end of file
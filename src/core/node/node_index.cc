@@ -16,24 +16,21 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include "node_index.h"
 #include "algorithm/singleton.h"
 #include "node.h"
 
 DTC_USING_NAMESPACE
 
-NodeIndex::NodeIndex() : _firstIndex(NULL)
+NodeIndex::NodeIndex() : _firstIndex(NULL), _flat(NULL), _flatSize(0)
 {
 	memset(errmsg_, 0, sizeof(errmsg_));
 }
 
 NodeIndex::~NodeIndex()
 {
-}
-
-NodeIndex *NodeIndex::instance()
-{
-	return Singleton<NodeIndex>::instance();
+	release_flat();
 }
 
 void NodeIndex::destroy()
@@ -83,10 +80,14 @@ int NodeIndex::do_insert(Node node)
 	p->si_used++;
 	p->si_h[OFFSET2(id)] = M_HANDLE(node.Owner());
 
+	if (reserve_flat(NG_OFFSET(id)) == DTC_CODE_SUCCESS)
+		_flat[NG_OFFSET(id)] = node.Owner();
+
 	return DTC_CODE_SUCCESS;
 }
 
-Node NodeIndex::do_search(NODE_ID_T id)
+/* 进程内数组未命中时查共享内存中的三级索引 */
+Node NodeIndex::search_index(NODE_ID_T id)
 {
 	if (INVALID_NODE_ID == id)
 		return Node(NULL, 0);
@@ -105,9 +106,74 @@ Node NodeIndex::do_search(NODE_ID_T id)
 	if (index < 0 || index > 255)
 		return Node(NULL, 0);
 
+	/* 其他进程分配的node group，补到进程内数组中 */
+	if (reserve_flat(NG_OFFSET(id)) == DTC_CODE_SUCCESS)
+		_flat[NG_OFFSET(id)] = NS;
+
 	return Node(NS, index);
 }
 
+int NodeIndex::reserve_flat(uint32_t ng)
+{
+	if (ng < _flatSize)
+		return DTC_CODE_SUCCESS;
+	/* INVALID_NODE_ID所在的node group不能被缓存 */
+	if (ng >= MAX_NG_NUM - 1)
+		return DTC_CODE_FAILED;
+
+	uint32_t size = _flatSize ? _flatSize : 1024;
+	while (size <= ng)
+		size *= 2;
+	if (size > MAX_NG_NUM - 1)
+		size = MAX_NG_NUM - 1;
+
+	NODE_SET **p = (NODE_SET **)realloc(_flat, sizeof(NODE_SET *) * size);
+	if (NULL == p) {
+		log4cplus_error("realloc flat node index[%u] failed", size);
+		return DTC_CODE_FAILED;
+	}
+	memset(p + _flatSize, 0, sizeof(NODE_SET *) * (size - _flatSize));
+	_flat = p;
+	_flatSize = size;
+	return DTC_CODE_SUCCESS;
+}
+
+/* attach时从共享内存中的索引重建进程内数组 */
+int NodeIndex::rebuild_flat(void)
+{
+	release_flat();
+
+	for (uint32_t i = 0; i < (1UL << 8); ++i) {
+		if (INVALID_HANDLE == _firstIndex->fi_h[i])
+			continue;
+
+		SECOND_INDEX_T *p = M_POINTER(SECOND_INDEX_T, _firstIndex->fi_h[i]);
+		if (0 == p->si_used)
+			continue;
+
+		for (uint32_t j = 0; j < (1UL << 16); ++j) {
+			if (INVALID_HANDLE == p->si_h[j])
+				continue;
+
+			uint32_t ng = (i << 16) | j;
+			if (reserve_flat(ng) != DTC_CODE_SUCCESS)
+				return DTC_CODE_FAILED;
+			_flat[ng] = M_POINTER(NODE_SET, p->si_h[j]);
+		}
+	}
+
+	return DTC_CODE_SUCCESS;
+}
+
+void NodeIndex::release_flat(void)
+{
+	if (_flat) {
+		free(_flat);
+		_flat = NULL;
+	}
+	_flatSize = 0;
+}
+
 int NodeIndex::do_init(size_t mem_size)
 {
 	MEM_HANDLE_T v = M_CALLOC(INDEX_1_SIZE);
@@ -117,6 +183,7 @@ int NodeIndex::do_init(size_t mem_size)
 	}
 
 	_firstIndex = M_POINTER(FIRST_INDEX_T, v);
+	release_flat();
 
 	return pre_allocate_index(mem_size);
 }
@@ -129,11 +196,16 @@ int NodeIndex::do_attach(MEM_HANDLE_T handle)
 	}
 
 	_firstIndex = M_POINTER(FIRST_INDEX_T, handle);
+	if (rebuild_flat() != DTC_CODE_SUCCESS) {
+		/* 只影响查找速度，search_index会逐步补齐 */
+		log4cplus_error("rebuild flat node index failed");
+	}
 	return DTC_CODE_SUCCESS;
 }
 
 int NodeIndex::do_detach(void)
 {
 	_firstIndex = 0;
+	release_flat();
 	return DTC_CODE_SUCCESS;
 }
@@ -19,6 +19,8 @@
 
 #include "namespace.h"
 #include "global.h"
+#include "compiler.h"
+#include "algorithm/singleton.h"
 
 DTC_BEGIN_NAMESPACE
 
@@ -32,6 +34,8 @@ DTC_BEGIN_NAMESPACE
 #define OFFSET1(id) ((id) >> 24) //高8位，一级index
 #define OFFSET2(id) (((id)&0xFFFF00) >> 8) //中间16位，二级index
 #define OFFSET3(id) ((id)&0xFF) //低8位
+#define NG_OFFSET(id) ((id) >> 8) //高24位，即node group序号
+#define MAX_NG_NUM (1UL << 24)
 
 struct first_index {
 	uint32_t fi_used; //一级index使用个数
@@ -45,17 +49,28 @@ struct second_index {
 };
 typedef struct second_index SECOND_INDEX_T;
 
+/*
+ * NodeIndex在共享内存中是三级索引，每次查找需要两次handle到指针的转换。
+ * 这里在进程内另外维护一个按node group序号直接下标的NODE_SET*数组：
+ * attach时从共享内存重建，分配新node group时追加。node group不会被释放，
+ * 所以缓存的指针一直有效；数组中找不到时回退到共享内存索引并补齐。
+ */
 class Node;
+struct node_set;
 class NodeIndex {
     public:
 	NodeIndex();
 	~NodeIndex();
 
-	static NodeIndex *instance();
+	static NodeIndex *instance()
+	{
+		return Singleton<NodeIndex>::instance();
+	}
 	static void destroy();
 
 	int do_insert(Node);
-	Node do_search(NODE_ID_T id);
+	/* 定义在node.h中，需要Node的完整定义 */
+	inline Node do_search(NODE_ID_T id);
 
 	int pre_allocate_index(size_t size);
 
@@ -72,8 +87,16 @@ class NodeIndex {
 	int do_attach(MEM_HANDLE_T handle);
 	int do_detach(void);
 
+    private:
+	Node search_index(NODE_ID_T id);
+	int reserve_flat(uint32_t ng);
+	int rebuild_flat(void);
+	void release_flat(void);
+
     private:
 	FIRST_INDEX_T *_firstIndex;
+	struct node_set **_flat; // node group序号 -> NODE_SET*
+	uint32_t _flatSize;
 	char errmsg_[256];
 };
 
@@ -20,6 +20,7 @@
 
 #include "raw_data.h"
 #include "global.h"
+#include "table/row_codec.h"
 #include "algorithm/relative_hour_calculator.h"
 
 #ifndef likely
@@ -365,8 +366,30 @@ int RawData::strip_mem()
 	return (0);
 }
 
+/* 按codec类型写一个定长字段 */
+static inline void encode_fixed_field(char *p, int kind, const DTCValue *v)
+{
+	switch (kind) {
+	case RC_INT32:
+		*(int32_t *)p = v->s64;
+		break;
+	case RC_UINT32:
+		*(uint32_t *)p = v->u64;
+		break;
+	case RC_INT64:
+		*(int64_t *)p = v->s64;
+		break;
+	case RC_FLOAT:
+		*(float *)p = v->flt;
+		break;
+	case RC_DOUBLE:
+		*(double *)p = v->flt;
+		break;
+	}
+}
+
 int RawData::decode_row(RowValue &stRow, unsigned char &uchRowFlags,
-			int iDecodeFlag)
+			int iDecodeFlag, const uint8_t *pchFieldMask)
 {
 	if (unlikely(handle_ == INVALID_HANDLE || p_content_ == NULL)) {
 		snprintf(err_message_, sizeof(err_message_),
@@ -374,55 +397,69 @@ int RawData::decode_row(RowValue &stRow, unsigned char &uchRowFlags,
 		return (-1);
 	}
 
+	const DTCRowCodec *codec = stRow.table_definition()->row_codec();
+	if (unlikely(codec->start_field() != key_index_ + 1)) {
+		snprintf(err_message_, sizeof(err_message_),
+			 "row codec start field %d mismatch key index %d",
+			 codec->start_field(), key_index_);
+		return (-1);
+	}
+
 	ALLOC_SIZE_T uiOldOffset = offset_;
 	ALLOC_SIZE_T uiOldRowOffset = row_offset_;
+	int iLASegment = m_iLAId > 0 ? codec->field_segment(m_iLAId) : -1;
+	// 字段id由codec按表定义生成，不再逐个做field_value()的范围检查
+	DTCValue *pstValue = stRow.field_value(0);
 	m_uiLAOffset = 0;
 	row_offset_ = offset_;
 	GET_VALUE(uchRowFlags, unsigned char);
 
-	for (int j = key_index_ + 1; j <= stRow.num_fields();
-	     j++) //拷贝一行数据
-	{
-		if (stRow.table_definition()->is_discard(j))
-			continue;
-		if (j == m_iLAId)
-			m_uiLAOffset = offset_;
-		switch (stRow.field_type(j)) {
-		case DField::Signed:
-			if (unlikely(stRow.field_size(j) >
-				     (int)sizeof(int32_t))) {
-				GET_VALUE(stRow.field_value(j)->s64, int64_t);
-			} else {
-				GET_VALUE(stRow.field_value(j)->s64, int32_t);
-			}
-			break;
-
-		case DField::Unsigned:
-			if (unlikely(stRow.field_size(j) >
-				     (int)sizeof(uint32_t))) {
-				GET_VALUE(stRow.field_value(j)->u64, uint64_t);
-			} else {
-				GET_VALUE(stRow.field_value(j)->u64, uint32_t);
+	for (int s = 0; s < codec->num_segments(); s++) {
+		const RowCodecSegment &seg = codec->segment(s);
+		// 整段定长字段只检查一次边界
+		CHECK_SIZE(seg.fixed_size);
+		const char *p = p_content_ + offset_;
+		if (s == iLASegment)
+			m_uiLAOffset = offset_ + codec->field_offset(m_iLAId);
+
+		const RowCodecField *f = &codec->field(seg.first);
+		const RowCodecField *fend = f + seg.count;
+		for (; f < fend; f++) {
+			if (pchFieldMask && !FIELD_ISSET(f->id, pchFieldMask))
+				continue;
+			DTCValue *v = pstValue + f->id;
+			const char *q = p + f->offset;
+			switch (f->kind) {
+			case RC_INT32:
+				v->s64 = *(const int32_t *)q;
+				break;
+			case RC_UINT32:
+				v->u64 = *(const uint32_t *)q;
+				break;
+			case RC_INT64:
+				v->s64 = *(const int64_t *)q;
+				break;
+			case RC_FLOAT:
+				v->flt = *(const float *)q;
+				break;
+			case RC_DOUBLE:
+				v->flt = *(const double *)q;
+				break;
 			}
-			break;
+		}
+		offset_ += seg.fixed_size;
 
-		case DField::Float: //浮点数
-			if (likely(stRow.field_size(j) > (int)sizeof(float))) {
-				GET_VALUE(stRow.field_value(j)->flt, double);
-			} else {
-				GET_VALUE(stRow.field_value(j)->flt, float);
+		if (seg.var_id >= 0) {
+			int iLen;
+			GET_VALUE(iLen, int);
+			if (pchFieldMask == NULL ||
+			    FIELD_ISSET(seg.var_id, pchFieldMask)) {
+				DTCValue *v = pstValue + seg.var_id;
+				v->bin.len = iLen;
+				v->bin.ptr = p_content_ + offset_;
 			}
-			break;
-
-		case DField::String: //字符串
-		case DField::Binary: //二进制数据
-		default: {
-			GET_VALUE(stRow.field_value(j)->bin.len, int);
-			stRow.field_value(j)->bin.ptr = p_content_ + offset_;
-			SKIP_SIZE(stRow.field_value(j)->bin.len);
-			break;
+			SKIP_SIZE(iLen);
 		}
-		} //end of switch
 	}
 
 	if (unlikely(iDecodeFlag & PRE_DECODE_ROW)) {
@@ -620,39 +657,13 @@ ALLOC_SIZE_T RawData::calc_row_size(const RowValue &stRow, int keyIdx)
 {
 	if (keyIdx == -1)
 		log4cplus_error("RawData may not init yet...");
-	ALLOC_SIZE_T tSize = 1; // flag
-	for (int j = keyIdx + 1; j <= stRow.num_fields(); j++) //拷贝一行数据
-	{
-		if (stRow.table_definition()->is_discard(j))
-			continue;
-		switch (stRow.field_type(j)) {
-		case DField::Signed:
-		case DField::Unsigned:
-			tSize += unlikely(stRow.field_size(j) >
-					  (int)sizeof(int32_t)) ?
-					 sizeof(int64_t) :
-					 sizeof(int32_t);
-			break;
-
-		case DField::Float: //浮点数
-			tSize += likely(stRow.field_size(j) >
-					(int)sizeof(float)) ?
-					 sizeof(double) :
-					 sizeof(float);
-			break;
-
-		case DField::String: //字符串
-		case DField::Binary: //二进制数据
-		default: {
-			tSize += sizeof(int);
-			tSize += stRow.field_value(j)->bin.len;
-			break;
-		}
-		} //end of switch
+	const DTCRowCodec *codec = stRow.table_definition()->row_codec();
+	ALLOC_SIZE_T tSize = codec->fixed_row_size(); // flag + 定长字段
+	for (int s = 0; s < codec->num_segments(); s++) {
+		int id = codec->segment(s).var_id;
+		if (id >= 0)
+			tSize += sizeof(int) + stRow.field_value(id)->bin.len;
 	}
-	if (tSize < 2)
-		log4cplus_info("key_index_:%d, stRow.num_fields():%d tSize:%d",
-			       keyIdx, stRow.num_fields(), tSize);
 
 	return (tSize);
 }
@@ -662,8 +673,17 @@ int RawData::encode_row(const RowValue &stRow, unsigned char uchOp,
 {
 	int iRet;
 
+	const DTCRowCodec *codec = stRow.table_definition()->row_codec();
+	if (unlikely(codec->start_field() != key_index_ + 1)) {
+		snprintf(err_message_, sizeof(err_message_),
+			 "row codec start field %d mismatch key index %d",
+			 codec->start_field(), key_index_);
+		return (-1);
+	}
+
 	ALLOC_SIZE_T tSize;
 	tSize = calc_row_size(stRow, key_index_);
+	const DTCValue *pstValue = stRow.field_value(0);
 
 	if (unlikely(expendBuf)) {
 		iRet = expand_chunk(tSize);
@@ -673,43 +693,22 @@ int RawData::encode_row(const RowValue &stRow, unsigned char uchOp,
 
 	SET_VALUE(uchOp, unsigned char);
 
-	for (int j = key_index_ + 1; j <= stRow.num_fields();
-	     j++) //拷贝一行数据
-	{
-		if (stRow.table_definition()->is_discard(j))
-			continue;
-		const DTCValue *const v = stRow.field_value(j);
-		switch (stRow.field_type(j)) {
-		case DField::Signed:
-			if (unlikely(stRow.field_size(j) >
-				     (int)sizeof(int32_t)))
-				SET_VALUE(v->s64, int64_t);
-			else
-				SET_VALUE(v->s64, int32_t);
-			break;
-
-		case DField::Unsigned:
-			if (unlikely(stRow.field_size(j) >
-				     (int)sizeof(uint32_t)))
-				SET_VALUE(v->u64, uint64_t);
-			else
-				SET_VALUE(v->u64, uint32_t);
-			break;
+	for (int s = 0; s < codec->num_segments(); s++) {
+		const RowCodecSegment &seg = codec->segment(s);
+		CHECK_SIZE(seg.fixed_size);
+		char *p = p_content_ + offset_;
 
-		case DField::Float: //浮点数
-			if (likely(stRow.field_size(j) > (int)sizeof(float)))
-				SET_VALUE(v->flt, double);
-			else
-				SET_VALUE(v->flt, float);
-			break;
+		const RowCodecField *f = &codec->field(seg.first);
+		const RowCodecField *fend = f + seg.count;
+		for (; f < fend; f++)
+			encode_fixed_field(p + f->offset, f->kind,
+					   pstValue + f->id);
+		offset_ += seg.fixed_size;
 
-		case DField::String: //字符串
-		case DField::Binary: //二进制数据
-		default: {
+		if (seg.var_id >= 0) {
+			const DTCValue *const v = pstValue + seg.var_id;
 			SET_BIN_VALUE(v->bin.ptr, v->bin.len);
-			break;
 		}
-		} //end of switch
 	}
 
 	data_size_ += tSize;
@@ -825,39 +824,18 @@ int RawData::skip_row(const RowValue &stRow)
 
 	SKIP_SIZE(sizeof(unsigned char)); // flag
 
-	for (int j = key_index_ + 1; j <= stRow.num_fields();
-	     j++) //拷贝一行数据
 	{
-		//id: bug fix skip discard
-		if (stRow.table_definition()->is_discard(j))
-			continue;
-
-		switch (stRow.field_type(j)) {
-		case DField::Unsigned:
-		case DField::Signed:
-			if (stRow.field_size(j) > (int)sizeof(int32_t))
-				SKIP_SIZE(sizeof(int64_t));
-			else
-				SKIP_SIZE(sizeof(int32_t));
-			;
-			break;
-
-		case DField::Float: //浮点数
-			if (stRow.field_size(j) > (int)sizeof(float))
-				SKIP_SIZE(sizeof(double));
-			else
-				SKIP_SIZE(sizeof(float));
-			break;
-
-		case DField::String: //字符串
-		case DField::Binary: //二进制数据
-		default: {
-			int iLen;
-			GET_VALUE(iLen, int);
-			SKIP_SIZE(iLen);
-			break;
+		const DTCRowCodec *codec =
+			stRow.table_definition()->row_codec();
+		for (int s = 0; s < codec->num_segments(); s++) {
+			const RowCodecSegment &seg = codec->segment(s);
+			SKIP_SIZE(seg.fixed_size);
+			if (seg.var_id >= 0) {
+				int iLen;
+				GET_VALUE(iLen, int);
+				SKIP_SIZE(iLen);
+			}
 		}
-		} //end of switch
 	}
 
 	return (0);
@@ -978,6 +956,94 @@ ERROR_RET:
 	return (iRet);
 }
 
+int RawData::update_cur_row_inplace(const RowValue &stRow,
+				    const DTCFieldValue *pstUpdate,
+				    bool isDirty)
+{
+	if (unlikely(handle_ == INVALID_HANDLE || p_content_ == NULL)) {
+		snprintf(err_message_, sizeof(err_message_),
+			 "rawdata not init yet");
+		return (-1);
+	}
+	if (pstUpdate == NULL || pstUpdate->num_fields() == 0)
+		return (1);
+
+	const DTCTableDefinition *tdef = stRow.table_definition();
+	const DTCRowCodec *codec = tdef->row_codec();
+	if (codec->start_field() != key_index_ + 1)
+		return (1);
+
+	// update_timestamp改写的时间戳字段不在pstUpdate里，也要写回
+	const int aiTimeId[3] = { tdef->lastacc_field_id(),
+				  tdef->lastmod_field_id(),
+				  tdef->lastcmod_field_id() };
+
+	// 所有被更新的字段都是定长字段时行大小不变
+	int iLastSegment = -1;
+	for (int n = 0; n < pstUpdate->num_fields(); n++) {
+		int iSegment = codec->field_segment(pstUpdate->field_id(n));
+		if (iSegment < 0)
+			return (1);
+		if (iSegment > iLastSegment)
+			iLastSegment = iSegment;
+	}
+	for (int n = 0; n < 3; n++) {
+		if (aiTimeId[n] <= 0)
+			continue;
+		int iSegment = codec->field_segment(aiTimeId[n]);
+		if (iSegment < 0)
+			return (1);
+		if (iSegment > iLastSegment)
+			iLastSegment = iSegment;
+	}
+
+	ALLOC_SIZE_T uiOldOffset = offset_;
+	offset_ = row_offset_;
+	SKIP_SIZE(sizeof(unsigned char)); // flag
+
+	// 段的起始位置取决于前面变长字段的长度
+	for (int s = 0; s <= iLastSegment; s++) {
+		const RowCodecSegment &seg = codec->segment(s);
+		CHECK_SIZE(seg.fixed_size);
+		for (int n = 0; n < pstUpdate->num_fields(); n++) {
+			const int id = pstUpdate->field_id(n);
+			if (codec->field_segment(id) != s)
+				continue;
+			encode_fixed_field(p_content_ + offset_ +
+						   codec->field_offset(id),
+					   codec->field_kind(id),
+					   stRow.field_value(id));
+		}
+		for (int n = 0; n < 3; n++) {
+			const int id = aiTimeId[n];
+			if (id <= 0 || codec->field_segment(id) != s)
+				continue;
+			encode_fixed_field(p_content_ + offset_ +
+						   codec->field_offset(id),
+					   codec->field_kind(id),
+					   stRow.field_value(id));
+		}
+		offset_ += seg.fixed_size;
+
+		if (seg.var_id >= 0 && s < iLastSegment) {
+			int iLen;
+			GET_VALUE(iLen, int);
+			SKIP_SIZE(iLen);
+		}
+	}
+
+	if (isDirty)
+		*(unsigned char *)(p_content_ + row_offset_) = OPER_UPDATE;
+
+	offset_ = uiOldOffset;
+	return (0);
+
+ERROR_RET:
+	offset_ = uiOldOffset;
+	snprintf(err_message_, sizeof(err_message_), "update row error");
+	return (-100);
+}
+
 int RawData::delete_cur_row(const RowValue &stRow)
 {
 	int iRet = 0;
@@ -1177,3 +1243,131 @@ DTCTableDefinition *RawData::get_node_table_def()
 {
 	return table_definition_;
 }
+
+int RawData::compress_data(DTCCompress &compressor, ALLOC_SIZE_T min_saved)
+{
+	if (unlikely(handle_ == INVALID_HANDLE || p_content_ == NULL)) {
+		snprintf(err_message_, sizeof(err_message_),
+			 "rawdata not init yet");
+		return (-1);
+	}
+	if (data_size_ <= data_start_ + min_saved)
+		return 1;
+
+	ALLOC_SIZE_T rows_size = data_size_ - data_start_;
+	/* 解压前的最大lastcmod记在压缩头里，淘汰告警统计不用解压 */
+	uint32_t max_lastcmod = 0;
+	uint32_t row_lastcmod;
+	offset_ = data_start_;
+	for (unsigned int i = 0; i < row_count_; i++) {
+		if (get_lastcmod(row_lastcmod) != 0)
+			return (-1);
+		if (row_lastcmod > max_lastcmod)
+			max_lastcmod = row_lastcmod;
+	}
+
+	if (compressor.set_buffer_len(rows_size) != 0) {
+		snprintf(err_message_, sizeof(err_message_),
+			 "alloc compress buffer error");
+		return (-1);
+	}
+	/* 压缩结果比原数据还大时zlib会返回Z_BUF_ERROR，当作不值得压缩 */
+	if (compressor.compress(p_content_ + data_start_, rows_size) != 0)
+		return 1;
+
+	ALLOC_SIZE_T new_size =
+		data_start_ + 2 * sizeof(uint32_t) + compressor.get_len();
+	if (new_size + min_saved > data_size_)
+		return 1;
+
+	MEM_HANDLE_T hNew = mallocator_->Malloc(new_size);
+	if (hNew == INVALID_HANDLE) {
+		snprintf(err_message_, sizeof(err_message_), "malloc error");
+		need_new_bufer_size = new_size;
+		return (EC_NO_MEM);
+	}
+	char *p = reinterpret_cast<char *>(mallocator_->handle_to_ptr(hNew));
+	memcpy(p, p_content_, data_start_);
+	*(unsigned char *)p |= RAW_COMPRESSED_FLAG;
+	((RawFormat *)p)->data_size_ = new_size;
+	*(uint32_t *)(p + data_start_) = data_size_;
+	*(uint32_t *)(p + data_start_ + sizeof(uint32_t)) = max_lastcmod;
+	memcpy(p + data_start_ + 2 * sizeof(uint32_t), compressor.get_buf(),
+	       compressor.get_len());
+
+	mallocator_->Free(handle_);
+	handle_ = hNew;
+	size_ = mallocator_->chunk_size(handle_);
+	p_content_ = p;
+	data_size_ = new_size;
+	offset_ = data_start_;
+	row_offset_ = data_start_;
+
+	return (0);
+}
+
+int RawData::uncompress_data(const char *pchChunk, DTCCompress &compressor)
+{
+	const RawFormat *pstRaw = (const RawFormat *)pchChunk;
+	unsigned char uchType = pstRaw->data_type_;
+	if (unlikely(!is_compressed(pchChunk))) {
+		snprintf(err_message_, sizeof(err_message_),
+			 "chunk not compressed, data type: %u", uchType);
+		return (-1);
+	}
+
+	DTCTableDefinition *t =
+		TableDefinitionManager::instance()->get_table_def_by_idx(
+			(uchType >> 7) & 0x01);
+	if (t == NULL) {
+		snprintf(err_message_, sizeof(err_message_),
+			 "uncompress error, tabledef[NULL]");
+		return (-1);
+	}
+
+	int ks = t->key_format() != 0 ?
+			 t->key_format() :
+			 1 + *(const unsigned char *)pstRaw->p_key_;
+	ALLOC_SIZE_T start = sizeof(RawFormat) + ks;
+	if (unlikely(pstRaw->data_size_ < start + 2 * sizeof(uint32_t))) {
+		snprintf(err_message_, sizeof(err_message_),
+			 "compressed data size[%u] error", pstRaw->data_size_);
+		return (-2);
+	}
+	uint32_t plain_size = *(const uint32_t *)(pchChunk + start);
+	if (unlikely(plain_size < start)) {
+		snprintf(err_message_, sizeof(err_message_),
+			 "uncompressed data size[%u] error", plain_size);
+		return (-2);
+	}
+
+	MEM_HANDLE_T hNew = mallocator_->Malloc(plain_size);
+	if (hNew == INVALID_HANDLE) {
+		snprintf(err_message_, sizeof(err_message_), "malloc error");
+		need_new_bufer_size = plain_size;
+		return (EC_NO_MEM);
+	}
+	char *p = reinterpret_cast<char *>(mallocator_->handle_to_ptr(hNew));
+	memcpy(p, pchChunk, start);
+
+	unsigned long len = plain_size - start;
+	if (compressor.uncompress_to(
+		    p + start, &len, pchChunk + start + 2 * sizeof(uint32_t),
+		    pstRaw->data_size_ - start - 2 * sizeof(uint32_t)) != 0 ||
+	    len != plain_size - start) {
+		snprintf(err_message_, sizeof(err_message_), "%s",
+			 compressor.error_message());
+		mallocator_->Free(hNew);
+		return (-3);
+	}
+	*(unsigned char *)p = uchType & ~RAW_COMPRESSED_FLAG;
+	((RawFormat *)p)->data_size_ = plain_size;
+
+	int iRet = do_attach(hNew);
+	if (iRet != 0) {
+		mallocator_->Free(hNew);
+		handle_ = INVALID_HANDLE;
+		size_ = 0;
+	}
+	return iRet;
+}
@@ -23,9 +23,18 @@
 #include "data/col_expand.h"
 #include "table/table_def_manager.h"
 #include "node/node.h"
+#include "algorithm/compress.h"
 
 #define PRE_DECODE_ROW 1
 
+/*
+ * data_type_的0x40位：行数据已被压缩(冷节点压缩)。
+ * 压缩后的chunk格式：
+ * |RawFormat头|key|4字节:解压后的data_size|4字节:最大lastcmod|zlib数据|
+ * 头部的data_size_为压缩后的总大小，row_count_及时间戳保持不变。
+ */
+#define RAW_COMPRESSED_FLAG 0x40
+
 typedef enum _EnumDataType {
 	DATA_TYPE_RAW, // 平板数据结构
 	DATA_TYPE_TREE_ROOT, // 树的根节点
@@ -285,14 +294,15 @@ class RawData {
 
 	/*************************************************
 	  Description:	读取一行数据
-	  Input:		
+	  Input:		pchFieldMask	只解码mask中的字段(FIELD_SET)，NULL为全部字段
 	  Output:		stRow	保存行数据
 				uchRowFlags	行数据是否脏数据等flag
 				iDecodeFlag	是否只是pre-read，不fetch_row移动指针
 	  Return:		0为成功，非0失败
 	*************************************************/
 	int decode_row(RowValue &stRow, unsigned char &uchRowFlags,
-		       int iDecodeFlag = 0);
+		       int iDecodeFlag = 0,
+		       const uint8_t *pchFieldMask = NULL);
 
 	/*************************************************
 	  Description:	插入一行数据
@@ -336,6 +346,19 @@ class RawData {
 	*************************************************/
 	int replace_cur_row(const RowValue &stRow, bool isDirty);
 
+	/*************************************************
+	  Description:	只更新了定长字段时，原地改写当前行(decode_row之后)，
+				行大小不变，不重新分配内存也不移动后续行
+	  Input:		stRow	更新后的行数据，时间戳字段一并写回
+				pstUpdate	更新操作，只用到其中的字段id
+				isDirty	是否脏数据
+	  Output:		
+	  Return:		0为成功，1为包含变长字段等不能原地更新，<0失败
+	*************************************************/
+	int update_cur_row_inplace(const RowValue &stRow,
+				   const DTCFieldValue *pstUpdate,
+				   bool isDirty);
+
 	/*************************************************
 	  Description:	删除当前行
 	  Input:		stRow	仅使用row的字段类型等信息，不需要实际数据
@@ -459,6 +482,32 @@ class RawData {
 	void attach_time_stamp();
 
 	DTCTableDefinition *get_node_table_def();
+
+	/*************************************************
+	  Description:	压缩行数据，用新分配的chunk替换当前chunk
+	  Input:		compressor	压缩器
+				min_saved	至少节省的字节数，否则不压缩
+	  Output:		
+	  Return:		0为成功，1为不值得压缩，<0失败。
+				成功后只能使用get_handle()/data_size()，不能再读写行
+	*************************************************/
+	int compress_data(DTCCompress &compressor, ALLOC_SIZE_T min_saved);
+
+	/*************************************************
+	  Description:	把压缩过的chunk解压到本对象的mallocator新分配的chunk并attach，
+				原chunk不会被释放
+	  Input:		pchChunk	压缩过的chunk
+				compressor	压缩器
+	  Output:		
+	  Return:		0为成功，非0失败
+	*************************************************/
+	int uncompress_data(const char *pchChunk, DTCCompress &compressor);
+
+	static bool is_compressed(const char *pchChunk)
+	{
+		return (*(const unsigned char *)pchChunk & RAW_COMPRESSED_FLAG) !=
+		       0;
+	}
 };
 
 inline int RawData::key_size()
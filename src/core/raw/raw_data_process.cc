@@ -25,6 +25,7 @@
 #include "task/task_pkey.h"
 #include "buffer_flush.h"
 #include "algorithm/relative_hour_calculator.h"
+#include "algorithm/timestamp.h"
 
 DTC_USING_NAMESPACE
 
@@ -39,6 +40,17 @@ RawDataProcess::RawDataProcess(MallocBase *pstMalloc,
 	nodeSizeLimit = 0;
 	history_datasize = g_stat_mgr.get_sample(DATA_SIZE_HISTORY_STAT);
 	history_rowsize = g_stat_mgr.get_sample(ROW_SIZE_HISTORY_STAT);
+	stat_compress_nodes_ = g_stat_mgr.get_stat_int_counter(DTC_COMPRESS_NODES);
+	stat_compress_saved_ = g_stat_mgr.get_stat_int_counter(DTC_COMPRESS_SAVED);
+	stat_compress_time_ = g_stat_mgr.get_stat_int_counter(DTC_COMPRESS_TIME);
+	stat_uncompress_nodes_ =
+		g_stat_mgr.get_stat_int_counter(DTC_UNCOMPRESS_NODES);
+	stat_uncompress_time_ =
+		g_stat_mgr.get_stat_int_counter(DTC_UNCOMPRESS_TIME);
+	stat_update_inplace_ =
+		g_stat_mgr.get_stat_int_counter(DTC_UPDATE_INPLACE);
+	stat_update_rewrite_ =
+		g_stat_mgr.get_stat_int_counter(DTC_UPDATE_REWRITE);
 }
 
 RawDataProcess::~RawDataProcess()
@@ -70,10 +82,100 @@ int RawDataProcess::init_data(Node *p_node, RawData *affected_data,
 	return DTC_CODE_SUCCESS;
 }
 
+int RawDataProcess::inflate_data(Node *p_node)
+{
+	const char *pchChunk = (const char *)p_mallocator_->handle_to_ptr(
+		p_node->vd_handle());
+	if (!RawData::is_compressed(pchChunk))
+		return DTC_CODE_SUCCESS;
+
+	int64_t start = GET_TIMESTAMP();
+	RawData stPlain(p_mallocator_);
+	int iRet = stPlain.uncompress_data(pchChunk, compressor_);
+	if (iRet == EC_NO_MEM &&
+	    p_buffer_pond_->try_purge_size(stPlain.need_size(), *p_node) == 0)
+		iRet = stPlain.uncompress_data(pchChunk, compressor_);
+	if (iRet != DTC_CODE_SUCCESS) {
+		log4cplus_error("raw-data uncompress[handle:" UINT64FMT
+				"] error: %d,%s",
+				p_node->vd_handle(), iRet,
+				stPlain.get_err_msg());
+		return (-1);
+	}
+
+	stat_compress_saved_ -=
+		stPlain.data_size() - ((RawFormat *)pchChunk)->data_size_;
+	p_mallocator_->Free(p_node->vd_handle());
+	p_node->vd_handle() = stPlain.get_handle();
+	stat_uncompress_nodes_++;
+	stat_uncompress_time_ += GET_TIMESTAMP() - start;
+
+	return DTC_CODE_SUCCESS;
+}
+
+int RawDataProcess::uncompress_to_temp(Node *p_node, RawData *pstRows)
+{
+	int64_t start = GET_TIMESTAMP();
+	int iRet = pstRows->uncompress_data(
+		(const char *)p_mallocator_->handle_to_ptr(p_node->vd_handle()),
+		compressor_);
+	if (iRet != DTC_CODE_SUCCESS) {
+		log4cplus_error("raw-data uncompress[handle:" UINT64FMT
+				"] error: %d,%s",
+				p_node->vd_handle(), iRet,
+				pstRows->get_err_msg());
+		return (-1);
+	}
+	stat_uncompress_nodes_++;
+	stat_uncompress_time_ += GET_TIMESTAMP() - start;
+
+	return DTC_CODE_SUCCESS;
+}
+
+int RawDataProcess::compress_node(Node *p_node, ALLOC_SIZE_T min_saved)
+{
+	int iRet;
+
+	iRet = raw_data_.do_attach(p_node->vd_handle());
+	if (iRet != DTC_CODE_SUCCESS) {
+		/* 已经压缩过的节点attach会失败 */
+		const char *pchChunk = (const char *)
+			p_mallocator_->handle_to_ptr(p_node->vd_handle());
+		if (RawData::is_compressed(pchChunk))
+			return 1;
+		log4cplus_error("raw-data attach[handle:" UINT64FMT
+				"] error: %d,%s",
+				p_node->vd_handle(), iRet,
+				raw_data_.get_err_msg());
+		return (-1);
+	}
+
+	int64_t start = GET_TIMESTAMP();
+	uint32_t uiPlainSize = raw_data_.data_size();
+	iRet = raw_data_.compress_data(compressor_, min_saved);
+	stat_compress_time_ += GET_TIMESTAMP() - start;
+	if (iRet != DTC_CODE_SUCCESS) {
+		if (iRet < 0 && iRet != EC_NO_MEM)
+			log4cplus_error("raw-data compress error: %d,%s", iRet,
+					raw_data_.get_err_msg());
+		return iRet == EC_NO_MEM ? 1 : iRet;
+	}
+
+	p_node->vd_handle() = raw_data_.get_handle();
+	stat_compress_nodes_++;
+	stat_compress_saved_ += uiPlainSize - raw_data_.data_size();
+
+	return DTC_CODE_SUCCESS;
+}
+
 int RawDataProcess::attach_data(Node *p_node, RawData *affected_data)
 {
 	int iRet;
 
+	iRet = inflate_data(p_node);
+	if (iRet != DTC_CODE_SUCCESS)
+		return iRet;
+
 	iRet = raw_data_.do_attach(p_node->vd_handle());
 	if (iRet != DTC_CODE_SUCCESS) {
 		log4cplus_error("raw-data attach[handle:" UINT64FMT
@@ -102,6 +204,11 @@ int RawDataProcess::get_node_all_rows_count(Node *p_node, RawData *pstRows)
 	rows_count_ = 0;
 	dirty_rows_count_ = 0;
 
+	/* 全量同步等只读遍历，不在共享内存中解压 */
+	if (RawData::is_compressed((const char *)p_mallocator_->handle_to_ptr(
+		    p_node->vd_handle())))
+		return uncompress_to_temp(p_node, pstRows);
+
 	iRet = attach_data(p_node, pstRows);
 	if (iRet != DTC_CODE_SUCCESS) {
 		log4cplus_error("attach data error: %d", iRet);
@@ -211,6 +318,18 @@ int RawDataProcess::destroy_data(Node *p_node)
 {
 	int iRet;
 
+	const char *pchChunk = (const char *)p_mallocator_->handle_to_ptr(
+		p_node->vd_handle());
+	if (RawData::is_compressed(pchChunk)) {
+		DataChunk *pstChunk = (DataChunk *)pchChunk;
+		rows_count_ += 0LL - pstChunk->total_rows();
+		stat_compress_saved_ -=
+			pstChunk->compressed_saved_size(p_table_->key_format());
+		p_mallocator_->Free(p_node->vd_handle());
+		p_node->vd_handle() = INVALID_HANDLE;
+		return DTC_CODE_SUCCESS;
+	}
+
 	iRet = raw_data_.do_attach(p_node->vd_handle());
 	if (iRet != DTC_CODE_SUCCESS) {
 		log4cplus_error("raw-data attach error: %d,%s", iRet,
@@ -282,6 +401,22 @@ int RawDataProcess::get_expire_time(DTCTableDefinition *t, Node *p_node,
 {
 	int iRet = DTC_CODE_SUCCESS;
 
+	/* 过期检查不算访问，压缩过的节点解压到临时内存 */
+	if (RawData::is_compressed((const char *)p_mallocator_->handle_to_ptr(
+		    p_node->vd_handle()))) {
+		RawData stTmpRows(&g_stSysMalloc, 1);
+		iRet = uncompress_to_temp(p_node, &stTmpRows);
+		if (iRet != DTC_CODE_SUCCESS)
+			return iRet;
+		iRet = stTmpRows.get_expire_time(t, expire);
+		if (iRet != DTC_CODE_SUCCESS) {
+			log4cplus_error("raw data get expire time error: %d",
+					iRet);
+			return iRet;
+		}
+		return DTC_CODE_SUCCESS;
+	}
+
 	iRet = attach_data(p_node, NULL);
 	if (iRet != DTC_CODE_SUCCESS) {
 		log4cplus_error("attach data error: %d", iRet);
@@ -440,6 +575,10 @@ int RawDataProcess::do_get(DTCJobOperation &job_op, Node *p_node)
 			   -1 :
 			   job_op.table_definition()->lastacc_field_id();
 
+	iRet = inflate_data(p_node);
+	if (iRet != DTC_CODE_SUCCESS)
+		return iRet;
+
 	iRet = raw_data_.do_attach(p_node->vd_handle());
 	if (iRet != 0) {
 		log4cplus_error("raw-data attach[handle:" UINT64FMT
@@ -471,13 +610,32 @@ int RawDataProcess::do_get(DTCJobOperation &job_op, Node *p_node)
 			stpNodeRow = &stNodeRow;
 			stpTaskRow = &stTaskRow;
 		}
+		/* 同一张表时只解码返回字段、条件字段和过期时间字段，其余字段跳过 */
+		uint8_t achFieldMask[32];
+		const uint8_t *pchFieldMask = NULL;
+		const DTCFieldSet *stpFields = job_op.request_fields();
+		if (stpNodeTab == stpTaskTab && stpFields != NULL) {
+			memset(achFieldMask, 0, sizeof(achFieldMask));
+			stpFields->build_field_mask(achFieldMask);
+			const DTCFieldValue *stpCond = job_op.request_condition();
+			if (stpCond != NULL) {
+				for (int n = 0; n < stpCond->num_fields(); n++)
+					FIELD_SET(stpCond->field_id(n),
+						  achFieldMask);
+			}
+			if (stpTaskTab->expire_time_field_id() > 0)
+				FIELD_SET(stpTaskTab->expire_time_field_id(),
+					  achFieldMask);
+			pchFieldMask = achFieldMask;
+		}
 		unsigned char uchRowFlags;
 		for (unsigned int i = 0; i < uiTotalRows; i++) //逐行拷贝数据
 		{
 			job_op.update_key(
 				*stpNodeRow); // use stpNodeRow is fine, as just modify key field
-			if ((iRet = raw_data_.decode_row(
-				     *stpNodeRow, uchRowFlags, 0)) != 0) {
+			if ((iRet = raw_data_.decode_row(*stpNodeRow,
+							 uchRowFlags, 0,
+							 pchFieldMask)) != 0) {
 				log4cplus_error(
 					"raw-data decode row error: %d,%s",
 					iRet, raw_data_.get_err_msg());
@@ -1059,33 +1217,52 @@ int RawDataProcess::do_update(DTCJobOperation &job_op, Node *p_node,
 			return (-2);
 		}
 
-		// 在私有区间decode
-		RawData stTmpRows(&g_stSysMalloc, 1);
-		if (encode_to_private_area(stTmpRows, *stpNodeRow,
-					   uchRowFlags)) {
-			log4cplus_error(
-				"encode rowvalue to private rawdata area failed");
-			return -3;
-		}
-
-		iRet = raw_data_.replace_cur_row(*stpNodeRow,
-						 async); // 加进cache
-		if (iRet == EC_NO_MEM) {
-			if (p_buffer_pond_->try_purge_size(
-				    raw_data_.need_size(), *p_node) == 0)
-				iRet = raw_data_.replace_cur_row(*stpNodeRow,
-								 async);
-		}
-		if (iRet != EC_NO_MEM)
-			p_node->vd_handle() = raw_data_.get_handle();
-		if (iRet != 0) {
+		// 只改了定长字段时直接改写行内字节
+		iRet = 1;
+		if (stpNodeTab == stpTaskTab)
+			iRet = raw_data_.update_cur_row_inplace(
+				*stpNodeRow, job_op.request_operation(), async);
+		if (iRet < 0) {
 			snprintf(err_message_, sizeof(err_message_),
-				 "raw-data replace row error: %d, %s", iRet,
+				 "raw-data update row error: %d, %s", iRet,
 				 raw_data_.get_err_msg());
-			/*标记加入黑名单*/
-			job_op.push_black_list_size(raw_data_.need_size());
 			return (-6);
 		}
+		if (iRet == 0) {
+			stat_update_inplace_++;
+		} else {
+			stat_update_rewrite_++;
+
+			// 在私有区间decode
+			RawData stTmpRows(&g_stSysMalloc, 1);
+			if (encode_to_private_area(stTmpRows, *stpNodeRow,
+						   uchRowFlags)) {
+				log4cplus_error(
+					"encode rowvalue to private rawdata area failed");
+				return -3;
+			}
+
+			iRet = raw_data_.replace_cur_row(*stpNodeRow,
+							 async); // 加进cache
+			if (iRet == EC_NO_MEM) {
+				if (p_buffer_pond_->try_purge_size(
+					    raw_data_.need_size(),
+					    *p_node) == 0)
+					iRet = raw_data_.replace_cur_row(
+						*stpNodeRow, async);
+			}
+			if (iRet != EC_NO_MEM)
+				p_node->vd_handle() = raw_data_.get_handle();
+			if (iRet != 0) {
+				snprintf(err_message_, sizeof(err_message_),
+					 "raw-data replace row error: %d, %s",
+					 iRet, raw_data_.get_err_msg());
+				/*标记加入黑名单*/
+				job_op.push_black_list_size(
+					raw_data_.need_size());
+				return (-6);
+			}
+		}
 
 		if (uchRowFlags & OPER_DIRTY)
 			dirty_rows_count_--;
@@ -54,10 +54,24 @@ class RawDataProcess : public DataProcess {
 	StatSample history_datasize;
 	StatSample history_rowsize;
 
+	/* 冷节点压缩 */
+	DTCCompress compressor_;
+	StatCounter stat_compress_nodes_;
+	StatCounter stat_compress_saved_;
+	StatCounter stat_compress_time_;
+	StatCounter stat_uncompress_nodes_;
+	StatCounter stat_uncompress_time_;
+	StatCounter stat_update_inplace_;
+	StatCounter stat_update_rewrite_;
+
     protected:
 	int init_data(Node *p_node, RawData *affected_data, const char *ptrKey);
 	int attach_data(Node *p_node, RawData *affected_data);
 	int destroy_data(Node *p_node);
+	/* 节点被压缩过则在原地解压，p_node->vd_handle()会改变 */
+	int inflate_data(Node *p_node);
+	/* 不修改节点，把压缩过的节点解压到临时的pstRows */
+	int uncompress_to_temp(Node *p_node, RawData *pstRows);
 
     private:
 	int encode_to_private_area(RawData &, RowValue &, unsigned char);
@@ -119,6 +133,13 @@ class RawDataProcess : public DataProcess {
 		     unsigned int &affected_count);
 	int do_purge(DTCFlushRequest *flush_req, Node *p_node,
 		     unsigned int &affected_count);
+
+	void set_compress_level(int level)
+	{
+		compressor_.set_compress_level(level);
+	}
+	/* 压缩干净节点的行数据，返回0为成功，1为不需要压缩，<0失败 */
+	int compress_node(Node *p_node, ALLOC_SIZE_T min_saved);
 };
 
 DTC_END_NAMESPACE
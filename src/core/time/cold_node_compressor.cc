@@ -0,0 +1,100 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "cold_node_compressor.h"
+
+DTC_USING_NAMESPACE
+
+ColdNodeCompressor::ColdNodeCompressor(TimerList *t, BufferPond *c,
+				       RawDataProcess *p, int ratio,
+				       int scan_nodes, int min_saved)
+	: timer(t), cache(c), process(p), cold_ratio_(ratio),
+	  scan_nodes_(scan_nodes), min_saved_(min_saved),
+	  cursor_(INVALID_NODE_ID), depth_(0)
+{
+	if (cold_ratio_ <= 0 || cold_ratio_ > 100)
+		cold_ratio_ = 50;
+	if (scan_nodes_ <= 0)
+		scan_nodes_ = 1000;
+	if (min_saved_ < 0)
+		min_saved_ = 0;
+}
+
+ColdNodeCompressor::~ColdNodeCompressor()
+{
+}
+
+void ColdNodeCompressor::start_cold_compress_task(void)
+{
+	log4cplus_info("start cold node compress job, ratio %d%%, scan %d",
+		       cold_ratio_, scan_nodes_);
+	attach_timer(timer);
+	return;
+}
+
+void ColdNodeCompressor::job_timer_procedure(void)
+{
+	log4cplus_debug("enter timer procedure");
+
+	Node clean_header = cache->clean_lru_head();
+	unsigned int used = cache->get_total_used_node();
+	unsigned int dirty = cache->total_dirty_node();
+	unsigned int cold_nodes =
+		used > dirty ? (uint64_t)(used - dirty) * cold_ratio_ / 100 : 0;
+
+	/*
+	 * 从上次停止的节点继续往热端扫描。该节点被访问过会移到LRU头部，
+	 * 其Prev()就是header，本次扫描直接结束，下次从尾部重新开始。
+	 */
+	Node pos;
+	if (cursor_ != INVALID_NODE_ID) {
+		Node stop = I_SEARCH(cursor_);
+		if (!!stop && !stop.not_in_lru_list() && !stop.is_dirty() &&
+		    !cache->is_time_marker(stop))
+			pos = stop.Prev();
+	}
+	if (!pos) {
+		pos = clean_header.Prev();
+		depth_ = 0;
+	}
+
+	int scanned = 0, compressed = 0;
+	Node last;
+	for (; scanned < scan_nodes_ && !(!pos) && pos != clean_header &&
+	       depth_ < cold_nodes;
+	     ++scanned, ++depth_) {
+		last = pos;
+		pos = pos.Prev();
+
+		if (last.vd_handle() == INVALID_HANDLE)
+			continue;
+		if (process->compress_node(&last, min_saved_) == 0)
+			++compressed;
+	}
+
+	if (!pos || pos == clean_header || depth_ >= cold_nodes || !last) {
+		cursor_ = INVALID_NODE_ID;
+		depth_ = 0;
+	} else {
+		cursor_ = last.node_id();
+	}
+	log4cplus_debug("cold compress scanned %d nodes, compressed %d",
+			scanned, compressed);
+
+	attach_timer(timer);
+	log4cplus_debug("leave timer procedure");
+	return;
+}
@@ -0,0 +1,62 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef __DTC_COLD_NODE_COMPRESSOR_H
+#define __DTC_COLD_NODE_COMPRESSOR_H
+
+#include "namespace.h"
+#include "timer/timer_list.h"
+#include "log/log.h"
+#include "buffer_pond.h"
+#include "raw_data_process.h"
+
+DTC_BEGIN_NAMESPACE
+
+/*
+ * 冷节点压缩：定时从clean LRU尾部开始，把最冷的一部分节点的行数据压缩，
+ * 节点再次被访问时由RawDataProcess在原地解压。
+ * 每次只扫描有限个节点，下次从上次停止的位置继续。
+ */
+class TimerObject;
+class ColdNodeCompressor : private TimerObject {
+    public:
+	/*
+	 * ratio:	clean LRU尾部多少百分比的节点算冷节点
+	 * scan_nodes:	每次最多扫描的节点数
+	 * min_saved:	压缩至少节省的字节数，否则不压缩
+	 */
+	ColdNodeCompressor(TimerList *t, BufferPond *c, RawDataProcess *p,
+			   int ratio, int scan_nodes, int min_saved);
+	virtual ~ColdNodeCompressor(void);
+	virtual void job_timer_procedure(void);
+	void start_cold_compress_task(void);
+
+    private:
+	TimerList *timer;
+	BufferPond *cache;
+	RawDataProcess *process;
+
+	int cold_ratio_;
+	int scan_nodes_;
+	int min_saved_;
+
+	NODE_ID_T cursor_; // 上次扫描停止的节点
+	unsigned int depth_; // cursor_到clean LRU尾部的节点数
+};
+
+DTC_END_NAMESPACE
+
+#endif
@@ -0,0 +1,679 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "bp_tree.h"
+#include "mem/pt_malloc.h"
+#include "dtc_error_code.h"
+
+void _BPtreeNode::do_init(bool isLeaf)
+{
+	m_chLeaf = isLeaf ? 1 : 0;
+	m_ushNItems = 0;
+	m_hPrev = INVALID_HANDLE;
+	m_hNext = INVALID_HANDLE;
+}
+
+void _BPtreeNode::insert_at(int i, uint64_t ullPrefix, ALLOC_HANDLE_T hItem)
+{
+	memmove(&m_aullPrefix[i + 1], &m_aullPrefix[i],
+		(m_ushNItems - i) * sizeof(uint64_t));
+	memmove(&m_ahItems[i + 1], &m_ahItems[i],
+		(m_ushNItems - i) * sizeof(ALLOC_HANDLE_T));
+	m_aullPrefix[i] = ullPrefix;
+	m_ahItems[i] = hItem;
+	m_ushNItems++;
+}
+
+void _BPtreeNode::remove_at(int i)
+{
+	m_ushNItems--;
+	memmove(&m_aullPrefix[i], &m_aullPrefix[i + 1],
+		(m_ushNItems - i) * sizeof(uint64_t));
+	memmove(&m_ahItems[i], &m_ahItems[i + 1],
+		(m_ushNItems - i) * sizeof(ALLOC_HANDLE_T));
+}
+
+void _BPtreeNode::destory(MallocBase &stMalloc, ALLOC_HANDLE_T hNode)
+{
+	if (hNode == INVALID_HANDLE)
+		return;
+
+	BPtreeNode *p_node;
+	GET_OBJ(stMalloc, hNode, p_node);
+	for (int i = 0; i < p_node->m_ushNItems; i++) {
+		if (p_node->m_chLeaf)
+			stMalloc.Free(p_node->m_ahItems[i]);
+		else
+			destory(stMalloc, p_node->m_ahItems[i]);
+	}
+	stMalloc.Free(hNode);
+}
+
+unsigned _BPtreeNode::ask_for_destroy_size(MallocBase &stMalloc,
+					   ALLOC_HANDLE_T hNode)
+{
+	unsigned size = 0;
+
+	if (hNode == INVALID_HANDLE)
+		return size;
+
+	BPtreeNode *p_node;
+	GET_OBJ(stMalloc, hNode, p_node);
+	for (int i = 0; i < p_node->m_ushNItems; i++) {
+		if (p_node->m_chLeaf)
+			size += stMalloc.chunk_size(p_node->m_ahItems[i]);
+		else
+			size += ask_for_destroy_size(stMalloc,
+						     p_node->m_ahItems[i]);
+	}
+	size += stMalloc.chunk_size(hNode);
+
+	return size;
+}
+
+BPtree::BPtree(MallocBase &stMalloc) : m_stMalloc(stMalloc)
+{
+	root_handle_ = INVALID_HANDLE;
+	m_pfPrefix = NULL;
+	m_bExact = false;
+	node_delta_ = 0;
+	err_message_[0] = 0;
+}
+
+BPtree::~BPtree()
+{
+}
+
+/* 先比较内联前缀，前缀相同且不精确时才回表调用比较函数 */
+int BPtree::compare(const char *pchKey, uint64_t ullPrefix, void *pCmpCookie,
+		    KeyComparator pfComp, ALLOC_HANDLE_T hNode, int i)
+{
+	BPtreeNode *p_node;
+	GET_OBJ(m_stMalloc, hNode, p_node);
+
+	if (m_pfPrefix != NULL) {
+		if (ullPrefix < p_node->m_aullPrefix[i])
+			return -1;
+		if (ullPrefix > p_node->m_aullPrefix[i])
+			return 1;
+		if (m_bExact)
+			return 0;
+	}
+
+	ALLOC_HANDLE_T hRecord = p_node->m_ahItems[i];
+	while (!p_node->m_chLeaf) {
+		GET_OBJ(m_stMalloc, hRecord, p_node);
+		hRecord = p_node->m_ahItems[0];
+	}
+
+	int64_t llDiff = pfComp(pchKey, pCmpCookie, m_stMalloc, hRecord);
+	return llDiff < 0 ? -1 : (llDiff > 0 ? 1 : 0);
+}
+
+/* 返回第一个不小于key的位置 */
+int BPtree::lower_bound(const char *pchKey, uint64_t ullPrefix,
+			void *pCmpCookie, KeyComparator pfComp,
+			ALLOC_HANDLE_T hNode, bool &isEqual)
+{
+	BPtreeNode *p_node;
+	GET_OBJ(m_stMalloc, hNode, p_node);
+
+	int iLow = 0;
+	int iHigh = p_node->m_ushNItems;
+	isEqual = false;
+	while (iLow < iHigh) {
+		int iMid = (iLow + iHigh) / 2;
+		int iDiff = compare(pchKey, ullPrefix, pCmpCookie, pfComp,
+				    hNode, iMid);
+		if (iDiff == 0) {
+			isEqual = true;
+			return iMid;
+		}
+		if (iDiff > 0)
+			iLow = iMid + 1;
+		else
+			iHigh = iMid;
+	}
+	return iLow;
+}
+
+ALLOC_HANDLE_T BPtree::find_leaf(const char *pchKey, uint64_t ullPrefix,
+				 void *pCmpCookie, KeyComparator pfComp,
+				 ALLOC_HANDLE_T *ahPath, int *aiPos,
+				 int &iDepth)
+{
+	ALLOC_HANDLE_T hNode = root_handle_;
+	BPtreeNode *p_node;
+
+	iDepth = 0;
+	GET_OBJ(m_stMalloc, hNode, p_node);
+	while (!p_node->m_chLeaf) {
+		if (iDepth >= MAX_DEPTH) {
+			snprintf(err_message_, sizeof(err_message_),
+				 "b+tree too deep");
+			return INVALID_HANDLE;
+		}
+
+		bool isEqual;
+		int i = lower_bound(pchKey, ullPrefix, pCmpCookie, pfComp,
+				    hNode, isEqual);
+		if (!isEqual && i > 0)
+			i--;
+		if (ahPath != NULL) {
+			ahPath[iDepth] = hNode;
+			aiPos[iDepth] = i;
+		}
+		iDepth++;
+		hNode = p_node->m_ahItems[i];
+		GET_OBJ(m_stMalloc, hNode, p_node);
+	}
+	return hNode;
+}
+
+ALLOC_HANDLE_T BPtree::first_leaf()
+{
+	ALLOC_HANDLE_T hNode = root_handle_;
+	BPtreeNode *p_node;
+
+	if (hNode == INVALID_HANDLE)
+		return INVALID_HANDLE;
+	GET_OBJ(m_stMalloc, hNode, p_node);
+	while (!p_node->m_chLeaf) {
+		hNode = p_node->m_ahItems[0];
+		GET_OBJ(m_stMalloc, hNode, p_node);
+	}
+	return hNode;
+}
+
+ALLOC_HANDLE_T BPtree::last_leaf()
+{
+	ALLOC_HANDLE_T hNode = root_handle_;
+	BPtreeNode *p_node;
+
+	if (hNode == INVALID_HANDLE)
+		return INVALID_HANDLE;
+	GET_OBJ(m_stMalloc, hNode, p_node);
+	while (!p_node->m_chLeaf) {
+		hNode = p_node->m_ahItems[p_node->m_ushNItems - 1];
+		GET_OBJ(m_stMalloc, hNode, p_node);
+	}
+	return hNode;
+}
+
+/* 从根到叶子的层数，空树为0 */
+int BPtree::depth()
+{
+	ALLOC_HANDLE_T hNode = root_handle_;
+	BPtreeNode *p_node;
+	int iDepth = 0;
+
+	while (hNode != INVALID_HANDLE) {
+		GET_OBJ(m_stMalloc, hNode, p_node);
+		iDepth++;
+		if (p_node->m_chLeaf)
+			break;
+		hNode = p_node->m_ahItems[0];
+	}
+	return iDepth;
+}
+
+/* 子树最小key变化后，沿路径向上修正父节点中保存的前缀 */
+void BPtree::refresh_prefix(ALLOC_HANDLE_T *ahPath, int *aiPos, int iLevel,
+			    uint64_t ullPrefix)
+{
+	for (int d = iLevel - 1; d >= 0; d--) {
+		BPtreeNode *p_node;
+		GET_OBJ(m_stMalloc, ahPath[d], p_node);
+		p_node->m_aullPrefix[aiPos[d]] = ullPrefix;
+		if (aiPos[d] != 0)
+			break;
+	}
+}
+
+ALLOC_HANDLE_T BPtree::first_node()
+{
+	ALLOC_HANDLE_T hLeaf = first_leaf();
+	if (hLeaf == INVALID_HANDLE)
+		return INVALID_HANDLE;
+
+	BPtreeNode *p_node;
+	GET_OBJ(m_stMalloc, hLeaf, p_node);
+	return p_node->m_ushNItems ? p_node->m_ahItems[0] : INVALID_HANDLE;
+}
+
+int BPtree::do_insert(const char *pchKey, void *pCmpCookie,
+		      KeyComparator pfComp, ALLOC_HANDLE_T hRecord,
+		      bool &isAllocNode)
+{
+	ALLOC_HANDLE_T ahPath[MAX_DEPTH];
+	int aiPos[MAX_DEPTH];
+	ALLOC_HANDLE_T ahNew[MAX_DEPTH + 2];
+	BPtreeNode *p_node;
+	uint64_t ullPrefix = key_prefix(pchKey);
+	int iDepth;
+
+	node_delta_ = 0;
+	if (root_handle_ == INVALID_HANDLE) {
+		ALLOC_HANDLE_T hNode = m_stMalloc.Malloc(sizeof(BPtreeNode));
+		if (hNode == INVALID_HANDLE) {
+			snprintf(err_message_, sizeof(err_message_),
+				 "alloc tree-node error: %s",
+				 m_stMalloc.get_err_msg());
+			return (EC_NO_MEM);
+		}
+		GET_OBJ(m_stMalloc, hNode, p_node);
+		p_node->do_init(true);
+		p_node->insert_at(0, ullPrefix, hRecord);
+		root_handle_ = hNode;
+		node_delta_ = 1;
+		isAllocNode = true;
+		return (0);
+	}
+
+	ALLOC_HANDLE_T hLeaf = find_leaf(pchKey, ullPrefix, pCmpCookie, pfComp,
+					 ahPath, aiPos, iDepth);
+	if (hLeaf == INVALID_HANDLE)
+		return (-1);
+
+	bool isEqual;
+	int iPos = lower_bound(pchKey, ullPrefix, pCmpCookie, pfComp, hLeaf,
+			       isEqual);
+	if (isEqual) {
+		snprintf(err_message_, sizeof(err_message_),
+			 "key already exists.");
+		return (EC_KEY_EXIST);
+	}
+
+	/* 先算出需要分裂的节点个数并一次性分配，保证内存不足时树不被破坏 */
+	int iNeed = 0;
+	GET_OBJ(m_stMalloc, hLeaf, p_node);
+	if (p_node->m_ushNItems == BPtreeNode::ORDER) {
+		int d = iDepth - 1;
+		iNeed = 1;
+		while (d >= 0) {
+			GET_OBJ(m_stMalloc, ahPath[d], p_node);
+			if (p_node->m_ushNItems < BPtreeNode::ORDER)
+				break;
+			iNeed++;
+			d--;
+		}
+		if (d < 0)
+			iNeed++;
+	}
+	for (int i = 0; i < iNeed; i++) {
+		ahNew[i] = m_stMalloc.Malloc(sizeof(BPtreeNode));
+		if (ahNew[i] == INVALID_HANDLE) {
+			snprintf(err_message_, sizeof(err_message_),
+				 "alloc tree-node error: %s",
+				 m_stMalloc.get_err_msg());
+			while (--i >= 0)
+				m_stMalloc.Free(ahNew[i]);
+			return (EC_NO_MEM);
+		}
+	}
+
+	if (iPos == 0)
+		refresh_prefix(ahPath, aiPos, iDepth, ullPrefix);
+
+	ALLOC_HANDLE_T hCur = hLeaf;
+	ALLOC_HANDLE_T hItem = hRecord;
+	int iUsed = 0;
+	int d = iDepth;
+	while (1) {
+		GET_OBJ(m_stMalloc, hCur, p_node);
+		if (p_node->m_ushNItems < BPtreeNode::ORDER) {
+			p_node->insert_at(iPos, ullPrefix, hItem);
+			break;
+		}
+
+		/* 节点已满，分裂为左右两半 */
+		uint64_t aullPrefix[BPtreeNode::ORDER + 1];
+		ALLOC_HANDLE_T ahItems[BPtreeNode::ORDER + 1];
+		int n = 0;
+		for (int i = 0; i < BPtreeNode::ORDER; i++) {
+			if (i == iPos) {
+				aullPrefix[n] = ullPrefix;
+				ahItems[n++] = hItem;
+			}
+			aullPrefix[n] = p_node->m_aullPrefix[i];
+			ahItems[n++] = p_node->m_ahItems[i];
+		}
+		if (iPos == BPtreeNode::ORDER) {
+			aullPrefix[n] = ullPrefix;
+			ahItems[n++] = hItem;
+		}
+
+		ALLOC_HANDLE_T hRight = ahNew[iUsed++];
+		BPtreeNode *pstRight;
+		GET_OBJ(m_stMalloc, hRight, pstRight);
+		pstRight->do_init(p_node->m_chLeaf);
+
+		int iHalf = n / 2;
+		p_node->m_ushNItems = iHalf;
+		memcpy(p_node->m_aullPrefix, aullPrefix,
+		       iHalf * sizeof(uint64_t));
+		memcpy(p_node->m_ahItems, ahItems,
+		       iHalf * sizeof(ALLOC_HANDLE_T));
+		pstRight->m_ushNItems = n - iHalf;
+		memcpy(pstRight->m_aullPrefix, aullPrefix + iHalf,
+		       (n - iHalf) * sizeof(uint64_t));
+		memcpy(pstRight->m_ahItems, ahItems + iHalf,
+		       (n - iHalf) * sizeof(ALLOC_HANDLE_T));
+
+		if (p_node->m_chLeaf) {
+			pstRight->m_hPrev = hCur;
+			pstRight->m_hNext = p_node->m_hNext;
+			if (p_node->m_hNext != INVALID_HANDLE) {
+				BPtreeNode *pstNext;
+				GET_OBJ(m_stMalloc, p_node->m_hNext, pstNext);
+				pstNext->m_hPrev = hRight;
+			}
+			p_node->m_hNext = hRight;
+		}
+
+		if (d == 0) {
+			ALLOC_HANDLE_T hRoot = ahNew[iUsed++];
+			BPtreeNode *pstRoot;
+			GET_OBJ(m_stMalloc, hRoot, pstRoot);
+			pstRoot->do_init(false);
+			pstRoot->insert_at(0, p_node->m_aullPrefix[0], hCur);
+			pstRoot->insert_at(1, pstRight->m_aullPrefix[0],
+					   hRight);
+			root_handle_ = hRoot;
+			break;
+		}
+
+		d--;
+		hCur = ahPath[d];
+		iPos = aiPos[d] + 1;
+		ullPrefix = pstRight->m_aullPrefix[0];
+		hItem = hRight;
+	}
+
+	node_delta_ = iNeed;
+	isAllocNode = iNeed > 0;
+	return (0);
+}
+
+/* 删除时不做节点合并，只回收空节点，树高不会因删除而增长 */
+int BPtree::Delete(const char *pchKey, void *pCmpCookie, KeyComparator pfComp,
+		   bool &isFreeNode)
+{
+	ALLOC_HANDLE_T ahPath[MAX_DEPTH];
+	int aiPos[MAX_DEPTH];
+	BPtreeNode *p_node;
+	uint64_t ullPrefix = key_prefix(pchKey);
+	int iDepth;
+	int iFree = 0;
+
+	node_delta_ = 0;
+	if (root_handle_ == INVALID_HANDLE)
+		return (0);
+
+	ALLOC_HANDLE_T hCur = find_leaf(pchKey, ullPrefix, pCmpCookie, pfComp,
+					ahPath, aiPos, iDepth);
+	if (hCur == INVALID_HANDLE)
+		return (-1);
+
+	bool isEqual;
+	int iPos = lower_bound(pchKey, ullPrefix, pCmpCookie, pfComp, hCur,
+			       isEqual);
+	if (!isEqual) {
+		snprintf(err_message_, sizeof(err_message_), "tree error");
+		return (-1);
+	}
+
+	int d = iDepth;
+	GET_OBJ(m_stMalloc, hCur, p_node);
+	p_node->remove_at(iPos);
+	while (1) {
+		GET_OBJ(m_stMalloc, hCur, p_node);
+		if (p_node->m_ushNItems > 0) {
+			if (iPos == 0)
+				refresh_prefix(ahPath, aiPos, d,
+					       p_node->m_aullPrefix[0]);
+			break;
+		}
+
+		if (p_node->m_chLeaf) {
+			BPtreeNode *pstLink;
+			if (p_node->m_hPrev != INVALID_HANDLE) {
+				GET_OBJ(m_stMalloc, p_node->m_hPrev, pstLink);
+				pstLink->m_hNext = p_node->m_hNext;
+			}
+			if (p_node->m_hNext != INVALID_HANDLE) {
+				GET_OBJ(m_stMalloc, p_node->m_hNext, pstLink);
+				pstLink->m_hPrev = p_node->m_hPrev;
+			}
+		}
+		m_stMalloc.Free(hCur);
+		iFree++;
+
+		if (d == 0) {
+			root_handle_ = INVALID_HANDLE;
+			break;
+		}
+
+		d--;
+		hCur = ahPath[d];
+		iPos = aiPos[d];
+		GET_OBJ(m_stMalloc, hCur, p_node);
+		p_node->remove_at(iPos);
+	}
+
+	/* 根节点只剩一个孩子时降低树高 */
+	while (root_handle_ != INVALID_HANDLE) {
+		GET_OBJ(m_stMalloc, root_handle_, p_node);
+		if (p_node->m_chLeaf || p_node->m_ushNItems != 1)
+			break;
+		ALLOC_HANDLE_T hChild = p_node->m_ahItems[0];
+		m_stMalloc.Free(root_handle_);
+		iFree++;
+		root_handle_ = hChild;
+	}
+
+	node_delta_ = -iFree;
+	isFreeNode = iFree > 0;
+	return (0);
+}
+
+int BPtree::do_find(const char *pchKey, void *pCmpCookie, KeyComparator pfComp,
+		    ALLOC_HANDLE_T &hRecord)
+{
+	ALLOC_HANDLE_T *phRecord;
+	int iRet = do_find(pchKey, pCmpCookie, pfComp, phRecord);
+	hRecord = phRecord ? *phRecord : INVALID_HANDLE;
+	return iRet;
+}
+
+int BPtree::do_find(const char *pchKey, void *pCmpCookie, KeyComparator pfComp,
+		    ALLOC_HANDLE_T *&phRecord)
+{
+	phRecord = NULL;
+	if (root_handle_ == INVALID_HANDLE)
+		return (0);
+
+	int iDepth;
+	uint64_t ullPrefix = key_prefix(pchKey);
+	ALLOC_HANDLE_T hLeaf = find_leaf(pchKey, ullPrefix, pCmpCookie, pfComp,
+					 NULL, NULL, iDepth);
+	if (hLeaf == INVALID_HANDLE)
+		return (0);
+
+	bool isEqual;
+	int iPos = lower_bound(pchKey, ullPrefix, pCmpCookie, pfComp, hLeaf,
+			       isEqual);
+	if (!isEqual)
+		return (0);
+
+	BPtreeNode *p_node;
+	GET_OBJ(m_stMalloc, hLeaf, p_node);
+	phRecord = &(p_node->m_ahItems[iPos]);
+	return (1);
+}
+
+int BPtree::destory()
+{
+	BPtreeNode::destory(m_stMalloc, root_handle_);
+	root_handle_ = INVALID_HANDLE;
+	return (0);
+}
+
+unsigned BPtree::ask_for_destroy_size(void)
+{
+	return BPtreeNode::ask_for_destroy_size(m_stMalloc, root_handle_);
+}
+
+int BPtree::traverse_forward(ItemVisit pfVisit, void *pCookie)
+{
+	ALLOC_HANDLE_T hLeaf = first_leaf();
+	while (hLeaf != INVALID_HANDLE) {
+		BPtreeNode *p_node;
+		GET_OBJ(m_stMalloc, hLeaf, p_node);
+		for (int i = 0; i < p_node->m_ushNItems; i++) {
+			int iRet = pfVisit(m_stMalloc, p_node->m_ahItems[i],
+					   pCookie);
+			if (iRet != 0)
+				return (iRet);
+		}
+		hLeaf = p_node->m_hNext;
+	}
+	return (0);
+}
+
+int BPtree::traverse_backward(ItemVisit pfVisit, void *pCookie)
+{
+	ALLOC_HANDLE_T hLeaf = last_leaf();
+	while (hLeaf != INVALID_HANDLE) {
+		BPtreeNode *p_node;
+		GET_OBJ(m_stMalloc, hLeaf, p_node);
+		for (int i = p_node->m_ushNItems; --i >= 0;) {
+			int iRet = pfVisit(m_stMalloc, p_node->m_ahItems[i],
+					   pCookie);
+			if (iRet != 0)
+				return (iRet);
+		}
+		hLeaf = p_node->m_hPrev;
+	}
+	return (0);
+}
+
+int BPtree::traverse_forward(const char *pchKey, void *pCmpCookie,
+			     KeyComparator pfComp, ItemVisit pfVisit,
+			     void *pCookie)
+{
+	if (root_handle_ == INVALID_HANDLE)
+		return (0);
+
+	int iDepth;
+	bool isEqual;
+	uint64_t ullPrefix = key_prefix(pchKey);
+	ALLOC_HANDLE_T hLeaf = find_leaf(pchKey, ullPrefix, pCmpCookie, pfComp,
+					 NULL, NULL, iDepth);
+	if (hLeaf == INVALID_HANDLE)
+		return (-1);
+	int iPos = lower_bound(pchKey, ullPrefix, pCmpCookie, pfComp, hLeaf,
+			       isEqual);
+
+	while (hLeaf != INVALID_HANDLE) {
+		BPtreeNode *p_node;
+		GET_OBJ(m_stMalloc, hLeaf, p_node);
+		for (int i = iPos; i < p_node->m_ushNItems; i++) {
+			int iRet = pfVisit(m_stMalloc, p_node->m_ahItems[i],
+					   pCookie);
+			if (iRet != 0)
+				return (iRet);
+		}
+		hLeaf = p_node->m_hNext;
+		iPos = 0;
+	}
+	return (0);
+}
+
+int BPtree::traverse_forward(const char *pchKey, const char *pchKey1,
+			     void *pCmpCookie, KeyComparator pfComp,
+			     ItemVisit pfVisit, void *pCookie)
+{
+	if (root_handle_ == INVALID_HANDLE)
+		return (0);
+
+	int iDepth;
+	bool isEqual;
+	uint64_t ullPrefix = key_prefix(pchKey);
+	uint64_t ullPrefix1 = key_prefix(pchKey1);
+	ALLOC_HANDLE_T hLeaf = find_leaf(pchKey, ullPrefix, pCmpCookie, pfComp,
+					 NULL, NULL, iDepth);
+	if (hLeaf == INVALID_HANDLE)
+		return (-1);
+	int iPos = lower_bound(pchKey, ullPrefix, pCmpCookie, pfComp, hLeaf,
+			       isEqual);
+
+	while (hLeaf != INVALID_HANDLE) {
+		BPtreeNode *p_node;
+		GET_OBJ(m_stMalloc, hLeaf, p_node);
+		for (int i = iPos; i < p_node->m_ushNItems; i++) {
+			if (compare(pchKey1, ullPrefix1, pCmpCookie, pfComp,
+				    hLeaf, i) < 0)
+				return (0);
+			int iRet = pfVisit(m_stMalloc, p_node->m_ahItems[i],
+					   pCookie);
+			if (iRet != 0)
+				return (iRet);
+		}
+		hLeaf = p_node->m_hNext;
+		iPos = 0;
+	}
+	return (0);
+}
+
+int BPtree::traverse_backward(const char *pchKey, void *pCmpCookie,
+			      KeyComparator pfComp, ItemVisit pfVisit,
+			      void *pCookie)
+{
+	if (root_handle_ == INVALID_HANDLE)
+		return (0);
+
+	int iDepth;
+	bool isEqual;
+	uint64_t ullPrefix = key_prefix(pchKey);
+	ALLOC_HANDLE_T hLeaf = find_leaf(pchKey, ullPrefix, pCmpCookie, pfComp,
+					 NULL, NULL, iDepth);
+	if (hLeaf == INVALID_HANDLE)
+		return (-1);
+	int iPos = lower_bound(pchKey, ullPrefix, pCmpCookie, pfComp, hLeaf,
+			       isEqual);
+	if (!isEqual)
+		iPos--;
+
+	while (hLeaf != INVALID_HANDLE) {
+		BPtreeNode *p_node;
+		GET_OBJ(m_stMalloc, hLeaf, p_node);
+		for (int i = iPos; i >= 0; i--) {
+			int iRet = pfVisit(m_stMalloc, p_node->m_ahItems[i],
+					   pCookie);
+			if (iRet != 0)
+				return (iRet);
+		}
+		hLeaf = p_node->m_hPrev;
+		if (hLeaf != INVALID_HANDLE) {
+			GET_OBJ(m_stMalloc, hLeaf, p_node);
+			iPos = p_node->m_ushNItems - 1;
+		}
+	}
+	return (0);
+}
@@ -0,0 +1,150 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef BP_TREE_H
+#define BP_TREE_H
+
+#include <stdint.h>
+#include "mem/mallocator.h"
+#include "t_tree.h"
+
+/************************************************************
+  Description:    共享内存中的B+树，接口与Ttree保持一致。
+                  节点较宽，并内联保存key的64位规范化前缀，绝大多数比较
+                  在节点内完成，不需要解引用记录句柄；叶子节点双向链接，
+                  范围遍历时顺序扫描叶子即可。
+  Version:         DTC 3.0
+***********************************************************/
+class BPtree {
+    protected:
+	ALLOC_HANDLE_T root_handle_;
+	MallocBase &m_stMalloc;
+	KeyNormalizer m_pfPrefix;
+	bool m_bExact;
+	int node_delta_; // 最近一次操作分配(正)或释放(负)的节点个数
+	char err_message_[100];
+
+	enum { MAX_DEPTH = 16 };
+
+	int compare(const char *pchKey, uint64_t ullPrefix, void *pCmpCookie,
+		    KeyComparator pfComp, ALLOC_HANDLE_T hNode, int i);
+	int lower_bound(const char *pchKey, uint64_t ullPrefix,
+			void *pCmpCookie, KeyComparator pfComp,
+			ALLOC_HANDLE_T hNode, bool &isEqual);
+	ALLOC_HANDLE_T find_leaf(const char *pchKey, uint64_t ullPrefix,
+				 void *pCmpCookie, KeyComparator pfComp,
+				 ALLOC_HANDLE_T *ahPath, int *aiPos,
+				 int &iDepth);
+	ALLOC_HANDLE_T first_leaf();
+	ALLOC_HANDLE_T last_leaf();
+	void refresh_prefix(ALLOC_HANDLE_T *ahPath, int *aiPos, int iLevel,
+			    uint64_t ullPrefix);
+	uint64_t key_prefix(const char *pchKey)
+	{
+		return m_pfPrefix ? m_pfPrefix(pchKey) : 0;
+	}
+
+    public:
+	BPtree(MallocBase &stMalloc);
+	~BPtree();
+
+	const char *get_err_msg()
+	{
+		return err_message_;
+	}
+	const ALLOC_HANDLE_T Root() const
+	{
+		return root_handle_;
+	}
+	void do_attach(ALLOC_HANDLE_T hRoot)
+	{
+		root_handle_ = hRoot;
+	}
+
+	/*************************************************
+	  Description:	设置key前缀规范化函数，必须与建树时一致
+	  Input:		pfPrefix	NULL表示不使用前缀
+				isExact		前缀相等是否意味着key相等
+	*************************************************/
+	void set_key_normalizer(KeyNormalizer pfPrefix, bool isExact)
+	{
+		m_pfPrefix = pfPrefix;
+		m_bExact = pfPrefix != NULL && isExact;
+	}
+
+	/* 最近一次insert/Delete引起的节点个数变化，用于统计tree_size_ */
+	int node_delta() const
+	{
+		return node_delta_;
+	}
+
+	ALLOC_HANDLE_T first_node();
+	int depth();
+
+	int do_insert(const char *pchKey, void *pCmpCookie,
+		      KeyComparator pfComp, ALLOC_HANDLE_T hRecord,
+		      bool &isAllocNode);
+	int Delete(const char *pchKey, void *pCmpCookie, KeyComparator pfComp,
+		   bool &isFreeNode);
+	int do_find(const char *pchKey, void *pCmpCookie, KeyComparator pfComp,
+		    ALLOC_HANDLE_T &hRecord);
+	int do_find(const char *pchKey, void *pCmpCookie, KeyComparator pfComp,
+		    ALLOC_HANDLE_T *&phRecord);
+	int destory();
+	unsigned ask_for_destroy_size(void);
+
+	int traverse_forward(ItemVisit pfVisit, void *pCookie);
+	int traverse_backward(ItemVisit pfVisit, void *pCookie);
+	/* 遍历大于等于key的所有记录 */
+	int traverse_forward(const char *pchKey, void *pCmpCookie,
+			     KeyComparator pfComp, ItemVisit pfVisit,
+			     void *pCookie);
+	/* 遍历范围为[key, key1] */
+	int traverse_forward(const char *pchKey, const char *pchKey1,
+			     void *pCmpCookie, KeyComparator pfComp,
+			     ItemVisit pfVisit, void *pCookie);
+	/* 从大到小遍历小于等于key的所有记录 */
+	int traverse_backward(const char *pchKey, void *pCmpCookie,
+			      KeyComparator pfComp, ItemVisit pfVisit,
+			      void *pCookie);
+};
+
+/************************************************************
+  Description:    B+树节点。叶子节点的item为记录句柄；中间节点的item为
+                  子节点句柄，对应前缀为该子树最小key的前缀。
+                  中间节点不保存记录句柄，因为记录可能被realloc。
+  Version:         DTC 3.0
+***********************************************************/
+struct _BPtreeNode {
+	enum { ORDER = 32 }; // 每个节点最多保存多少项
+
+	ALLOC_HANDLE_T m_hPrev;
+	ALLOC_HANDLE_T m_hNext;
+	uint16_t m_ushNItems;
+	uint8_t m_chLeaf;
+	uint64_t m_aullPrefix[ORDER];
+	ALLOC_HANDLE_T m_ahItems[ORDER];
+
+	void do_init(bool isLeaf);
+	void insert_at(int i, uint64_t ullPrefix, ALLOC_HANDLE_T hItem);
+	void remove_at(int i);
+	static void destory(MallocBase &stMalloc, ALLOC_HANDLE_T hNode);
+	static unsigned ask_for_destroy_size(MallocBase &stMalloc,
+					     ALLOC_HANDLE_T hNode);
+};
+typedef struct _BPtreeNode BPtreeNode;
+
+#endif
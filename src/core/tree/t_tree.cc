@@ -18,6 +18,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <ctype.h>
 #include "log/log.h"
 #include "t_tree.h"
 #include "value.h"
@@ -175,6 +176,141 @@ int Visit(MallocBase &stMalloc, ALLOC_HANDLE_T &hRecord, void *pCookie)
 	return 0;
 }
 
+#define RECORD_INDEX_KEY(stMalloc, h)                                          \
+	(reinterpret_cast<char *>(stMalloc.handle_to_ptr(h)) +                 \
+	 sizeof(unsigned char) * 2 + 2 * sizeof(uint32_t))
+
+template <class T>
+static int64_t key_compare_signed(const char *pchKey, void *pCmpCookie,
+				  MallocBase &stMalloc,
+				  ALLOC_HANDLE_T hOtherKey)
+{
+	int64_t skey = reinterpret_cast<const DTCValue *>(pchKey)->s64;
+	int64_t sotherKey = *(T *)RECORD_INDEX_KEY(stMalloc, hOtherKey);
+	return skey < sotherKey ? -1 : (skey > sotherKey ? 1 : 0);
+}
+
+template <class T>
+static int64_t key_compare_unsigned(const char *pchKey, void *pCmpCookie,
+				    MallocBase &stMalloc,
+				    ALLOC_HANDLE_T hOtherKey)
+{
+	uint64_t ukey = reinterpret_cast<const DTCValue *>(pchKey)->u64;
+	uint64_t uotherKey = *(T *)RECORD_INDEX_KEY(stMalloc, hOtherKey);
+	return ukey < uotherKey ? -1 : (ukey > uotherKey ? 1 : 0);
+}
+
+template <class T>
+static int64_t key_compare_float(const char *pchKey, void *pCmpCookie,
+				 MallocBase &stMalloc, ALLOC_HANDLE_T hOtherKey)
+{
+	double dkey = reinterpret_cast<const DTCValue *>(pchKey)->flt;
+	double sKey = dkey - *(T *)RECORD_INDEX_KEY(stMalloc, hOtherKey);
+	if (sKey > -0.0001 && sKey < 0.0001)
+		return 0;
+	return sKey < 0 ? -1 : 1;
+}
+
+template <int (*CMP)(const char *, const char *, size_t)>
+static int64_t key_compare_bin(const char *pchKey, void *pCmpCookie,
+			       MallocBase &stMalloc, ALLOC_HANDLE_T hOtherKey)
+{
+	const DTCValue *value = reinterpret_cast<const DTCValue *>(pchKey);
+	const char *pOtherKey = RECORD_INDEX_KEY(stMalloc, hOtherKey);
+	int keyLen = value->bin.len;
+	int tKeyLen = *(int *)pOtherKey;
+
+	if (keyLen == 0 || tKeyLen == 0)
+		return keyLen == tKeyLen ? 0 : (keyLen == 0 ? -1 : 1);
+
+	int len = keyLen < tKeyLen ? keyLen : tKeyLen;
+	int res = CMP(value->bin.ptr, pOtherKey + sizeof(int), len);
+	if (res != 0 || keyLen == tKeyLen)
+		return res;
+	return keyLen > tKeyLen ? 1 : -1;
+}
+
+static int memcmp_bin(const char *p, const char *q, size_t n)
+{
+	return memcmp(p, q, n);
+}
+
+static uint64_t key_prefix_signed(const char *pchKey)
+{
+	return (uint64_t)reinterpret_cast<const DTCValue *>(pchKey)->s64 ^
+	       0x8000000000000000ULL;
+}
+
+static uint64_t key_prefix_unsigned(const char *pchKey)
+{
+	return reinterpret_cast<const DTCValue *>(pchKey)->u64;
+}
+
+/* 大端序取前8字节，strncasecmp遇'\0'即止，所以字符串前缀也在'\0'处截断 */
+template <bool CASE_INSENSITIVE>
+static uint64_t key_prefix_bin(const char *pchKey)
+{
+	const DTCValue *value = reinterpret_cast<const DTCValue *>(pchKey);
+	uint64_t prefix = 0;
+	int len = value->bin.len < 8 ? value->bin.len : 8;
+	for (int i = 0; i < len; i++) {
+		unsigned char c = value->bin.ptr[i];
+		if (CASE_INSENSITIVE) {
+			if (c == '\0')
+				break;
+			c = tolower(c);
+		}
+		prefix |= (uint64_t)c << (56 - 8 * i);
+	}
+	return prefix;
+}
+
+static const TreeKeyOps s_key_ops_s32 = { key_compare_signed<int32_t>,
+					  key_prefix_signed, true };
+static const TreeKeyOps s_key_ops_s64 = { key_compare_signed<int64_t>,
+					  key_prefix_signed, true };
+static const TreeKeyOps s_key_ops_u32 = { key_compare_unsigned<uint32_t>,
+					  key_prefix_unsigned, true };
+static const TreeKeyOps s_key_ops_u64 = { key_compare_unsigned<uint64_t>,
+					  key_prefix_unsigned, true };
+static const TreeKeyOps s_key_ops_flt = { key_compare_float<float>, NULL,
+					  false };
+static const TreeKeyOps s_key_ops_dbl = { key_compare_float<double>, NULL,
+					  false };
+static const TreeKeyOps s_key_ops_str = { key_compare_bin<strncasecmp>,
+					  key_prefix_bin<true>, false };
+static const TreeKeyOps s_key_ops_bin = { key_compare_bin<memcmp_bin>,
+					  key_prefix_bin<false>, false };
+static const TreeKeyOps s_key_ops_generic = { KeyCompare, NULL, false };
+
+const TreeKeyOps *select_tree_key_ops(const DTCTableDefinition *pstTab,
+				      int idx)
+{
+	if (pstTab == NULL)
+		return &s_key_ops_generic;
+
+	switch (pstTab->field_type(idx)) {
+	case DField::Signed:
+		return pstTab->field_size(idx) > (int)sizeof(int32_t) ?
+			       &s_key_ops_s64 :
+			       &s_key_ops_s32;
+	case DField::Unsigned:
+		return pstTab->field_size(idx) > (int)sizeof(uint32_t) ?
+			       &s_key_ops_u64 :
+			       &s_key_ops_u32;
+	case DField::Float:
+		return pstTab->field_size(idx) > (int)sizeof(float) ?
+			       &s_key_ops_dbl :
+			       &s_key_ops_flt;
+	case DField::String:
+		return &s_key_ops_str;
+	case DField::Binary:
+		return &s_key_ops_bin;
+	default:
+		return &s_key_ops_generic;
+	}
+}
+
 int _TtreeNode::do_init()
 {
 	m_hLeft = INVALID_HANDLE;
@@ -30,6 +30,26 @@ typedef int64_t (*KeyComparator)(const char *pchKey, void *pCmpCookie,
 typedef int (*ItemVisit)(MallocBase &stMalloc, ALLOC_HANDLE_T &hRecord,
 			 void *pCookie);
 
+/* 把查询key转换成可直接比较大小的64位前缀，用于B+树节点内联保存 */
+typedef uint64_t (*KeyNormalizer)(const char *pchKey);
+
+/************************************************************
+  Description:    按索引字段类型特化的比较函数，加载表定义时选定一次，
+                  避免每次比较都重新判断field_type/field_size。
+                  只用于B+树：特化比较与KeyCompare对相差不足1的浮点数、
+                  溢出的整数差排序不同，T树仍用KeyCompare
+  Version:         DTC 3.0
+***********************************************************/
+typedef struct _TreeKeyOps {
+	KeyComparator m_pfComp;
+	KeyNormalizer m_pfPrefix; // NULL表示前缀不可用(如Float带误差比较)
+	bool m_bExact; // 前缀相等即key相等，无需回表比较
+} TreeKeyOps;
+
+class DTCTableDefinition;
+const TreeKeyOps *select_tree_key_ops(const DTCTableDefinition *pstTab,
+				      int idx);
+
 class Ttree {
     protected:
 	ALLOC_HANDLE_T root_handle_;
@@ -82,9 +82,14 @@
 		offset_ += s;                                                  \
 	} while (0)
 
-TreeData::TreeData(MallocBase *pstMalloc) : t_tree_(*pstMalloc)
+TreeData::TreeData(MallocBase *pstMalloc)
+	: t_tree_(*pstMalloc), bp_tree_(*pstMalloc)
 {
 	p_tree_root_ = NULL;
+	use_bp_tree_ = false;
+	key_ops_ = select_tree_key_ops(NULL, TTREE_INDEX_POS);
+	key_ops_table_ = NULL;
+	key_comp_ = key_ops_->m_pfComp;
 	index_depth_ = 0;
 	need_new_bufer_size = 0;
 	key_size_ = 0;
@@ -133,8 +138,12 @@ int TreeData::do_init(uint8_t uchKeyIdx, int iKeySize, const char *pchKey,
 	_root_size = mallocator_->chunk_size(handle_);
 
 	p_tree_root_ = Pointer<RootData>();
+	use_bp_tree_ = p_table_ != NULL &&
+		       p_table_->index_tree_type() == INDEX_TREE_BPTREE;
 	p_tree_root_->data_type_ =
-		((table_index_ << 7) & 0x80) + DATA_TYPE_TREE_ROOT;
+		((table_index_ << 7) & 0x80) +
+		(use_bp_tree_ ? TREE_INDEX_BPTREE_FLAG : 0) +
+		DATA_TYPE_TREE_ROOT;
 	p_tree_root_->tree_size_ = 0;
 	p_tree_root_->total_raw_size_ = 0;
 	p_tree_root_->node_count_ = 0;
@@ -164,6 +173,8 @@ int TreeData::do_init(uint8_t uchKeyIdx, int iKeySize, const char *pchKey,
 	}
 
 	t_tree_.do_attach(INVALID_HANDLE);
+	bp_tree_.do_attach(INVALID_HANDLE);
+	resolve_key_ops();
 
 	return (0);
 }
@@ -208,7 +219,7 @@ int TreeData::do_attach(MEM_HANDLE_T hHandle, uint8_t uchKeyIdx, int iKeySize,
 
 	unsigned char uchType;
 	uchType = p_tree_root_->data_type_;
-	if (unlikely((uchType & 0x7f) != DATA_TYPE_TREE_ROOT)) {
+	if (unlikely((uchType & TREE_DATA_TYPE_MASK) != DATA_TYPE_TREE_ROOT)) {
 		snprintf(err_message_, sizeof(err_message_),
 			 "invalid data type: %u", uchType);
 		return (-2);
@@ -222,11 +233,118 @@ int TreeData::do_attach(MEM_HANDLE_T hHandle, uint8_t uchKeyIdx, int iKeySize,
 	m_iLAId = laid;
 	m_iLCmodId = lcmodid;
 
-	t_tree_.do_attach(p_tree_root_->root_handle_);
+	use_bp_tree_ = (uchType & TREE_INDEX_BPTREE_FLAG) != 0;
+	if (use_bp_tree_)
+		bp_tree_.do_attach(p_tree_root_->root_handle_);
+	else
+		t_tree_.do_attach(p_tree_root_->root_handle_);
+	resolve_key_ops();
 
 	return (0);
 }
 
+void TreeData::resolve_key_ops()
+{
+	if (!use_bp_tree_) {
+		/* T树沿用KeyCompare的顺序，共享内存中已有的T树按它建成 */
+		key_ops_ = select_tree_key_ops(NULL, TTREE_INDEX_POS);
+		key_ops_table_ = NULL;
+	} else if (p_table_ != NULL && p_table_ != key_ops_table_) {
+		key_ops_ = select_tree_key_ops(p_table_, TTREE_INDEX_POS);
+		key_ops_table_ = p_table_;
+	}
+	key_comp_ = key_ops_->m_pfComp;
+	bp_tree_.set_key_normalizer(key_ops_->m_pfPrefix, key_ops_->m_bExact);
+}
+
+int TreeData::index_insert(const char *pchKey, void *pCmpCookie,
+			   KeyComparator pfComp, ALLOC_HANDLE_T hRecord)
+{
+	int iRet;
+	bool isAllocNode = false;
+
+	if (use_bp_tree_) {
+		iRet = bp_tree_.do_insert(pchKey, pCmpCookie, pfComp, hRecord,
+					  isAllocNode);
+		if (iRet == 0)
+			p_tree_root_->tree_size_ +=
+				bp_tree_.node_delta() * sizeof(BPtreeNode);
+	} else {
+		iRet = t_tree_.do_insert(pchKey, pCmpCookie, pfComp, hRecord,
+					 isAllocNode);
+		if (iRet == 0 && isAllocNode)
+			p_tree_root_->tree_size_ += sizeof(TtreeNode);
+	}
+	return iRet;
+}
+
+int TreeData::index_delete(const char *pchKey, void *pCmpCookie,
+			   KeyComparator pfComp)
+{
+	int iRet;
+	bool isFreeNode = false;
+
+	if (use_bp_tree_) {
+		iRet = bp_tree_.Delete(pchKey, pCmpCookie, pfComp, isFreeNode);
+		if (iRet == 0)
+			p_tree_root_->tree_size_ +=
+				bp_tree_.node_delta() * sizeof(BPtreeNode);
+	} else {
+		iRet = t_tree_.Delete(pchKey, pCmpCookie, pfComp, isFreeNode);
+		if (iRet == 0 && isFreeNode)
+			p_tree_root_->tree_size_ -= sizeof(TtreeNode);
+	}
+	return iRet;
+}
+
+int TreeData::index_find(const char *pchKey, void *pCmpCookie,
+			 KeyComparator pfComp, ALLOC_HANDLE_T *&phRecord)
+{
+	if (use_bp_tree_)
+		return bp_tree_.do_find(pchKey, pCmpCookie, pfComp, phRecord);
+	return t_tree_.do_find(pchKey, pCmpCookie, pfComp, phRecord);
+}
+
+int TreeData::index_traverse_forward(ItemVisit pfVisit, void *pCookie)
+{
+	if (use_bp_tree_)
+		return bp_tree_.traverse_forward(pfVisit, pCookie);
+	return t_tree_.traverse_forward(pfVisit, pCookie);
+}
+
+int TreeData::index_traverse_forward(const char *pchKey, void *pCmpCookie,
+				     KeyComparator pfComp, ItemVisit pfVisit,
+				     void *pCookie)
+{
+	if (use_bp_tree_)
+		return bp_tree_.traverse_forward(pchKey, pCmpCookie, pfComp,
+						 pfVisit, pCookie);
+	return t_tree_.traverse_forward(pchKey, pCmpCookie, pfComp, pfVisit,
+					pCookie);
+}
+
+int TreeData::index_traverse_forward(const char *pchKey, const char *pchKey1,
+				     void *pCmpCookie, KeyComparator pfComp,
+				     ItemVisit pfVisit, void *pCookie)
+{
+	if (use_bp_tree_)
+		return bp_tree_.traverse_forward(pchKey, pchKey1, pCmpCookie,
+						 pfComp, pfVisit, pCookie);
+	return t_tree_.traverse_forward(pchKey, pchKey1, pCmpCookie, pfComp,
+					pfVisit, pCookie);
+}
+
+int TreeData::index_traverse_backward(const char *pchKey, void *pCmpCookie,
+				      KeyComparator pfComp, ItemVisit pfVisit,
+				      void *pCookie)
+{
+	if (use_bp_tree_)
+		return bp_tree_.traverse_backward(pchKey, pCmpCookie, pfComp,
+						  pfVisit, pCookie);
+	return t_tree_.traverse_backward(pchKey, pCmpCookie, pfComp, pfVisit,
+					 pCookie);
+}
+
 int TreeData::do_attach(MEM_HANDLE_T hHandle)
 {
 	handle_ = hHandle;
@@ -337,14 +455,10 @@ int TreeData::insert_sub_tree(uint8_t uchCondIdxCnt,
 		return (-100);
 	}
 
-	bool isAllocNode = false;
 	DTCValue value = stCondition[TTREE_INDEX_POS];
 	char *indexKey = reinterpret_cast<char *>(&value);
 	CmpCookie cookie(p_table_, uchCondIdxCnt);
-	iRet = t_tree_.do_insert(indexKey, &cookie, pfComp, hRoot, isAllocNode);
-	if (iRet == 0 && isAllocNode) {
-		p_tree_root_->tree_size_ += sizeof(TtreeNode);
-	}
+	iRet = index_insert(indexKey, &cookie, pfComp, hRoot);
 	return iRet;
 }
 
@@ -361,7 +475,7 @@ int TreeData::do_find(uint8_t uchCondIdxCnt, const RowValue &stCondition,
 	DTCValue value = stCondition[TTREE_INDEX_POS];
 	char *indexKey = reinterpret_cast<char *>(&value);
 	CmpCookie cookie(p_table_, uchCondIdxCnt);
-	iRet = t_tree_.do_find(indexKey, &cookie, pfComp, hRecord);
+	iRet = index_find(indexKey, &cookie, pfComp, hRecord);
 	return iRet;
 }
 
@@ -406,7 +520,7 @@ int TreeData::insert_row_flag(const RowValue &stRow, KeyComparator pfComp,
 		if (iRet != 0) {
 			snprintf(err_message_, sizeof(err_message_),
 				 "insert error");
-			need_new_bufer_size = sizeof(TtreeNode);
+			need_new_bufer_size = index_insert_size();
 			mallocator_->Free(hRecord);
 			goto ERROR_INSERT_RET;
 		}
@@ -437,7 +551,7 @@ int TreeData::insert_row_flag(const RowValue &stRow, KeyComparator pfComp,
 	*(uint32_t *)(p_content_ + sizeof(unsigned char)) = offset_;
 	*(uint32_t *)(p_content_ + sizeof(unsigned char) + sizeof(uint32_t)) =
 		rowCnt + 1;
-	p_tree_root_->root_handle_ = t_tree_.Root();
+	p_tree_root_->root_handle_ = index_root();
 	p_tree_root_->row_count_ += 1;
 	p_tree_root_->total_raw_size_ += trowSize;
 
@@ -474,7 +588,10 @@ int TreeData::destory()
 			 mallocator_->get_err_msg());
 		return (-1);
 	}
-	t_tree_.destory();
+	if (use_bp_tree_)
+		bp_tree_.destory();
+	else
+		t_tree_.destory();
 	mallocator_->Free(handle_);
 
 	handle_ = INVALID_HANDLE;
@@ -493,7 +610,7 @@ int TreeData::copy_raw_all(RawData *new_data)
 	MEM_HANDLE_T pCookie[totalNodeCnt];
 	resCookie.p_handle = pCookie;
 	resCookie.need_find_node_count = 0;
-	iRet = t_tree_.traverse_forward(Visit, &resCookie);
+	iRet = index_traverse_forward(Visit, &resCookie);
 	if (iRet != 0) {
 		snprintf(err_message_, sizeof(err_message_),
 			 " traverse tree-data rows error:%d", iRet);
@@ -541,7 +658,7 @@ int TreeData::copy_tree_all(RawData *new_data)
 			return (-1);
 		}
 
-		iRet = insert_row(stOldRow, KeyCompare, false);
+		iRet = insert_row(stOldRow, key_comp_, false);
 		if (iRet == EC_NO_MEM) {
 			/*这里为了下次完全重新建立T树，把未建立完的树全部删除*/
 			need_new_bufer_size =
@@ -638,7 +755,7 @@ int TreeData::compare_tree_data(RowValue *stpNodeRow)
 			stpNodeRow->field_value(TTREE_INDEX_POS));
 		CmpCookie cookie(p_table_, TTREE_INDEX_POS);
 		int iRet =
-			t_tree_.do_find(indexKey, &cookie, KeyCompare, pRecord);
+			index_find(indexKey, &cookie, key_comp_, pRecord);
 		if (iRet == -100)
 			return iRet;
 		if (pRecord != NULL) {
@@ -670,7 +787,7 @@ int TreeData::compare_tree_data(RowValue *stpNodeRow)
 		MEM_HANDLE_T pCookie[rowCnt];
 		resCookie.p_handle = pCookie;
 		resCookie.need_find_node_count = 0;
-		if (t_tree_.traverse_forward(Visit, &resCookie) != 0) {
+		if (index_traverse_forward(Visit, &resCookie) != 0) {
 			snprintf(err_message_, sizeof(err_message_),
 				 " traverse tree-data rows error");
 			return (-1);
@@ -745,13 +862,13 @@ int TreeData::replace_tree_data(DTCJobOperation &job_op, Node *p_node,
 		DTCValue new_value = (*stpTaskRow)[TTREE_INDEX_POS];
 		char *NewIndex = reinterpret_cast<char *>(&new_value);
 		CmpCookie cookie(p_table_, TTREE_INDEX_POS);
-		if (KeyCompare(NewIndex, &cookie, *mallocator_, p_record_) !=
+		if (key_comp_(NewIndex, &cookie, *mallocator_, p_record_) !=
 		    0) //Index字段变更
 		{
 			char *tmp_pchContent = p_content_;
 			uint32_t tmp_size = size_;
 			ALLOC_SIZE_T tmp_uiOffset = offset_;
-			iRet = insert_row(*stpTaskRow, KeyCompare, m_async);
+			iRet = insert_row(*stpTaskRow, key_comp_, m_async);
 			p_content_ = tmp_pchContent;
 			size_ = tmp_size;
 			offset_ = tmp_uiOffset;
@@ -778,7 +895,6 @@ int TreeData::replace_tree_data(DTCJobOperation &job_op, Node *p_node,
 					    0) //RowFormat上的内容已删光
 				{
 					//删除tree node
-					bool isFreeNode = false;
 					DTCValue value = (stOldRow)
 						[TTREE_INDEX_POS]; //for轮询的最后一行数据
 					char *indexKey =
@@ -786,10 +902,9 @@ int TreeData::replace_tree_data(DTCJobOperation &job_op, Node *p_node,
 							&value);
 					CmpCookie cookie(p_table_,
 							 TTREE_INDEX_POS);
-					int iret = t_tree_.Delete(indexKey,
+					int iret = index_delete(indexKey,
 								  &cookie,
-								  KeyCompare,
-								  isFreeNode);
+								  key_comp_);
 					if (iret != 0) {
 						snprintf(
 							err_message_,
@@ -798,13 +913,10 @@ int TreeData::replace_tree_data(DTCJobOperation &job_op, Node *p_node,
 							iret);
 						return -4;
 					}
-					if (isFreeNode)
-						p_tree_root_->tree_size_ -=
-							sizeof(TtreeNode);
 					p_tree_root_->tree_size_ -= size_;
 					p_tree_root_->node_count_--;
 					p_tree_root_->root_handle_ =
-						t_tree_.Root();
+						index_root();
 					//释放handle
 					mallocator_->Free(p_record_);
 				}
@@ -813,7 +925,7 @@ int TreeData::replace_tree_data(DTCJobOperation &job_op, Node *p_node,
 		{
 			MEM_HANDLE_T *pRawHandle = NULL;
 			int iRet = do_find(TTREE_INDEX_POS, *stpNodeRow,
-					   KeyCompare, pRawHandle);
+					   key_comp_, pRawHandle);
 			if (iRet == -100 || iRet == 0)
 				return iRet;
 
@@ -874,7 +986,7 @@ int TreeData::replace_sub_raw_data(DTCJobOperation &job_op,
 			continue;
 
 		MEM_HANDLE_T *pRawHandle = NULL;
-		int iRet = do_find(TTREE_INDEX_POS, *stpCurRow, KeyCompare,
+		int iRet = do_find(TTREE_INDEX_POS, *stpCurRow, key_comp_,
 				   pRawHandle);
 		if (iRet == -100 || iRet == 0)
 			return iRet;
@@ -890,14 +1002,14 @@ int TreeData::replace_sub_raw_data(DTCJobOperation &job_op,
 			char *NewIndex = reinterpret_cast<char *>(&new_value);
 			CmpCookie cookie(p_table_, TTREE_INDEX_POS);
 
-			if (KeyCompare(NewIndex, &cookie, *mallocator_,
+			if (key_comp_(NewIndex, &cookie, *mallocator_,
 				       hRecord) != 0) //update Index字段
 			{
 				char *tmp_pchContent = p_content_;
 				uint32_t tmp_size = size_;
 				ALLOC_SIZE_T tmp_uiOffset = offset_;
 
-				iRet = insert_row(*stpTaskRow, KeyCompare,
+				iRet = insert_row(*stpTaskRow, key_comp_,
 						  m_async);
 
 				p_content_ = tmp_pchContent;
@@ -938,23 +1050,19 @@ int TreeData::replace_sub_raw_data(DTCJobOperation &job_op,
 	    uiTotalRows - iDelete == 0) //RowFormat上的内容已删光
 	{
 		//删除tree node
-		bool isFreeNode = false;
 		DTCValue value =
 			(*stpCurRow)[TTREE_INDEX_POS]; //for轮询的最后一行数据
 		char *indexKey = reinterpret_cast<char *>(&value);
 		CmpCookie cookie(p_table_, TTREE_INDEX_POS);
-		int iret = t_tree_.Delete(indexKey, &cookie, KeyCompare,
-					  isFreeNode);
+		int iret = index_delete(indexKey, &cookie, key_comp_);
 		if (iret != 0) {
 			snprintf(err_message_, sizeof(err_message_),
 				 "delete stTree failed:%d", iret);
 			return -4;
 		}
-		if (isFreeNode)
-			p_tree_root_->tree_size_ -= sizeof(TtreeNode);
 		p_tree_root_->tree_size_ -= size_;
 		p_tree_root_->node_count_--;
-		p_tree_root_->root_handle_ = t_tree_.Root();
+		p_tree_root_->root_handle_ = index_root();
 		//释放handle
 		mallocator_->Free(hRecord);
 	}
@@ -1035,7 +1143,7 @@ int TreeData::update_sub_raw_data(DTCJobOperation &job_op, MEM_HANDLE_T hRecord)
 			continue;
 
 		MEM_HANDLE_T *pRawHandle = NULL;
-		int iRet = do_find(TTREE_INDEX_POS, *stpCurRow, KeyCompare,
+		int iRet = do_find(TTREE_INDEX_POS, *stpCurRow, key_comp_,
 				   pRawHandle);
 		if (iRet == -100 || iRet == 0)
 			return iRet;
@@ -1050,14 +1158,14 @@ int TreeData::update_sub_raw_data(DTCJobOperation &job_op, MEM_HANDLE_T hRecord)
 		char *NewIndex = reinterpret_cast<char *>(&new_value);
 		CmpCookie cookie(p_table_, TTREE_INDEX_POS);
 
-		if (KeyCompare(NewIndex, &cookie, *mallocator_, hRecord) !=
+		if (key_comp_(NewIndex, &cookie, *mallocator_, hRecord) !=
 		    0) //update Index字段
 		{
 			char *tmp_pchContent = p_content_;
 			uint32_t tmp_size = size_;
 			ALLOC_SIZE_T tmp_uiOffset = offset_;
 
-			iRet = insert_row(*stpTaskRow, KeyCompare, m_async);
+			iRet = insert_row(*stpTaskRow, key_comp_, m_async);
 
 			p_content_ = tmp_pchContent;
 			size_ = tmp_size;
@@ -1103,23 +1211,19 @@ int TreeData::update_sub_raw_data(DTCJobOperation &job_op, MEM_HANDLE_T hRecord)
 	    uiTotalRows - iDelete == 0) //RowFormat上的内容已删光
 	{
 		//删除tree node
-		bool isFreeNode = false;
 		DTCValue value =
 			(*stpCurRow)[TTREE_INDEX_POS]; //for轮询的最后一行数据
 		char *indexKey = reinterpret_cast<char *>(&value);
 		CmpCookie cookie(p_table_, TTREE_INDEX_POS);
-		int iret = t_tree_.Delete(indexKey, &cookie, KeyCompare,
-					  isFreeNode);
+		int iret = index_delete(indexKey, &cookie, key_comp_);
 		if (iret != 0) {
 			snprintf(err_message_, sizeof(err_message_),
 				 "delete stTree failed:%d", iret);
 			return -4;
 		}
-		if (isFreeNode)
-			p_tree_root_->tree_size_ -= sizeof(TtreeNode);
 		p_tree_root_->tree_size_ -= size_;
 		p_tree_root_->node_count_--;
-		p_tree_root_->root_handle_ = t_tree_.Root();
+		p_tree_root_->root_handle_ = index_root();
 		//释放handle
 		mallocator_->Free(hRecord);
 	}
@@ -1188,24 +1292,20 @@ int TreeData::delete_sub_raw_data(DTCJobOperation &job_op, MEM_HANDLE_T hRecord)
 		 uiTotalRows > 0) //RowFormat上的内容已删光
 	{
 		//删除tree node
-		bool isFreeNode = false;
 		DTCValue value =
 			(*stpNodeRow)[TTREE_INDEX_POS]; //for轮询的最后一行数据
 		char *indexKey = reinterpret_cast<char *>(&value);
 		CmpCookie cookie(p_table_, TTREE_INDEX_POS);
-		int iret = t_tree_.Delete(indexKey, &cookie, KeyCompare,
-					  isFreeNode);
+		int iret = index_delete(indexKey, &cookie, key_comp_);
 		if (iret != 0) {
 			snprintf(err_message_, sizeof(err_message_),
 				 "delete stTree failed:%d\t%s", iret,
-				 t_tree_.get_err_msg());
+				 index_err_msg());
 			return -4;
 		}
-		if (isFreeNode)
-			p_tree_root_->tree_size_ -= sizeof(TtreeNode);
 		p_tree_root_->tree_size_ -= size_;
 		p_tree_root_->node_count_--;
-		p_tree_root_->root_handle_ = t_tree_.Root();
+		p_tree_root_->root_handle_ = index_root();
 		//释放handle
 		mallocator_->Free(hRecord);
 	}
@@ -1481,7 +1581,7 @@ int TreeData::get_sub_raw(DTCJobOperation &job_op, unsigned int nodeCnt,
 	else
 		resCookie.need_find_node_count = 0;
 
-	t_tree_.traverse_forward(Visit, &resCookie);
+	index_traverse_forward(Visit, &resCookie);
 
 	if (isAsc) //升序
 	{
@@ -1541,7 +1641,7 @@ int TreeData::match_index_condition(DTCJobOperation &job_op,
 			condition->field_value(firstEQIndex));
 		CmpCookie cookie(p_table_, TTREE_INDEX_POS);
 		int iRet =
-			t_tree_.do_find(indexKey, &cookie, KeyCompare, pRecord);
+			index_find(indexKey, &cookie, key_comp_, pRecord);
 		if (iRet == -100)
 			return iRet;
 		if (pRecord != NULL) {
@@ -1582,8 +1682,8 @@ int TreeData::match_index_condition(DTCJobOperation &job_op,
 				condition->field_value(leftId));
 			CmpCookie cookie(p_table_, TTREE_INDEX_POS);
 
-			if (t_tree_.traverse_forward(indexKey, &cookie,
-						     KeyCompare, Visit,
+			if (index_traverse_forward(indexKey, &cookie,
+						     key_comp_, Visit,
 						     &resCookie) != 0) {
 				snprintf(err_message_, sizeof(err_message_),
 					 " traverse tree-data rows error");
@@ -1619,8 +1719,8 @@ int TreeData::match_index_condition(DTCJobOperation &job_op,
 				condition->field_value(rightId));
 			CmpCookie cookie(p_table_, TTREE_INDEX_POS);
 
-			if (t_tree_.traverse_backward(indexKey, &cookie,
-						      KeyCompare, Visit,
+			if (index_traverse_backward(indexKey, &cookie,
+						      key_comp_, Visit,
 						      &resCookie) != 0) {
 				snprintf(err_message_, sizeof(err_message_),
 					 " traverse tree-data rows error");
@@ -1658,8 +1758,8 @@ int TreeData::match_index_condition(DTCJobOperation &job_op,
 				condition->field_value(rightId));
 			CmpCookie cookie(p_table_, TTREE_INDEX_POS);
 
-			if (t_tree_.traverse_forward(beginKey, endKey, &cookie,
-						     KeyCompare, Visit,
+			if (index_traverse_forward(beginKey, endKey, &cookie,
+						     key_comp_, Visit,
 						     &resCookie) != 0) {
 				snprintf(err_message_, sizeof(err_message_),
 					 " traverse tree-data rows error");
@@ -1708,7 +1808,7 @@ int TreeData::get_dirty_row_count()
 
 	RowValue stRow(p_table_);
 
-	t_tree_.traverse_forward(Visit, &resCookie);
+	index_traverse_forward(Visit, &resCookie);
 
 	for (int i = 0; i < (int)resCookie.has_got_node_count; i++) {
 		p_content_ = Pointer<char>(pCookie[i]);
@@ -1753,7 +1853,7 @@ int TreeData::flush_tree_data(DTCFlushRequest *flush_req, Node *p_node,
 	resCookie.p_handle = pCookie;
 	resCookie.need_find_node_count = 0;
 
-	t_tree_.traverse_forward(Visit, &resCookie);
+	index_traverse_forward(Visit, &resCookie);
 
 	for (int i = 0; i < (int)resCookie.has_got_node_count; i++) {
 		p_content_ = Pointer<char>(pCookie[i]);
@@ -1879,7 +1979,8 @@ int TreeData::get_expire_time(DTCTableDefinition *t, uint32_t &expire)
 		return (-1);
 	}
 
-	MEM_HANDLE_T firstHanle = t_tree_.first_node();
+	MEM_HANDLE_T firstHanle = use_bp_tree_ ? bp_tree_.first_node() :
+						 t_tree_.first_node();
 	if (unlikely(firstHanle == INVALID_HANDLE)) {
 		snprintf(err_message_, sizeof(err_message_),
 			 "root tree data not init yet");
@@ -1978,7 +2079,10 @@ ALLOC_SIZE_T TreeData::calc_tree_row_size(const RowValue &stRow, int keyIdx)
 
 int TreeData::destroy_sub_tree()
 {
-	t_tree_.destory();
+	if (use_bp_tree_)
+		bp_tree_.destory();
+	else
+		t_tree_.destory();
 	p_tree_root_->row_count_ = 0;
 	p_tree_root_->root_handle_ = INVALID_HANDLE;
 	p_tree_root_->tree_size_ = 0;
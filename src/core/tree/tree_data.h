@@ -19,6 +19,7 @@
 
 #include "raw/raw_data.h"
 #include "t_tree.h"
+#include "bp_tree.h"
 #include "protocol.h"
 #include "task/task_request.h"
 #include "value.h"
@@ -35,6 +36,10 @@ typedef enum _TreeCheckResult {
 
 #define TTREE_INDEX_POS 1
 
+/* RootData::data_type_的第6位标记索引使用B+树，低6位为数据类型 */
+#define TREE_INDEX_BPTREE_FLAG 0x40
+#define TREE_DATA_TYPE_MASK 0x3f
+
 typedef TreeCheckResult (*CheckTreeFunc)(MallocBase &stMalloc,
 					 uint8_t uchIndexCnt,
 					 uint8_t uchCurIdxCnt,
@@ -119,6 +124,11 @@ class TreeData {
     private:
 	RootData *p_tree_root_; // 注意：地址可能会因为realloc而改变
 	Ttree t_tree_;
+	BPtree bp_tree_;
+	bool use_bp_tree_;
+	const TreeKeyOps *key_ops_;
+	KeyComparator key_comp_;
+	const DTCTableDefinition *key_ops_table_;
 	DTCTableDefinition *p_table_;
 	uint8_t index_depth_;
 	int table_index_;
@@ -202,6 +212,42 @@ class TreeData {
 	int encode_to_private_area(RawData &raw, RowValue &value,
 				   unsigned char value_flag);
 
+	/* 按表定义选定索引字段的比较函数，表定义不变时不重复选择 */
+	void resolve_key_ops();
+
+	/* 以下封装T树/B+树的差异，并维护tree_size_统计 */
+	/* 插入一条记录最多需要的索引空间：B+树可能逐层分裂直到新建根节点 */
+	ALLOC_SIZE_T index_insert_size()
+	{
+		return use_bp_tree_ ? (bp_tree_.depth() + 1) * sizeof(BPtreeNode) :
+				      sizeof(TtreeNode);
+	}
+	ALLOC_HANDLE_T index_root() const
+	{
+		return use_bp_tree_ ? bp_tree_.Root() : t_tree_.Root();
+	}
+	int index_insert(const char *pchKey, void *pCmpCookie,
+			 KeyComparator pfComp, ALLOC_HANDLE_T hRecord);
+	int index_delete(const char *pchKey, void *pCmpCookie,
+			 KeyComparator pfComp);
+	int index_find(const char *pchKey, void *pCmpCookie,
+		       KeyComparator pfComp, ALLOC_HANDLE_T *&phRecord);
+	int index_traverse_forward(ItemVisit pfVisit, void *pCookie);
+	int index_traverse_forward(const char *pchKey, void *pCmpCookie,
+				   KeyComparator pfComp, ItemVisit pfVisit,
+				   void *pCookie);
+	int index_traverse_forward(const char *pchKey, const char *pchKey1,
+				   void *pCmpCookie, KeyComparator pfComp,
+				   ItemVisit pfVisit, void *pCookie);
+	int index_traverse_backward(const char *pchKey, void *pCmpCookie,
+				    KeyComparator pfComp, ItemVisit pfVisit,
+				    void *pCookie);
+	const char *index_err_msg()
+	{
+		return use_bp_tree_ ? bp_tree_.get_err_msg() :
+				      t_tree_.get_err_msg();
+	}
+
 	inline int pack_key(const RowValue &stRow, uint8_t uchKeyIdx,
 			    int &iKeySize, char *&pchKey,
 			    unsigned char achKeyBuf[]);
@@ -249,7 +295,15 @@ class TreeData {
 
 	const MEM_HANDLE_T get_tree_root() const
 	{
-		return t_tree_.Root();
+		return index_root();
+	}
+
+	/*************************************************
+	  Description:	索引字段特化后的key比较函数
+	*************************************************/
+	KeyComparator key_comparator() const
+	{
+		return key_comp_;
 	}
 
 	/*************************************************
@@ -186,12 +186,14 @@ int TreeDataProcess::do_append(DTCJobOperation &job_op, Node *p_node,
 	}
 
 	// insert clean row
-	iRet = m_stTreeData.insert_row(*stpNodeRow, KeyCompare, isDirty);
+	iRet = m_stTreeData.insert_row(
+		*stpNodeRow, m_stTreeData.key_comparator(), isDirty);
 	if (iRet == EC_NO_MEM) {
 		if (p_buffer_pond_->try_purge_size(m_stTreeData.need_size(),
 						   *p_node) == 0)
-			iRet = m_stTreeData.insert_row(*stpNodeRow, KeyCompare,
-						       isDirty);
+			iRet = m_stTreeData.insert_row(
+				*stpNodeRow, m_stTreeData.key_comparator(),
+				isDirty);
 	}
 	if (iRet != EC_NO_MEM)
 		p_node->vd_handle() = m_stTreeData.get_handle();
@@ -460,8 +462,9 @@ int TreeDataProcess::do_replace_all(DTCJobOperation &job_op, Node *p_node)
 			}
 
 			/* 插入当前行 */
-			iRet = m_stTreeData.insert_row(*stpNodeRow, KeyCompare,
-						       false);
+			iRet = m_stTreeData.insert_row(
+				*stpNodeRow, m_stTreeData.key_comparator(),
+				false);
 
 			/* 如果内存空间不足，尝试扩大最多两次 */
 			if (iRet == EC_NO_MEM) {
@@ -475,7 +478,9 @@ int TreeDataProcess::do_replace_all(DTCJobOperation &job_op, Node *p_node)
 					    m_stTreeData.need_size(),
 					    *p_node) == 0)
 					iRet = m_stTreeData.insert_row(
-						*stpNodeRow, KeyCompare, false);
+						*stpNodeRow,
+						m_stTreeData.key_comparator(),
+						false);
 			}
 			if (iRet != EC_NO_MEM)
 				p_node->vd_handle() = m_stTreeData.get_handle();
@@ -575,13 +580,15 @@ int TreeDataProcess::do_replace(DTCJobOperation &job_op, Node *p_node,
 		stNewRow.default_value();
 		stpNewRow = &stNewRow;
 		job_op.update_row(*stpNewRow); //获取Replace的行
-		iRet = m_stTreeData.insert_row(*stpNewRow, KeyCompare,
-					       async); // 加进cache
+		iRet = m_stTreeData.insert_row(
+			*stpNewRow, m_stTreeData.key_comparator(),
+			async); // 加进cache
 		if (iRet == EC_NO_MEM) {
 			if (p_buffer_pond_->try_purge_size(
 				    m_stTreeData.need_size(), *p_node) == 0)
 				iRet = m_stTreeData.insert_row(
-					*stpNewRow, KeyCompare, async);
+					*stpNewRow,
+					m_stTreeData.key_comparator(), async);
 		}
 		if (iRet != EC_NO_MEM)
 			p_node->vd_handle() = m_stTreeData.get_handle();
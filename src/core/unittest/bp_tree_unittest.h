@@ -0,0 +1,561 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#ifndef BP_TREE_UNITTEST_H_
+#define BP_TREE_UNITTEST_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "bp_tree.h"
+#include "tree_data.h"
+#include "pt_malloc.h"
+#include "table/table_def.h"
+#include "dtc_error_code.h"
+
+#define UT_TREE_MEM_SIZE (256UL << 20)
+/* 记录头：两个字节的类型/标志加两个uint32，之后是索引key */
+#define UT_RECORD_HEAD (sizeof(unsigned char) * 2 + 2 * sizeof(uint32_t))
+#define UT_TREE_KEYS 4000
+#define UT_BENCH_KEYS 1000000
+#define UT_BENCH_RANGE 100
+
+/*
+ * 直接在一块堆内存上格式化PtMalloc建树，每次修改后遍历整棵树，
+ * 校验中间节点保存的前缀、叶子内key的顺序以及叶子链表。
+ */
+class BPtreeTest : public testing::Test {
+    protected:
+	static DTCTableDefinition *build_table(uint8_t type, int size)
+	{
+		DTCTableDefinition *tdef = new DTCTableDefinition(2);
+		tdef->set_table_name("ut_bp_tree");
+		if (tdef->add_field(0, "uid", DField::Unsigned, 4) != 0 ||
+		    tdef->add_field(TTREE_INDEX_POS, "idx", type, size) != 0 ||
+		    tdef->set_key_fields(1) < 0) {
+			delete tdef;
+			return NULL;
+		}
+		tdef->set_index_fields(1);
+		tdef->set_index_tree_type(INDEX_TREE_BPTREE);
+		tdef->build_info_cache();
+		return tdef;
+	}
+	static void SetUpTestCase()
+	{
+		signed_table_ = build_table(DField::Signed, sizeof(int64_t));
+		string_table_ = build_table(DField::String, 64);
+	}
+	static void TearDownTestCase()
+	{
+		delete signed_table_;
+		delete string_table_;
+	}
+	virtual void SetUp()
+	{
+		ASSERT_TRUE(signed_table_ != NULL);
+		ASSERT_TRUE(string_table_ != NULL);
+		mem_ = malloc(UT_TREE_MEM_SIZE);
+		ASSERT_TRUE(mem_ != NULL);
+		malloc_ = new PtMalloc();
+		ASSERT_EQ(0, malloc_->do_init(mem_, UT_TREE_MEM_SIZE))
+			<< malloc_->get_err_msg();
+		tree_ = new BPtree(*malloc_);
+		node_count_ = 0;
+		use_table(signed_table_);
+	}
+	virtual void TearDown()
+	{
+		delete tree_;
+		delete malloc_;
+		free(mem_);
+	}
+
+	void use_table(const DTCTableDefinition *tdef)
+	{
+		table_ = tdef;
+		ops_ = select_tree_key_ops(tdef, TTREE_INDEX_POS);
+		tree_->set_key_normalizer(ops_->m_pfPrefix, ops_->m_bExact);
+	}
+
+	static DTCValue signed_key(int64_t key)
+	{
+		DTCValue value;
+		value.s64 = key;
+		return value;
+	}
+	static DTCValue string_key(const std::string &key)
+	{
+		DTCValue value;
+		value.str.len = key.size();
+		value.str.ptr = const_cast<char *>(key.data());
+		return value;
+	}
+
+	ALLOC_HANDLE_T make_record(const DTCValue &value)
+	{
+		bool isString = table_->field_type(TTREE_INDEX_POS) ==
+				DField::String;
+		ALLOC_SIZE_T size = UT_RECORD_HEAD +
+				    (isString ? sizeof(int) + value.str.len :
+						sizeof(int64_t));
+		ALLOC_HANDLE_T hRecord = malloc_->Malloc(size);
+		if (hRecord == INVALID_HANDLE)
+			return hRecord;
+		char *p = malloc_->Pointer<char>(hRecord);
+		memset(p, 0, UT_RECORD_HEAD);
+		if (isString) {
+			memcpy(p + UT_RECORD_HEAD, &value.str.len, sizeof(int));
+			memcpy(p + UT_RECORD_HEAD + sizeof(int), value.str.ptr,
+			       value.str.len);
+		} else {
+			memcpy(p + UT_RECORD_HEAD, &value.s64, sizeof(int64_t));
+		}
+		return hRecord;
+	}
+
+	/* 把记录里的key还原成DTCValue，字符串指向共享内存 */
+	static DTCValue record_key(MallocBase &stMalloc,
+				   const DTCTableDefinition *tdef,
+				   ALLOC_HANDLE_T hRecord)
+	{
+		const char *p = reinterpret_cast<char *>(
+					stMalloc.handle_to_ptr(hRecord)) +
+				UT_RECORD_HEAD;
+		DTCValue value;
+		if (tdef->field_type(TTREE_INDEX_POS) == DField::String) {
+			memcpy(&value.str.len, p, sizeof(int));
+			value.str.ptr = const_cast<char *>(p + sizeof(int));
+		} else {
+			memcpy(&value.s64, p, sizeof(int64_t));
+		}
+		return value;
+	}
+
+	int insert(const DTCValue &value)
+	{
+		ALLOC_HANDLE_T hRecord = make_record(value);
+		if (hRecord == INVALID_HANDLE)
+			return -1;
+		bool isAllocNode = false;
+		int ret = tree_->do_insert((const char *)&value, NULL,
+					   ops_->m_pfComp, hRecord,
+					   isAllocNode);
+		if (ret != 0) {
+			malloc_->Free(hRecord);
+			return ret;
+		}
+		node_count_ += tree_->node_delta();
+		EXPECT_EQ(isAllocNode, tree_->node_delta() > 0);
+		return 0;
+	}
+
+	int remove(const DTCValue &value)
+	{
+		ALLOC_HANDLE_T hRecord;
+		if (tree_->do_find((const char *)&value, NULL, ops_->m_pfComp,
+				   hRecord) != 1)
+			return -1;
+		bool isFreeNode = false;
+		int ret = tree_->Delete((const char *)&value, NULL,
+					ops_->m_pfComp, isFreeNode);
+		if (ret != 0)
+			return ret;
+		malloc_->Free(hRecord);
+		node_count_ += tree_->node_delta();
+		EXPECT_EQ(isFreeNode, tree_->node_delta() < 0);
+		return 0;
+	}
+
+	bool exists(const DTCValue &value)
+	{
+		ALLOC_HANDLE_T hRecord = INVALID_HANDLE;
+		if (tree_->do_find((const char *)&value, NULL, ops_->m_pfComp,
+				   hRecord) != 1)
+			return false;
+		return ops_->m_pfComp((const char *)&value, NULL, *malloc_,
+				      hRecord) == 0;
+	}
+
+	/* 返回子树最小key的前缀，同时检查节点内的顺序 */
+	uint64_t check_node(ALLOC_HANDLE_T hNode, int depth,
+			    std::vector<ALLOC_HANDLE_T> &leaves, int &leafDepth)
+	{
+		BPtreeNode *p_node = malloc_->Pointer<BPtreeNode>(hNode);
+		EXPECT_GT(p_node->m_ushNItems, 0);
+		EXPECT_LE(p_node->m_ushNItems, BPtreeNode::ORDER);
+		counted_nodes_++;
+		for (int i = 0; i < p_node->m_ushNItems; i++) {
+			uint64_t prefix;
+			if (p_node->m_chLeaf) {
+				DTCValue value = record_key(
+					*malloc_, table_, p_node->m_ahItems[i]);
+				prefix = ops_->m_pfPrefix ?
+						 ops_->m_pfPrefix(
+							 (const char *)&value) :
+						 0;
+			} else {
+				prefix = check_node(p_node->m_ahItems[i],
+						    depth + 1, leaves,
+						    leafDepth);
+			}
+			EXPECT_EQ(prefix, p_node->m_aullPrefix[i])
+				<< "depth " << depth << " item " << i;
+			if (i > 0)
+				EXPECT_LE(p_node->m_aullPrefix[i - 1],
+					  p_node->m_aullPrefix[i]);
+		}
+		if (p_node->m_chLeaf) {
+			if (leafDepth < 0)
+				leafDepth = depth;
+			EXPECT_EQ(leafDepth, depth);
+			leaves.push_back(hNode);
+		}
+		return p_node->m_aullPrefix[0];
+	}
+
+	void check_tree(void)
+	{
+		std::vector<ALLOC_HANDLE_T> leaves;
+		int leafDepth = -1;
+		counted_nodes_ = 0;
+		if (tree_->Root() != INVALID_HANDLE)
+			check_node(tree_->Root(), 0, leaves, leafDepth);
+		EXPECT_EQ(node_count_, counted_nodes_);
+
+		for (size_t i = 0; i < leaves.size(); i++) {
+			BPtreeNode *p_node =
+				malloc_->Pointer<BPtreeNode>(leaves[i]);
+			EXPECT_EQ(i > 0 ? leaves[i - 1] : INVALID_HANDLE,
+				  p_node->m_hPrev);
+			EXPECT_EQ(i + 1 < leaves.size() ? leaves[i + 1] :
+							   INVALID_HANDLE,
+				  p_node->m_hNext);
+		}
+	}
+
+	struct Collect {
+		MallocBase *m;
+		const DTCTableDefinition *tdef;
+		std::vector<int64_t> keys;
+		std::vector<std::string> strs;
+	};
+	static int collect(MallocBase &stMalloc, ALLOC_HANDLE_T &hRecord,
+			   void *pCookie)
+	{
+		Collect *c = reinterpret_cast<Collect *>(pCookie);
+		DTCValue value = record_key(stMalloc, c->tdef, hRecord);
+		if (c->tdef->field_type(TTREE_INDEX_POS) == DField::String)
+			c->strs.push_back(
+				std::string(value.str.ptr, value.str.len));
+		else
+			c->keys.push_back(value.s64);
+		return 0;
+	}
+	Collect new_collect(void)
+	{
+		Collect c;
+		c.m = malloc_;
+		c.tdef = table_;
+		return c;
+	}
+
+	static DTCTableDefinition *signed_table_;
+	static DTCTableDefinition *string_table_;
+	void *mem_;
+	PtMalloc *malloc_;
+	BPtree *tree_;
+	const DTCTableDefinition *table_;
+	const TreeKeyOps *ops_;
+	int node_count_;
+	int counted_nodes_;
+};
+
+DTCTableDefinition *BPtreeTest::signed_table_ = NULL;
+DTCTableDefinition *BPtreeTest::string_table_ = NULL;
+
+TEST_F(BPtreeTest, InsertAndFind)
+{
+	std::vector<int64_t> keys;
+	for (int64_t k = -UT_TREE_KEYS / 2; k < UT_TREE_KEYS / 2; k++)
+		keys.push_back(k * 7);
+	srand(26);
+	std::random_shuffle(keys.begin(), keys.end());
+
+	for (size_t i = 0; i < keys.size(); i++)
+		ASSERT_EQ(0, insert(signed_key(keys[i])));
+	check_tree();
+	EXPECT_GT(tree_->depth(), 2);
+	EXPECT_EQ(EC_KEY_EXIST, insert(signed_key(keys[0])));
+
+	for (size_t i = 0; i < keys.size(); i++) {
+		EXPECT_TRUE(exists(signed_key(keys[i])));
+		EXPECT_FALSE(exists(signed_key(keys[i] + 1)));
+	}
+
+	Collect c = new_collect();
+	ASSERT_EQ(0, tree_->traverse_forward(collect, &c));
+	std::sort(keys.begin(), keys.end());
+	EXPECT_TRUE(c.keys == keys);
+
+	c.keys.clear();
+	ASSERT_EQ(0, tree_->traverse_backward(collect, &c));
+	std::reverse(c.keys.begin(), c.keys.end());
+	EXPECT_TRUE(c.keys == keys);
+}
+
+/* 倒序插入时每次都落在第一个叶子的0号位置，沿路径向上刷新前缀 */
+TEST_F(BPtreeTest, InsertDescendingRefreshesPrefix)
+{
+	for (int64_t k = UT_TREE_KEYS; k > 0; k--) {
+		ASSERT_EQ(0, insert(signed_key(k)));
+		if (k % 97 == 0)
+			check_tree();
+	}
+	check_tree();
+	for (int64_t k = 1; k <= UT_TREE_KEYS; k++)
+		EXPECT_TRUE(exists(signed_key(k)));
+	EXPECT_FALSE(exists(signed_key(0)));
+}
+
+TEST_F(BPtreeTest, RangeScan)
+{
+	for (int64_t k = 0; k < UT_TREE_KEYS; k++)
+		ASSERT_EQ(0, insert(signed_key(k * 2)));
+
+	/* [101, 301]：两端都不在树里 */
+	DTCValue lo = signed_key(101), hi = signed_key(301);
+	Collect c = new_collect();
+	ASSERT_EQ(0, tree_->traverse_forward((const char *)&lo,
+					     (const char *)&hi, NULL,
+					     ops_->m_pfComp, collect, &c));
+	ASSERT_EQ(100U, c.keys.size());
+	for (size_t i = 0; i < c.keys.size(); i++)
+		EXPECT_EQ((int64_t)(102 + 2 * i), c.keys[i]);
+
+	/* [100, 300]：两端都在树里，闭区间 */
+	lo = signed_key(100);
+	hi = signed_key(300);
+	c.keys.clear();
+	ASSERT_EQ(0, tree_->traverse_forward((const char *)&lo,
+					     (const char *)&hi, NULL,
+					     ops_->m_pfComp, collect, &c));
+	ASSERT_EQ(101U, c.keys.size());
+	EXPECT_EQ(100, c.keys.front());
+	EXPECT_EQ(300, c.keys.back());
+
+	/* 大于等于key */
+	lo = signed_key(2 * UT_TREE_KEYS - 41);
+	c.keys.clear();
+	ASSERT_EQ(0, tree_->traverse_forward((const char *)&lo, NULL,
+					     ops_->m_pfComp, collect, &c));
+	ASSERT_EQ(20U, c.keys.size());
+	EXPECT_EQ(2 * UT_TREE_KEYS - 40, c.keys.front());
+
+	/* 从大到小小于等于key */
+	hi = signed_key(39);
+	c.keys.clear();
+	ASSERT_EQ(0, tree_->traverse_backward((const char *)&hi, NULL,
+					      ops_->m_pfComp, collect, &c));
+	ASSERT_EQ(20U, c.keys.size());
+	EXPECT_EQ(38, c.keys.front());
+	EXPECT_EQ(0, c.keys.back());
+
+	/* 越过两端 */
+	lo = signed_key(-1);
+	c.keys.clear();
+	ASSERT_EQ(0, tree_->traverse_backward((const char *)&lo, NULL,
+					      ops_->m_pfComp, collect, &c));
+	EXPECT_TRUE(c.keys.empty());
+	lo = signed_key(2 * UT_TREE_KEYS);
+	ASSERT_EQ(0, tree_->traverse_forward((const char *)&lo, NULL,
+					     ops_->m_pfComp, collect, &c));
+	EXPECT_TRUE(c.keys.empty());
+}
+
+/* 删除一整段key，中间的叶子被删空回收，父节点的0号项随之删除并刷新前缀 */
+TEST_F(BPtreeTest, DeleteEmptiesLeaves)
+{
+	for (int64_t k = 0; k < UT_TREE_KEYS; k++)
+		ASSERT_EQ(0, insert(signed_key(k)));
+	int nodes = node_count_;
+
+	for (int64_t k = UT_TREE_KEYS / 4; k < UT_TREE_KEYS * 3 / 4; k++) {
+		ASSERT_EQ(0, remove(signed_key(k)));
+		if (k % 13 == 0)
+			check_tree();
+	}
+	check_tree();
+	EXPECT_LT(node_count_, nodes);
+	for (int64_t k = 0; k < UT_TREE_KEYS; k++)
+		EXPECT_EQ(k < UT_TREE_KEYS / 4 || k >= UT_TREE_KEYS * 3 / 4,
+			  exists(signed_key(k)));
+
+	/* 删空的区间可以重新插入 */
+	for (int64_t k = UT_TREE_KEYS / 2; k > UT_TREE_KEYS / 4; k--)
+		ASSERT_EQ(0, insert(signed_key(k)));
+	check_tree();
+
+	std::vector<int64_t> keys;
+	Collect c = new_collect();
+	ASSERT_EQ(0, tree_->traverse_forward(collect, &c));
+	keys.swap(c.keys);
+	srand(414);
+	std::random_shuffle(keys.begin(), keys.end());
+	for (size_t i = 0; i < keys.size(); i++) {
+		ASSERT_EQ(0, remove(signed_key(keys[i])));
+		if (i % 101 == 0)
+			check_tree();
+	}
+	EXPECT_EQ(INVALID_HANDLE, tree_->Root());
+	EXPECT_EQ(0, node_count_);
+	EXPECT_EQ(-1, remove(signed_key(0)));
+}
+
+/* 字符串前8字节相同，前缀不能区分，要回表比较；比较不区分大小写 */
+TEST_F(BPtreeTest, StringKeysSharePrefix)
+{
+	use_table(string_table_);
+	ASSERT_FALSE(ops_->m_bExact);
+
+	std::vector<std::string> keys;
+	char buf[32];
+	for (int i = 0; i < UT_TREE_KEYS; i++) {
+		snprintf(buf, sizeof(buf), "user-key-%06d", i);
+		keys.push_back(buf);
+	}
+	srand(27);
+	std::random_shuffle(keys.begin(), keys.end());
+	for (size_t i = 0; i < keys.size(); i++)
+		ASSERT_EQ(0, insert(string_key(keys[i])));
+	check_tree();
+
+	EXPECT_TRUE(exists(string_key("USER-KEY-000123")));
+	EXPECT_FALSE(exists(string_key("user-key-0001234")));
+	EXPECT_FALSE(exists(string_key("user-key")));
+
+	for (int i = 0; i < UT_TREE_KEYS; i += 2) {
+		snprintf(buf, sizeof(buf), "user-key-%06d", i);
+		ASSERT_EQ(0, remove(string_key(buf)));
+	}
+	check_tree();
+
+	std::string lo = "user-key-000100", hi = "user-key-000200";
+	DTCValue vlo = string_key(lo), vhi = string_key(hi);
+	Collect c = new_collect();
+	ASSERT_EQ(0, tree_->traverse_forward((const char *)&vlo,
+					     (const char *)&vhi, NULL,
+					     ops_->m_pfComp, collect, &c));
+	ASSERT_EQ(50U, c.strs.size());
+	EXPECT_EQ("user-key-000101", c.strs.front());
+	EXPECT_EQ("user-key-000199", c.strs.back());
+}
+
+/*
+ * T树(KeyCompare)与B+树(特化比较)在插入、点查、范围查询上的对比，
+ * 默认不运行，用--gtest_also_run_disabled_tests --gtest_filter=*Bench*执行
+ */
+static double ut_elapsed_ms(const struct timeval &begin)
+{
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	return (now.tv_sec - begin.tv_sec) * 1000.0 +
+	       (now.tv_usec - begin.tv_usec) / 1000.0;
+}
+
+static int ut_count_visit(MallocBase &stMalloc, ALLOC_HANDLE_T &hRecord,
+			  void *pCookie)
+{
+	(*reinterpret_cast<int *>(pCookie))++;
+	return 0;
+}
+
+TEST_F(BPtreeTest, DISABLED_BenchAgainstTtree)
+{
+	std::vector<int64_t> keys;
+	srand(1);
+	for (int i = 0; i < UT_BENCH_KEYS; i++)
+		keys.push_back(rand() & ((1 << 30) - 1));
+	std::vector<ALLOC_HANDLE_T> records;
+	for (int i = 0; i < UT_BENCH_KEYS; i++)
+		records.push_back(make_record(signed_key(keys[i])));
+
+	Ttree ttree(*malloc_);
+	CmpCookie cookie(table_, TTREE_INDEX_POS);
+	struct timeval begin;
+	bool isAlloc;
+	int visited;
+	/* T树把比较结果截断成int，key取[0, 2^30)；每个范围约UT_BENCH_RANGE行 */
+	int64_t width = ((int64_t)1 << 30) / UT_BENCH_KEYS * UT_BENCH_RANGE;
+
+	for (int pass = 0; pass < 2; pass++) {
+		bool bp = pass == 1;
+		const char *name = bp ? "bptree" : "ttree";
+
+		gettimeofday(&begin, NULL);
+		for (int i = 0; i < UT_BENCH_KEYS; i++) {
+			DTCValue v = signed_key(keys[i]);
+			int ret = bp ? tree_->do_insert((const char *)&v, NULL,
+							ops_->m_pfComp,
+							records[i], isAlloc) :
+				       ttree.do_insert((const char *)&v,
+						       &cookie, KeyCompare,
+						       records[i], isAlloc);
+			ASSERT_TRUE(ret == 0 || ret == EC_KEY_EXIST);
+		}
+		printf("%s insert %d keys: %.1f ms\n", name, UT_BENCH_KEYS,
+		       ut_elapsed_ms(begin));
+
+		gettimeofday(&begin, NULL);
+		int found = 0;
+		for (int i = 0; i < UT_BENCH_KEYS; i++) {
+			DTCValue v =
+				signed_key(keys[(i * 7919LL) % UT_BENCH_KEYS]);
+			ALLOC_HANDLE_T h;
+			found += bp ? tree_->do_find((const char *)&v, NULL,
+						     ops_->m_pfComp, h) :
+				      ttree.do_find((const char *)&v, &cookie,
+						    KeyCompare, h);
+		}
+		EXPECT_EQ(UT_BENCH_KEYS, found);
+		printf("%s point lookup %d keys: %.1f ms\n", name,
+		       UT_BENCH_KEYS, ut_elapsed_ms(begin));
+
+		gettimeofday(&begin, NULL);
+		visited = 0;
+		for (int i = 0; i < UT_BENCH_KEYS / 10; i++) {
+			DTCValue lo = signed_key(keys[i]);
+			DTCValue hi = signed_key(keys[i] + width);
+			if (bp)
+				tree_->traverse_forward(
+					(const char *)&lo, (const char *)&hi,
+					NULL, ops_->m_pfComp, ut_count_visit,
+					&visited);
+			else
+				ttree.traverse_forward(
+					(const char *)&lo, (const char *)&hi,
+					&cookie, KeyCompare, ut_count_visit,
+					&visited);
+		}
+		printf("%s range scan %d ranges (%d rows): %.1f ms\n", name,
+		       UT_BENCH_KEYS / 10, visited, ut_elapsed_ms(begin));
+	}
+}
+
+#endif
@@ -0,0 +1,310 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#ifndef BUFFER_POND_UNITTEST_H_
+#define BUFFER_POND_UNITTEST_H_
+
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+#include "gtest/gtest.h"
+#include "buffer_pond.h"
+#include "admission_filter.h"
+#include "raw_data.h"
+#include "dtc_global.h"
+#include "table/table_def_manager.h"
+
+#define UT_SHM_KEY 0x44540049
+#define UT_SHM_SIZE (64UL << 20)
+#define UT_SMALL_CHUNK 64
+#define UT_LARGE_CHUNK 16384
+#define UT_SMALL_NODES 8
+#define UT_TRACE_KEYS 100000 /* Zipf读的key空间 */
+#define UT_TRACE_READS 600000
+#define UT_TRACE_SCAN_EVERY 150000 /* 每隔多少次读插入一段扫描 */
+#define UT_TRACE_SCAN_KEYS 50000 /* 每段扫描的一次性key个数 */
+#define UT_TRACE_CHUNK 4096
+
+/* 4字节整数key的测试表，不依赖机器上的/etc/dtc/table.yaml */
+static const char ut_table_yaml[] =
+	"DATABASE_CONF:\n"
+	"  hot_database_name: ut_buffer_pond\n"
+	"  hot_database_number: (1,1)\n"
+	"  hot_database_max_count: 1\n"
+	"  hot_server_count: 1\n"
+	"  hot_deploy: 0\n"
+	"HOT_MACHINE1:\n"
+	"  Procs: 1\n"
+	"  WriteProcs: 1\n"
+	"  CommitProcs: 1\n"
+	"  database_index: 0\n"
+	"  database_address: 127.0.0.1:3306\n"
+	"  database_username: username\n"
+	"  database_password: password\n"
+	"HOT_TABLE_CONF:\n"
+	"  table_name: ut_buffer_pond\n"
+	"  field_count: 2\n"
+	"  key_count: 1\n"
+	"  TableNum: (1,1)\n"
+	"FIELD1:\n"
+	"  field_name: uid\n"
+	"  field_type: 1\n"
+	"  field_size: 4\n"
+	"FIELD2:\n"
+	"  field_name: value\n"
+	"  field_type: 4\n"
+	"  field_size: 255\n";
+
+/*
+ * 按buffer_replace_result的顺序回放一段读请求：命中时移到队头，缺失时
+ * 在admission_begin/admission_end之间分配节点和数据，内存不足时走
+ * try_purge_size，失败则清掉新节点，只返回结果不进cache。
+ */
+class BufferPondAdmissionTest : public testing::Test {
+    protected:
+	static void SetUpTestCase()
+	{
+		/* cache_open时会把table.yaml保存到共享内存，
+		 * load_table只接受文件 */
+		char path[] = "/tmp/ut_buffer_pond_XXXXXX";
+		int fd = mkstemp(path);
+		ASSERT_GE(fd, 0);
+		ssize_t len =
+			write(fd, ut_table_yaml, sizeof(ut_table_yaml) - 1);
+		close(fd);
+		ASSERT_EQ((ssize_t)sizeof(ut_table_yaml) - 1, len);
+		DTCTableDefinition *t =
+			TableDefinitionManager::instance()->load_table(path);
+		unlink(path);
+		ASSERT_TRUE(t != NULL);
+		ASSERT_EQ((int)sizeof(uint32_t), t->key_format());
+	}
+	virtual void SetUp()
+	{
+		open_pond();
+		ASSERT_EQ(0, filter_.init(16384, sizeof(uint32_t)));
+		pond_->set_admission_filter(&filter_);
+	}
+	virtual void TearDown()
+	{
+		close_pond();
+	}
+
+	void open_pond(void)
+	{
+		remove_shm();
+		DTCGlobal::pre_alloc_nodegroup_count = 1;
+
+		BlockProperties info;
+		memset(&info, 0, sizeof(info));
+		info.init(sizeof(uint32_t), UT_SHM_SIZE, 4);
+		info.ipc_mem_key = UT_SHM_KEY;
+		info.sync_update = 1;
+		pond_ = new BufferPond();
+		ASSERT_EQ(0, pond_->cache_open(&info)) << pond_->error();
+	}
+	void close_pond(void)
+	{
+		delete pond_;
+		pond_ = NULL;
+		PtMalloc::destroy();
+		remove_shm();
+	}
+
+	static void remove_shm(void)
+	{
+		SharedMemory shm;
+		if (shm.mem_open(UT_SHM_KEY) > 0)
+			shm.mem_delete();
+	}
+
+	/* 不经过准入判断直接填充，用于构造淘汰队列 */
+	bool fill(uint32_t key, unsigned size)
+	{
+		const char *k = (const char *)&key;
+		Node node = pond_->cache_allocation(k);
+		if (!node)
+			return false;
+		RawData raw(PtMalloc::instance());
+		if (raw.init(0, sizeof(key), k, size, -1, -1, 0) != 0) {
+			pond_->cache_purge(k);
+			return false;
+		}
+		node.vd_handle() = raw.get_handle();
+		pond_->inc_total_row(1);
+		return true;
+	}
+
+	/* 回放一次读，返回1命中，0缺失后回填，-1缺失但未进cache；
+	 * admission_为本次回填的准入结果 */
+	int replay(uint32_t key, unsigned size)
+	{
+		const char *k = (const char *)&key;
+		filter_.touch(k);
+		Node hit = pond_->cache_find(k, 0);
+		if (!(!hit)) {
+			/* 命中时移到clean lru队头，同transaction_update_lru */
+			NGInfo::instance()->remove_from_lru(hit);
+			NGInfo::instance()->insert_to_clean_lru(hit);
+			return 1;
+		}
+
+		pond_->admission_begin(k);
+		Node node = pond_->cache_allocation(k);
+		if (!node) {
+			admission_ = pond_->admission_end();
+			return -1;
+		}
+		RawData raw(PtMalloc::instance());
+		int ret = raw.init(0, sizeof(key), k, size, -1, -1, 0);
+		if (ret == EC_NO_MEM &&
+		    pond_->try_purge_size(raw.need_size(), node) == 0)
+			ret = raw.init(0, sizeof(key), k, size, -1, -1, 0);
+		admission_ = pond_->admission_end();
+		if (ret != 0) {
+			pond_->cache_purge(k);
+			return -1;
+		}
+		node.vd_handle() = raw.get_handle();
+		pond_->inc_total_row(1);
+		return 0;
+	}
+
+	/*
+	 * clean lru队尾放几个小节点，之后用大节点把内存填满，
+	 * 再读几轮让这些key都成为热key
+	 */
+	void fill_hot_keys(void)
+	{
+		uint32_t key = 1;
+		for (; key <= UT_SMALL_NODES; key++)
+			ASSERT_TRUE(fill(key, UT_SMALL_CHUNK));
+		while (fill(key, UT_LARGE_CHUNK))
+			key++;
+		hot_keys_ = key - 1;
+		ASSERT_GT(hot_keys_, (uint32_t)UT_SMALL_NODES);
+
+		for (int round = 0; round < 4; round++)
+			for (uint32_t k = 1; k <= hot_keys_; k++)
+				ASSERT_EQ(1, replay(k, UT_LARGE_CHUNK));
+	}
+
+	/*
+	 * Zipf(0.9)读，每UT_TRACE_SCAN_EVERY次读后插入一段一次性key的扫描，
+	 * 每个请求后做一次延迟淘汰。返回第一段扫描之后Zipf读的命中率。
+	 */
+	double replay_trace(void)
+	{
+		std::vector<double> cdf(UT_TRACE_KEYS);
+		double sum = 0;
+		for (unsigned i = 0; i < UT_TRACE_KEYS; i++) {
+			sum += 1 / pow(i + 1, 0.9);
+			cdf[i] = sum;
+		}
+
+		srandom(20210);
+		uint32_t scan_key = 0x10000000;
+		unsigned reads = 0, hits = 0;
+		for (unsigned r = 0; r < UT_TRACE_READS; r++) {
+			if (r > 0 && r % UT_TRACE_SCAN_EVERY == 0) {
+				for (int i = 0; i < UT_TRACE_SCAN_KEYS; i++) {
+					replay(scan_key++, UT_TRACE_CHUNK);
+					pond_->delay_purge_notify();
+				}
+			}
+			double u = (double)random() / RAND_MAX * sum;
+			uint32_t key = std::lower_bound(cdf.begin(), cdf.end(),
+							u) -
+				       cdf.begin() + 1;
+			int ret = replay(key, UT_TRACE_CHUNK);
+			pond_->delay_purge_notify();
+			if (r >= UT_TRACE_SCAN_EVERY) {
+				reads++;
+				hits += ret == 1;
+			}
+		}
+		return (double)hits / reads;
+	}
+
+	unsigned cached_hot_keys(void)
+	{
+		unsigned count = 0;
+		for (uint32_t k = 1; k <= hot_keys_; k++)
+			if (!(!pond_->cache_find((const char *)&k, 0)))
+				count++;
+		return count;
+	}
+
+	BufferPond *pond_;
+	AdmissionFilter filter_;
+	uint32_t hot_keys_;
+	int admission_;
+};
+
+TEST_F(BufferPondAdmissionTest, RejectPurgesNothing)
+{
+	fill_hot_keys();
+	unsigned used = pond_->get_total_used_node();
+
+	/* 一串只读一次的新key，都不比被淘汰的热key更热 */
+	for (uint32_t k = 0; k < 64; k++) {
+		EXPECT_EQ(-1, replay(0x10000 + k, UT_LARGE_CHUNK));
+		EXPECT_EQ(-1, admission_);
+	}
+
+	/* 被拒绝时既不立即淘汰，也不安排延迟淘汰 */
+	pond_->delay_purge_notify(UINT_MAX);
+	EXPECT_EQ(used, pond_->get_total_used_node());
+	EXPECT_EQ(hot_keys_, cached_hot_keys());
+}
+
+TEST_F(BufferPondAdmissionTest, AdmitPurgesVictim)
+{
+	fill_hot_keys();
+	unsigned used = pond_->get_total_used_node();
+
+	/* 新key比队尾的key读得更多，准入后淘汰 */
+	uint32_t key = 0x10000;
+	for (int n = 0; n < 16; n++)
+		filter_.touch((const char *)&key);
+	EXPECT_EQ(0, replay(key, UT_LARGE_CHUNK));
+	EXPECT_EQ(1, admission_);
+	EXPECT_FALSE(!pond_->cache_find((const char *)&key, 0));
+
+	/* 队尾的小节点延迟淘汰，第一个大节点让给新key */
+	pond_->delay_purge_notify(UINT_MAX);
+	EXPECT_EQ(used - UT_SMALL_NODES, pond_->get_total_used_node());
+	EXPECT_EQ(hot_keys_ - UT_SMALL_NODES - 1, cached_hot_keys());
+}
+
+TEST_F(BufferPondAdmissionTest, TraceReplayHitRate)
+{
+	double admission = replay_trace();
+
+	/* 同一段trace，不开准入重放一遍 */
+	close_pond();
+	open_pond();
+	pond_->set_admission_filter(NULL);
+	double lru = replay_trace();
+
+	printf("trace replay hit rate: lru %.1f%%, lru + admission %.1f%%\n",
+	       lru * 100, admission * 100);
+	EXPECT_GT(admission, lru + 0.02);
+}
+
+#endif
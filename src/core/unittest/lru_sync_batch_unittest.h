@@ -0,0 +1,138 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#ifndef LRU_SYNC_BATCH_UNITTEST_H_
+#define LRU_SYNC_BATCH_UNITTEST_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include <set>
+#include <string>
+#include "gtest/gtest.h"
+#include "table/lru_sync_batch.h"
+
+/* 编码一批packed key再读回来，读出的key应为排序去重后的输入 */
+class LruSyncBatchTest : public testing::Test {
+    protected:
+	virtual void SetUp()
+	{
+		srandom(20211);
+	}
+
+	void round_trip(int key_format, const std::set<std::string> &keys,
+			int dups)
+	{
+		LruSyncBatch batch(key_format);
+		std::set<std::string>::const_iterator it;
+		for (int n = 0; n <= dups; n++)
+			for (it = keys.begin(); it != keys.end(); ++it)
+				batch.add_key(it->data());
+		ASSERT_EQ((int)keys.size() * (dups + 1), batch.Count());
+
+		std::string buf;
+		ASSERT_EQ((int)keys.size(), batch.Encode(buf));
+
+		LruSyncBatchReader reader;
+		ASSERT_EQ(0, reader.Attach(buf.data(), buf.size(), key_format));
+		ASSERT_EQ((int)keys.size(), reader.Count());
+
+		std::set<std::string> decoded;
+		const char *packed_key;
+		int ret;
+		while ((ret = reader.Next(packed_key)) > 0) {
+			int len = key_format ? key_format :
+					       *(unsigned char *)packed_key + 1;
+			decoded.insert(std::string(packed_key, len));
+		}
+		ASSERT_EQ(0, ret);
+		EXPECT_TRUE(decoded == keys);
+	}
+
+	std::set<std::string> int_keys(int key_format, int count)
+	{
+		std::set<std::string> keys;
+		while ((int)keys.size() < count) {
+			uint64_t v = ((uint64_t)random() << 31) | random();
+			keys.insert(std::string((const char *)&v, key_format));
+		}
+		return keys;
+	}
+};
+
+TEST_F(LruSyncBatchTest, IntKeysRoundTrip)
+{
+	round_trip(4, int_keys(4, 1000), 2);
+	round_trip(8, int_keys(8, 1000), 1);
+	round_trip(2, int_keys(2, 100), 0);
+}
+
+TEST_F(LruSyncBatchTest, FixedKeysRoundTrip)
+{
+	std::set<std::string> keys;
+	while (keys.size() < 500) {
+		char k[12];
+		for (int i = 0; i < (int)sizeof(k); i++)
+			k[i] = random();
+		keys.insert(std::string(k, sizeof(k)));
+	}
+	round_trip(12, keys, 1);
+}
+
+TEST_F(LruSyncBatchTest, VarKeysRoundTrip)
+{
+	std::set<std::string> keys;
+	keys.insert(std::string(1, '\0'));
+	while (keys.size() < 500) {
+		char k[256];
+		int len = random() % 32;
+		k[0] = len;
+		for (int i = 1; i <= len; i++)
+			k[i] = 'a' + random() % 26;
+		keys.insert(std::string(k, len + 1));
+	}
+	round_trip(0, keys, 1);
+}
+
+TEST_F(LruSyncBatchTest, EmptyBatch)
+{
+	round_trip(4, std::set<std::string>(), 0);
+	round_trip(0, std::set<std::string>(), 0);
+}
+
+TEST_F(LruSyncBatchTest, RejectBadBatch)
+{
+	LruSyncBatch batch(4);
+	std::set<std::string> keys = int_keys(4, 100);
+	std::set<std::string>::const_iterator it;
+	for (it = keys.begin(); it != keys.end(); ++it)
+		batch.add_key(it->data());
+	std::string buf;
+	batch.Encode(buf);
+
+	LruSyncBatchReader reader;
+	/* key格式和主机不一致 */
+	EXPECT_EQ(-1, reader.Attach(buf.data(), buf.size(), 0));
+	EXPECT_EQ(-1, reader.Attach(buf.data(), 0, 4));
+
+	/* 截断的记录读到一半报错，不会越界 */
+	ASSERT_EQ(0, reader.Attach(buf.data(), buf.size() / 2, 4));
+	const char *packed_key;
+	int ret;
+	while ((ret = reader.Next(packed_key)) > 0)
+		;
+	EXPECT_EQ(-1, ret);
+}
+
+#endif
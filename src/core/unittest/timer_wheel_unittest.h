@@ -0,0 +1,227 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#ifndef TIMER_WHEEL_UNITTEST_H_
+#define TIMER_WHEEL_UNITTEST_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+#include "gtest/gtest.h"
+#include "timer/timer_list.h"
+
+#define UT_TIMER_SPAN_MS 600000 /* 定时器在10分钟内到期 */
+#define UT_TIMER_LATE_US 2000 /* 允许的最大延迟 */
+#define UT_TIMER_BENCH_COUNT 1000000
+
+/*
+ * TimerUnit的时间轮。不调用update_now_time，挂定时器时的当前时间固定为
+ * start_，之后每次把模拟时间往前推1ms，调用expire_micro_seconds和
+ * check_expired，检查每个定时器只触发一次、不提前、延迟不超过2ms。
+ */
+class TimerWheelTest : public testing::Test {
+    protected:
+	struct UtTimer : public TimerObject {
+		TimerWheelTest *owner;
+		int64_t want;
+		int fired;
+		int rearm_ms;
+
+		UtTimer() : owner(NULL), want(0), fired(0), rearm_ms(-1)
+		{
+		}
+		virtual void job_timer_procedure(void)
+		{
+			fired++;
+			owner->fired_++;
+			if (owner->now_ < want)
+				owner->early_++;
+			if (owner->now_ > want + UT_TIMER_LATE_US)
+				owner->late_++;
+			if (rearm_ms >= 0)
+				attach_timer(owner->unit_, rearm_ms);
+		}
+	};
+
+	virtual void SetUp()
+	{
+		unit_ = new TimerUnit();
+		start_ = now_ = unit_->get_now_time();
+		fired_ = early_ = late_ = 0;
+		srandom(20211);
+	}
+	virtual void TearDown()
+	{
+		delete unit_;
+	}
+
+	/* 随机超时1ms~span，lists>0时只取lists种超时，模拟按TimerList分组 */
+	void make_timers(std::vector<UtTimer> &timers, int span, int lists)
+	{
+		for (size_t i = 0; i < timers.size(); i++) {
+			int ms = 1 + random() % span;
+			if (lists > 0)
+				ms = 1 + ms % lists * (span / lists);
+			timers[i].owner = this;
+			timers[i].want = start_ + ms * 1000LL;
+			timers[i].rearm_ms = -1;
+			ms_.push_back(ms);
+		}
+	}
+	void attach(UtTimer &t, int ms, bool by_list)
+	{
+		if (by_list)
+			t.attach_timer(unit_->get_timer_list_by_m_seconds(ms));
+		else
+			t.attach_timer(unit_, ms);
+	}
+
+	/* 每步前进1ms直到全部触发或超过span，返回推进的步数 */
+	long run(long expect, int span)
+	{
+		long steps = 0;
+		while (fired_ < expect && steps <= span + 10) {
+			now_ += 1000;
+			unit_->expire_micro_seconds(1, 0);
+			unit_->check_expired(now_);
+			steps++;
+		}
+		return steps;
+	}
+
+	static double elapsed_ns(const struct timespec &a,
+				 const struct timespec &b)
+	{
+		return (b.tv_sec - a.tv_sec) * 1e9 + (b.tv_nsec - a.tv_nsec);
+	}
+
+	/* 10^6个定时器：插入、一半取消后重挂、逐ms推进的耗时 */
+	void bench(int lists)
+	{
+		std::vector<UtTimer> timers(UT_TIMER_BENCH_COUNT);
+		make_timers(timers, UT_TIMER_SPAN_MS, lists);
+		bool by_list = lists > 0;
+
+		struct timespec a, b, c, d;
+		clock_gettime(CLOCK_MONOTONIC, &a);
+		for (size_t i = 0; i < timers.size(); i++)
+			attach(timers[i], ms_[i], by_list);
+		clock_gettime(CLOCK_MONOTONIC, &b);
+		for (size_t i = 0; i < timers.size(); i += 2) {
+			timers[i].disable_timer();
+			attach(timers[i], ms_[i], by_list);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &c);
+		long steps = run(timers.size(), UT_TIMER_SPAN_MS);
+		clock_gettime(CLOCK_MONOTONIC, &d);
+
+		printf("%s: insert %.0f ns, cancel+insert %.0f ns, "
+		       "1ms step %.0f ns\n",
+		       by_list ? "TimerList API" : "arbitrary deadline",
+		       elapsed_ns(a, b) / timers.size(),
+		       elapsed_ns(b, c) / (timers.size() / 2),
+		       elapsed_ns(c, d) / steps);
+		EXPECT_EQ((long)timers.size(), fired_);
+		EXPECT_EQ(0, early_);
+		EXPECT_EQ(0, late_);
+	}
+
+	TimerUnit *unit_;
+	int64_t start_;
+	int64_t now_;
+	long fired_;
+	long early_;
+	long late_;
+	std::vector<int> ms_;
+};
+
+TEST_F(TimerWheelTest, FireOnceOnTime)
+{
+	std::vector<UtTimer> timers(20000);
+	make_timers(timers, UT_TIMER_SPAN_MS, 0);
+	for (size_t i = 0; i < timers.size(); i++)
+		attach(timers[i], ms_[i], false);
+
+	run(timers.size(), UT_TIMER_SPAN_MS);
+	EXPECT_EQ((long)timers.size(), fired_);
+	EXPECT_EQ(0, early_);
+	EXPECT_EQ(0, late_);
+	for (size_t i = 0; i < timers.size(); i++)
+		ASSERT_EQ(1, timers[i].fired) << "timer " << i;
+}
+
+TEST_F(TimerWheelTest, TimerListTimeouts)
+{
+	std::vector<UtTimer> timers(5000);
+	make_timers(timers, UT_TIMER_SPAN_MS, 100);
+	for (size_t i = 0; i < timers.size(); i++)
+		attach(timers[i], ms_[i], true);
+
+	run(timers.size(), UT_TIMER_SPAN_MS);
+	EXPECT_EQ((long)timers.size(), fired_);
+	EXPECT_EQ(0, early_);
+	EXPECT_EQ(0, late_);
+}
+
+TEST_F(TimerWheelTest, DisabledTimerNotFired)
+{
+	std::vector<UtTimer> timers(1000);
+	make_timers(timers, 5000, 0);
+	for (size_t i = 0; i < timers.size(); i++)
+		attach(timers[i], ms_[i], false);
+	for (size_t i = 0; i < timers.size(); i += 2)
+		timers[i].disable_timer();
+
+	run(timers.size(), 5000);
+	EXPECT_EQ((long)timers.size() / 2, fired_);
+	for (size_t i = 0; i < timers.size(); i++)
+		EXPECT_EQ(i % 2, (size_t)timers[i].fired);
+}
+
+TEST_F(TimerWheelTest, RearmInCallback)
+{
+	std::vector<UtTimer> timers(1);
+	make_timers(timers, 10, 0);
+	timers[0].rearm_ms = 0;
+	attach(timers[0], ms_[0], false);
+
+	/* 到期时间向上取整到tick，最晚在want之后的下一个tick触发 */
+	now_ = timers[0].want + 1000;
+	unit_->check_expired(now_);
+	EXPECT_EQ(1, timers[0].fired);
+
+	/* 回调里重新挂上的定时器已过期，但不在同一个tick里再次触发 */
+	timers[0].rearm_ms = -1;
+	unit_->check_expired(now_);
+	EXPECT_EQ(1, timers[0].fired);
+	now_ += 1000;
+	unit_->check_expired(now_);
+	EXPECT_EQ(2, timers[0].fired);
+	EXPECT_EQ(0, early_);
+}
+
+/* --gtest_also_run_disabled_tests --gtest_filter=*Bench* 运行 */
+TEST_F(TimerWheelTest, DISABLED_BenchMillionTimers)
+{
+	bench(0);
+}
+
+TEST_F(TimerWheelTest, DISABLED_BenchMillionTimersByList)
+{
+	bench(100);
+}
+
+#endif
@@ -0,0 +1,10 @@
+#include "buffer_pond_unittest.h"
+#include "bp_tree_unittest.h"
+#include "lru_sync_batch_unittest.h"
+#include "timer_wheel_unittest.h"
+
+int main(int argc, char **argv)
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -144,6 +144,11 @@ int DataConf::ParseConfig(ConfigParam& config_param){
         return DTC_CODE_PARSE_CONFIG_ERR;
     }
     config_param.key_field_name_ = key_field_name;
+    config_param.key_field_type_ = g_dtc_config->get_int_val("FIELD1", "field_type", -1);
+    if(config_param.key_field_type_ <= 0){
+        log4cplus_error("key_field_type not defined.");
+        return DTC_CODE_PARSE_CONFIG_ERR;
+    }
 
     const char* table_name = g_dtc_config->get_str_val("HOT_TABLE_CONF", "table_name");
     if(NULL == table_name){
@@ -152,10 +157,36 @@ int DataConf::ParseConfig(ConfigParam& config_param){
     }
     config_param.table_name_ = table_name;
 
+    config_param.batch_delete_ = g_dtc_config->get_int_val("data_lifecycle", "BatchDelete", 0);
+    // 先按int检查，负数直接存入uint32_t会变成很大的正数
+    int batch_page_size = g_dtc_config->get_int_val("data_lifecycle", "BatchPageSize", 5000);
+    int delete_batch_keys = g_dtc_config->get_int_val("data_lifecycle", "DeleteBatchKeys", 500);
+    int delete_workers = g_dtc_config->get_int_val("data_lifecycle", "DeleteWorkers", DEFAULT_DELETE_WORKERS);
+    int checkpoint_pages = g_dtc_config->get_int_val("data_lifecycle", "CheckpointPages", 10);
+    int target_latency_ms = g_dtc_config->get_int_val("data_lifecycle", "DeleteTargetLatency", 50);
+    if(batch_page_size <= 0 || delete_batch_keys <= 0 || delete_workers <= 0 ||
+        checkpoint_pages <= 0 || target_latency_ms <= 0){
+        log4cplus_error("batch delete param must be positive.");
+        return DTC_CODE_PARSE_CONFIG_ERR;
+    }
+    if(delete_workers > MAX_DELETE_WORKERS){
+        log4cplus_warning("DeleteWorkers %d too large, use %d.", delete_workers, MAX_DELETE_WORKERS);
+        delete_workers = MAX_DELETE_WORKERS;
+    }
+    config_param.batch_page_size_ = batch_page_size;
+    config_param.delete_batch_keys_ = delete_batch_keys;
+    config_param.delete_workers_ = delete_workers;
+    config_param.checkpoint_pages_ = checkpoint_pages;
+    config_param.target_latency_ms_ = target_latency_ms;
+
     log4cplus_debug("single_query_cnt_: %d, data_rule: %s, operate_time_rule: %s, operate_type: %s, "
         "life_cycle_table_name: %s, key_field_name: %s, table_name: %s, hot_database_name: %s",
         config_param.single_query_cnt_, config_param.data_rule_.c_str(), config_param.operate_time_rule_.c_str(),
         config_param.operate_type_.c_str(), config_param.life_cycle_table_name_.c_str(), config_param.key_field_name_.c_str(),
         config_param.table_name_.c_str(), config_param.hot_db_name_.c_str());
+    log4cplus_debug("batch_delete: %d, batch_page_size: %d, delete_batch_keys: %d, delete_workers: %d, "
+        "checkpoint_pages: %d, target_latency_ms: %d",
+        config_param.batch_delete_, config_param.batch_page_size_, config_param.delete_batch_keys_,
+        config_param.delete_workers_, config_param.checkpoint_pages_, config_param.target_latency_ms_);
     return 0;
 }
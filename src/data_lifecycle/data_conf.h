@@ -5,6 +5,9 @@
 #include <string>
 #include <stdint.h>
 
+#define DEFAULT_DELETE_WORKERS 4    // 默认并发delete连接数
+#define MAX_DELETE_WORKERS 64       // 每个worker独占一个到agent的连接，限制上限
+
 struct ConfigParam{
 public:
     uint32_t single_query_cnt_;
@@ -12,10 +15,18 @@ public:
     std::string operate_time_rule_;
     std::string operate_type_;
     std::string key_field_name_;
+    int key_field_type_;            // key字段类型，决定delete语句中key是否加引号
     std::string table_name_;
     std::string life_cycle_table_name_;
     std::string hot_db_name_;
     std::string cold_db_name_;
+    // 批量删除模式
+    uint32_t batch_delete_;         // 0: 逐条删除(默认), 1: 分页批量删除
+    uint32_t batch_page_size_;      // 每页查询的行数
+    uint32_t delete_batch_keys_;    // 每批delete包含的key个数
+    uint32_t delete_workers_;       // 并发执行delete的连接数
+    uint32_t checkpoint_pages_;     // 每删除多少页更新一次检查点
+    uint32_t target_latency_ms_;    // delete语句的目标耗时，超过时放慢速度
 };
 
 class DataConf{
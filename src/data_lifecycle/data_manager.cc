@@ -2,10 +2,22 @@
 #include "global.h"
 #include "data_conf.h"
 #include "croncpp.h"
+#include "protocol.h"
 #include <unistd.h>
+#include <time.h>
 #include <set>
+#include <thread>
+#include <algorithm>
 
-DataManager::DataManager(){
+DataManager::DataManager():
+key_field_type_(DField::Signed),
+batch_delete_(0),
+batch_page_size_(5000),
+delete_batch_keys_(500),
+delete_workers_(DEFAULT_DELETE_WORKERS),
+checkpoint_pages_(10),
+stat_deleted_rows_(0),
+stat_statements_(0){
     next_process_time_ = 0;
     DBHost* db_host = new DBHost();
     memset(db_host, 0, sizeof(db_host));
@@ -25,26 +37,55 @@ operate_time_rule_(config_param.operate_time_rule_),
 single_query_cnt_(config_param.single_query_cnt_),
 table_name_(config_param.table_name_),
 key_field_name_(config_param.key_field_name_),
+key_field_type_(config_param.key_field_type_),
 life_cycle_table_name_(config_param.life_cycle_table_name_),
 hot_db_name_(config_param.hot_db_name_),
-cold_db_name_(config_param.cold_db_name_){
+cold_db_name_(config_param.cold_db_name_),
+batch_delete_(config_param.batch_delete_),
+batch_page_size_(config_param.batch_page_size_),
+delete_batch_keys_(config_param.delete_batch_keys_),
+delete_workers_(config_param.delete_workers_),
+checkpoint_pages_(config_param.checkpoint_pages_),
+rate_controller_(config_param.target_latency_ms_),
+stat_deleted_rows_(0),
+stat_statements_(0){
     next_process_time_ = 0;
-    DBHost* db_host = new DBHost();
-    memset(db_host, 0, sizeof(db_host));
-    strcpy(db_host->Host, "127.0.0.1");
-    db_host->Port = DataConf::Instance()->Port();
-    strcpy(db_host->User, "root");
-    strcpy(db_host->Password, "root");
-    db_conn_ = new CDBConn(db_host);
-    if(NULL != db_host){
-        delete db_host;
-    }
+    db_conn_ = CreateAgentConn();
 }
 
 DataManager::~DataManager(){
     if(NULL != db_conn_){
         delete db_conn_;
     }
+    for(size_t i = 0; i < worker_conns_.size(); i++){
+        delete worker_conns_[i];
+    }
+}
+
+CDBConn* DataManager::CreateAgentConn(){
+    DBHost db_host;
+    memset(&db_host, 0, sizeof(db_host));
+    strcpy(db_host.Host, "127.0.0.1");
+    db_host.Port = DataConf::Instance()->Port();
+    strcpy(db_host.User, "root");
+    strcpy(db_host.Password, "root");
+    return new CDBConn(&db_host);
+}
+
+void DeleteRateController::Update(double latency_ms){
+    if(latency_ms > target_latency_ms_){
+        pause_ms_ = std::min(max_pause_ms_, pause_ms_ ? pause_ms_ * 2 : 10);
+    } else {
+        pause_ms_ /= 2;
+    }
+}
+
+void DataManager::SetBatchDelete(uint32_t page_size, uint32_t batch_keys, uint32_t workers, uint32_t checkpoint_pages){
+    batch_delete_ = 1;
+    batch_page_size_ = page_size;
+    delete_batch_keys_ = batch_keys;
+    delete_workers_ = std::min(workers, (uint32_t)MAX_DELETE_WORKERS);
+    checkpoint_pages_ = checkpoint_pages;
 }
 
 int DataManager::ConnectAgent(){
@@ -69,7 +110,11 @@ int DataManager::DoProcess(){
         }
         std::time_t now = std::time(0);
         if(now >= next_process_time_){
-            DoTaskOnce();
+            if(batch_delete_){
+                DoBatchTaskOnce();
+            } else {
+                DoTaskOnce();
+            }
             try{
                 std::time_t now = std::time(0);
                 next_process_time_ = cron::cron_next(cron, now);
@@ -129,6 +174,149 @@ int DataManager::DoTaskOnce(){
     return 0;
 }
 
+int DataManager::DoBatchTaskOnce(){
+    uint64_t last_delete_id = 0;
+    std::string last_invisible_time;
+    int ret = GetLastId(last_delete_id, last_invisible_time);
+    if(0 != ret){
+        log4cplus_error("GetLastId error, ret: %d", ret);
+        return DTC_CODE_MYSQL_QRY_ERR;
+    }
+    while(worker_conns_.size() < delete_workers_){
+        worker_conns_.push_back(CreateAgentConn());
+    }
+
+    stat_deleted_rows_ = 0;
+    stat_statements_ = 0;
+    stat_start_ = std::chrono::steady_clock::now();
+    // 检查点之后已删除的页数
+    uint32_t pending_pages = 0;
+    while(!stop){
+        std::string query_sql = ConstructQuerySql(last_delete_id, last_invisible_time, batch_page_size_);
+        std::vector<QueryInfo> query_info_vec;
+        ret = DoQuery(query_sql, query_info_vec);
+        if(0 != ret){
+            log4cplus_error("DoQuery error, ret: %d", ret);
+            if(pending_pages > 0){
+                UpdateLastDeleteId();
+            }
+            return DTC_CODE_MYSQL_QRY_ERR;
+        }
+        if(query_info_vec.empty()){
+            break;
+        }
+
+        uint64_t affected_rows = 0;
+        double latency_ms = 0;
+        ret = DeletePage(query_info_vec, affected_rows, latency_ms);
+        if(0 != ret){
+            // 检查点只推进到上一页，本页下次重新删除
+            log4cplus_error("DeletePage error, ret: %d", ret);
+            if(pending_pages > 0){
+                UpdateLastDeleteId();
+            }
+            return DTC_CODE_MYSQL_DEL_ERR;
+        }
+        rate_controller_.Update(latency_ms);
+        stat_deleted_rows_ += affected_rows;
+
+        last_delete_id = last_delete_id_ = query_info_vec.back().id;
+        last_invisible_time = last_invisible_time_ = query_info_vec.back().invisible_time;
+        if(++pending_pages >= checkpoint_pages_){
+            UpdateLastDeleteId();
+            pending_pages = 0;
+            ReportProgress();
+        }
+
+        if(query_info_vec.size() < batch_page_size_){
+            break;
+        }
+        if(rate_controller_.PauseMs() > 0){
+            usleep(rate_controller_.PauseMs() * 1000);
+        }
+    }
+    if(pending_pages > 0){
+        UpdateLastDeleteId();
+    }
+    ReportProgress();
+    return 0;
+}
+
+int DataManager::DeletePage(const std::vector<QueryInfo>& query_info_vec, uint64_t& affected_rows, double& latency_ms){
+    // 每批delete_batch_keys_个key，同一批的语句在同一个连接上顺序执行
+    std::vector<std::vector<std::string> > batch_vec;
+    size_t statements = 0;
+    for(size_t i = 0; i < query_info_vec.size(); i += delete_batch_keys_){
+        size_t end = std::min(query_info_vec.size(), i + delete_batch_keys_);
+        batch_vec.push_back(ConstructBatchDeleteSql(query_info_vec, i, end));
+        statements += batch_vec.back().size();
+    }
+
+    uint32_t workers = std::min((size_t)delete_workers_, batch_vec.size());
+    std::vector<int> ret_vec(workers, 0);
+    std::vector<uint64_t> affected_vec(workers, 0);
+    std::vector<double> latency_vec(workers, 0);
+    auto worker = [&](uint32_t w){
+        for(size_t i = w; i < batch_vec.size() && 0 == ret_vec[w]; i += workers){
+            for(size_t j = 0; j < batch_vec[i].size(); j++){
+                uint64_t affected = 0;
+                auto begin = std::chrono::steady_clock::now();
+                int ret = DoBatchDelete(worker_conns_[w], batch_vec[i][j], affected);
+                latency_vec[w] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+                if(0 != ret){
+                    ret_vec[w] = ret;
+                    break;
+                }
+                affected_vec[w] += affected;
+            }
+        }
+    };
+    if(workers <= 1){
+        if(workers == 1){
+            worker(0);
+        }
+    } else {
+        std::vector<std::thread> threads;
+        for(uint32_t w = 0; w < workers; w++){
+            threads.push_back(std::thread(worker, w));
+        }
+        for(uint32_t w = 0; w < workers; w++){
+            threads[w].join();
+        }
+    }
+
+    double total_latency = 0;
+    affected_rows = 0;
+    for(uint32_t w = 0; w < workers; w++){
+        total_latency += latency_vec[w];
+        affected_rows += affected_vec[w];
+    }
+    stat_statements_ += statements;
+    latency_ms = statements == 0 ? 0 : total_latency / statements;
+    for(uint32_t w = 0; w < workers; w++){
+        if(0 != ret_vec[w]){
+            return ret_vec[w];
+        }
+    }
+    return 0;
+}
+
+void DataManager::ReportProgress(){
+    double elapse = std::chrono::duration<double>(std::chrono::steady_clock::now() - stat_start_).count();
+    // 落后时长：当前时间与已删除的最后一行invisible_time的差值
+    long lag = -1;
+    struct tm tm_invisible;
+    memset(&tm_invisible, 0, sizeof(tm_invisible));
+    if(NULL != strptime(last_invisible_time_.c_str(), "%Y-%m-%d %H:%M:%S", &tm_invisible)){
+        tm_invisible.tm_isdst = -1;
+        lag = (long)(std::time(0) - mktime(&tm_invisible));
+    }
+    log4cplus_info("batch delete: rows: %lu, statements: %lu, rows/s: %.1f, pause: %ums, last id: %lu, lag: %lds",
+        (unsigned long)stat_deleted_rows_, (unsigned long)stat_statements_,
+        elapse > 0 ? stat_deleted_rows_ / elapse : 0.0, rate_controller_.PauseMs(),
+        (unsigned long)last_delete_id_, lag);
+}
+
 void DataManager::SetTimeRule(const std::string& time_rule){
     operate_time_rule_ = time_rule;
 }
@@ -157,7 +345,7 @@ int DataManager::GetLastId(uint64_t& last_delete_id, std::string& last_invisible
     return 0;
 }
 
-std::string DataManager::ConstructQuerySql(uint64_t last_delete_id, std::string last_invisible_time){
+std::string DataManager::ConstructQuerySql(uint64_t last_delete_id, std::string last_invisible_time, uint32_t limit){
     // example: select id from table_A where status=0 and (invisible_time>6 or (invisible_time=6 and id>6)) order by invisible_time limit 2
     std::stringstream ss_sql;
     ss_sql << "select id,invisible_time," << key_field_name_ 
@@ -166,7 +354,7 @@ std::string DataManager::ConstructQuerySql(uint64_t last_delete_id, std::string
         << ") and (invisible_time>'" << last_invisible_time
         << "' or (invisible_time='" << last_invisible_time
         << "' and id>" << last_delete_id
-        << ")) order by invisible_time,id limit " << single_query_cnt_;
+        << ")) order by invisible_time,id limit " << (limit ? limit : single_query_cnt_);
     log4cplus_debug("query sql: %s", ss_sql.str().c_str());
     return ss_sql.str();
 }
@@ -214,6 +402,59 @@ std::set<std::string> DataManager::ConstructDeleteSql(const std::string& key){
     return sql_set;
 }
 
+std::string DataManager::KeyLiteral(const std::string& key){
+    // 整型key不加引号，否则agent按字符串计算key的hash，路由到错误的分片
+    if(key_field_type_ == DField::Signed || key_field_type_ == DField::Unsigned ||
+        key_field_type_ == DField::Float){
+        return key;
+    }
+    // agent和DTC用hsql解析语句，hsql只识别''转义，反斜杠原样保留
+    std::string literal = "'";
+    for(size_t i = 0; i < key.size(); i++){
+        if(key[i] == '\''){
+            literal += '\'';
+        }
+        literal += key[i];
+    }
+    literal += "'";
+    return literal;
+}
+
+std::vector<std::string> DataManager::ConstructBatchDeleteSql(const std::vector<QueryInfo>& query_info_vec, size_t begin, size_t end){
+    // agent只能从 key = value 的条件中取出key，每个key单独一条语句，同一个key可能对应多行，去重
+    std::vector<std::string> sql_vec;
+    std::set<std::string> key_set;
+    std::string or_flag = " or ";
+    std::set<std::string> res = splitStr(data_rule_, or_flag);
+    for(size_t i = begin; i < end; i++){
+        const std::string& key = query_info_vec[i].key_info;
+        if(!key_set.insert(key).second){
+            continue;
+        }
+        std::string literal = KeyLiteral(key);
+        for(auto iter = res.begin(); iter != res.end(); iter++){
+            std::stringstream ss_sql;
+            ss_sql << "delete from " << table_name_
+                << " where " << key_field_name_
+                << " = " << literal
+                << " and (" << *iter << ")";
+            log4cplus_debug("delete sql: %s", ss_sql.str().c_str());
+            sql_vec.push_back(ss_sql.str());
+        }
+    }
+    return sql_vec;
+}
+
+int DataManager::DoBatchDelete(CDBConn* db_conn, const std::string& delete_sql, uint64_t& affected_rows){
+    int ret = db_conn->do_query(hot_db_name_.c_str(), delete_sql.c_str());
+    if(0 != ret){
+        log4cplus_error("DoBatchDelete error, ret: %d, err msg: %s", ret, db_conn->get_err_msg());
+        return ret;
+    }
+    affected_rows = db_conn->affected_rows();
+    return 0;
+}
+
 int DataManager::DoDelete(const std::string& delete_sql){
     int ret = db_conn_->do_query(hot_db_name_.c_str(), delete_sql.c_str());
     if(0 != ret){
@@ -17,6 +17,26 @@ public:
     std::string invisible_time;
 };
 
+// 根据delete耗时调整两页之间的停顿：超过目标耗时时成倍增加，低于目标时减半
+class DeleteRateController
+{
+public:
+    DeleteRateController(uint32_t target_latency_ms = 50, uint32_t max_pause_ms = 5000):
+    target_latency_ms_(target_latency_ms), max_pause_ms_(max_pause_ms), pause_ms_(0){
+    }
+    void SetTargetLatency(uint32_t target_latency_ms){
+        target_latency_ms_ = target_latency_ms;
+    }
+    void Update(double latency_ms);
+    uint32_t PauseMs() const{
+        return pause_ms_;
+    }
+private:
+    uint32_t target_latency_ms_;
+    uint32_t max_pause_ms_;
+    uint32_t pause_ms_;
+};
+
 class DataManager
 {
 public:
@@ -26,23 +46,36 @@ public:
     int ConnectAgent();
     int DoProcess();
     int DoTaskOnce();
+    int DoBatchTaskOnce();
     void SetTimeRule(const std::string& time_rule);
     void SetDataRule(const std::string& data_rule){
     data_rule_ = data_rule;
     }
     virtual int GetLastId(uint64_t& last_delete_id, std::string& last_invisible_time);
-    std::string ConstructQuerySql(uint64_t last_delete_id, std::string last_invisible_time);
+    void SetBatchDelete(uint32_t page_size, uint32_t batch_keys, uint32_t workers, uint32_t checkpoint_pages);
+    void SetKeyFieldType(int key_field_type){
+    key_field_type_ = key_field_type;
+    }
+    std::string ConstructQuerySql(uint64_t last_delete_id, std::string last_invisible_time, uint32_t limit = 0);
     virtual int DoQuery(const std::string& query_sql, std::vector<QueryInfo>& query_info_vec);
     std::set<std::string> ConstructDeleteSql(const std::string& key);
     virtual int DoDelete(const std::string& delete_sql);
+    // 每个key的每个OR分支生成一条 delete ... where key = value and (rule) 语句，agent按key路由
+    std::vector<std::string> ConstructBatchDeleteSql(const std::vector<QueryInfo>& query_info_vec, size_t begin, size_t end);
+    virtual int DoBatchDelete(CDBConn* db_conn, const std::string& delete_sql, uint64_t& affected_rows);
     virtual int UpdateLastDeleteId();
     std::set<std::string> splitStr(const std::string& src, const std::string& separate_character);
 private:
+    CDBConn* CreateAgentConn();
+    int DeletePage(const std::vector<QueryInfo>& query_info_vec, uint64_t& affected_rows, double& latency_ms);
+    std::string KeyLiteral(const std::string& key);
+    void ReportProgress();
     std::string data_rule_; // example: status=0
     std::string operate_time_rule_; // example: 0 */5 * * * ?
     uint32_t single_query_cnt_;
     std::string table_name_;
     std::string key_field_name_;
+    int key_field_type_;
     std::string life_cycle_table_name_;
     std::string hot_db_name_;
     std::string cold_db_name_;
@@ -50,6 +83,18 @@ private:
     CDBConn* db_conn_;
     uint64_t last_delete_id_;
     std::string last_invisible_time_;
+
+    uint32_t batch_delete_;
+    uint32_t batch_page_size_;
+    uint32_t delete_batch_keys_;
+    uint32_t delete_workers_;
+    uint32_t checkpoint_pages_;
+    DeleteRateController rate_controller_;
+    std::vector<CDBConn*> worker_conns_;
+    // 批量删除统计
+    uint64_t stat_deleted_rows_;
+    uint64_t stat_statements_;
+    std::chrono::steady_clock::time_point stat_start_;
 };
 
 
@@ -3,6 +3,7 @@
 
 #include "unittest_comm.h"
 #include "../data_manager.h"
+#include "my/my_request.h"
 
 UNITEST_NAMESPACE_BEGIN
 class MockDataManager : public DataManager{
@@ -17,6 +18,7 @@ public:
     MOCK_METHOD(int, DoQuery, (const std::string& query_sql, std::vector<QueryInfo>& query_info_vec));
     MOCK_METHOD(int, DoDelete, (const std::string& delete_sql));
     MOCK_METHOD(int, UpdateLastDeleteId, ());
+    MOCK_METHOD(int, DoBatchDelete, (CDBConn* db_conn, const std::string& delete_sql, uint64_t& affected_rows));
 };
 
 class DataManagerTest : public testing::Test {
@@ -63,5 +65,149 @@ TEST_F(DataManagerTest , DoProcessTest){
     printf("4\n");
     EXPECT_EQ(0, data_manager_->DoTaskOnce());
 }
+TEST_F(DataManagerTest , ConstructBatchDeleteSqlTest){
+    data_manager_->SetDataRule("status = 0 or flag = 1");
+    std::vector<QueryInfo> query_info_vec(4);
+    query_info_vec[0].key_info = "1";
+    query_info_vec[1].key_info = "2";
+    query_info_vec[2].key_info = "2";
+    query_info_vec[3].key_info = "a'b";
+    // 3个不同的key，每个key两个OR分支
+    data_manager_->SetKeyFieldType(DField::String);
+    std::vector<std::string> sql_vec = data_manager_->ConstructBatchDeleteSql(query_info_vec, 0, 4);
+    ASSERT_EQ(6u, sql_vec.size());
+    EXPECT_NE(std::string::npos, sql_vec[0].find(" = '1' and ("));
+    EXPECT_NE(std::string::npos, sql_vec[2].find(" = '2' and ("));
+    EXPECT_NE(std::string::npos, sql_vec[4].find(" = 'a''b' and ("));
+
+    data_manager_->SetKeyFieldType(DField::Signed);
+    sql_vec = data_manager_->ConstructBatchDeleteSql(query_info_vec, 0, 3);
+    ASSERT_EQ(4u, sql_vec.size());
+    EXPECT_NE(std::string::npos, sql_vec[0].find(" = 1 and ("));
+    EXPECT_NE(std::string::npos, sql_vec[2].find(" = 2 and ("));
+}
+
+// 用agent取key的代码解析生成的语句，确认每条delete都能按key路由
+static bool RouteKey(const std::string& sql, const char* key_name, bool string_key, DTCValue& key, std::string& str_key){
+    std::string packet(5, '\0');
+    uint32_t len = sql.size() + 1;
+    packet[0] = len & 0xFF;
+    packet[1] = (len >> 8) & 0xFF;
+    packet[2] = (len >> 16) & 0xFF;
+    packet[4] = 0x03; // COM_QUERY
+    packet += sql;
+    MyRequest request;
+    request.set_packet_info(&packet[0], packet.size());
+    if(!request.load_sql() || request.get_request_type() != DRequest::Delete){
+        return false;
+    }
+    std::string name(key_name);
+    if(!request.get_key(&key, &name[0])){
+        return false;
+    }
+    // 字符串key指向解析结果，request析构前复制出来
+    if(string_key){
+        str_key.assign(key.str.ptr, key.str.len);
+    }
+    return true;
+}
+
+TEST(BatchDeleteRouteTest, KeyExtractable){
+    ConfigParam config_param;
+    config_param.single_query_cnt_ = 10;
+    config_param.data_rule_ = "status = 0 and flag = 1 or expire = 1";
+    config_param.key_field_name_ = "uid";
+    config_param.key_field_type_ = DField::Signed;
+    config_param.table_name_ = "t_user";
+    config_param.batch_delete_ = 1;
+    config_param.batch_page_size_ = 10;
+    config_param.delete_batch_keys_ = 10;
+    config_param.delete_workers_ = 1;
+    config_param.checkpoint_pages_ = 1;
+    config_param.target_latency_ms_ = 50;
+
+    std::vector<QueryInfo> query_info_vec(2);
+    query_info_vec[0].key_info = "12";
+    query_info_vec[1].key_info = "34";
+    DataManager int_manager(config_param);
+    std::vector<std::string> sql_vec = int_manager.ConstructBatchDeleteSql(query_info_vec, 0, 2);
+    ASSERT_EQ(4u, sql_vec.size());
+    for(size_t i = 0; i < sql_vec.size(); i++){
+        DTCValue key;
+        std::string str_key;
+        ASSERT_TRUE(RouteKey(sql_vec[i], "uid", false, key, str_key)) << sql_vec[i];
+        EXPECT_EQ(i < 2 ? 12 : 34, key.s64) << sql_vec[i];
+    }
+
+    query_info_vec[0].key_info = "a'b";
+    query_info_vec[1].key_info = "c\\d";
+    config_param.key_field_type_ = DField::String;
+    DataManager str_manager(config_param);
+    sql_vec = str_manager.ConstructBatchDeleteSql(query_info_vec, 0, 2);
+    ASSERT_EQ(4u, sql_vec.size());
+    for(size_t i = 0; i < sql_vec.size(); i++){
+        DTCValue key;
+        std::string str_key;
+        ASSERT_TRUE(RouteKey(sql_vec[i], "uid", true, key, str_key)) << sql_vec[i];
+        EXPECT_EQ(query_info_vec[i / 2].key_info, str_key) << sql_vec[i];
+    }
+}
+
+TEST_F(DataManagerTest , DoBatchTaskOnceTest){
+    data_manager_->SetDataRule("status = 0");
+    data_manager_->SetBatchDelete(4, 2, 2, 10);
+
+    std::vector<QueryInfo> query_info_vec(3);
+    for(size_t i = 0; i < query_info_vec.size(); i++){
+        query_info_vec[i].id = i + 1;
+        query_info_vec[i].invisible_time = "2022-03-01 15:00:43";
+        query_info_vec[i].key_info = std::to_string(i + 1);
+    }
+    EXPECT_CALL(data_manager_mock_ , GetLastId(testing::_, testing::_)).WillRepeatedly(Return(0));
+    // 不满一页说明已经是最后一页，不再继续查询
+    EXPECT_CALL(data_manager_mock_ , DoQuery(testing::_, testing::_)).Times(1)
+        .WillOnce(DoAll(SetArgReferee<1>(query_info_vec), Return(0)));
+    // 每个key一条delete语句
+    EXPECT_CALL(data_manager_mock_ , DoBatchDelete(testing::_, testing::_, testing::_)).Times(3)
+        .WillRepeatedly(DoAll(SetArgReferee<2>(1), Return(0)));
+    // 只在结束时更新一次检查点
+    EXPECT_CALL(data_manager_mock_ , UpdateLastDeleteId()).Times(1).WillOnce(Return(0));
+    EXPECT_EQ(0, data_manager_->DoBatchTaskOnce());
+}
+
+TEST_F(DataManagerTest , DoBatchTaskOnceDeleteErrorTest){
+    data_manager_->SetDataRule("status = 0");
+    data_manager_->SetBatchDelete(2, 2, 1, 10);
+
+    std::vector<QueryInfo> query_info_vec(2);
+    for(size_t i = 0; i < query_info_vec.size(); i++){
+        query_info_vec[i].id = i + 1;
+        query_info_vec[i].invisible_time = "2022-03-01 15:00:43";
+        query_info_vec[i].key_info = std::to_string(i + 1);
+    }
+    EXPECT_CALL(data_manager_mock_ , GetLastId(testing::_, testing::_)).WillRepeatedly(Return(0));
+    EXPECT_CALL(data_manager_mock_ , DoQuery(testing::_, testing::_)).Times(2)
+        .WillRepeatedly(DoAll(SetArgReferee<1>(query_info_vec), Return(0)));
+    EXPECT_CALL(data_manager_mock_ , DoBatchDelete(testing::_, testing::_, testing::_)).Times(3)
+        .WillOnce(Return(0)).WillOnce(Return(0)).WillOnce(Return(1));
+    // 第二页失败，检查点推进到第一页
+    EXPECT_CALL(data_manager_mock_ , UpdateLastDeleteId()).Times(1).WillOnce(Return(0));
+    EXPECT_NE(0, data_manager_->DoBatchTaskOnce());
+}
+
+TEST(DeleteRateControllerTest, AdjustPause){
+    DeleteRateController controller(50, 1000);
+    EXPECT_EQ(0u, controller.PauseMs());
+    controller.Update(100);
+    EXPECT_EQ(10u, controller.PauseMs());
+    controller.Update(100);
+    EXPECT_EQ(20u, controller.PauseMs());
+    for(int i = 0; i < 20; i++){
+        controller.Update(100);
+    }
+    EXPECT_EQ(1000u, controller.PauseMs());
+    controller.Update(10);
+    EXPECT_EQ(500u, controller.PauseMs());
+}
 UNITEST_NAMESPACE_END
 #endif
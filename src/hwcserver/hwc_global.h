@@ -37,6 +37,11 @@
 #define READER_SLEEP_TIME           500	//500ms
 #define READER_RETRY_COUNT          20
 
+#define HWC_SYNC_BATCH_LIMIT        128	// 每次从master拉取的binlog条数
+#define HWC_SYNC_MIN_IDLE_US        1000	// 没追上时的拉取间隔
+#define HWC_SYNC_MAX_IDLE_US        1000000	// 空闲时的最大拉取间隔
+#define HWC_SYNC_STAT_INTERVAL      10	// 同步统计输出间隔(s)
+
 #define SYS_CONFIG_FILE             "../conf/hbp.conf"
 /*
  *   err code
@@ -1,5 +1,7 @@
 #include "hwc_sync_unit.h"
 #include <string>
+#include <algorithm>
+#include <tr1/unordered_set>
 #include <sys/time.h>
 // local
 #include "comm.h"
@@ -13,6 +15,11 @@ HwcSync::HwcSync(DTC::Server* p_server)
     : i_limit_(1)
     , p_master_(p_server)
     , o_journal_id_(CComm::registor.JournalId())
+    , ui_stat_rows_(0)
+    , ui_stat_batches_(0)
+    , ui_stat_fallbacks_(0)
+    , i_stat_time_(0)
+    , i_caught_up_time_(0)
 { } 
 
 HwcSync::~HwcSync()
@@ -51,12 +58,14 @@ int HwcSync::query_cold_server(
 
 void HwcSync::sql_statement_query(
     const DTCValue* p_key,
-    std::string& s_sql)
+    const std::string& s_sql)
 {
     uint32_t ui_count = 0;
 
     do {
-        int i_ret = CComm::mysql_process_.process_statement_query(p_key , s_sql);
+        // 分表时会改写表名，每次重试都从原始sql开始
+        std::string s_exec(s_sql);
+        int i_ret = CComm::mysql_process_.process_statement_query(p_key , s_exec);
         if (-ER_DUP_ENTRY == i_ret || 0 == i_ret) {
             break;
         }
@@ -85,19 +94,214 @@ int HwcSync::get_current_time()
     return now.tv_sec;
 }
 
+/*
+ * 按对账字段把行编码成定长的整型和带长度的字符串，
+ * 编码相同当且仅当RowValue::Compare相等(字符串忽略大小写)
+ */
+static bool encode_row(
+    const RowValue* p_row,
+    const uint8_t* p_field_list,
+    int i_num,
+    std::string& s_row)
+{
+    s_row.clear();
+    for (int i = 0; i < i_num; i++) {
+        const DTCValue* p_val = p_row->field_value(p_field_list[i]);
+        switch (p_row->field_type(p_field_list[i])) {
+        case DField::Signed:
+        case DField::Unsigned:
+            s_row.append((const char*)&p_val->u64, sizeof(p_val->u64));
+            break;
+        case DField::String:
+            s_row.append((const char*)&p_val->str.len, sizeof(p_val->str.len));
+            for (int b = 0; b < p_val->str.len; b++) {
+                s_row.push_back(INTERNAL_TO_LOWER(p_val->str.ptr[b]));
+            }
+            break;
+        case DField::Binary:
+            s_row.append((const char*)&p_val->bin.len, sizeof(p_val->bin.len));
+            s_row.append(p_val->bin.ptr, p_val->bin.len);
+            break;
+        default:
+            // 浮点数不参与比较，与Compare一致视为不相等
+            return false;
+        }
+    }
+    return true;
+}
+
+bool HwcSync::reconcile_rows(
+    ResultSet* p_cold_res,
+    const HwcBinlogCont& o_hot_bin)
+{
+    DTCTableDefinition* p_dtc_tab_def = TableDefinitionManager::instance()->get_cur_table_def();
+    uint8_t* p_fiedld_list = p_dtc_tab_def->raw_fields_list();
+    int i_num = p_dtc_tab_def->num_fields() + 1;
+
+    // 冷数据库为base，先把冷数据的行编码建成集合，再逐行检查热数据
+    std::tr1::unordered_set<std::string> cold_rows;
+    std::string s_row;
+    p_cold_res->rewind();
+    for (int j = 0; j < p_cold_res->total_rows(); j++) {
+        const RowValue* p_cold_raw = p_cold_res->fetch_row();
+        if (NULL == p_cold_raw ||
+            !encode_row(p_cold_raw, p_fiedld_list, i_num, s_row)) {
+            return false;
+        }
+        cold_rows.insert(s_row);
+    }
+
+    DTCFieldSet o_dtc_field_set(p_fiedld_list , i_num);
+    ResultSet p_hot_result(o_dtc_field_set , p_dtc_tab_def);
+    decode_hotbin_result(&p_hot_result , o_hot_bin);
+
+    for (int i = 0; i < p_hot_result.total_rows(); i++) {
+        const RowValue* p_hot_raw = p_hot_result.fetch_row();
+        if (NULL == p_hot_raw ||
+            !encode_row(p_hot_raw, p_fiedld_list, i_num, s_row) ||
+            cold_rows.find(s_row) == cold_rows.end()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int HwcSync::apply_statement(
+    const DTCValue* p_key,
+    const HwcBinlogCont& o_bin,
+    bool b_batch)
+{
+    std::string s_sql(o_bin.p_sql , o_bin.i_sql_len);
+    if (!b_batch) {
+        sql_statement_query(p_key, s_sql);
+        return 0;
+    }
+
+    // 事务中任何错误(包括主键冲突)都会关闭连接，交给逐条模式处理
+    return CComm::mysql_process_.process_statement_query(p_key , s_sql) ? -1 : 0;
+}
+
+int HwcSync::apply_entry(
+    HwcSyncEntry& entry,
+    bool b_batch)
+{
+    const DTCValue* p_key = &entry.keys[0];
+    HwcBinlogCont& o_hot_bin = entry.o_bin;
+
+    log4cplus_debug(" mysql cmd:%.*s , check flag:%d , row len:%d" ,
+         o_hot_bin.i_sql_len, o_hot_bin.p_sql, o_hot_bin.i_check_flag
+         , o_hot_bin.i_raw_len);
+
+    if (0 == o_hot_bin.i_check_flag) {
+        return apply_statement(p_key, o_hot_bin, b_batch);
+    }
+
+    if (1 != o_hot_bin.i_check_flag) {
+        log4cplus_error("illegal check flag");
+        return 0;
+    }
+
+    log4cplus_debug("check: starting...");
+    DTCTableDefinition* p_dtc_tab_def = TableDefinitionManager::instance()->get_cur_table_def();
+    DTCJobOperation o_cold_job(p_dtc_tab_def);
+    query_cold_server(&o_cold_job , p_key);
+
+    ResultSet* p_cold_res = o_cold_job.result;
+    if (!p_cold_res) {
+        log4cplus_info("cold res is null");
+        return b_batch ? -1 : 1;
+    }
+
+    log4cplus_debug("hot row num:%d ,cold row num:%d" ,
+            o_hot_bin.i_raw_nums , p_cold_res->total_rows());
+
+    if (o_hot_bin.i_raw_nums != p_cold_res->total_rows() ||
+        !reconcile_rows(p_cold_res, o_hot_bin)) {
+        // 对账失败，执行sql语句 ，容错逻辑
+        log4cplus_info("check: need insert in cold table");
+        return apply_statement(p_key, o_hot_bin, b_batch);
+    }
+
+    log4cplus_debug("check: row data has been in cold table");
+    return 0;
+}
+
+int HwcSync::apply_batch(std::vector<HwcSyncEntry>& entries)
+{
+    if (entries.size() > 1 &&
+        0 == CComm::mysql_process_.begin_batch()) {
+        unsigned int ui_seq = CComm::mysql_process_.connect_seq();
+        size_t i = 0;
+        for (; i < entries.size(); i++) {
+            if (apply_entry(entries[i], true) != 0 ||
+                ui_seq != CComm::mysql_process_.connect_seq()) {
+                break;
+            }
+        }
+
+        if (i == entries.size() &&
+            ui_seq == CComm::mysql_process_.connect_seq() &&
+            0 == CComm::mysql_process_.commit_batch()) {
+            ui_stat_rows_ += entries.size();
+            ui_stat_batches_++;
+            return 0;
+        }
+
+        CComm::mysql_process_.rollback_batch();
+        ui_stat_fallbacks_++;
+        log4cplus_warning("batch apply failed at %d/%d, replay row by row",
+            (int)i, (int)entries.size());
+    }
+
+    for (size_t i = 0; i < entries.size(); i++) {
+        int i_ret = apply_entry(entries[i], false);
+        if (i_ret > 0) {
+            return i_ret;
+        }
+    }
+    ui_stat_rows_ += entries.size();
+    ui_stat_batches_++;
+    return 0;
+}
+
+void HwcSync::report_stat(int i_now)
+{
+    int i_elapse = i_now - i_stat_time_;
+    if (i_elapse < HWC_SYNC_STAT_INTERVAL) {
+        return;
+    }
+
+    // 落后时长: 距离最近一次拉空master的时间
+    log4cplus_info("sync stat: rows:" UINT64FMT " (%d/s), batches:" UINT64FMT
+        ", fallbacks:" UINT64FMT ", lag:%ds",
+        ui_stat_rows_, (int)(ui_stat_rows_ / i_elapse), ui_stat_batches_,
+        ui_stat_fallbacks_, i_now - i_caught_up_time_);
+
+    ui_stat_rows_ = 0;
+    ui_stat_batches_ = 0;
+    ui_stat_fallbacks_ = 0;
+    i_stat_time_ = i_now;
+}
+
 int HwcSync::Run()
 {
     /* 先关闭连接，防止fd重路 */
     p_master_->Close();
     int i_sec = get_current_time() + 1;
+    i_stat_time_ = i_caught_up_time_ = get_current_time();
+    int i_idle_us = 0;
     while (true) {
-        usleep(1000000); // 1s
-        if (get_current_time() >= i_sec) {
+        if (i_idle_us > 0) {
+            usleep(i_idle_us);
+        }
+        int i_now = get_current_time();
+        if (i_now >= i_sec) {
             if (CComm::registor.CheckMemoryCreateTime()) {
                 log4cplus_error("detect share memory changed");
             }
-            i_sec += 1;
+            i_sec = i_now + 1;
         }
+        report_stat(i_now);
 
         DTC::SvrAdminRequest request_m(p_master_);
         request_m.SetAdminCode(DTC::GetUpdateKey);
@@ -108,11 +312,10 @@ int HwcSync::Run()
         request_m.Need("value");
         request_m.SetHotBackupID((uint64_t)o_journal_id_);
         request_m.Limit(0, i_limit_);
-        log4cplus_info("begin serial:%d , offset:%d" , o_journal_id_.serial , o_journal_id_.offset);
+        log4cplus_debug("begin serial:%d , offset:%d" , o_journal_id_.serial , o_journal_id_.offset);
 
         DTC::Result result_m;
         int ret = request_m.Execute(result_m);
-        log4cplus_error("aliving....., return:%d", ret);
 
         if (-DTC::EC_BAD_HOTBACKUP_JID == ret) {
             log4cplus_error("master report journalID is not match");
@@ -122,15 +325,21 @@ int HwcSync::Run()
         if (0 != ret) {
             log4cplus_error("fetch key-list from master failed, limit[%d], ret=%d, err=%s",
             i_limit_, ret, result_m.ErrorMessage());
-            usleep(100);
+            i_idle_us = HWC_SYNC_MAX_IDLE_US;
             continue;
         }
-        // 写请求 插入 冷数据库
+
+        DTCTableDefinition* p_dtc_tab_def = TableDefinitionManager::instance()->get_cur_table_def();
+        std::vector<HwcSyncEntry> entries(result_m.NumRows());
+        size_t i_entries = 0;
         for (int i = 0; i < result_m.NumRows(); ++i) {
             ret = result_m.FetchRow();
             if (ret < 0) {
                 log4cplus_error("fetch key-list from master failed, limit[%d], ret=%d, err=%s",
                       i_limit_, ret, result_m.ErrorMessage());
+                for (size_t j = 0; j < i_entries; j++) {
+                    entries[j].o_bin.Clear();
+                }
                 // dtc可以运行失败
                 return E_HWC_SYNC_DTC_ERROR;
             }
@@ -138,97 +347,50 @@ int HwcSync::Run()
             int i_type = result_m.IntValue("type");
             if (i_type != DTCHotBackup::SYNC_NONE) {
                 log4cplus_info("no sync none type , continue");
-                break;
+                continue;
             }
-            
-            // key parse
-            int i_key_size = 0;
-            char* p_key = result_m.BinaryValue("key", i_key_size);
 
-            DTCTableDefinition* p_dtc_tab_def = TableDefinitionManager::instance()->get_cur_table_def();
+            HwcSyncEntry& entry = entries[i_entries];
 
-            DTCValue astKey[p_dtc_tab_def->key_fields()];// always single key
-            TaskPackedKey::unpack_key(p_dtc_tab_def, p_key, astKey);
+            // key parse, key的内容引用result_m中的数据，本批处理完之前有效
+            int i_key_size = 0;
+            char* p_key = result_m.BinaryValue("key", i_key_size);
+            entry.keys.resize(p_dtc_tab_def->key_fields());
+            TaskPackedKey::unpack_key(p_dtc_tab_def, p_key, &entry.keys[0]);
 
             int i_value_size = 0;
             char* p_value = (char *)result_m.BinaryValue("value", i_value_size);
-
-            HwcBinlogCont o_hot_bin;
-            bool b_ret = o_hot_bin.ParseFromString(p_value , i_value_size);
-            if (!b_ret) {
+            if (!entry.o_bin.ParseFromString(p_value , i_value_size)) {
                 log4cplus_error("report alarm to manager");
-                break;
-            }
-
-            std::string s_sql(o_hot_bin.p_sql , o_hot_bin.i_sql_len);
-            log4cplus_info(" mysql cmd:%s , check flag:%d , row len:%d" ,
-                 s_sql.c_str(), o_hot_bin.i_check_flag
-                 , o_hot_bin.i_raw_len);
-
-            if (0 == o_hot_bin.i_check_flag) {
-                sql_statement_query(astKey, s_sql);
-                break;
-            } else if (1 == o_hot_bin.i_check_flag) {
-                log4cplus_info("check: starting...");
-
-                DTCJobOperation o_cold_job(p_dtc_tab_def);
-                query_cold_server(&o_cold_job , astKey);
-
-                ResultSet* p_cold_res = o_cold_job.result;
-                if (!p_cold_res) {
-                    log4cplus_info("cold res is null");
-                    return E_HWC_SYNC_NORMAL_EXIT;
-                }
-
-                log4cplus_info("hot row num:%d ,cold row num:%d" , 
-                        o_hot_bin.i_raw_nums , p_cold_res->total_rows());
-
-                if (o_hot_bin.i_raw_nums > p_cold_res->total_rows() ||
-                    o_hot_bin.i_raw_nums < p_cold_res->total_rows()) {
-                    sql_statement_query(astKey, s_sql);
-                    break;
-                }
-
-                uint8_t* p_fiedld_list = p_dtc_tab_def->raw_fields_list();
-                DTCFieldSet o_dtc_field_set(p_fiedld_list , p_dtc_tab_def->num_fields() + 1);
-
-                ResultSet p_hot_result(o_dtc_field_set , p_dtc_tab_def);
-                decode_hotbin_result(&p_hot_result , o_hot_bin);
-
-                for (int i = 0; i < p_hot_result.total_rows(); i++) {
-                    RowValue* p_hot_raw = p_hot_result.fetch_row();
-                    
-                    bool b_check = false;
-                    // 冷数据库为base,只要冷数据库中没有热的，就插入
-                    for (int j = 0; j < p_cold_res->total_rows(); j++) {
-                        RowValue* p_cold_raw = p_cold_res->fetch_row();
-                        if(p_hot_raw->Compare(*p_cold_raw ,
-                                p_fiedld_list , 
-                                p_dtc_tab_def->num_fields() + 1) == 0) {
-                            log4cplus_info("check: row data has been in cold table");
-                            b_check = true;
-                            break;
-                        }
-                    }
-
-                    if (!b_check) {
-                        // 对账失败，执行sql语句 ，容错逻辑
-                        log4cplus_info("check: need insert in cold table");
-                        sql_statement_query(astKey, s_sql);
-                        break;
-                    }
-                    p_cold_res->rewind();
-                }
-                log4cplus_info("check: finish");
-            } else {
-                log4cplus_error("illegal check flag");
                 continue;
             }
+            i_entries++;
         }
+        entries.resize(i_entries);
+
+        // 写请求 插入 冷数据库
+        int i_ret = apply_batch(entries);
+        for (size_t j = 0; j < entries.size(); j++) {
+            entries[j].o_bin.Clear();
+        }
+        if (i_ret > 0) {
+            return E_HWC_SYNC_NORMAL_EXIT;
+        }
+
         // 成功，则更新控制文件中的journalID
         o_journal_id_ = (uint64_t)result_m.HotBackupID();
-        log4cplus_info("end serial:%d , offset:%d" , o_journal_id_.serial , o_journal_id_.offset);
+        log4cplus_debug("end serial:%d , offset:%d" , o_journal_id_.serial , o_journal_id_.offset);
         CComm::registor.JournalId() = o_journal_id_;
+
+        // 拉满一批说明还有积压，立即拉取下一批；否则逐步退避
+        if (result_m.NumRows() >= i_limit_) {
+            i_idle_us = 0;
+        } else {
+            i_caught_up_time_ = i_now;
+            i_idle_us = result_m.NumRows() > 0 ? HWC_SYNC_MIN_IDLE_US :
+                std::min(std::max(i_idle_us * 2, HWC_SYNC_MIN_IDLE_US),
+                    HWC_SYNC_MAX_IDLE_US);
+        }
     }
 
     return E_HWC_SYNC_NORMAL_EXIT;
@@ -22,8 +22,10 @@
 #include <sys/types.h>
 #include <unistd.h>
 #include <signal.h>
+#include <vector>
 // local
 #include "async_file.h"
+#include "hwc_global.h"
 // common
 #include "log/log.h"
 #include "task/task_request.h"
@@ -42,6 +44,13 @@ enum E_HWC_SYNC_ERROR_ID
     E_HWC_SYNC_DTC_ERROR
 };
 
+// 一条待同步的binlog
+struct HwcSyncEntry
+{
+    std::vector<DTCValue> keys;
+    HwcBinlogCont o_bin;
+};
+
 class HwcSync
 {
 public:
@@ -51,20 +60,35 @@ public:
     int Run();
 
     void SetLimit(int iLimit) {
-        // Here we need sync one by one
         i_limit_ = iLimit;
     }
 
 public:
     int query_cold_server(DTCJobOperation* p_job , const DTCValue* key);
     void decode_hotbin_result(ResultSet* o_hot_res, const HwcBinlogCont& o_hwc_bin);
-    void sql_statement_query(const DTCValue* p_key , std::string& s_sql);
+    void sql_statement_query(const DTCValue* p_key , const std::string& s_sql);
     int get_current_time();
 
+    // 整批binlog放在一个事务中写冷库，失败时逐条重做
+    int apply_batch(std::vector<HwcSyncEntry>& entries);
+    // 返回值: 0 成功, <0 批量模式下出错, >0 需要退出同步
+    int apply_entry(HwcSyncEntry& entry, bool b_batch);
+    int apply_statement(const DTCValue* p_key, const HwcBinlogCont& o_bin, bool b_batch);
+    // 热数据的每一行都在冷库中时返回true
+    bool reconcile_rows(ResultSet* p_cold_res, const HwcBinlogCont& o_hot_bin);
+    void report_stat(int i_now);
+
 private:
     int i_limit_;
     DTC::Server* p_master_;
     JournalID o_journal_id_;
+
+    // 同步统计
+    uint64_t ui_stat_rows_;
+    uint64_t ui_stat_batches_;
+    uint64_t ui_stat_fallbacks_;
+    int i_stat_time_;
+    int i_caught_up_time_; // 最近一次追上master的时间
 };
 
 class HwcSyncUnit {
@@ -72,7 +96,7 @@ public:
     HwcSyncUnit();
     ~HwcSyncUnit();
 
-    bool Run(DTC::Server* m , int limit = 1);
+    bool Run(DTC::Server* m , int limit = HWC_SYNC_BATCH_LIMIT);
 
 private:
     HwcSync* p_hwc_sync_;
@@ -62,6 +62,7 @@ namespace DTC {
 	const int ColExpand = 25;
 	const int ColExpandDone = 26;
 	const int ColExpandKey = 27;
+	const int AdjustLRUBatch = 29;
 	
 	const int KeyTypeNone		= 0;	// undefined
 	const int KeyTypeInt		= 1;	// Signed Integer
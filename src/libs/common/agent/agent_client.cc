@@ -215,6 +215,7 @@ int ClientAgent::attach_thread()
 {
 	disable_output();
 	enable_input();
+	enable_edge_trigger();
 
 	if (attach_poller() < 0) {
 		log4cplus_error("client agent attach agengInc thread failed");
@@ -300,11 +301,14 @@ int ClientAgent::recv_request()
 void ClientAgent::input_notify()
 {
 	log4cplus_debug("enter input_notify.");
-	if (recv_request() < 0) {
-		log4cplus_debug("erro when recv");
-		delete this;
-		return;
-	}
+	/* ET模式下一直读到socket读空为止 */
+	do {
+		if (recv_request() < 0) {
+			log4cplus_debug("erro when recv");
+			delete this;
+			return;
+		}
+	} while (edge_triggered() && !receiver->is_drained());
 	delay_apply_events();
 	log4cplus_debug("leave input_notify.");
 	return;
@@ -351,9 +355,11 @@ int ClientAgent::send_result()
 		return -1;
 	}
 
-	if (sender->left_len() != 0)
+	if (sender->left_len() != 0) {
+		/* 没有写完说明发送缓冲区已满，等下一次可写的边沿通知 */
+		ready_events &= ~EPOLLOUT;
 		enable_output();
-	else
+	} else
 		disable_output();
 
 	delay_apply_events();
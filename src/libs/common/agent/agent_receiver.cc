@@ -26,7 +26,8 @@
 #include "task/task_request.h"
 
 AgentReceiver::AgentReceiver(int f)
-	: fd(f), buffer(NULL), offset(0), buffSize(0), pktTail(0), pktCnt(0)
+	: fd(f), buffer(NULL), offset(0), buffSize(0), pktTail(0), pktCnt(0),
+	  drained(0)
 {
 }
 
@@ -59,6 +60,7 @@ int AgentReceiver::recv_once()
 
 	rv = recv(fd, offset + buffer, buffSize - offset, 0);
 	if (rv < 0) {
+		drained = EAGAIN == errno;
 		if (EAGAIN == errno || EINTR == errno || EINPROGRESS == errno)
 			return 0;
 		log4cplus_error("agent receiver recv error: %m, %d", errno);
@@ -69,6 +71,7 @@ int AgentReceiver::recv_once()
 		return -errno;
 	}
 
+	drained = (uint32_t)rv < buffSize - offset;
 	offset += rv;
 
 	return rv;
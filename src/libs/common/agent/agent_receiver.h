@@ -38,6 +38,11 @@ class AgentReceiver {
 
 	int initialization();
 	RecvedPacket receive_network_packet();
+	/* 最近一次recv已经读空了socket(EAGAIN或者没有读满) */
+	int is_drained() const
+	{
+		return drained;
+	}
 
     private:
 	int fd;
@@ -46,6 +51,7 @@ class AgentReceiver {
 	uint32_t buffSize;
 	uint32_t pktTail;
 	int pktCnt;
+	int drained;
 
 	int enlarge_buffer();
 	bool is_need_enlarge_buffer();
@@ -92,3 +92,23 @@ int DTCCompress::UnCompress(char **buf, int *lenp, const char *source,
 	*lenp = _len;
 	return 0;
 }
+
+int DTCCompress::uncompress_to(char *dest, unsigned long *destlen,
+			       const char *source, unsigned long sourceLen)
+{
+	if (dest == NULL || source == NULL) {
+		snprintf(errmsg_, sizeof(errmsg_),
+			 "input buffer or output buffer is null");
+		return -111111;
+	}
+	int iret = uncompress((Bytef *)dest, destlen, (Bytef *)source,
+			      sourceLen);
+	if (iret) {
+		snprintf(
+			errmsg_, sizeof(errmsg_),
+			"uncompress error,error code is:%d.check it in /usr/include/zlib.h",
+			iret);
+		return -111111;
+	}
+	return 0;
+}
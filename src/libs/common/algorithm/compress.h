@@ -36,6 +36,11 @@ class DTCCompress {
 	int UnCompress(char **dest, int *destlen, const char *source,
 		       unsigned long sourceLen);
 
+	//直接解压到调用者提供的缓冲区，不经过内部buffer
+	//destlen 调用前为dest的大小，返回时为解压后的长度
+	int uncompress_to(char *dest, unsigned long *destlen,
+			  const char *source, unsigned long sourceLen);
+
 	unsigned long get_len(void)
 	{
 		return _len;
@@ -26,10 +26,16 @@
 #include "client_dgram.h"
 #include "task/task_request.h"
 #include "client/client_unit.h"
+#include "poll/poller_base.h"
 #include "protocol.h"
 #include "log/log.h"
+#include "stat_dtc.h"
+
+static StatCounter stat_dgram_recv_syscall;
+static StatCounter stat_dgram_recv_packet;
+static StatCounter stat_dgram_send_syscall;
+static StatCounter stat_dgram_send_packet;
 
-class PollerBase;
 static int GetSocketFamily(int fd)
 {
 	struct sockaddr addr;
@@ -71,13 +77,22 @@ static ReplyDgram replyDgram;
 
 ClientDgram::ClientDgram(DTCDecoderUnit *o, int fd)
 	: EpollBase(o->owner_thread(), fd), owner(o), hastrunc(0), mru(0),
-	  mtu(0), alen(0), abuf(NULL)
+	  mtu(0), alen(0), abuf(NULL), batch(0), rbuf(NULL), raddr(NULL),
+	  riov(NULL), rmsg(NULL), nsend(0), saddr(NULL), smsg(NULL)
 {
 }
 
 ClientDgram::~ClientDgram()
 {
+	for (int i = 0; i < nsend; i++)
+		delete spkt[i];
 	FREE_IF(abuf);
+	FREE_IF(rbuf);
+	FREE_IF(raddr);
+	FREE_IF(riov);
+	FREE_IF(rmsg);
+	FREE_IF(saddr);
+	FREE_IF(smsg);
 }
 
 int ClientDgram::init_socket_info(void)
@@ -109,6 +124,28 @@ int ClientDgram::init_socket_info(void)
 	return 0;
 }
 
+/* 接收缓冲区按mru预分配，保证recvmmsg不会截断报文；只有实际写入的页才占用物理内存 */
+int ClientDgram::init_batch_buffer(void)
+{
+	rbuf = (char *)MALLOC((size_t)DGRAM_BATCH_SIZE * mru);
+	raddr = (char *)MALLOC(DGRAM_BATCH_SIZE * alen);
+	riov = (struct iovec *)MALLOC(DGRAM_BATCH_SIZE * sizeof(struct iovec));
+	rmsg = (struct mmsghdr *)CALLOC(DGRAM_BATCH_SIZE,
+					sizeof(struct mmsghdr));
+	saddr = (char *)MALLOC(DGRAM_BATCH_SIZE * alen);
+	smsg = (struct mmsghdr *)CALLOC(DGRAM_BATCH_SIZE,
+					sizeof(struct mmsghdr));
+	if (rbuf == NULL || raddr == NULL || riov == NULL || rmsg == NULL ||
+	    saddr == NULL || smsg == NULL)
+		return -1;
+
+	for (int i = 0; i < DGRAM_BATCH_SIZE; i++) {
+		riov[i].iov_base = rbuf + i * mru;
+		riov[i].iov_len = mru;
+	}
+	return 0;
+}
+
 int ClientDgram::allocate_dgram_info(void)
 {
 	if (abuf != NULL)
@@ -126,6 +163,23 @@ int ClientDgram::do_attach()
 {
 	init_socket_info();
 
+	stat_dgram_recv_syscall =
+		g_stat_mgr.get_stat_int_counter(DGRAM_RECV_SYSCALL_COUNT);
+	stat_dgram_recv_packet =
+		g_stat_mgr.get_stat_int_counter(DGRAM_RECV_PACKET_COUNT);
+	stat_dgram_send_syscall =
+		g_stat_mgr.get_stat_int_counter(DGRAM_SEND_SYSCALL_COUNT);
+	stat_dgram_send_packet =
+		g_stat_mgr.get_stat_int_counter(DGRAM_SEND_PACKET_COUNT);
+
+	if (hastrunc) {
+		if (init_batch_buffer() < 0)
+			log4cplus_warning(
+				"allocate dgram batch buffer failed, fallback to recvfrom");
+		else
+			batch = 1;
+	}
+
 	enable_input();
 	if (attach_poller() == -1)
 		return -1;
@@ -202,24 +256,86 @@ int ClientDgram::recv_request(int noempty)
 		return 0;
 	}
 
+	decode_request(buf, data_len, 1 /*eat*/);
+	return 0;
+}
+
+// 接收一批报文，返回值同recvmmsg，地址和数据在rmsg中
+int ClientDgram::recv_batch(void)
+{
+	for (int i = 0; i < DGRAM_BATCH_SIZE; i++) {
+		struct msghdr *h = &rmsg[i].msg_hdr;
+		h->msg_name = raddr + i * alen;
+		h->msg_namelen = alen;
+		h->msg_iov = &riov[i];
+		h->msg_iovlen = 1;
+		h->msg_control = NULL;
+		h->msg_controllen = 0;
+		h->msg_flags = 0;
+	}
+
+	int n = recvmmsg(netfd, rmsg, DGRAM_BATCH_SIZE, MSG_DONTWAIT, NULL);
+	if (n <= 0) {
+		if (n < 0 && errno != EAGAIN && errno != EINTR)
+			log4cplus_info("recvmmsg error: errno=%d", errno);
+		return n;
+	}
+	stat_dgram_recv_syscall++;
+	stat_dgram_recv_packet += n;
+
+	for (int i = 0; i < n; i++) {
+		struct msghdr *h = &rmsg[i].msg_hdr;
+		int data_len = rmsg[i].msg_len;
+
+		if (h->msg_namelen <= 1) {
+			log4cplus_info("recvmmsg error: no source address");
+			continue;
+		}
+		if (data_len <= (int)sizeof(DTC_HEADER_V1)) {
+			log4cplus_info("recvmmsg error: size=%d", data_len);
+			continue;
+		}
+		if (allocate_dgram_info() < 0) {
+			log4cplus_error(
+				"%s",
+				"create DgramInfo object failed, msg[no enough memory]");
+			return -1;
+		}
+
+		memcpy(abuf->addr, h->msg_name, h->msg_namelen);
+		abuf->len = h->msg_namelen;
+		// 接收缓冲区会被下一批报文覆盖，job需要复制一份
+		decode_request((char *)riov[i].iov_base, data_len,
+			       0 /*clone*/);
+	}
+	return n;
+}
+
+// type: 参见DtcJob::do_decode，1表示job接管buf
+void ClientDgram::decode_request(char *buf, int data_len, int type)
+{
 	DTCJobOperation *job = new DTCJobOperation(owner->owner_table());
 	if (NULL == job) {
 		log4cplus_error(
 			"%s",
 			"create DTCJobOperation object failed, msg[no enough memory]");
-		return -1;
+		if (type == 1)
+			free(buf);
+		return;
 	}
 
 	job->set_hotbackup_table(owner->admin_table());
 
-	int ret = job->do_decode(buf, data_len, 1 /*eat*/);
+	int ret = job->do_decode(buf, data_len, type);
 	switch (ret) {
 	default:
 	case DecodeFatalError:
 		if (errno != 0)
 			log4cplus_info("decode fatal error, ret = %d msg = %m",
 				       ret);
-		free(buf); // buf not eatten
+		if (type == 1)
+			free(buf); // buf not eatten
+		delete job;
 		break;
 
 	case DecodeDataError:
@@ -243,7 +359,6 @@ int ClientDgram::recv_request(int noempty)
 		job->push_reply_dispatcher(&replyDgram);
 		owner->task_dispatcher(job);
 	}
-	return 0;
 }
 
 int ClientDgram::send_result(DTCJobOperation *job, void *addr, int len)
@@ -263,6 +378,22 @@ int ClientDgram::send_result(DTCJobOperation *job, void *addr, int len)
 	reply->encode_result(job, mtu);
 	delete job;
 
+	// 批量模式下应答先排队，本轮事件循环结束时统一sendmmsg
+	if (batch && len <= alen) {
+		char *a = saddr + nsend * alen;
+		memcpy(a, addr, len);
+		if (reply->fill_msghdr(&smsg[nsend].msg_hdr, a, len) == 0) {
+			delete reply;
+			return 0;
+		}
+		spkt[nsend] = reply;
+		if (nsend++ == 0)
+			attach_ready(owner->owner_thread());
+		if (nsend == DGRAM_BATCH_SIZE)
+			flush_reply();
+		return 0;
+	}
+
 	int ret = reply->send_to(netfd, (struct sockaddr *)addr, len);
 
 	delete reply;
@@ -274,13 +405,47 @@ int ClientDgram::send_result(DTCJobOperation *job, void *addr, int len)
 	return 0;
 }
 
+void ClientDgram::flush_reply(void)
+{
+	int i = 0;
+	while (i < nsend) {
+		int n = sendmmsg(netfd, smsg + i, nsend - i,
+				 MSG_DONTWAIT | MSG_NOSIGNAL);
+		stat_dgram_send_syscall++;
+		if (n <= 0) {
+			// 第一个报文就发送失败，丢弃它继续发送后面的
+			log4cplus_info("send failed, error = %m");
+			i++;
+			continue;
+		}
+		stat_dgram_send_packet += n;
+		i += n;
+	}
+
+	for (i = 0; i < nsend; i++)
+		delete spkt[i];
+	nsend = 0;
+}
+
+void ClientDgram::ready_notify(uint64_t now)
+{
+	flush_reply();
+}
+
 void ClientDgram::input_notify(void)
 {
 	log4cplus_debug("enter input_notify.");
 	const int batchsize = 64;
-	for (int i = 0; i < batchsize; ++i) {
-		if (recv_request(i) < 0)
-			break;
+	if (batch) {
+		for (int i = 0; i < batchsize; i += DGRAM_BATCH_SIZE) {
+			if (recv_batch() < DGRAM_BATCH_SIZE)
+				break;
+		}
+	} else {
+		for (int i = 0; i < batchsize; ++i) {
+			if (recv_request(i) < 0)
+				break;
+		}
 	}
 	log4cplus_debug("leave input_notify.");
 }
@@ -25,13 +25,16 @@
 class DTCDecoderUnit;
 class ClientDgram;
 
+/* recvmmsg/sendmmsg每次最多收发的报文个数 */
+#define DGRAM_BATCH_SIZE 32
+
 struct DgramInfo {
 	ClientDgram *cli;
 	socklen_t len;
 	char addr[0];
 };
 
-class ClientDgram : public EpollBase {
+class ClientDgram : public EpollBase, private ReadyObject {
     public:
 	DTCDecoderUnit *owner;
 
@@ -52,9 +55,27 @@ class ClientDgram : public EpollBase {
 	int alen; // address length
 	DgramInfo *abuf; // current packet address
 
+	/* 批量收发，只用于报文不超过64K的inet socket */
+	int batch;
+	char *rbuf; // DGRAM_BATCH_SIZE个mru大小的接收缓冲区
+	char *raddr; // 接收报文的源地址
+	struct iovec *riov;
+	struct mmsghdr *rmsg;
+	int nsend; // 等待sendmmsg的应答个数
+	Packet *spkt[DGRAM_BATCH_SIZE];
+	char *saddr; // 应答的目的地址
+	struct mmsghdr *smsg;
+
 	virtual void input_notify(void);
+	virtual void ready_notify(uint64_t now);
 	int allocate_dgram_info(void);
 	int init_socket_info(void);
+	int init_batch_buffer(void);
+	void decode_request(char *buf, int len, int type);
+	// recvmmsg收取一批报文，返回收到的个数
+	int recv_batch(void);
+	// sendmmsg发送所有排队的应答
+	void flush_reply(void);
 };
 
 #endif
@@ -129,6 +129,7 @@ ClientSync::~ClientSync()
 int ClientSync::do_attach()
 {
 	enable_input();
+	enable_edge_trigger();
 	if (attach_poller() == -1)
 		return -1;
 
@@ -163,6 +164,8 @@ int ClientSync::recv_request()
 		return -1;
 
 	case DecodeDataError:
+		if (edge_triggered())
+			retain_input();
 		job->response_timer_start();
 		job->mark_as_hit();
 		if (job->result_code() < 0)
@@ -188,6 +191,14 @@ int ClientSync::recv_request()
 		}
 
 		disable_output();
+		/*
+		 * ET模式下按包长读取，socket中可能还有下一个请求，
+		 * 处理期间不再关注输入，回包后重新关注时补发通知
+		 */
+		if (edge_triggered()) {
+			disable_input();
+			retain_input();
+		}
 		job->set_owner_info(this, 0, (struct sockaddr *)addr);
 		stage = ProcReqState;
 		job->push_reply_dispatcher(&syncReplyObject);
@@ -216,6 +227,7 @@ int ClientSync::Response(void)
 
 	switch (ret) {
 	case SendResultMoreData:
+		ready_events &= ~EPOLLOUT;
 		enable_output();
 		return 0;
 
@@ -256,6 +268,8 @@ void ClientSync::input_notify(void)
 			return;
 		} else {
 			disable_input();
+			if (edge_triggered())
+				retain_input();
 		}
 	}
 
@@ -374,6 +374,12 @@ int DbConfig::parse_db_config(DTCConfig* raw, int i_server_type = 0)
 
     checkTable = raw->get_int_val("DATABASE_CONF", (s_lower_prefix + "CheckTableConfig").c_str(), 1);
 
+    stmtCacheSize = raw->get_int_val("DATABASE_CONF", (s_lower_prefix + "StmtCacheSize").c_str(), 0);
+    if (stmtCacheSize < 0) {
+        log4cplus_error("invalid [DATABASE_CONF].StmtCacheSize");
+        return -1;
+    }
+
     // key-hash dll
     if (load_key_hash(raw) != 0)
         return -1;
@@ -493,6 +499,14 @@ int DbConfig::parse_db_config(DTCConfig* raw, int i_server_type = 0)
         return -1;
     }
 
+    idxTreeType = raw->get_idx_val(
+        (s_upper_prefix + "TABLE_CONF").c_str(), "IndexTreeType",
+        ((const char *const[]){ "ttree", "bptree", NULL }), 0);
+    if (idxTreeType < 0) {
+        log4cplus_error("bad [TABLE_CONF].IndexTreeType");
+        return -1;
+    }
+
     cp = raw->get_str_val((s_upper_prefix + "TABLE_CONF").c_str(), "ServerOrderBySQL");
     if (cp && cp[0] != '\0') {
         int n = strlen(cp) - 1;
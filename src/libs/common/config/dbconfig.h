@@ -99,6 +99,7 @@ struct DbConfig {
 
 	int dstype; /* data-source type: default is mysql   0: mysql  1: gaussdb  2: rocksdb */
 	int checkTable;
+	int stmtCacheSize; /* prepared statements cached per connection, 0(default): disable */
 	unsigned int dbDiv;
 	unsigned int dbMod;
 	unsigned int tblMod;
@@ -106,6 +107,7 @@ struct DbConfig {
 	int fieldCnt;
 	int keyFieldCnt;
 	int idxFieldCnt;
+	int idxTreeType; /* 0: t-tree  1: b+tree */
 	int machineCnt;
 	int procs; //all machine procs total
 	int database_max_count; //max db index
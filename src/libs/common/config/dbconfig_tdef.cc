@@ -70,6 +70,7 @@ DTCTableDefinition *DbConfig::build_table_definition(void)
 		return NULL;
 	}
 	tdef->set_index_fields(idxFieldCnt);
+	tdef->set_index_tree_type(idxTreeType);
 	tdef->build_info_cache();
 	return tdef;
 }
@@ -22,6 +22,7 @@
 #include "config/dbconfig.h"
 #include "connector_client.h"
 #include "connector/connector_group.h"
+#include "data_connector_ask_chain.h"
 #include "table/hotbackup_table_def.h"
 #include "table/table_def_manager.h"
 #include "task/task_pkey.h"
@@ -30,6 +31,8 @@
 #include "hwc_binlog_obj.h"
 
 static StatCounter statHelperExpireCount;
+static StatCounter statFlushBatchCount;
+static StatCounter statFlushBatchRowCount;
 
 static void IncHelperExpireCount()
 {
@@ -70,6 +73,41 @@ void WriteBinLogReplay::job_answer_procedure(DTCJobOperation *job_operation)
 }
 
 
+ConnectorFlushBatch::ConnectorFlushBatch(DTCTableDefinition *tdef)
+{
+    /* 整行提交：key和所有字段 */
+    const int n = tdef->num_fields() + 1;
+    uint8_t idtab[n];
+    for (int i = 0; i < n; i++)
+        idtab[i] = i;
+    fields = new DTCFieldSet(idtab, n);
+    rows = new ResultPacket(fields, 0, 0);
+}
+
+ConnectorFlushBatch::~ConnectorFlushBatch()
+{
+    DELETE(rows);
+    DELETE(fields);
+}
+
+int ConnectorFlushBatch::append(DTCJobOperation *job)
+{
+    /* flush任务由DtcJob::Copy(RowValue)生成，key加上全字段的Set操作 */
+    RowValue row(job->table_definition());
+    row[0] = *job->request_key();
+    if (job->DtcJob::update_row(row) < 0)
+        return -1;
+    if (rows->append_row(row) < 0)
+        return -1;
+    jobs.push_back(job);
+    return 0;
+}
+
+void FlushBatchReply::job_answer_procedure(DTCJobOperation *job)
+{
+    group->complete_flush_batch(job);
+}
+
 class HelperClientList : public ListObject<HelperClientList> {
     public:
     HelperClientList() : helper(NULL)
@@ -86,10 +124,13 @@ ConnectorGroup::ConnectorGroup(const char *s, const char *name_, int hc, int qs,
                    int statIndex , int i_has_hwc)
     : JobAskInterface<DTCJobOperation>(NULL), queueSize(qs), helperCount(0),
       helperMax(hc), readyHelperCnt(0), fallback(NULL),
+      collector(NULL),
       average_delay(0),/*默认时延为0*/
       hblogoutput_(owner),
       writeBinlogReply(),
-      i_has_hwc_(i_has_hwc)
+      i_has_hwc_(i_has_hwc),
+      flushBatchRows(0), flushBatchBytes(0),
+      flushBatchReply(this)
 {
     sockpath = strdup(s);
     freeHelper.InitList();
@@ -106,7 +147,10 @@ ConnectorGroup::ConnectorGroup(const char *s, const char *name_, int hc, int qs,
     statTime[3] = g_stat_mgr.get_sample(statIndex + 3);
     statTime[4] = g_stat_mgr.get_sample(statIndex + 4);
     statTime[5] = g_stat_mgr.get_sample(statIndex + 5);
-    
+
+    statFlushBatchCount = g_stat_mgr.get_stat_int_counter(FLUSH_BATCH_COUNT);
+    statFlushBatchRowCount =
+        g_stat_mgr.get_stat_int_counter(FLUSH_BATCH_ROW_COUNT);
 }
 
 ConnectorGroup::~ConnectorGroup()
@@ -166,6 +210,15 @@ int ConnectorGroup::WriteHBLog(
     const DTCJobOperation* p_job,
     int i_check)
 {
+    if (p_job->is_flush_batch()) {
+        /* 合并的flush按原任务逐个记录 */
+        ConnectorFlushBatch *batch =
+            const_cast<DTCJobOperation *>(p_job)->get_flush_batch();
+        for (size_t i = 0; i < batch->jobs.size(); i++)
+            WriteHBLog(batch->jobs[i], i_check);
+        return 0;
+    }
+
     log4cplus_info("WriteHBLog start");
     DTCJobOperation* p_task = new DTCJobOperation();
     if(NULL == p_task) {
@@ -333,7 +386,10 @@ void ConnectorGroup::process_task(DTCJobOperation *job)
         job->mark_field_set_with_key();
 
     Packet *packet = new Packet;
-    if (packet->encode_forward_request(job) != 0) {
+    int ret = job->is_flush_batch() ?
+        packet->encode_flush_batch(*job, *job->get_flush_batch()->rows) :
+        packet->encode_forward_request(*job);
+    if (ret != 0) {
         delete packet;
         log4cplus_error("[2][job=%d]request error: %m", job->Role());
         job->set_error(-EC_BAD_SOCKET, "ForwardRequest", NULL);
@@ -374,7 +430,7 @@ void ConnectorGroup::flush_task(uint64_t now)
             job->turn_around_job_answer();
         } else if (!freeHelper.ListEmpty()) {
             queue.Pop();
-            process_task(job);
+            process_task(build_flush_batch(job));
         } else if (fallback && fallback->has_free_helper()) {
             queue.Pop();
             fallback->process_task(job);
@@ -384,12 +440,100 @@ void ConnectorGroup::flush_task(uint64_t now)
     }
 }
 
+DTCJobOperation *ConnectorGroup::build_flush_batch(DTCJobOperation *job)
+{
+    if (flushBatchRows < 2 || job->request_type() != TaskTypeCommit ||
+        job->is_flush_batch())
+        return job;
+
+    /* 只合并已经在排队的任务，helper空闲时不额外等待 */
+    DTCJobOperation *next = queue.Front();
+    if (next == NULL || next->request_type() != TaskTypeCommit ||
+        next->is_flush_batch())
+        return job;
+
+    ConnectorFlushBatch *batch =
+        new ConnectorFlushBatch(job->table_definition());
+    if (batch->append(job) < 0) {
+        delete batch;
+        return job;
+    }
+
+    while (batch->row_count() < flushBatchRows &&
+           batch->byte_count() < flushBatchBytes) {
+        next = queue.Front();
+        if (next == NULL || next->request_type() != TaskTypeCommit ||
+            next->is_flush_batch())
+            break;
+        if (batch->append(next) < 0)
+            break;
+        queue.Pop();
+    }
+
+    if (batch->row_count() < 2) {
+        delete batch;
+        return job;
+    }
+
+    /* 载体任务沿用第一行的key，路由和表名与单行flush一致 */
+    RowValue row(job->table_definition());
+    row[0] = *job->request_key();
+    job->DtcJob::update_row(row);
+
+    DTCJobOperation *carrier = new DTCJobOperation(job->table_definition());
+    if (carrier->Copy(row) < 0) {
+        log4cplus_error("build flush batch error: %s",
+                carrier->resultInfo.error_message());
+        delete carrier;
+        /* 已经出队的任务放回队头，保持原来的顺序 */
+        for (int i = batch->row_count() - 1; i > 0; i--)
+            queue_back_task(batch->jobs[i]);
+        delete batch;
+        return job;
+    }
+    carrier->set_request_type(TaskTypeCommit);
+    carrier->set_flush_batch(batch);
+    carrier->set_owner_info(batch, 0, NULL);
+    carrier->push_reply_dispatcher(&flushBatchReply);
+
+    statFlushBatchCount++;
+    statFlushBatchRowCount += batch->row_count();
+    log4cplus_debug("flush batch %d rows %d bytes", batch->row_count(),
+            batch->byte_count());
+    return carrier;
+}
+
+void ConnectorGroup::complete_flush_batch(DTCJobOperation *job)
+{
+    ConnectorFlushBatch *batch = job->get_flush_batch();
+    int err = job->result_code();
+
+    if (err < 0)
+        log4cplus_warning("flush batch %d rows error: from %s msg %s",
+                  batch->row_count(), job->resultInfo.error_from(),
+                  job->resultInfo.error_message());
+
+    /* 整批在一个事务里，成功或失败对每个原任务都一样 */
+    for (size_t i = 0; i < batch->jobs.size(); i++) {
+        DTCJobOperation *t = batch->jobs[i];
+        if (err < 0)
+            t->set_error_dup(err, job->resultInfo.error_from(),
+                     job->resultInfo.error_message());
+        t->turn_around_job_answer();
+    }
+
+    delete batch;
+    delete job;
+}
+
 void ConnectorGroup::job_timer_procedure(void)
 {
     // log4cplus_debug("enter timer procedure");
     uint64_t v = GET_TIMESTAMP() / 1000;
     attach_timer(retryList);
     flush_task(v);
+    if (collector)
+        collector->publish_commit_queue_count();
     // log4cplus_debug("leave timer procedure");
 }
 
@@ -24,10 +24,51 @@
 #include "request/request_base.h"
 #include "stat_dtc.h"
 #include "task/task_request.h"
+#include "result.h"
+
+#include <vector>
 
 class ConnectorClient;
+class ConnectorGroup;
 class HelperClientList;
 class DbConfig;
+class DataConnectorAskChain;
+
+/*
+ * 多个flush任务(TaskTypeCommit)合并成的一个批量Replace，
+ * 行按出队顺序保存，helper在一个事务里执行，应答后再逐个回复原任务
+ */
+class ConnectorFlushBatch {
+    public:
+    ConnectorFlushBatch(DTCTableDefinition *tdef);
+    ~ConnectorFlushBatch();
+
+    /* 失败时不修改已有的行 */
+    int append(DTCJobOperation *job);
+    int row_count(void) const
+    {
+        return jobs.size();
+    }
+    int byte_count(void) const
+    {
+        return rows->bc->usedBytes;
+    }
+
+    std::vector<DTCJobOperation *> jobs;
+    DTCFieldSet *fields;
+    ResultPacket *rows;
+};
+
+class FlushBatchReply : public JobAnswerInterface<DTCJobOperation> {
+public:
+    FlushBatchReply(ConnectorGroup *g) : group(g)
+    { }
+    virtual ~FlushBatchReply()
+    { }
+    virtual void job_answer_procedure(DTCJobOperation *job);
+private:
+    ConnectorGroup *group;
+};
 
 class WriteBinLogReplay : public JobAnswerInterface<DTCJobOperation> {
 public:
@@ -94,6 +135,14 @@ class ConnectorGroup : private TimerObject,
 
     int WriteHBLog(const DTCJobOperation* p_job, int i_check = 0);
 
+    /* rows小于2时不合并flush任务 */
+    void set_flush_batch(int rows, int bytes)
+    {
+        flushBatchRows = rows;
+        flushBatchBytes = bytes;
+    }
+    void complete_flush_batch(DTCJobOperation *job);
+
 private:
     virtual void job_timer_procedure(void);
     /* trying pop job and process */
@@ -108,6 +157,8 @@ private:
     int accept_new_request_fail(DTCJobOperation *);
     void group_notify_helper_reload_config(DTCJobOperation *job);
     void process_reload_config(DTCJobOperation *job);
+    /* 把队列里连续的flush任务合并到job上，返回实际要发送的任务 */
+    DTCJobOperation *build_flush_batch(DTCJobOperation *job);
 
     void DispatchHotBackTask(DTCJobOperation* task) {
         task->push_reply_dispatcher(&writeBinlogReply);
@@ -136,8 +187,14 @@ private:
     WriteBinLogReplay writeBinlogReply; // hb replay
     int i_has_hwc_;
 
+    int flushBatchRows;
+    int flushBatchBytes;
+    FlushBatchReply flushBatchReply;
+
     public:
     ConnectorGroup *fallback;
+    /* 出队后通知collector刷新提交队列长度快照 */
+    DataConnectorAskChain *collector;
 
     public:
     void record_process_time(int type, unsigned int msec);
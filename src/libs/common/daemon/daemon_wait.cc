@@ -27,12 +27,22 @@
 #include "mem_check.h"
 #include <stat_dtc.h>
 #include "thread/thread_cpu_stat.h"
+#include "task/task_request.h"
+#include "packet/packet.h"
 
 void daemon_wait(void)
 {
 	StatCounter statfd =
 		g_stat_mgr.get_stat_int_counter(SERVER_OPENNING_FD);
 	statfd = 0;
+	StatCounter stat_job_malloc =
+		g_stat_mgr.get_stat_int_counter(POOL_JOB_MALLOC_COUNT);
+	StatCounter stat_job_free =
+		g_stat_mgr.get_stat_int_counter(POOL_JOB_FREE_COUNT);
+	StatCounter stat_packet_malloc =
+		g_stat_mgr.get_stat_int_counter(POOL_PACKET_MALLOC_COUNT);
+	StatCounter stat_packet_free =
+		g_stat_mgr.get_stat_int_counter(POOL_PACKET_FREE_COUNT);
 
 	unsigned fdthreshold, fdlimit = daemon_get_fd_limit();
 	if (fdlimit < 0)
@@ -49,6 +59,12 @@ void daemon_wait(void)
 
 		cpu_stat.do_stat();
 
+		/* 对象池稳定后job/packet的malloc/free计数不再增长 */
+		stat_job_malloc = ObjectPool<DTCJobOperation>::malloc_times();
+		stat_job_free = ObjectPool<DTCJobOperation>::free_times();
+		stat_packet_malloc = ObjectPool<Packet>::malloc_times();
+		stat_packet_free = ObjectPool<Packet>::free_times();
+
 		/* 扫描进程打开的fd句柄数，如果超过配置阈值，向二级网管告警 */
 		statfd = scan_process_openning_fd();
 		if ((unsigned)statfd > fdthreshold) {
@@ -240,6 +240,12 @@ int DataConnectorAskChain::build_helper_object(int idx)
 	DTCConfig* p_dtc_conf = dbConfig[idx]->cfgObj;
 	int i_has_hwc = p_dtc_conf ? p_dtc_conf->get_int_val("cache", "EnableHwc", 1) : 1;
 	log4cplus_info("enable hwc:%d" , i_has_hwc);
+	/* 排队中的flush任务合并成批量Replace，需要helper支持 */
+	int flush_batch_rows = p_dtc_conf ?
+		p_dtc_conf->get_int_val("cache", "FlushBatchRows", 0) : 0;
+	int flush_batch_bytes = p_dtc_conf ?
+		p_dtc_conf->get_int_val("cache", "FlushBatchBytes", 512 * 1024) :
+		512 * 1024;
 
 	/* build helper object */
 	for (int i = 0; i < dbConfig[idx]->machineCnt; i++) {
@@ -270,6 +276,12 @@ int DataConnectorAskChain::build_helper_object(int idx)
 					DTC_SQL_USEC_ALL,
 					i_has_hwc);
 
+			groups[idx][i * GROUPS_PER_MACHINE + j]->set_flush_batch(
+				flush_batch_rows, flush_batch_bytes);
+
+			groups[idx][i * GROUPS_PER_MACHINE + j]->collector =
+				this;
+
 			if (j >= GROUPS_PER_ROLE)
 				groups[idx][i * GROUPS_PER_MACHINE + j]
 					->fallback =
@@ -622,6 +634,7 @@ void DataConnectorAskChain::job_ask_procedure(DTCJobOperation *job)
 	stat_helper_group_queue_count(groups[0], dbConfig[0]->machineCnt *
 							 GROUPS_PER_MACHINE);
 	stat_helper_group_cur_max_queue_count(job->request_type());
+	publish_commit_queue_count();
 }
 
 int DataConnectorAskChain::load_config(DbConfig *cfg, int keysize, int idx)
@@ -743,6 +756,16 @@ int DataConnectorAskChain::get_queue_cur_max_count(int iColumn)
 	}
 	return max_count;
 }
+void DataConnectorAskChain::publish_commit_queue_count(void)
+{
+	if (dbConfig[0] == NULL || groups[0] == NULL)
+		return;
+
+	int commit = get_queue_cur_max_count(MASTER_COMMIT_GROUP_COLUMN);
+	int write = get_queue_cur_max_count(MASTER_WRITE_GROUP_COLUMN);
+	flushQueueCount.set(commit > write ? commit : write);
+}
+
 /*传入请求类型，每次只根据请求类型统计响应的值*/
 void DataConnectorAskChain::stat_helper_group_cur_max_queue_count(
 	int iRequestType)
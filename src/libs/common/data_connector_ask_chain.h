@@ -63,6 +63,14 @@ class DataConnectorAskChain : public JobAskInterface<DTCJobOperation> {
 	{
 		return hasDummyMachine;
 	}
+	/* flush任务所在组当前最大的排队长度，提交组被禁用时flush走写组。
+	 * 组只在connector线程访问，这里读的是connector线程发布的快照 */
+	int commit_queue_count(void) const
+	{
+		return (int)flushQueueCount.get();
+	}
+	/* connector线程在入队和组定时器出队后刷新快照 */
+	void publish_commit_queue_count(void);
 
     private:
 	virtual void job_ask_procedure(DTCJobOperation *);
@@ -105,6 +113,7 @@ private:
 	StatCounter statReadQueueCurMaxCount; /*所有机器所有主读组当前最大的队列大小*/
 	StatCounter statWriteQueueMaxCount; /*所有机器所有写组当前最大的队列大小*/
 	StatCounter statCommitQueueCurMaxCount; /*所有机器所有提交组当前最大的队列大小*/
+	AtomicU32 flushQueueCount; /*commit_queue_count的快照*/
 	StatCounter statSlaveReadQueueMaxCount; /*所有机器所有备读组当前最大的队列大小*/
 };
 
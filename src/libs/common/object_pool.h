@@ -0,0 +1,107 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#ifndef __DTC_OBJECT_POOL_H__
+#define __DTC_OBJECT_POOL_H__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <new>
+
+#include "compiler.h"
+#include "mem_check.h"
+
+/*
+ * 按线程缓存的定长对象池，用于替换高频对象的operator new/delete。
+ * 对象可以在一个线程分配、在另一个线程释放，释放的内存挂到释放线程的
+ * 空闲链表上；每个线程最多缓存MAX_FREE个，多余的还给malloc。
+ * 派生类(size不等于sizeof(T))直接走malloc。
+ * 只有走到malloc/free的慢路径才更新全局计数，稳态下malloc计数不再增长。
+ * 这里只覆盖job和packet对象本身：接收缓冲区、解码出的字段和值、结果块
+ * 仍然各自malloc/free，计数不增长不代表命中路径上没有分配。
+ */
+template <class T, int MAX_FREE = 1024> class ObjectPool {
+    private:
+	struct FreeNode {
+		FreeNode *next;
+	};
+
+#if HAS_TLS
+	static __thread FreeNode *free_list;
+	static __thread int cached_count;
+#endif
+	static volatile uint64_t malloc_count;
+	static volatile uint64_t free_count_total;
+
+    public:
+	static void *alloc(size_t size)
+	{
+#if HAS_TLS
+		if (likely(size == sizeof(T) && free_list != NULL)) {
+			FreeNode *n = free_list;
+			free_list = n->next;
+			cached_count--;
+			return n;
+		}
+#endif
+		void *p = MALLOC(size);
+		if (p == NULL)
+			throw std::bad_alloc();
+		__sync_fetch_and_add(&malloc_count, 1);
+		return p;
+	}
+
+	static void release(void *p, size_t size)
+	{
+		if (p == NULL)
+			return;
+#if HAS_TLS
+		if (likely(size == sizeof(T) && cached_count < MAX_FREE)) {
+			FreeNode *n = (FreeNode *)p;
+			n->next = free_list;
+			free_list = n;
+			cached_count++;
+			return;
+		}
+#endif
+		FREE(p);
+		__sync_fetch_and_add(&free_count_total, 1);
+	}
+
+	/* 从malloc分配的对象个数 */
+	static uint64_t malloc_times(void)
+	{
+		return malloc_count;
+	}
+	/* 还给free的对象个数 */
+	static uint64_t free_times(void)
+	{
+		return free_count_total;
+	}
+};
+
+#if HAS_TLS
+template <class T, int MAX_FREE>
+__thread typename ObjectPool<T, MAX_FREE>::FreeNode
+	*ObjectPool<T, MAX_FREE>::free_list = NULL;
+template <class T, int MAX_FREE>
+__thread int ObjectPool<T, MAX_FREE>::cached_count = 0;
+#endif
+template <class T, int MAX_FREE>
+volatile uint64_t ObjectPool<T, MAX_FREE>::malloc_count = 0;
+template <class T, int MAX_FREE>
+volatile uint64_t ObjectPool<T, MAX_FREE>::free_count_total = 0;
+
+#endif
@@ -17,12 +17,14 @@
 #define __CH_PACKET_H__
 
 #include <sys/uio.h>
+#include <sys/socket.h>
 
 #include "protocol.h"
 #include "section.h"
 #include "socket/socket_addr.h"
 #include "log/log.h"
 #include "result.h"
+#include "object_pool.h"
 
 class NCRequest;
 union DTCValue;
@@ -51,6 +53,16 @@ class Packet {
 		FREE_IF(buf);
 	}
 
+	/* 每个应答都要分配一个packet，走线程本地的空闲链表 */
+	static void *operator new(size_t size)
+	{
+		return ObjectPool<Packet>::alloc(size);
+	}
+	static void operator delete(void *p, size_t size)
+	{
+		ObjectPool<Packet>::release(p, size);
+	}
+
 	inline void Clean()
 	{
 		v = NULL;
@@ -61,6 +73,8 @@ class Packet {
 	}
 	int Send(int fd);
 	int send_to(int fd, void *name, int namelen);
+	/* 填充sendmsg/sendmmsg使用的消息头，返回0表示没有数据要发送 */
+	int fill_msghdr(struct msghdr *msgh, void *name, int namelen);
 	int send_to(int fd, SocketAddress *addr)
 	{
 		return addr == NULL ?
@@ -95,6 +109,8 @@ class Packet {
 	int encode_forward_request(DTCJobOperation &);
 	int encode_pass_thru(DtcJob &);
 	int encode_fetch_data(DTCJobOperation &);
+	/* 合并的flush请求：Replace + DTCResultSet，rows的缓冲区由调用者持有 */
+	int encode_flush_batch(DtcJob &, ResultPacket &rows);
 
 	// encode result, for helper/server reply
 	// side effect:
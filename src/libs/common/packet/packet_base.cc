@@ -64,18 +64,25 @@ int Packet::Send(int fd)
 	return nv == 0 ? SendResultDone : SendResultMoreData;
 }
 
-int Packet::send_to(int fd, void *addr, int len)
+int Packet::fill_msghdr(struct msghdr *msgh, void *addr, int len)
 {
 	if (nv <= 0)
-		return SendResultDone;
+		return 0;
+	msgh->msg_name = addr;
+	msgh->msg_namelen = len;
+	msgh->msg_iov = v;
+	msgh->msg_iovlen = nv;
+	msgh->msg_control = NULL;
+	msgh->msg_controllen = 0;
+	msgh->msg_flags = 0;
+	return nv;
+}
+
+int Packet::send_to(int fd, void *addr, int len)
+{
 	struct msghdr msgh;
-	msgh.msg_name = addr;
-	msgh.msg_namelen = len;
-	msgh.msg_iov = v;
-	msgh.msg_iovlen = nv;
-	msgh.msg_control = NULL;
-	msgh.msg_controllen = 0;
-	msgh.msg_flags = 0;
+	if (fill_msghdr(&msgh, addr, len) == 0)
+		return SendResultDone;
 
 	int rv = sendmsg(fd, &msgh, MSG_DONTWAIT | MSG_NOSIGNAL);
 
@@ -472,6 +472,94 @@ int Packet::encode_pass_thru(DtcJob &job)
 	return 0;
 }
 
+int Packet::encode_flush_batch(DtcJob &job, ResultPacket &rows)
+{
+	const DTCTableDefinition *tdef = job.table_definition();
+	DTC_HEADER_V1 header;
+
+	/* 行数据直接引用rows的缓冲区，不做拷贝 */
+	BufferChain *rb = rows.bc;
+	if (rb == NULL || rows.numRows == 0)
+		return -EINVAL;
+	int off = 5 - encoded_bytes_length(rows.numRows);
+	encode_length(rb->data + off, rows.numRows);
+	const int lrp = rb->usedBytes - off;
+
+	header.version = 1;
+	header.scts = 8;
+	header.flags = DRequest::Flag::KeepAlive;
+	header.cmd = DRequest::Replace;
+
+	/* calculate version info */
+	header.len[DRequest::Section::VersionInfo] =
+		encoded_bytes_simple_section(job.versionInfo, DField::None);
+
+	/* no table definition */
+	header.len[DRequest::Section::table_definition] = 0;
+
+	/* encode request info */
+	header.len[DRequest::Section::RequestInfo] =
+		encoded_bytes_simple_section(job.requestInfo, tdef->key_type());
+
+	/* no result info */
+	header.len[DRequest::Section::ResultInfo] = 0;
+
+	/* no update info, all rows in result set */
+	header.len[DRequest::Section::UpdateInfo] = 0;
+
+	/* no condition info */
+	header.len[DRequest::Section::ConditionInfo] = 0;
+
+	/* no field set */
+	header.len[DRequest::Section::FieldSet] = 0;
+
+	/* batch rows */
+	header.len[DRequest::Section::DTCResultSet] = lrp;
+
+	bytes = encode_header_v1(header);
+	const int len = bytes - lrp;
+
+	/* pool, exist and large enough, use. else free and malloc */
+	int total_len = sizeof(BufferChain) + sizeof(struct iovec) * 2 + len;
+	if (buf == NULL) {
+		buf = (BufferChain *)MALLOC(total_len);
+		if (buf == NULL) {
+			return -ENOMEM;
+		}
+		buf->totalBytes = total_len - sizeof(BufferChain);
+	} else if (buf &&
+		   buf->totalBytes < total_len - (int)sizeof(BufferChain)) {
+		FREE_IF(buf);
+		buf = (BufferChain *)MALLOC(total_len);
+		if (buf == NULL) {
+			return -ENOMEM;
+		}
+		buf->totalBytes = total_len - sizeof(BufferChain);
+	}
+
+	/* rows的缓冲区不挂到nextBuffer上，避免被free_result_buff释放 */
+	buf->nextBuffer = NULL;
+	v = (struct iovec *)buf->data;
+	nv = 2;
+	char *p = buf->data + sizeof(struct iovec) * 2;
+	v[0].iov_base = p;
+	v[0].iov_len = len;
+	v[1].iov_base = rb->data + off;
+	v[1].iov_len = lrp;
+
+	memcpy(p, &header, sizeof(header));
+	p += sizeof(header);
+	p = encode_simple_section(p, job.versionInfo, DField::None);
+	p = encode_simple_section(p, job.requestInfo, tdef->key_type());
+
+	if (p - (char *)v->iov_base != len)
+		fprintf(stderr, "%s(%d): BAD ENCODER len=%ld must=%d\n",
+			__FILE__, __LINE__, (long)(p - (char *)v->iov_base),
+			len);
+
+	return 0;
+}
+
 int Packet::encode_forward_request(DTCJobOperation &job)
 {
 	if (job.flag_pass_thru())
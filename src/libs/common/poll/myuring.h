@@ -0,0 +1,137 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#ifndef __MY_URING_H__
+#define __MY_URING_H__
+
+/*
+ * io_uring内核ABI的最小子集，直接走系统调用，不依赖liburing和
+ * 系统的linux/io_uring.h头文件。只定义了poll用到的部分。
+ */
+#include <stdint.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+
+#define URING_OFF_SQ_RING 0ULL
+#define URING_OFF_CQ_RING 0x8000000ULL
+#define URING_OFF_SQES 0x10000000ULL
+
+#define URING_FEAT_SINGLE_MMAP (1U << 0)
+#define URING_FEAT_NODROP (1U << 1)
+#define URING_FEAT_EXT_ARG (1U << 8)
+
+#define URING_ENTER_GETEVENTS (1U << 0)
+#define URING_ENTER_EXT_ARG (1U << 3)
+
+#define URING_OP_POLL_ADD 6
+#define URING_OP_POLL_REMOVE 7
+
+/* POLL_ADD的sqe->len */
+#define URING_POLL_ADD_MULTI (1U << 0)
+
+#define URING_CQE_F_MORE (1U << 1)
+
+struct uring_sqring_offsets {
+	uint32_t head;
+	uint32_t tail;
+	uint32_t ring_mask;
+	uint32_t ring_entries;
+	uint32_t flags;
+	uint32_t dropped;
+	uint32_t array;
+	uint32_t resv1;
+	uint64_t resv2;
+};
+
+struct uring_cqring_offsets {
+	uint32_t head;
+	uint32_t tail;
+	uint32_t ring_mask;
+	uint32_t ring_entries;
+	uint32_t overflow;
+	uint32_t cqes;
+	uint32_t flags;
+	uint32_t resv1;
+	uint64_t resv2;
+};
+
+struct uring_params {
+	uint32_t sq_entries;
+	uint32_t cq_entries;
+	uint32_t flags;
+	uint32_t sq_thread_cpu;
+	uint32_t sq_thread_idle;
+	uint32_t features;
+	uint32_t wq_fd;
+	uint32_t resv[3];
+	struct uring_sqring_offsets sq_off;
+	struct uring_cqring_offsets cq_off;
+};
+
+struct uring_sqe {
+	uint8_t opcode;
+	uint8_t flags;
+	uint16_t ioprio;
+	int32_t fd;
+	uint64_t off;
+	uint64_t addr;
+	uint32_t len;
+	uint32_t poll32_events;
+	uint64_t user_data;
+	uint16_t buf_index;
+	uint16_t personality;
+	int32_t splice_fd_in;
+	uint64_t pad2[2];
+};
+
+struct uring_cqe {
+	uint64_t user_data;
+	int32_t res;
+	uint32_t flags;
+};
+
+struct uring_timespec {
+	int64_t tv_sec;
+	long long tv_nsec;
+};
+
+struct uring_getevents_arg {
+	uint64_t sigmask;
+	uint32_t sigmask_sz;
+	uint32_t pad;
+	uint64_t ts;
+};
+
+static inline int uring_setup(unsigned entries, struct uring_params *p)
+{
+	return syscall(__NR_io_uring_setup, entries, p);
+}
+
+static inline int uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+			      unsigned flags, void *arg, size_t argsz)
+{
+	return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+		       arg, argsz);
+}
+
+#endif
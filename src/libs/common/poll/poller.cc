@@ -25,6 +25,7 @@
 
 #include "poller_base.h"
 #include "poller.h"
+#include "uring_poller.h"
 #include "../log/log.h"
 
 EpollBase::~EpollBase()
@@ -43,6 +44,12 @@ EpollBase::~EpollBase()
 	}
 }
 
+void EpollBase::enable_edge_trigger(void)
+{
+	if (epslot <= 0 && owner_unit && owner_unit->edge_trigger)
+		edge_trigger = 1;
+}
+
 int EpollBase::attach_poller(EpollOperation *unit)
 {
 	if (unit) {
@@ -65,9 +72,11 @@ int EpollBase::attach_poller(EpollOperation *unit)
 		fcntl(netfd, F_SETFL, O_NONBLOCK | flag);
 		struct epoll_event ev;
 		memset(&ev, 0x0, sizeof(ev));
-		ev.events = new_events;
+		ev.events = edge_trigger ? (EPOLLIN | EPOLLOUT | EPOLLET) :
+					   new_events;
 		slot->seq++;
 		ev.data.u64 = ((unsigned long long)slot->seq << 32) + epslot;
+		ready_events = 0;
 		if (owner_unit->epoll_control(EPOLL_CTL_ADD, netfd, &ev) == 0)
 			old_events = new_events;
 		else {
@@ -85,6 +94,9 @@ int EpollBase::detach_poller()
 	if (epslot) {
 		struct epoll_event ev;
 		memset(&ev, 0x0, sizeof(ev));
+		ev.data.u64 = ((unsigned long long)owner_unit->get_slot(epslot)->seq
+			       << 32) +
+			      epslot;
 		if (owner_unit->epoll_control(EPOLL_CTL_DEL, netfd, &ev) == 0)
 			old_events = new_events;
 		else {
@@ -102,6 +114,12 @@ int EpollBase::apply_events()
 	if (epslot <= 0 || old_events == new_events)
 		return 0;
 
+	/* ET模式只需更新用户态的关注位 */
+	if (edge_trigger) {
+		old_events = new_events;
+		return 0;
+	}
+
 	struct epoll_event ev;
 	memset(&ev, 0x0, sizeof(ev));
 
@@ -121,7 +139,18 @@ int EpollBase::apply_events()
 
 int EpollBase::delay_apply_events()
 {
-	if (epslot <= 0 || old_events == new_events)
+	if (epslot <= 0)
+		return 0;
+
+	/* 
+	 * ET模式直接生效，只有新打开的关注位上有未通知的事件时，
+	 * 才需要在本轮事件循环结束前补发通知
+	 */
+	if (edge_trigger) {
+		old_events = new_events;
+		if ((ready_events & new_events) == 0)
+			return 0;
+	} else if (old_events == new_events)
 		return 0;
 
 	if (event_slot)
@@ -130,6 +159,12 @@ int EpollBase::delay_apply_events()
 	event_slot = owner_unit->add_delay_event_poller(this);
 	if (event_slot == NULL) {
 		log4cplus_error("max events!!!!!!");
+		/* 无法排队补发时立即通知，否则事件会一直留在ready_events里 */
+		if (edge_trigger) {
+			owner_unit->dispatch_edge_events(this);
+			return 0;
+		}
+
 		struct epoll_event ev;
 
 		ev.events = new_events;
@@ -195,6 +230,9 @@ EpollOperation::EpollOperation(int mp)
 
 	eevent_size = max_pollers > 1024 ? 1024 : max_pollers;
 	epfd = -1;
+	edge_trigger = 0;
+	use_uring = 0;
+	uring = NULL;
 	ep_events = NULL;
 	poller_list = NULL;
 	current_pos = 0;
@@ -212,6 +250,7 @@ EpollOperation::~EpollOperation()
 	}
 
 	FREE_CLEAR(poller_list);
+	DELETE(uring);
 
 	if (epfd != -1) {
 		close(epfd);
@@ -260,6 +299,22 @@ int EpollOperation::initialize_poller_unit(void)
 		return -1;
 	}
 	fcntl(epfd, F_SETFD, FD_CLOEXEC);
+
+	if (use_uring) {
+		int entries = 1;
+		while (entries < max_pollers && entries < 4096)
+			entries <<= 1;
+		NEW(UringPoller, uring);
+		if (uring == NULL || uring->initialize(entries, max_pollers) < 0) {
+			log4cplus_warning("io_uring unavailable, fallback to epoll");
+			DELETE(uring);
+		} else
+			log4cplus_info("poller use io_uring, entries %d", entries);
+	}
+
+	stat_epoll_wait = g_stat_mgr.get_stat_int_counter(EPOLL_WAIT_COUNT);
+	stat_epoll_events = g_stat_mgr.get_stat_int_counter(EPOLL_EVENT_COUNT);
+	stat_epoll_ctl = g_stat_mgr.get_stat_int_counter(EPOLL_CTL_COUNT);
 	return 0;
 }
 
@@ -291,6 +346,8 @@ void EpollOperation::remove_epoll_slot(int n)
 	used_pollers--;
 	poller_list[n].seq++;
 	poller_list[n].poller = NULL;
+	if (uring)
+		uring->remove_slot(n);
 }
 
 int EpollOperation::insert_epoll_slot()
@@ -312,6 +369,10 @@ int EpollOperation::insert_epoll_slot()
 
 int EpollOperation::epoll_control(int op, int fd, struct epoll_event *events)
 {
+	if (uring)
+		return uring->control(op, fd, events);
+
+	stat_epoll_ctl++;
 	if (epoll_ctl(epfd, op, fd, events) == -1) {
 		log4cplus_warning("epoll_ctl error, epfd=%d, fd=%d", epfd, fd);
 
@@ -323,11 +384,59 @@ int EpollOperation::epoll_control(int op, int fd, struct epoll_event *events)
 
 int EpollOperation::wait_poller_events(int timeout)
 {
-	need_request_events_count =
-		epoll_wait(epfd, ep_events, eevent_size, timeout);
+	if (uring)
+		need_request_events_count =
+			uring->wait(ep_events, eevent_size, timeout);
+	else
+		need_request_events_count =
+			epoll_wait(epfd, ep_events, eevent_size, timeout);
+	stat_epoll_wait++;
+	if (need_request_events_count > 0)
+		stat_epoll_events += need_request_events_count;
 	return need_request_events_count;
 }
 
+/*
+ * 一次epoll_wait取满说明还有就绪事件没有取到，处理完本批事件后
+ * 按倍数扩大事件数组，上限为max_pollers
+ */
+void EpollOperation::grow_poller_events(void)
+{
+	if (need_request_events_count < eevent_size ||
+	    eevent_size >= max_pollers)
+		return;
+
+	int n = eevent_size * 2;
+	if (n > max_pollers)
+		n = max_pollers;
+
+	struct epoll_event *p = (struct epoll_event *)REALLOC(
+		ep_events, n * sizeof(struct epoll_event));
+	if (p == NULL) {
+		log4cplus_warning("grow epoll events to %d failed, %m", n);
+		return;
+	}
+	ep_events = p;
+	eevent_size = n;
+	log4cplus_debug("epoll events array grows to %d", eevent_size);
+}
+
+/* 只通知已关注的就绪事件，其余的留在ready_events中等关注时再补发 */
+void EpollOperation::dispatch_edge_events(EpollBase *p)
+{
+	int slot = p->epslot;
+	int ready = p->ready_events & p->old_events;
+
+	p->ready_events &= ~ready;
+	if (ready & EPOLLIN) {
+		p->input_notify();
+		if (poller_list[slot].poller != p)
+			return;
+	}
+	if (ready & EPOLLOUT)
+		p->output_notify();
+}
+
 void EpollOperation::process_poller_events(void)
 {
 	for (int i = 0; i < need_request_events_count; i++) {
@@ -347,17 +456,24 @@ void EpollOperation::process_poller_events(void)
 			continue;
 		}
 
-		if (ep_events[i].events & EPOLLIN)
+		if (p->edge_trigger) {
+			p->ready_events |=
+				ep_events[i].events & (EPOLLIN | EPOLLOUT);
+			dispatch_edge_events(p);
+		} else if (ep_events[i].events & EPOLLIN)
 			p->input_notify();
 
 		s = &poller_list[EPOLL_DATA_SLOT(ep_events + i)];
-		if (s->poller == p && ep_events[i].events & EPOLLOUT)
+		if (s->poller == p && !p->edge_trigger &&
+		    ep_events[i].events & EPOLLOUT)
 			p->output_notify();
 
 		s = &poller_list[EPOLL_DATA_SLOT(ep_events + i)];
 		if (s->poller == p)
 			p->delay_apply_events();
 	}
+
+	grow_poller_events();
 }
 
 int EpollOperation::delay_apply_events()
@@ -368,6 +484,9 @@ int EpollOperation::delay_apply_events()
 			p->apply_events();
 			event_slot[i].poller = NULL;
 			p->clean_slot_event();
+			/* 补发ET模式下新关注的就绪事件，可能再次加入event_slot */
+			if (p->edge_trigger)
+				dispatch_edge_events(p);
 		}
 	}
 	event_cnt = 0;
@@ -20,12 +20,14 @@
 #include <sys/poll.h>
 #include "myepoll.h"
 #include "list/list.h"
+#include "stat_dtc.h"
 
 #define EPOLL_DATA_SLOT(x) ((x)->data.u64 & 0xFFFFFFFF)
 #define EPOLL_DATA_SEQ(x) ((x)->data.u64 >> 32)
 
 class EpollOperation;
 class EpollBase;
+class UringPoller;
 
 struct EpollSlot {
 	EpollBase *poller;
@@ -41,7 +43,7 @@ class EpollBase {
     public:
 	EpollBase(EpollOperation *o = NULL, int fd = 0)
 		: owner_unit(o), netfd(fd), new_events(0), old_events(0),
-		  epslot(0)
+		  epslot(0), edge_trigger(0), ready_events(0)
 	{
 	}
 
@@ -83,6 +85,24 @@ class EpollBase {
 			new_events &= ~EPOLLOUT;
 	}
 
+	/*
+	 * 边沿触发(ET)：内核中固定关注IN|OUT，enable/disable只修改用户态的
+	 * 关注位，不再调用epoll_ctl。开启后子类必须遵守：收到通知后读/写到
+	 * EAGAIN为止，或者关闭对应的关注位；未读空就返回的需要调用
+	 * retain_input()，否则该socket不会再收到输入通知。
+	 * 必须在attach_poller之前调用，所在线程未开启EpollEdgeTrigger时无效。
+	 */
+	void enable_edge_trigger(void);
+	int edge_triggered(void) const
+	{
+		return edge_trigger;
+	}
+	/* ET模式下socket中还有未读的数据，重新关注输入时再通知一次 */
+	void retain_input(void)
+	{
+		ready_events |= EPOLLIN;
+	}
+
 	int attach_poller(EpollOperation *thread = NULL);
 	int detach_poller(void);
 	int apply_events();
@@ -103,6 +123,9 @@ class EpollBase {
 	int new_events;
 	int old_events;
 	int epslot;
+	int edge_trigger;
+	/* ET模式下已经就绪但尚未通知(未关注)的事件 */
+	int ready_events;
 	struct EventSlot *event_slot;
 };
 
@@ -125,9 +148,20 @@ class EpollOperation {
 		return epfd;
 	}
 	int delay_apply_events();
+	void set_edge_trigger(int et)
+	{
+		edge_trigger = et;
+	}
+	/* 使用io_uring代替epoll，内核不支持时自动回退到epoll */
+	void set_io_uring(int u)
+	{
+		use_uring = u;
+	}
 
     private:
 	int verify_events(struct epoll_event *);
+	void dispatch_edge_events(EpollBase *p);
+	void grow_poller_events(void);
 	int epoll_control(int op, int fd, struct epoll_event *events);
 	struct EpollSlot *get_slot(int n)
 	{
@@ -156,6 +190,12 @@ class EpollOperation {
 	int current_pos;
 	int max_pollers;
 	int used_pollers;
+	int edge_trigger;
+	int use_uring;
+	UringPoller *uring;
+	StatCounter stat_epoll_wait;
+	StatCounter stat_epoll_events;
+	StatCounter stat_epoll_ctl;
 	/* FIXME: maybe too small */
 	static int total_event_slot;
 	struct EventSlot event_slot[40960];
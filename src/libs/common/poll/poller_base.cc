@@ -50,6 +50,9 @@ int PollerBase::initialize(void)
 		if (mp1 > mp0) {
 			set_max_pollers(mp1);
 		}
+		set_edge_trigger(
+			g_autoconf->get_int_val("EpollEdgeTrigger", Name(), 0));
+		set_io_uring(g_autoconf->get_int_val("PollerIoUring", Name(), 0));
 	}
 	if (initialize_poller_unit() < 0)
 		return -1;
@@ -0,0 +1,394 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <endian.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include "mem_check.h"
+
+#include "uring_poller.h"
+#include "poller.h"
+#include "../log/log.h"
+
+/* user_data高32位是slot的gen，从1开始；小于2^32的留给内部请求 */
+#define URING_INTERNAL_KEY(k) (((k) >> 32) == 0)
+#define URING_USER_DATA(gen, slot) (((uint64_t)(gen) << 32) | (uint32_t)(slot))
+#define URING_PROBE_KEY 1ULL
+
+static inline uint32_t uring_poll_events(uint32_t ev)
+{
+#if __BYTE_ORDER == __BIG_ENDIAN
+	return (ev << 16) | (ev >> 16);
+#else
+	return ev;
+#endif
+}
+
+UringPoller::UringPoller()
+	: ring_fd(-1), sq_ring(NULL), cq_ring(NULL), sqes(NULL),
+	  sq_ring_size(0), cq_ring_size(0), sqes_size(0), sq_head(NULL),
+	  sq_tail(NULL), sq_mask(NULL), sq_array(NULL), cq_head(NULL),
+	  cq_tail(NULL), cq_mask(NULL), cqes(NULL), sq_entries(0),
+	  to_submit(0), slots(NULL), max_slots(0), rearm_list(NULL),
+	  rearm_count(0)
+{
+}
+
+UringPoller::~UringPoller()
+{
+	if (sqes)
+		munmap(sqes, sqes_size);
+	if (cq_ring && cq_ring != sq_ring)
+		munmap(cq_ring, cq_ring_size);
+	if (sq_ring)
+		munmap(sq_ring, sq_ring_size);
+	if (ring_fd >= 0)
+		close(ring_fd);
+
+	FREE_CLEAR(slots);
+	FREE_CLEAR(rearm_list);
+}
+
+int UringPoller::initialize(int entries, int maxslots)
+{
+	struct uring_params p;
+	const uint32_t need = URING_FEAT_SINGLE_MMAP | URING_FEAT_NODROP |
+			      URING_FEAT_EXT_ARG;
+
+	memset(&p, 0, sizeof(p));
+	ring_fd = uring_setup(entries, &p);
+	if (ring_fd < 0) {
+		log4cplus_info("io_uring_setup failed, %m");
+		return -1;
+	}
+	if ((p.features & need) != need) {
+		log4cplus_info("io_uring features 0x%x not supported",
+			       p.features);
+		return -1;
+	}
+
+	sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct uring_cqe);
+	if (cq_ring_size > sq_ring_size)
+		sq_ring_size = cq_ring_size;
+	cq_ring_size = sq_ring_size;
+
+	sq_ring = mmap(NULL, sq_ring_size, PROT_READ | PROT_WRITE,
+		       MAP_SHARED | MAP_POPULATE, ring_fd, URING_OFF_SQ_RING);
+	if (sq_ring == MAP_FAILED) {
+		sq_ring = NULL;
+		log4cplus_warning("mmap io_uring ring failed, %m");
+		return -1;
+	}
+	cq_ring = sq_ring;
+
+	sqes_size = p.sq_entries * sizeof(struct uring_sqe);
+	sqes = (struct uring_sqe *)mmap(NULL, sqes_size,
+					PROT_READ | PROT_WRITE,
+					MAP_SHARED | MAP_POPULATE, ring_fd,
+					URING_OFF_SQES);
+	if (sqes == MAP_FAILED) {
+		sqes = NULL;
+		log4cplus_warning("mmap io_uring sqes failed, %m");
+		return -1;
+	}
+
+	char *sq = (char *)sq_ring;
+	char *cq = (char *)cq_ring;
+	sq_head = (unsigned *)(sq + p.sq_off.head);
+	sq_tail = (unsigned *)(sq + p.sq_off.tail);
+	sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+	sq_array = (unsigned *)(sq + p.sq_off.array);
+	cq_head = (unsigned *)(cq + p.cq_off.head);
+	cq_tail = (unsigned *)(cq + p.cq_off.tail);
+	cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+	cqes = (struct uring_cqe *)(cq + p.cq_off.cqes);
+	sq_entries = p.sq_entries;
+
+	/* sqe与sq array一一对应，之后不再修改array */
+	for (unsigned i = 0; i < sq_entries; i++)
+		sq_array[i] = i;
+
+	max_slots = maxslots;
+	slots = (struct UringSlot *)CALLOC(max_slots, sizeof(*slots));
+	rearm_list = (int *)CALLOC(max_slots, sizeof(int));
+	if (slots == NULL || rearm_list == NULL) {
+		log4cplus_error("calloc failed, num=%d, %m", max_slots);
+		return -1;
+	}
+	for (int i = 0; i < max_slots; i++) {
+		slots[i].fd = -1;
+		slots[i].gen = 1;
+	}
+
+	if (probe_multishot() < 0) {
+		log4cplus_info("io_uring multishot poll not supported");
+		return -1;
+	}
+
+	return 0;
+}
+
+/* 取一个空闲的sqe，sq满时先把已填好的提交掉 */
+struct uring_sqe *UringPoller::get_sqe(void)
+{
+	unsigned tail = *sq_tail;
+
+	if (tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) >= sq_entries) {
+		if (submit(0, 0, NULL) < 0)
+			return NULL;
+		if (tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) >=
+		    sq_entries)
+			return NULL;
+	}
+
+	struct uring_sqe *sqe = &sqes[tail & *sq_mask];
+	memset(sqe, 0, sizeof(*sqe));
+	return sqe;
+}
+
+int UringPoller::submit(unsigned min_complete, unsigned flags, void *arg)
+{
+	int ret = uring_enter(ring_fd, to_submit, min_complete, flags, arg,
+			      arg ? sizeof(struct uring_getevents_arg) : 0);
+	if (ret > 0)
+		to_submit -= (unsigned)ret > to_submit ? to_submit : ret;
+	return ret;
+}
+
+void UringPoller::arm(int slot)
+{
+	struct UringSlot *s = &slots[slot];
+	struct uring_sqe *sqe = get_sqe();
+
+	if (sqe == NULL) {
+		log4cplus_error("io_uring sq full, fd=%d", s->fd);
+		return;
+	}
+
+	sqe->opcode = URING_OP_POLL_ADD;
+	sqe->fd = s->fd;
+	sqe->poll32_events = uring_poll_events(s->events);
+	sqe->len = s->multishot ? URING_POLL_ADD_MULTI : 0;
+	sqe->user_data = URING_USER_DATA(s->gen, slot);
+	__atomic_store_n(sq_tail, *sq_tail + 1, __ATOMIC_RELEASE);
+	to_submit++;
+	s->armed = 1;
+}
+
+void UringPoller::cancel(uint64_t user_data)
+{
+	struct uring_sqe *sqe = get_sqe();
+
+	if (sqe == NULL) {
+		log4cplus_error("io_uring sq full, cancel poll failed");
+		return;
+	}
+
+	sqe->opcode = URING_OP_POLL_REMOVE;
+	sqe->fd = -1;
+	sqe->addr = user_data;
+	sqe->user_data = 0;
+	__atomic_store_n(sq_tail, *sq_tail + 1, __ATOMIC_RELEASE);
+	to_submit++;
+}
+
+/* multishot poll需要5.13以上的内核，旧内核会返回EINVAL */
+int UringPoller::probe_multishot(void)
+{
+	int fds[2];
+	int ok = 0;
+
+	if (pipe(fds) < 0)
+		return -1;
+	if (write(fds[1], "", 1) != 1) {
+		close(fds[0]);
+		close(fds[1]);
+		return -1;
+	}
+
+	struct uring_sqe *sqe = get_sqe();
+	sqe->opcode = URING_OP_POLL_ADD;
+	sqe->fd = fds[0];
+	sqe->poll32_events = uring_poll_events(EPOLLIN);
+	sqe->len = URING_POLL_ADD_MULTI;
+	sqe->user_data = URING_PROBE_KEY;
+	__atomic_store_n(sq_tail, *sq_tail + 1, __ATOMIC_RELEASE);
+	to_submit++;
+
+	if (submit(1, URING_ENTER_GETEVENTS, NULL) >= 0) {
+		unsigned head = *cq_head;
+		unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+		for (; head != tail; head++) {
+			struct uring_cqe *cqe = &cqes[head & *cq_mask];
+			if (cqe->user_data == URING_PROBE_KEY && cqe->res > 0 &&
+			    (cqe->flags & URING_CQE_F_MORE))
+				ok = 1;
+		}
+		__atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+	}
+
+	/* 取消后剩下的完成事件都是内部key，reap时会跳过 */
+	cancel(URING_PROBE_KEY);
+	submit(1, URING_ENTER_GETEVENTS, NULL);
+	close(fds[0]);
+	close(fds[1]);
+
+	return ok ? 0 : -1;
+}
+
+/*
+ * 取消slot当前的poll。替换后的poll与旧的poll不共用user_data，
+ * 旧poll的-ECANCELED或者与取消同时到达的通知在reap时按gen丢弃
+ */
+void UringPoller::cancel_slot(int slot)
+{
+	struct UringSlot *s = &slots[slot];
+
+	if (s->armed)
+		cancel(URING_USER_DATA(s->gen, slot));
+	s->armed = 0;
+	if (++s->gen == 0)
+		s->gen = 1;
+}
+
+int UringPoller::control(int op, int fd, struct epoll_event *ev)
+{
+	int slot = EPOLL_DATA_SLOT(ev);
+
+	if (slot <= 0 || slot >= max_slots) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	struct UringSlot *s = &slots[slot];
+	switch (op) {
+	case EPOLL_CTL_ADD:
+	case EPOLL_CTL_MOD:
+		cancel_slot(slot);
+		s->fd = fd;
+		s->events = ev->events & ~EPOLLET;
+		s->multishot = (ev->events & EPOLLET) != 0;
+		s->key = ev->data.u64;
+		arm(slot);
+		return 0;
+
+	case EPOLL_CTL_DEL:
+		remove_slot(slot);
+		return 0;
+	}
+
+	errno = EINVAL;
+	return -1;
+}
+
+/*
+ * poll持有文件的引用，fd关闭前必须取消，
+ * 取消请求在下一次wait时和其他请求一起提交
+ */
+void UringPoller::remove_slot(int slot)
+{
+	if (slot <= 0 || slot >= max_slots)
+		return;
+
+	cancel_slot(slot);
+	slots[slot].fd = -1;
+}
+
+int UringPoller::reap(struct epoll_event *events, int maxevents)
+{
+	unsigned head = *cq_head;
+	unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+	int n = 0;
+
+	for (; head != tail && n < maxevents; head++) {
+		struct uring_cqe *cqe = &cqes[head & *cq_mask];
+		uint64_t user_data = cqe->user_data;
+
+		if (URING_INTERNAL_KEY(user_data))
+			continue;
+
+		int slot = user_data & 0xFFFFFFFF;
+		if (slot <= 0 || slot >= max_slots)
+			continue;
+
+		/* 取消或者被替换掉的poll，不能影响slot当前的poll */
+		struct UringSlot *s = &slots[slot];
+		if ((uint32_t)(user_data >> 32) != s->gen || !s->armed)
+			continue;
+
+		/* 单次poll(或者被内核终止的multishot)通知后需要重新提交 */
+		if (!(cqe->flags & URING_CQE_F_MORE)) {
+			s->armed = 0;
+			if (!s->rearm) {
+				s->rearm = 1;
+				rearm_list[rearm_count++] = slot;
+			}
+		}
+
+		/* 内核终止的multishot，上面已经安排重新提交 */
+		if (cqe->res == -ECANCELED)
+			continue;
+
+		events[n].events = cqe->res < 0 ? EPOLLERR : cqe->res;
+		events[n].data.u64 = s->key;
+		n++;
+	}
+	__atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+
+	return n;
+}
+
+int UringPoller::wait(struct epoll_event *events, int maxevents, int timeout)
+{
+	for (int i = 0; i < rearm_count; i++) {
+		struct UringSlot *s = &slots[rearm_list[i]];
+		s->rearm = 0;
+		if (s->fd >= 0 && !s->armed)
+			arm(rearm_list[i]);
+	}
+	rearm_count = 0;
+
+	int ret = 0;
+	if (*cq_head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE) ||
+	    timeout == 0) {
+		/* 已经有完成事件，只提交不等待 */
+		if (to_submit)
+			ret = submit(0, 0, NULL);
+	} else {
+		struct uring_timespec ts;
+		struct uring_getevents_arg arg;
+
+		memset(&arg, 0, sizeof(arg));
+		if (timeout > 0) {
+			ts.tv_sec = timeout / 1000;
+			ts.tv_nsec = (timeout % 1000) * 1000000LL;
+			arg.ts = (uint64_t)(unsigned long)&ts;
+		}
+		ret = submit(1, URING_ENTER_GETEVENTS | URING_ENTER_EXT_ARG,
+			     &arg);
+	}
+
+	if (ret < 0 && errno != ETIME && errno != EINTR)
+		log4cplus_warning("io_uring_enter failed, %m");
+
+	int n = reap(events, maxevents);
+	if (n == 0 && ret < 0 && errno == EINTR)
+		return -1;
+	return n;
+}
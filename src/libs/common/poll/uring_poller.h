@@ -0,0 +1,91 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#ifndef __URING_POLLER_H__
+#define __URING_POLLER_H__
+
+#include "myepoll.h"
+#include "myuring.h"
+
+/*
+ * 用io_uring的POLL_ADD代替epoll_ctl/epoll_wait，对EpollOperation保持
+ * 同样的事件格式(epoll_event)，EpollBase的回调接口不变。
+ * 电平触发的poller用单次poll，通知后在下一次等待时重新提交；
+ * 边沿触发(EPOLLET)的poller用multishot poll，只提交一次。
+ * 所有的提交都和等待合并在一次io_uring_enter中完成。
+ * 实验性质，由PollerIoUring打开(默认关闭)：在单线程echo测试中与
+ * 边沿触发的epoll吞吐相当，只有频繁切换IN/OUT时省掉epoll_ctl。
+ */
+class UringPoller {
+    public:
+	UringPoller();
+	~UringPoller();
+
+	/* 内核不支持(低于5.13)时返回-1，调用者回退到epoll */
+	int initialize(int entries, int max_slots);
+	/* 与epoll_ctl参数相同，slot取自events->data */
+	int control(int op, int fd, struct epoll_event *events);
+	void remove_slot(int slot);
+	/* 与epoll_wait返回值相同 */
+	int wait(struct epoll_event *events, int maxevents, int timeout);
+
+    private:
+	struct UringSlot {
+		int fd;
+		uint32_t events;
+		uint64_t key;
+		/* 每次取消加一，区分被取消的poll迟到的完成事件 */
+		uint32_t gen;
+		uint8_t armed;
+		uint8_t multishot;
+		uint8_t rearm;
+	};
+
+	struct uring_sqe *get_sqe(void);
+	int submit(unsigned min_complete, unsigned flags, void *arg);
+	void arm(int slot);
+	void cancel(uint64_t user_data);
+	void cancel_slot(int slot);
+	int probe_multishot(void);
+	int reap(struct epoll_event *events, int maxevents);
+
+    private:
+	int ring_fd;
+	void *sq_ring;
+	void *cq_ring;
+	struct uring_sqe *sqes;
+	size_t sq_ring_size;
+	size_t cq_ring_size;
+	size_t sqes_size;
+
+	unsigned *sq_head;
+	unsigned *sq_tail;
+	unsigned *sq_mask;
+	unsigned *sq_array;
+	unsigned *cq_head;
+	unsigned *cq_tail;
+	unsigned *cq_mask;
+	struct uring_cqe *cqes;
+	unsigned sq_entries;
+	/* 已填好还未提交的sqe个数 */
+	unsigned to_submit;
+
+	struct UringSlot *slots;
+	int max_slots;
+	int *rearm_list;
+	int rearm_count;
+};
+
+#endif
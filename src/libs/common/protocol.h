@@ -121,6 +121,7 @@ class DRequest {
 			ColExpandDone = 26,
 			ColExpandKey = 27,
 			Cascade = 28,
+			AdjustLRUBatch = 29,
 		};
 	};
 };
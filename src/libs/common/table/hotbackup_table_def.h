@@ -35,6 +35,8 @@ class DTCHotBackup {
 	       HAS_VALUE = 2,
 	       EMPTY_NODE = 4,
 	       KEY_NOEXIST = 8,
+	       KEY_BATCH = 16, // value中是LruSyncBatch编码的一批key,
+			       // 备机用AdjustLRUBatch回放
 	};
 };
 
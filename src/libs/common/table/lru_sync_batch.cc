@@ -0,0 +1,176 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <string.h>
+#include <algorithm>
+
+#include "lru_sync_batch.h"
+
+static inline void put_varint(std::string &out, uint64_t v)
+{
+	while (v >= 0x80) {
+		out.push_back((char)(v | 0x80));
+		v >>= 7;
+	}
+	out.push_back((char)v);
+}
+
+static inline int get_varint(const char *&p, const char *end, uint64_t &v)
+{
+	v = 0;
+	for (int shift = 0; shift < 64 && p < end; shift += 7) {
+		uint8_t b = *p++;
+		v |= (uint64_t)(b & 0x7f) << shift;
+		if (!(b & 0x80))
+			return 0;
+	}
+	return -1;
+}
+
+LruSyncBatch::LruSyncBatch(int key_format) : key_format_(key_format)
+{
+}
+
+void LruSyncBatch::Reset(void)
+{
+	ints_.clear();
+	keys_.clear();
+}
+
+void LruSyncBatch::add_key(const char *packed_key)
+{
+	if (key_format_ > 0 && key_format_ <= (int)sizeof(uint64_t)) {
+		uint64_t v = 0;
+		memcpy(&v, packed_key, key_format_);
+		ints_.push_back(v);
+	} else {
+		int len = key_format_ ? key_format_ :
+					*(unsigned char *)packed_key + 1;
+		keys_.push_back(std::string(packed_key, len));
+	}
+}
+
+int LruSyncBatch::Encode(std::string &out)
+{
+	int count;
+
+	out.clear();
+	if (key_format_ > 0 && key_format_ <= (int)sizeof(uint64_t)) {
+		std::sort(ints_.begin(), ints_.end());
+		ints_.erase(std::unique(ints_.begin(), ints_.end()),
+			    ints_.end());
+		count = ints_.size();
+
+		out.push_back((char)LSB_INT);
+		put_varint(out, count);
+		uint64_t last = 0;
+		for (int i = 0; i < count; i++) {
+			put_varint(out, ints_[i] - last);
+			last = ints_[i];
+		}
+	} else {
+		std::sort(keys_.begin(), keys_.end());
+		keys_.erase(std::unique(keys_.begin(), keys_.end()),
+			    keys_.end());
+		count = keys_.size();
+
+		out.push_back((char)(key_format_ ? LSB_FIXED : LSB_VAR));
+		put_varint(out, count);
+		for (int i = 0; i < count; i++)
+			out.append(keys_[i]);
+	}
+
+	return count;
+}
+
+LruSyncBatchReader::LruSyncBatchReader()
+	: pos_(NULL), end_(NULL), mode_(0), key_format_(0), count_(0),
+	  read_(0), last_(0)
+{
+}
+
+int LruSyncBatchReader::Attach(const char *buf, int len, int key_format)
+{
+	uint64_t count;
+
+	pos_ = buf;
+	end_ = buf + len;
+	key_format_ = key_format;
+	read_ = 0;
+	last_ = 0;
+
+	if (len < 1)
+		return -1;
+	mode_ = *pos_++;
+	switch (mode_) {
+	case LSB_INT:
+		if (key_format <= 0 || key_format > (int)sizeof(uint64_t))
+			return -1;
+		break;
+	case LSB_FIXED:
+		if (key_format <= 0 || key_format >= (int)sizeof(key_))
+			return -1;
+		break;
+	case LSB_VAR:
+		if (key_format != 0)
+			return -1;
+		break;
+	default:
+		return -1;
+	}
+	if (get_varint(pos_, end_, count) < 0 || count > (uint64_t)len)
+		return -1;
+	count_ = count;
+
+	return 0;
+}
+
+int LruSyncBatchReader::Next(const char *&packed_key)
+{
+	if (read_ >= count_)
+		return 0;
+
+	int len;
+	switch (mode_) {
+	case LSB_INT: {
+		uint64_t delta;
+		if (get_varint(pos_, end_, delta) < 0)
+			return -1;
+		last_ += delta;
+		memcpy(key_, &last_, key_format_);
+		packed_key = key_;
+		break;
+	}
+	case LSB_FIXED:
+		len = key_format_;
+		if (end_ - pos_ < len)
+			return -1;
+		packed_key = pos_;
+		pos_ += len;
+		break;
+	default:
+		if (pos_ >= end_)
+			return -1;
+		len = *(unsigned char *)pos_ + 1;
+		if (end_ - pos_ < len)
+			return -1;
+		packed_key = pos_;
+		pos_ += len;
+		break;
+	}
+
+	read_++;
+	return 1;
+}
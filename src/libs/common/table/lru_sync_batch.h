@@ -0,0 +1,76 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#ifndef __DTC_LRU_SYNC_BATCH_H__
+#define __DTC_LRU_SYNC_BATCH_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*
+ * 热备LRU同步的批量key记录，一次扫描产生一条：
+ * |1B mode|varint count|keys|
+ * LSB_INT:   定长key且不超过8字节，按整数排序去重，写varint差值
+ * LSB_FIXED: 其它定长key，排序去重后直接拼接
+ * LSB_VAR:   变长key(首字节为长度)，排序去重后直接拼接
+ */
+enum { LSB_INT = 1, LSB_FIXED = 2, LSB_VAR = 3 };
+
+class LruSyncBatch {
+    public:
+	/* key_format: 定长key的字节数，变长key为0 */
+	LruSyncBatch(int key_format);
+
+	void Reset(void);
+	void add_key(const char *packed_key);
+	int Count(void) const
+	{
+		return ints_.size() + keys_.size();
+	}
+	/* 排序去重后编码到out，返回记录中的key个数 */
+	int Encode(std::string &out);
+
+    private:
+	int key_format_;
+	std::vector<uint64_t> ints_;
+	std::vector<std::string> keys_;
+};
+
+class LruSyncBatchReader {
+    public:
+	LruSyncBatchReader();
+
+	/* 成功返回0，格式错误返回-1 */
+	int Attach(const char *buf, int len, int key_format);
+	/* 读出下一个packed key返回1，读完返回0，格式错误返回-1 */
+	int Next(const char *&packed_key);
+	int Count(void) const
+	{
+		return count_;
+	}
+
+    private:
+	const char *pos_;
+	const char *end_;
+	int mode_;
+	int key_format_;
+	int count_;
+	int read_;
+	uint64_t last_;
+	char key_[256];
+};
+
+#endif
@@ -0,0 +1,114 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <stdlib.h>
+#include <string.h>
+
+#include "../table/table_def.h"
+#include "row_codec.h"
+#include "mem_check.h"
+
+DTCRowCodec::DTCRowCodec()
+	: start_(0), fixed_row_size_(1), num_segments_(0), segments_(NULL),
+	  fields_(NULL)
+{
+	memset(field_segment_, -1, sizeof(field_segment_));
+	memset(field_offset_, 0, sizeof(field_offset_));
+	memset(field_kind_, 0, sizeof(field_kind_));
+}
+
+DTCRowCodec::~DTCRowCodec()
+{
+	FREE_IF(segments_);
+	FREE_IF(fields_);
+}
+
+int DTCRowCodec::build(const DTCTableDefinition *t)
+{
+	int n = t->num_fields() + 1;
+
+	FREE_IF(segments_);
+	FREE_IF(fields_);
+	/* 最坏情况每个字段一段 */
+	segments_ = (RowCodecSegment *)calloc(n + 1, sizeof(RowCodecSegment));
+	fields_ = (RowCodecField *)calloc(n, sizeof(RowCodecField));
+	if (segments_ == NULL || fields_ == NULL)
+		return -1;
+	memset(field_segment_, -1, sizeof(field_segment_));
+	memset(field_offset_, 0, sizeof(field_offset_));
+	memset(field_kind_, 0, sizeof(field_kind_));
+
+	start_ = t->key_fields();
+	fixed_row_size_ = 1; // flag
+	num_segments_ = 0;
+
+	int nfield = 0;
+	RowCodecSegment *seg = &segments_[0];
+	seg->first = 0;
+	seg->var_id = -1;
+	for (int j = start_; j <= t->num_fields(); j++) {
+		if (t->is_discard(j))
+			continue;
+
+		int kind;
+		switch (t->field_type(j)) {
+		case DField::Signed:
+			kind = t->field_size(j) > (int)sizeof(int32_t) ?
+				       RC_INT64 :
+				       RC_INT32;
+			break;
+		case DField::Unsigned:
+			kind = t->field_size(j) > (int)sizeof(uint32_t) ?
+				       RC_INT64 :
+				       RC_UINT32;
+			break;
+		case DField::Float:
+			kind = t->field_size(j) > (int)sizeof(float) ?
+				       RC_DOUBLE :
+				       RC_FLOAT;
+			break;
+		case DField::String:
+		case DField::Binary:
+		default:
+			kind = -1;
+			break;
+		}
+
+		if (kind < 0) {
+			/* 变长字段结束当前段 */
+			seg->var_id = j;
+			seg = &segments_[++num_segments_];
+			seg->first = nfield;
+			seg->var_id = -1;
+			continue;
+		}
+
+		RowCodecField *f = &fields_[nfield++];
+		f->id = j;
+		f->kind = kind;
+		f->offset = seg->fixed_size;
+		field_segment_[j] = num_segments_;
+		field_offset_[j] = seg->fixed_size;
+		field_kind_[j] = kind;
+		seg->fixed_size += kind_size(kind);
+		seg->count++;
+		fixed_row_size_ += kind_size(kind);
+	}
+	/* 最后一段没有定长字段也没有变长字段时丢弃 */
+	if (seg->count > 0)
+		num_segments_++;
+
+	return 0;
+}
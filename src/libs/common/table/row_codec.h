@@ -0,0 +1,114 @@
+/*
+* Copyright [2021] JD.com, Inc.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#ifndef __DTC_ROW_CODEC_H_
+#define __DTC_ROW_CODEC_H_
+
+#include <stdint.h>
+
+class DTCTableDefinition;
+
+/*
+ * RawData行编码的预计算布局，加载表定义时由build_info_cache()生成。
+ * 行格式保持不变：|1字节flag|key之后、非discard字段按id顺序排列|，
+ * 定长字段直接存放，变长字段为|4字节长度|数据|。
+ * 连续的定长字段合并成一段，段内偏移预先算好，编解码时每段只检查一次边界，
+ * 只有变长字段需要逐个读取长度。
+ */
+enum {
+	RC_INT32 = 0, // Signed, <= 4字节
+	RC_UINT32, // Unsigned, <= 4字节
+	RC_INT64, // Signed/Unsigned, 8字节
+	RC_FLOAT,
+	RC_DOUBLE,
+};
+
+struct RowCodecField {
+	uint8_t id;
+	uint8_t kind; // RC_*
+	uint16_t offset; // 段内偏移
+};
+
+struct RowCodecSegment {
+	uint16_t fixed_size; // 本段定长字段总字节数
+	uint16_t first; // 在fields中的起始下标
+	uint16_t count; // 定长字段个数
+	int16_t var_id; // 段尾的变长字段id，-1表示没有
+};
+
+class DTCRowCodec {
+    public:
+	DTCRowCodec();
+	~DTCRowCodec();
+
+	/* 从key之后的第一个字段开始生成布局 */
+	int build(const DTCTableDefinition *t);
+
+	/* 行数据的起始字段id */
+	int start_field(void) const
+	{
+		return start_;
+	}
+	/* flag加上所有定长字段的大小 */
+	int fixed_row_size(void) const
+	{
+		return fixed_row_size_;
+	}
+	int num_segments(void) const
+	{
+		return num_segments_;
+	}
+	const RowCodecSegment &segment(int n) const
+	{
+		return segments_[n];
+	}
+	const RowCodecField &field(int n) const
+	{
+		return fields_[n];
+	}
+	/* 字段所在的段，变长或discard字段返回-1 */
+	int field_segment(int id) const
+	{
+		return id >= 0 && id < 256 ? field_segment_[id] : -1;
+	}
+	/* 字段在段内的偏移 */
+	int field_offset(int id) const
+	{
+		return field_offset_[id];
+	}
+	/* 定长字段的编码类型RC_* */
+	int field_kind(int id) const
+	{
+		return field_kind_[id];
+	}
+	static int kind_size(int kind)
+	{
+		return kind == RC_INT64 || kind == RC_DOUBLE ? 8 : 4;
+	}
+
+    private:
+	int start_;
+	int fixed_row_size_;
+	int num_segments_;
+	RowCodecSegment *segments_;
+	RowCodecField *fields_;
+	int16_t field_segment_[256];
+	uint16_t field_offset_[256];
+	uint8_t field_kind_[256];
+
+	DTCRowCodec(const DTCRowCodec &);
+};
+
+#endif
@@ -22,6 +22,7 @@
 // skip scope test here, we need full decleration
 #undef CLIENTAPI
 #include "../table/table_def.h"
+#include "row_codec.h"
 #include "algorithm/md5.h"
 #include "../decode/decode.h"
 #include "dtc_error_code.h"
@@ -44,7 +45,8 @@ const SectionDefinition tableAttributeDefinition = {
 };
 
 DTCTableDefinition::DTCTableDefinition(int m)
-	: maxFields(m), usedFields(0), numFields(0), keyFields(0)
+	: maxFields(m), usedFields(0), numFields(0), keyFields(0),
+	  rowCodec(NULL)
 {
 	// memset 0xFF, == all value 0xFFFF (HASHSTOP)
 	memset(nameHash, 0xFF, sizeof(nameHash));
@@ -75,6 +77,7 @@ DTCTableDefinition::DTCTableDefinition(int m)
 		m_row_size = 0;
 		hasDiscard = 0;
 		indexFields = 0; // by TREE_DATA
+		indexTreeType = INDEX_TREE_TTREE;
 		maxKeySize = 0;
 	} else {
 		// client side code
@@ -92,6 +95,7 @@ DTCTableDefinition::DTCTableDefinition(int m)
 		//	 keyFormat
 		//	 m_row_size
 		//	 indexFields
+		//	 indexTreeType
 		// because client side don't use it, and save a lot of CPU cycle
 	}
 }
@@ -114,6 +118,7 @@ DTCTableDefinition::~DTCTableDefinition(void)
 		FREE_IF(rawFields);
 		FREE(defaultValue);
 	}
+	delete rowCodec;
 }
 
 // used for bitmap svr
@@ -431,7 +436,9 @@ int DTCTableDefinition::build_info_cache(void)
 
 	memcpy(hash, packedTableDefinition.ptr, 16);
 
-	return 0;
+	if (rowCodec == NULL)
+		rowCodec = new DTCRowCodec();
+	return rowCodec->build(this);
 }
 
 int DTCTableDefinition::Unpack(const char *ptr, int len)
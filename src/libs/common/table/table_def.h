@@ -23,6 +23,8 @@
 
 #include <vector>
 
+class DTCRowCodec;
+
 struct FieldDefinition {
     public:
 	enum { FF_READONLY = 1,
@@ -49,6 +51,11 @@ struct FieldDefinition {
 
 extern const SectionDefinition tableAttributeDefinition;
 
+// index structure used by TREE_DATA
+enum { INDEX_TREE_TTREE = 0,
+       INDEX_TREE_BPTREE = 1,
+};
+
 class TableAttribute : public SimpleSection {
     public:
 	enum { SingleRow = 0x1,
@@ -137,8 +144,10 @@ class DTCTableDefinition {
 	uint8_t keyFormat; // 0:varsize, 1-255:fixed, large than 255 is invalid
 	uint8_t hasDiscard;
 	int8_t indexFields; // TREE_DATA, disabled in this release
+	uint8_t indexTreeType; // TREE_DATA, INDEX_TREE_TTREE/INDEX_TREE_BPTREE
 	uint8_t uniqFieldCnt; //the size of uniqFields member
 	uint8_t keysAsUniqField; /* 0 == NO, 1 == EXACT, 2 == SUBSET */
+	DTCRowCodec *rowCodec; // server side, RawData行编码布局
 
 	// no copy
 	DTCTableDefinition(const DTCTableDefinition &);
@@ -313,6 +322,10 @@ class DTCTableDefinition {
 		v = packedTableDefinition;
 	}
 	int build_info_cache(void);
+	const DTCRowCodec *row_codec(void) const
+	{
+		return rowCodec;
+	}
 	const DTCBinary &packed_field_set(void) const
 	{
 		return packedFullFieldSet;
@@ -463,6 +476,14 @@ class DTCTableDefinition {
 	{
 		indexFields = n;
 	}
+	int index_tree_type() const
+	{
+		return indexTreeType;
+	}
+	void set_index_tree_type(int n)
+	{
+		indexTreeType = n;
+	}
 
 	int set_key_fields(int n = 1);
 	// 0: string or binary
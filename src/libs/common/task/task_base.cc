@@ -455,9 +455,12 @@ int DtcJob::validate_section(DTC_HEADER_V1 &header)
 		return -1;
 	}
 
-	if ((m & ~validsections[header.cmd][1]) != 0) {
-		log4cplus_error("m[%x] valid[%x]", m,
-				validsections[header.cmd][1]);
+	int valid = validsections[header.cmd][1];
+	if (header.cmd == DRequest::Replace && accept_batch_replace)
+		valid |= 1 << DRequest::Section::DTCResultSet;
+
+	if ((m & ~valid) != 0) {
+		log4cplus_error("m[%x] valid[%x]", m, valid);
 		set_error(-EC_EXTRA_SECTION, "decoder", "Extra Section");
 		return -1;
 	}
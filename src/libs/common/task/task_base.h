@@ -85,6 +85,8 @@ class DtcJob : public TableReference {
 	static const uint32_t validcmds[];
 	static const uint16_t cmd2type[];
 	static const uint16_t validsections[][2];
+	/* helper进程接受DTC合并flush行的Replace，DTCResultSet中为多行数据 */
+	static bool accept_batch_replace;
 	static const uint8_t validktype[DField::TotalType][DField::TotalType];
 	static const uint8_t validxtype[DField::TotalOperation]
 				       [DField::TotalType][DField::TotalType];
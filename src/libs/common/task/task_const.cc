@@ -69,6 +69,8 @@ const uint16_t DtcJob::cmd2type[] = {
 	TaskTypeHelperReloadConfig, //Reload
 };
 
+bool DtcJob::accept_batch_replace = false;
+
 const uint16_t DtcJob::validsections[][2] = {
 	//0001 VersionInfo
 	//0002 DataDefinition
@@ -50,6 +50,7 @@ void DTCJobOperation::Clean()
 	expire_time = 0;
 	keyList = NULL;
 	batch_key = NULL;
+	flush_batch = NULL;
 	DtcJob::Clean();
 	TaskOwnerInfo::Clean();
 }
@@ -20,11 +20,13 @@
 #include "task_base.h"
 #include "stop_watch.h"
 #include "hotback_task.h"
+#include "object_pool.h"
 class DecoderBase;
 class MultiRequest;
 class NCKeyValueList;
 class NCRequest;
 class AgentMultiRequest;
+class ConnectorFlushBatch;
 class ClientAgent;
 
 class TaskOwnerInfo {
@@ -81,12 +83,23 @@ class DTCJobOperation : public DtcJob,
 		: DtcJob(t, TaskRoleServer), blacklist_size(0), timestamp(0),
 		  barrier_hash(0), packedKey(NULL), expire_time(0),
 		  multi_key(NULL), keyList(NULL), batch_key(NULL),
-		  agent_multi_req(NULL), owner_client_(NULL), recv_buf(NULL),
+		  flush_batch(NULL), agent_multi_req(NULL), owner_client_(NULL),
+		  recv_buf(NULL),
 		  recv_len(0), recv_packet_cnt(0), resource_id(0),
 		  packet_version(0), resource_owner(NULL), resource_seq(0){};
 
 	virtual ~DTCJobOperation();
 
+	/* 每个请求都要分配一个job，走线程本地的空闲链表 */
+	static void *operator new(size_t size)
+	{
+		return ObjectPool<DTCJobOperation>::alloc(size);
+	}
+	static void operator delete(void *p, size_t size)
+	{
+		ObjectPool<DTCJobOperation>::release(p, size);
+	}
+
 	inline DTCJobOperation(const DTCJobOperation &rq)
 	{
 		DTCJobOperation();
@@ -232,6 +245,8 @@ class DTCJobOperation : public DtcJob,
 	const NCKeyValueList *keyList;
 	/* need clean when job begin in use(deleted when batch request finished) */
 	MultiRequest *batch_key;
+	/* 合并了多个flush任务的批量提交，由ConnectorGroup负责释放 */
+	ConnectorFlushBatch *flush_batch;
 
 	/* for agent request */
     private:
@@ -281,6 +296,19 @@ class DTCJobOperation : public DtcJob,
 	int set_batch_cursor(int i);
 	void done_batch_cursor(int i);
 
+	int is_flush_batch(void) const
+	{
+		return flush_batch != NULL;
+	}
+	void set_flush_batch(ConnectorFlushBatch *fb)
+	{
+		flush_batch = fb;
+	}
+	ConnectorFlushBatch *get_flush_batch(void)
+	{
+		return flush_batch;
+	}
+
     public:
 	/* for agent request */
 	void set_owner_client(ClientAgent *client);
@@ -14,6 +14,7 @@
 * limitations under the License.
 */
 #include <stdint.h>
+#include <string.h>
 #include "../timer/timer_list.h"
 #include "../log/log.h"
 #if TIMESTAMP_PRECISION < 1000
@@ -43,12 +44,148 @@ void TimerObject::job_timer_procedure(void)
 
 void TimerObject::attach_timer(class TimerList *lst)
 {
+	if (lst->timerUnitOwner) {
+		attach_timer(lst->timerUnitOwner, lst->timeout);
+		return;
+	}
+
 	if (lst->timeout > 0)
 		objexp = lst->get_time_unit_now_time() +
 			 lst->timeout * (TIMESTAMP_PRECISION / 1000);
 	list_move_tail(lst->tlist);
 }
 
+void TimerObject::attach_timer(class TimerUnit *unit, int msec)
+{
+	objexp = unit->get_now_time();
+	if (msec > 0)
+		objexp += (int64_t)msec * (TIMESTAMP_PRECISION / 1000);
+	unit->wheel.add(this);
+}
+
+#define TW_TICK ((int64_t)(TIMESTAMP_PRECISION / 1000))
+#define TW_ROOT_MASK (TW_ROOT_SIZE - 1)
+#define TW_LEVEL_MASK (TW_LEVEL_SIZE - 1)
+#define TW_LEVEL_INDEX(t, n)                                                   \
+	(((t) >> (TW_ROOT_BITS + (n)*TW_LEVEL_BITS)) & TW_LEVEL_MASK)
+#define TW_MAX_TICKS ((1LL << (TW_ROOT_BITS + TW_LEVELS * TW_LEVEL_BITS)) - 1)
+
+TimerWheel::TimerWheel(int64_t now) : base(now / TW_TICK)
+{
+	memset(root_map, 0, sizeof(root_map));
+}
+
+TimerWheel::~TimerWheel()
+{
+	for (int i = 0; i < TW_ROOT_SIZE; i++)
+		root[i].FreeList();
+	for (int n = 0; n < TW_LEVELS; n++)
+		for (int i = 0; i < TW_LEVEL_SIZE; i++)
+			level[n][i].FreeList();
+}
+
+void TimerWheel::add_tick(TimerObject *o, int64_t tick)
+{
+	int64_t idx = tick - base;
+
+	if (idx < TW_ROOT_SIZE) {
+		/* 已经过期的放到下一个要处理的槽 */
+		int s = (idx < 0 ? base : tick) & TW_ROOT_MASK;
+		o->list_move_tail(root[s]);
+		root_map[s >> 6] |= 1ULL << (s & 63);
+		return;
+	}
+
+	if (idx > TW_MAX_TICKS) {
+		tick = base + TW_MAX_TICKS;
+		idx = TW_MAX_TICKS;
+	}
+
+	int n = 0;
+	while (n < TW_LEVELS - 1 &&
+	       idx >= 1LL << (TW_ROOT_BITS + (n + 1) * TW_LEVEL_BITS))
+		n++;
+	o->list_move_tail(level[n][TW_LEVEL_INDEX(tick, n)]);
+}
+
+void TimerWheel::add(TimerObject *o)
+{
+	/* 向上取整，保证到期时now >= objexp */
+	add_tick(o, (o->objexp + TW_TICK - 1) / TW_TICK);
+}
+
+/* 把第n层的一个槽下放到低层，返回槽号，为0时需要继续下放更高一层 */
+int TimerWheel::cascade(int n, int idx)
+{
+	ListObject<TimerObject> tmp;
+
+	list_splice_init(&level[n][idx].objlist, &tmp.objlist);
+	while (!tmp.ListEmpty()) {
+		TimerObject *o = tmp.NextOwner();
+		add_tick(o, (o->objexp + TW_TICK - 1) / TW_TICK);
+	}
+	return idx;
+}
+
+int TimerWheel::run(int64_t now)
+{
+	int64_t now_tick = now / TW_TICK;
+	int n = 0;
+
+	while (base <= now_tick) {
+		int idx = base & TW_ROOT_MASK;
+		if (idx == 0) {
+			for (int i = 0; i < TW_LEVELS; i++)
+				if (cascade(i, TW_LEVEL_INDEX(base, i)) != 0)
+					break;
+		}
+
+		/* 先摘下整个槽再触发，回调中重新挂的定时器不会在本槽里循环 */
+		ListObject<TimerObject> tmp;
+		list_splice_init(&root[idx].objlist, &tmp.objlist);
+		root_map[idx >> 6] &= ~(1ULL << (idx & 63));
+		base++;
+
+		while (!tmp.ListEmpty()) {
+			TimerObject *o = tmp.NextOwner();
+			o->list_del();
+			o->job_timer_procedure();
+			n++;
+		}
+	}
+	return n;
+}
+
+int64_t TimerWheel::next_expire(int64_t limit)
+{
+	int64_t limit_tick = limit / TW_TICK;
+
+	for (int i = 0; i < TW_ROOT_SIZE && base + i <= limit_tick;) {
+		int s = (base + i) & TW_ROOT_MASK;
+		uint64_t w = root_map[s >> 6] >> (s & 63);
+		if (w == 0) {
+			i += 64 - (s & 63);
+			continue;
+		}
+		i += __builtin_ctzll(w);
+		if (i >= TW_ROOT_SIZE || base + i > limit_tick)
+			break;
+		s = (base + i) & TW_ROOT_MASK;
+		if (root[s].ListEmpty()) {
+			root_map[s >> 6] &= ~(1ULL << (s & 63));
+			i++;
+			continue;
+		}
+		return (base + i) * TW_TICK;
+	}
+
+	/* 第0层没有，最迟在下一次下放时再检查 */
+	int64_t cascade_tick = (base | TW_ROOT_MASK) + 1;
+	if (cascade_tick * TW_TICK < limit)
+		return cascade_tick * TW_TICK;
+	return limit;
+}
+
 int TimerList::check_expired(int64_t now)
 {
 	int n = 0;
@@ -117,21 +254,20 @@ void TimerUnit::update_now_time(int max_wait, int interrupted)
 	}
 }
 
+/* TimerList只记录超时时间，定时器都挂在时间轮上 */
 TimerList *TimerUnit::get_timer_list_by_m_seconds(int to)
 {
-	TimerList *tl;
+	std::map<int, TimerList *>::iterator it = lists.find(to);
+	if (it != lists.end())
+		return it->second;
 
-	for (tl = next; tl; tl = tl->next) {
-		if (tl->timeout == to)
-			return tl;
-	}
-	tl = new TimerList(to, this);
-	tl->next = next;
-	next = tl;
+	TimerList *tl = new TimerList(to, this);
+	lists[to] = tl;
 	return tl;
 }
 
-TimerUnit::TimerUnit(void) : pending(0), next(NULL), m_TimeOffSet(0)
+TimerUnit::TimerUnit(void)
+	: pending(0), wheel(GET_TIMESTAMP()), m_TimeOffSet(0)
 {
 	m_SystemTime = GET_TIMESTAMP();
 	m_NowTime = m_SystemTime;
@@ -139,28 +275,18 @@ TimerUnit::TimerUnit(void) : pending(0), next(NULL), m_TimeOffSet(0)
 
 TimerUnit::~TimerUnit(void)
 {
-	while (next) {
-		TimerList *tl = next;
-		next = tl->next;
-		delete tl;
-	}
+	std::map<int, TimerList *>::iterator it;
+	for (it = lists.begin(); it != lists.end(); ++it)
+		delete it->second;
 };
 
 int TimerUnit::expire_micro_seconds(int msec, int msec0)
 {
 	int64_t exp;
-	TimerList *tl;
 	int64_t timestamp = get_now_time();
 	exp = timestamp + msec * (TIMESTAMP_PRECISION / 1000);
 
-	for (tl = next; tl; tl = tl->next) {
-		if (tl->tlist.ListEmpty())
-			continue;
-		TimerObject *o = tl->tlist.NextOwner();
-
-		if (o->objexp < exp)
-			exp = o->objexp;
-	}
+	exp = wheel.next_expire(exp);
 	exp -= timestamp;
 	if (exp <= 0)
 		return 0;
@@ -187,10 +313,7 @@ int TimerUnit::check_expired(int64_t now)
 
 	int n = check_ready();
 
-	TimerList *tl;
-	for (tl = next; tl; tl = tl->next) {
-		n += tl->check_expired(now);
-	}
+	n += wheel.run(now);
 	return n;
 }
 
@@ -16,27 +16,62 @@
 #ifndef __TIMERLIST_H__
 #define __TIMERLIST_H__
 
+#include <map>
 #include "list/list.h"
 #include "algorithm/timestamp.h"
 
 class TimerObject;
 class TimerUnit;
 
+/*
+ * 分层时间轮，精度1ms。第0层256个槽，之后4层各64个槽，共覆盖2^32ms，
+ * 更远的超时按最大值处理。插入和删除都是O(1)，到期时高层的槽逐级
+ * 下放到低层，均摊O(1)。
+ */
+#define TW_ROOT_BITS 8
+#define TW_LEVEL_BITS 6
+#define TW_ROOT_SIZE (1 << TW_ROOT_BITS)
+#define TW_LEVEL_SIZE (1 << TW_LEVEL_BITS)
+#define TW_LEVELS 4
+
+class TimerWheel {
+    private:
+	ListObject<TimerObject> root[TW_ROOT_SIZE];
+	ListObject<TimerObject> level[TW_LEVELS][TW_LEVEL_SIZE];
+	/* 第0层非空槽的位图，删除时不清除，查找时遇到空槽再清 */
+	uint64_t root_map[TW_ROOT_SIZE / 64];
+	/* 下一个待处理的tick(ms) */
+	int64_t base;
+
+	void add_tick(TimerObject *o, int64_t tick);
+	int cascade(int n, int idx);
+
+    public:
+	TimerWheel(int64_t now);
+	~TimerWheel();
+
+	/* 按o->objexp(us)挂到对应的槽上 */
+	void add(TimerObject *o);
+	/* 触发所有objexp<=now的定时器，返回个数 */
+	int run(int64_t now);
+	/* 最早可能到期的时间(us)，不晚于limit */
+	int64_t next_expire(int64_t limit);
+};
+
 class TimerList {
     private:
 	ListObject<TimerObject> tlist;
 	int timeout;
-	TimerList *next;
 	TimerUnit *timerUnitOwner;
 
     public:
 	friend class TimerUnit;
 	friend class TimerObject;
-	TimerList(int t) : timeout(t), next(NULL)
+	TimerList(int t) : timeout(t), timerUnitOwner(NULL)
 	{
 	}
 	TimerList(int t, TimerUnit *timerUnitOwner)
-		: timeout(t), next(NULL), timerUnitOwner(timerUnitOwner)
+		: timeout(t), timerUnitOwner(timerUnitOwner)
 	{
 	}
 	int64_t get_time_unit_now_time();
@@ -50,7 +85,8 @@ class TimerList {
 class TimerUnit {
     private:
 	TimerList pending;
-	TimerList *next;
+	std::map<int, TimerList *> lists;
+	TimerWheel wheel;
 
 	int64_t m_SystemTime; /*系统时间*/
 	int64_t m_NowTime; /*应用层时间*/
@@ -82,6 +118,7 @@ class TimerObject : private ListObject<TimerObject> {
     public:
 	friend class TimerList;
 	friend class TimerUnit;
+	friend class TimerWheel;
 	TimerObject()
 	{
 	}
@@ -92,6 +129,8 @@ class TimerObject : private ListObject<TimerObject> {
 		ResetList();
 	}
 	void attach_timer(class TimerList *o);
+	/* 任意超时时间(ms)，不需要先取TimerList */
+	void attach_timer(class TimerUnit *o, int msec);
 	void attach_ready_timer(class TimerUnit *o)
 	{
 		list_move_tail(o->pending.tlist);
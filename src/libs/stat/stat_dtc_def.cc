@@ -191,6 +191,14 @@ DTCStatDefinition g_stat_definition[] = {
 	{ DTC_KEY_EXPIRE_DTC_COUNT, "cache - dtc key expire count", SA_COUNT,
 	  SU_INT },
 
+	/***************** empty filter **************************/
+	{ DTC_EMPTY_FILTER_HITS, "cache - empty filter hits", SA_COUNT,
+	  SU_INT },
+	{ DTC_EMPTY_FILTER_KEYS, "cache - empty filter keys", SA_VALUE,
+	  SU_INT },
+	{ DTC_EMPTY_FILTER_FULL, "cache - empty filter set failed", SA_COUNT,
+	  SU_INT },
+
 	/************************** bitmapsvr ***********************/
 	{ BTM_INDEX_1, "Mem - index(1)", SA_COUNT, SU_INT },
 	{ BTM_INDEX_2, "Mem - index(2)", SA_COUNT, SU_INT },
@@ -204,6 +212,10 @@ DTCStatDefinition g_stat_definition[] = {
 	{ HBP_LRU_SET_COUNT, "hbp - lru set op count", SA_COUNT, SU_INT },
 	{ HBP_LRU_SET_HIT_COUNT, "hbp - lru set hit count", SA_COUNT, SU_INT },
 	{ HBP_LRU_CLR_COUNT, "hbp - lru clr op count", SA_COUNT, SU_INT },
+	{ HBP_LRU_SYNC_KEYS, "hbp - lru sync keys", SA_COUNT, SU_INT },
+	{ HBP_LRU_SYNC_BYTES, "hbp - lru sync log bytes", SA_COUNT, SU_INT },
+	{ HBP_LRU_SYNC_ROW_BYTES, "hbp - lru sync row-format bytes", SA_COUNT,
+	  SU_INT },
 
 	//      {HBP_INC_SYNC_STEP,          "hbp - inc-sync step",     SA_SAMPLE,   SU_INT, 0, 0,
 	//           { 1, 2, 5, 10, 20, 50, 100, 500, 1000, 2000, 5000, 10000} },
@@ -268,6 +280,49 @@ DTCStatDefinition g_stat_definition[] = {
 	{ DTC_BACK_BARRIER_COUNT, "end barrier number", SA_VALUE, SU_INT },
 	{ DTC_BACK_BARRIER_MAX_TASK, "end barrier max job number", SA_VALUE,
 	  SU_INT },
+	{ DTC_FRONT_BARRIER_COLLAPSED, "front barrier collapsed reads",
+	  SA_COUNT, SU_INT },
+	{ POOL_JOB_MALLOC_COUNT, "job pool - malloc count", SA_VALUE, SU_INT },
+	{ POOL_JOB_FREE_COUNT, "job pool - free count", SA_VALUE, SU_INT },
+	{ POOL_PACKET_MALLOC_COUNT, "packet pool - malloc count", SA_VALUE,
+	  SU_INT },
+	{ POOL_PACKET_FREE_COUNT, "packet pool - free count", SA_VALUE,
+	  SU_INT },
+	{ DGRAM_RECV_SYSCALL_COUNT, "udp recvmmsg calls", SA_COUNT, SU_INT },
+	{ DGRAM_RECV_PACKET_COUNT, "udp recvmmsg packets", SA_COUNT, SU_INT },
+	{ DGRAM_SEND_SYSCALL_COUNT, "udp sendmmsg calls", SA_COUNT, SU_INT },
+	{ DGRAM_SEND_PACKET_COUNT, "udp sendmmsg packets", SA_COUNT, SU_INT },
+	{ FLUSH_BATCH_COUNT, "flush batch requests", SA_COUNT, SU_INT },
+	{ FLUSH_BATCH_ROW_COUNT, "flush batch rows", SA_COUNT, SU_INT },
+	{ DTC_FLUSH_BUDGET, "cache - flush budget", SA_VALUE, SU_INT },
+	{ DTC_FLUSH_QUEUE, "cache - flush queue depth", SA_VALUE, SU_INT },
+	{ DTC_FLUSH_LATENCY, "cache - flush latency", SA_VALUE, SU_USEC },
+	{ DTC_FLUSH_ERRORS, "cache - flush errors", SA_COUNT, SU_INT },
+	{ DTC_COMPRESS_NODES, "cache - cold nodes compressed", SA_COUNT, SU_INT },
+	{ DTC_COMPRESS_SAVED, "cache - compress saved bytes", SA_VALUE, SU_INT },
+	{ DTC_COMPRESS_TIME, "cache - compress cpu usec", SA_COUNT, SU_INT },
+	{ DTC_UNCOMPRESS_NODES, "cache - compressed node hits", SA_COUNT,
+	  SU_INT },
+	{ DTC_UNCOMPRESS_TIME, "cache - uncompress cpu usec", SA_COUNT, SU_INT },
+	{ DTC_UPDATE_INPLACE, "cache - in-place row updates", SA_COUNT, SU_INT },
+	{ DTC_UPDATE_REWRITE, "cache - rewritten row updates", SA_COUNT,
+	  SU_INT },
+	{ EPOLL_WAIT_COUNT, "epoll_wait calls", SA_COUNT, SU_INT },
+	{ EPOLL_EVENT_COUNT, "epoll_wait events", SA_COUNT, SU_INT },
+	{ EPOLL_CTL_COUNT, "epoll_ctl calls", SA_COUNT, SU_INT },
+	{ DTC_ADMISSION_ADMITTED, "cache - admission admitted fills", SA_COUNT,
+	  SU_INT },
+	{ DTC_ADMISSION_REJECTED, "cache - admission rejected fills", SA_COUNT,
+	  SU_INT },
+	{ PURGE_NODES_PER_ALLOC,
+	  "try purge size - purged nodes per allocation",
+	  SA_SAMPLE,
+	  SU_INT,
+	  0,
+	  0,
+	  { 1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2500 } },
+	{ PURGE_LOOK_AHEAD_PICKS, "try purge size - look-ahead victims",
+	  SA_COUNT, SU_INT },
 	{ DATA_SIZE_HISTORY_STAT,
 	  "history data - size distribution",
 	  SA_SAMPLE,
@@ -129,6 +129,42 @@ enum {
 	DTC_KEY_EXPIRE_USER_COUNT,
 	DTC_KEY_EXPIRE_DTC_COUNT,
 
+	DTC_EMPTY_FILTER_HITS,
+	DTC_EMPTY_FILTER_KEYS,
+	DTC_EMPTY_FILTER_FULL,
+
+	DTC_FRONT_BARRIER_COLLAPSED,
+
+	POOL_JOB_MALLOC_COUNT,
+	POOL_JOB_FREE_COUNT,
+	POOL_PACKET_MALLOC_COUNT,
+	POOL_PACKET_FREE_COUNT,
+
+	DGRAM_RECV_SYSCALL_COUNT,
+	DGRAM_RECV_PACKET_COUNT,
+	DGRAM_SEND_SYSCALL_COUNT,
+	DGRAM_SEND_PACKET_COUNT,
+	FLUSH_BATCH_COUNT,
+	FLUSH_BATCH_ROW_COUNT,
+	DTC_FLUSH_BUDGET,
+	DTC_FLUSH_QUEUE,
+	DTC_FLUSH_LATENCY,
+	DTC_FLUSH_ERRORS,
+	DTC_COMPRESS_NODES,
+	DTC_COMPRESS_SAVED,
+	DTC_COMPRESS_TIME,
+	DTC_UNCOMPRESS_NODES,
+	DTC_UNCOMPRESS_TIME,
+	DTC_UPDATE_INPLACE,
+	DTC_UPDATE_REWRITE,
+	EPOLL_WAIT_COUNT,
+	EPOLL_EVENT_COUNT,
+	EPOLL_CTL_COUNT,
+	DTC_ADMISSION_ADMITTED,
+	DTC_ADMISSION_REJECTED,
+	PURGE_NODES_PER_ALLOC,
+	PURGE_LOOK_AHEAD_PICKS,
+
 	BTM_INDEX_1 = 2000,
 	BTM_INDEX_2,
 	BTM_INDEX_3,
@@ -143,6 +179,9 @@ enum {
 	HBP_LRU_SET_HIT_COUNT,
 	HBP_LRU_CLR_COUNT,
 	HBP_INC_SYNC_STEP,
+	HBP_LRU_SYNC_KEYS,
+	HBP_LRU_SYNC_BYTES,
+	HBP_LRU_SYNC_ROW_BYTES,
 
 	// statistic item for blacklist
 	BLACKLIST_CURRENT_SLOT = 3010,